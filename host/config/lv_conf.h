@@ -0,0 +1,79 @@
+/**
+ * LVGL configuration for the host simulator.
+ *
+ * Mirrors the LVGL options in ../sdkconfig that affect rendering cost (colour format, memory,
+ * caches, fonts, image decoders) so frame times are comparable between builds. Anything not
+ * set here uses the LVGL 8.4 default from lv_conf_internal.h.
+ */
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#include <stdint.h>
+
+/* Colour: RGB565, byte-swapped for the SH8601, as on the device. */
+#define LV_COLOR_DEPTH 16
+#define LV_COLOR_16_SWAP 1
+#define LV_COLOR_SCREEN_TRANSP 0
+#define LV_COLOR_MIX_ROUND_OFS 128
+#define LV_COLOR_CHROMA_KEY lv_color_hex(0x00ff00)
+
+/* Memory: stdlib malloc, like CONFIG_LV_MEM_CUSTOM. */
+#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM_INCLUDE <stdlib.h>
+#define LV_MEM_CUSTOM_ALLOC malloc
+#define LV_MEM_CUSTOM_FREE free
+#define LV_MEM_CUSTOM_REALLOC realloc
+#define LV_MEM_BUF_MAX_NUM 16
+#define LV_MEMCPY_MEMSET_STD 1
+
+/* Timing */
+#define LV_DISP_DEF_REFR_PERIOD 4
+#define LV_INDEV_DEF_READ_PERIOD 4
+#define LV_TICK_CUSTOM 1
+#define LV_TICK_CUSTOM_INCLUDE "sim_tick.h"
+#define LV_TICK_CUSTOM_SYS_TIME_EXPR (sim_tick_ms())
+#define LV_DPI_DEF 130
+
+/* Drawing */
+#define LV_DRAW_COMPLEX 1
+#define LV_SHADOW_CACHE_SIZE 0
+#define LV_CIRCLE_CACHE_SIZE 4
+#define LV_LAYER_SIMPLE_BUF_SIZE (24 * 1024)
+#define LV_IMG_CACHE_DEF_SIZE 2
+#define LV_GRADIENT_MAX_STOPS 2
+
+/* Logging and asserts */
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 1
+#define LV_USE_ASSERT_MALLOC 1
+#define LV_USE_ASSERT_STYLE 0
+#define LV_USE_ASSERT_MEM_INTEGRITY 0
+#define LV_USE_ASSERT_OBJ 0
+#define LV_USE_PERF_MONITOR 0
+#define LV_USE_MEM_MONITOR 0
+#define LV_USE_USER_DATA 1
+
+/* Fonts */
+#define LV_FONT_MONTSERRAT_12 1
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+#define LV_USE_FONT_PLACEHOLDER 1
+#define LV_TXT_ENC LV_TXT_ENC_UTF8
+
+/* Themes */
+#define LV_USE_THEME_DEFAULT 1
+#define LV_THEME_DEFAULT_DARK 0
+#define LV_THEME_DEFAULT_GROW 1
+#define LV_THEME_DEFAULT_TRANSITION_TIME 80
+#define LV_USE_THEME_BASIC 1
+
+/* Libraries used by the media apps and the screen cache */
+#define LV_USE_PNG 0
+#define LV_USE_SJPG 1
+#define LV_USE_GIF 1
+#define LV_USE_SNAPSHOT 1
+#define LV_USE_FS_STDIO 0
+#define LV_USE_FS_POSIX 0
+
+#endif /* LV_CONF_H */
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Milliseconds since the simulator started (LVGL tick source, see lv_conf.h).
+uint32_t sim_tick_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
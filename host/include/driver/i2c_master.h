@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build: opaque bus handle for service headers; no I2C traffic happens on the host.
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t *i2c_master_dev_handle_t;
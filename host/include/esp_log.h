@@ -0,0 +1,44 @@
+#pragma once
+
+// Host build: ESP_LOGx print to stdout through a replaceable vprintf, like the IDF logger.
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*vprintf_like_t)(const char *, va_list);
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+uint32_t esp_log_timestamp(void);
+
+#define ESP_LOG_FORMAT_(letter, format) #letter " (%u) %s: " format "\n"
+
+#define ESP_LOGE(tag, format, ...) \
+    esp_log_write(ESP_LOG_ERROR, tag, ESP_LOG_FORMAT_(E, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) \
+    esp_log_write(ESP_LOG_WARN, tag, ESP_LOG_FORMAT_(W, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) \
+    esp_log_write(ESP_LOG_INFO, tag, ESP_LOG_FORMAT_(I, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) \
+    esp_log_write(ESP_LOG_DEBUG, tag, ESP_LOG_FORMAT_(D, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) \
+    esp_log_write(ESP_LOG_VERBOSE, tag, ESP_LOG_FORMAT_(V, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+// Host build: only the auth-mode constants the settings UI compares against.
+
+#include "esp_err.h"
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+    WIFI_AUTH_WPA3_PSK = 6,
+} wifi_auth_mode_t;
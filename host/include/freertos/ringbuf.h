@@ -0,0 +1,27 @@
+#pragma once
+
+// Host build: item ring buffer (no-split semantics only).
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_ringbuf *RingbufHandle_t;
+
+typedef enum {
+    RINGBUF_TYPE_NOSPLIT = 0,
+    RINGBUF_TYPE_ALLOWSPLIT,
+    RINGBUF_TYPE_BYTEBUF,
+} RingbufferType_t;
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type);
+void vRingbufferDelete(RingbufHandle_t rb);
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *data, size_t size, TickType_t ticks);
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *item_size, TickType_t ticks);
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+// Internal interface between the simulator pieces (display, input, VFS, logging).
+
+// One lv_timer_handler() pass.
+typedef struct {
+    uint32_t handler_us; // wall time of the whole pass (timers, input, layout, render, flush)
+    uint32_t flush_us;   // part of handler_us spent copying stripes into the framebuffer
+    uint32_t px;         // pixels refreshed (0 when nothing was redrawn)
+    uint32_t areas;      // invalidated areas after LVGL and area_merge joined them
+    uint32_t flushes;    // flush_cb calls (one panel transaction each on the device)
+    uint32_t next_ms;    // lv_timer_handler() return value: time until the next LVGL timer
+} sim_frame_t;
+
+// Display: LVGL on an in-memory RGB565 framebuffer with an LVGL-style partial draw buffer.
+esp_err_t sim_display_init(int stripe_lines);
+void sim_display_step(sim_frame_t *out);
+void sim_display_set_pointer(int x, int y, bool pressed);
+bool sim_display_write_ppm(const char *path);
+
+// Paths under /sdcard are redirected to this host directory (see sim_esp.cpp).
+void sim_vfs_set_root(const char *dir);
+const char *sim_vfs_root(void);
+
+void sim_log_set_level(esp_log_level_t level);
+
+// Audio stands in for I2S: stream writes block for their playback time and, with a file set, are
+// appended to it as raw S16LE stereo at the stream's rate.
+void sim_audio_set_pcm_out(FILE *f);
+
+// FreeRTOS shim. Blocking shim calls are the cancellation points of vTaskDelete(other):
+// sim_task_check_deleted() unwinds the calling task if it was deleted.
+extern "C" void sim_task_check_deleted(void);
+// Marks every task deleted before the process exits.
+void sim_tasks_shutdown(void);
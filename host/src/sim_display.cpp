@@ -0,0 +1,265 @@
+// display_lvgl.h on the host: LVGL renders into partial stripe buffers like on the device, and
+// flush_cb copies each stripe into an in-memory RGB565 framebuffer. The pointer input device
+// reads the state set by the script runner.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "lvgl.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "app_pins.h"
+#include "area_merge.h"
+#include "display_lvgl.h"
+#include "screen_mirror.h"
+
+#include "sim.h"
+
+static const char *TAG = "sim_disp";
+
+static std::recursive_timed_mutex s_lvgl_mux;
+
+static lv_disp_draw_buf_t s_draw_buf;
+static lv_disp_drv_t s_disp_drv;
+static lv_indev_drv_t s_indev_drv;
+static lv_color_t *s_stripes[2] = {};
+static uint16_t *s_framebuffer = nullptr;
+static uint8_t s_brightness = 100;
+static bool s_display_on = true;
+
+static int s_ptr_x = 0;
+static int s_ptr_y = 0;
+static bool s_ptr_pressed = false;
+
+// Per pass, filled by flush_cb / monitor_cb.
+static uint32_t s_pass_flush_us = 0;
+static uint32_t s_pass_px = 0;
+static uint32_t s_pass_areas = 0;
+static uint32_t s_pass_flushes = 0;
+static bool s_pass_first_flush = true;
+
+static std::mutex s_stats_mux;
+static display_lvgl_flush_stats_t s_flush_stats = {};
+
+static void flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p)
+{
+    const int64_t t0 = esp_timer_get_time();
+    if (s_pass_first_flush) {
+        s_pass_first_flush = false;
+        lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+        uint32_t areas = 0;
+        for (uint32_t i = 0; disp && i < disp->inv_p; i++) {
+            areas += disp->inv_area_joined[i] ? 0 : 1;
+        }
+        s_pass_areas = areas;
+    }
+
+    const int w = lv_area_get_width(area);
+    for (int y = area->y1; y <= area->y2; y++) {
+        memcpy(&s_framebuffer[(size_t)y * APP_LCD_H_RES + area->x1], &color_p[(size_t)(y - area->y1) * w],
+               (size_t)w * sizeof(uint16_t));
+    }
+    screen_mirror_tap(area, color_p);
+
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    s_pass_flush_us += us;
+    s_pass_flushes++;
+    lv_disp_flush_ready(drv);
+}
+
+// Same combiner as the device driver, so pass counts match what the panel would see.
+static void render_start_cb(lv_disp_drv_t *drv)
+{
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    if (!disp || disp->inv_p == 0) {
+        return;
+    }
+    area_merge_result_t r;
+    area_merge_run(disp->inv_areas, disp->inv_area_joined, disp->inv_p, drv->draw_buf->size, AREA_MERGE_TXN_COST_PX, &r);
+}
+
+static void monitor_cb(lv_disp_drv_t *, uint32_t, uint32_t px)
+{
+    s_pass_px += px;
+}
+
+static void pointer_read_cb(lv_indev_drv_t *, lv_indev_data_t *data)
+{
+    data->point.x = (lv_coord_t)s_ptr_x;
+    data->point.y = (lv_coord_t)s_ptr_y;
+    data->state = s_ptr_pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+esp_err_t sim_display_init(int stripe_lines)
+{
+    if (stripe_lines <= 0 || stripe_lines > APP_LCD_V_RES) {
+        stripe_lines = APP_LCD_V_RES / 8;
+    }
+    s_framebuffer = (uint16_t *)calloc((size_t)APP_LCD_H_RES * APP_LCD_V_RES, sizeof(uint16_t));
+    const size_t stripe_px = (size_t)APP_LCD_H_RES * (size_t)stripe_lines;
+    s_stripes[0] = (lv_color_t *)malloc(stripe_px * sizeof(lv_color_t));
+    s_stripes[1] = (lv_color_t *)malloc(stripe_px * sizeof(lv_color_t));
+    if (!s_framebuffer || !s_stripes[0] || !s_stripes[1]) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    lv_init();
+    lv_disp_draw_buf_init(&s_draw_buf, s_stripes[0], s_stripes[1], (uint32_t)stripe_px);
+
+    lv_disp_drv_init(&s_disp_drv);
+    s_disp_drv.hor_res = APP_LCD_H_RES;
+    s_disp_drv.ver_res = APP_LCD_V_RES;
+    s_disp_drv.flush_cb = flush_cb;
+    s_disp_drv.render_start_cb = render_start_cb;
+    s_disp_drv.monitor_cb = monitor_cb;
+    s_disp_drv.draw_buf = &s_draw_buf;
+    lv_disp_drv_register(&s_disp_drv);
+
+    lv_indev_drv_init(&s_indev_drv);
+    s_indev_drv.type = LV_INDEV_TYPE_POINTER;
+    s_indev_drv.read_cb = pointer_read_cb;
+    lv_indev_drv_register(&s_indev_drv);
+
+    s_flush_stats.stripe_lines = (uint16_t)stripe_lines;
+    s_flush_stats.pool_size = 2;
+    ESP_LOGI(TAG, "%dx%d framebuffer, %d-line stripes", APP_LCD_H_RES, APP_LCD_V_RES, stripe_lines);
+    return ESP_OK;
+}
+
+void sim_display_step(sim_frame_t *out)
+{
+    s_pass_flush_us = 0;
+    s_pass_px = 0;
+    s_pass_areas = 0;
+    s_pass_flushes = 0;
+    s_pass_first_flush = true;
+
+    display_lvgl_lock(-1);
+    const int64_t t0 = esp_timer_get_time();
+    const uint32_t next_ms = lv_timer_handler();
+    const uint32_t handler_us = (uint32_t)(esp_timer_get_time() - t0);
+    display_lvgl_unlock();
+
+    if (s_pass_px > 0) {
+        std::lock_guard<std::mutex> guard(s_stats_mux);
+        display_lvgl_flush_stats_t *fs = &s_flush_stats;
+        fs->frames++;
+        fs->last_render_us = handler_us - s_pass_flush_us;
+        fs->last_transfer_us = s_pass_flush_us;
+        fs->last_overlap_us = 0;
+        fs->last_wait_us = 0;
+        fs->last_px = s_pass_px;
+        fs->avg_render_us = (fs->avg_render_us * 7 + fs->last_render_us) / 8;
+        fs->avg_transfer_us = (fs->avg_transfer_us * 7 + fs->last_transfer_us) / 8;
+    }
+
+    if (out) {
+        out->handler_us = handler_us;
+        out->flush_us = s_pass_flush_us;
+        out->px = s_pass_px;
+        out->areas = s_pass_areas;
+        out->flushes = s_pass_flushes;
+        out->next_ms = next_ms;
+    }
+}
+
+void sim_display_set_pointer(int x, int y, bool pressed)
+{
+    s_ptr_x = x;
+    s_ptr_y = y;
+    s_ptr_pressed = pressed;
+}
+
+bool sim_display_write_ppm(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "cannot write %s", path);
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", APP_LCD_H_RES, APP_LCD_V_RES);
+    for (size_t i = 0; i < (size_t)APP_LCD_H_RES * APP_LCD_V_RES; i++) {
+        uint16_t c = s_framebuffer[i];
+#if LV_COLOR_16_SWAP
+        c = (uint16_t)((c << 8) | (c >> 8));
+#endif
+        const uint8_t r = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+        const uint8_t g = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+        const uint8_t b = (uint8_t)((c & 0x1F) * 255 / 31);
+        const uint8_t rgb[3] = {r, g, b};
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return true;
+}
+
+// ---- display_lvgl.h ----
+
+esp_err_t display_lvgl_init(void)
+{
+    return sim_display_init(0);
+}
+
+bool display_lvgl_lock(int timeout_ms)
+{
+    // Tasks blocked here must still see vTaskDelete(), so wait in slices.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms);
+    while (!s_lvgl_mux.try_lock_for(std::chrono::milliseconds(10))) {
+        sim_task_check_deleted();
+        if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void display_lvgl_unlock(void)
+{
+    s_lvgl_mux.unlock();
+}
+
+void display_lvgl_wake(void)
+{
+    // The simulator loop polls at the LVGL timer deadline (capped, see sim_main.cpp).
+}
+
+esp_err_t display_lvgl_async_call(void (*cb)(void *), void *user_data)
+{
+    if (!display_lvgl_lock(1000)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    const lv_res_t res = lv_async_call(cb, user_data);
+    display_lvgl_unlock();
+    return res == LV_RES_OK ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void display_lvgl_set_on(bool on)
+{
+    s_display_on = on;
+}
+
+void display_lvgl_set_brightness(uint8_t brightness_percent)
+{
+    s_brightness = brightness_percent > 100 ? 100 : brightness_percent;
+}
+
+uint8_t display_lvgl_get_brightness(void)
+{
+    return s_brightness;
+}
+
+void display_lvgl_get_flush_stats(display_lvgl_flush_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(s_stats_mux);
+    *out = s_flush_stats;
+}
@@ -0,0 +1,194 @@
+// ESP-IDF runtime pieces the UI code calls directly: logging, heap_caps, error names, and the
+// /sdcard mount point (redirected to a host directory).
+
+#include <dirent.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <mutex>
+#include <string>
+
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "sim.h"
+
+// ---- logging ----
+
+static vprintf_like_t s_vprintf = vprintf;
+static esp_log_level_t s_level = ESP_LOG_INFO;
+static std::mutex s_log_mux;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
+{
+    std::lock_guard<std::mutex> guard(s_log_mux);
+    vprintf_like_t prev = s_vprintf;
+    s_vprintf = func ? func : vprintf;
+    return prev;
+}
+
+void esp_log_level_set(const char *, esp_log_level_t level)
+{
+    s_level = level;
+}
+
+void sim_log_set_level(esp_log_level_t level)
+{
+    s_level = level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_write(esp_log_level_t level, const char *, const char *format, ...)
+{
+    if (level > s_level) {
+        return;
+    }
+    vprintf_like_t fn;
+    {
+        std::lock_guard<std::mutex> guard(s_log_mux);
+        fn = s_vprintf;
+    }
+    va_list args;
+    va_start(args, format);
+    fn(format, args);
+    va_end(args);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    default: return "ERROR";
+    }
+}
+
+// ---- heap ----
+
+// Typical free heap on the board after boot (8 MB PSRAM).
+#define SIM_FREE_INTERNAL (160 * 1024)
+#define SIM_FREE_SPIRAM (6 * 1024 * 1024)
+
+void *heap_caps_malloc(size_t size, uint32_t)
+{
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t)
+{
+    return calloc(n, size);
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t)
+{
+    return realloc(ptr, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? SIM_FREE_SPIRAM : SIM_FREE_INTERNAL;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
+
+// ---- /sdcard ----
+//
+// The UI code and the S: LVGL driver use absolute /sdcard paths. The host build links with
+// -Wl,--wrap=fopen,--wrap=opendir,--wrap=mkdir (and stat, rename, unlink for media_index) so those calls land here and are rebased onto the
+// directory given with --sdcard.
+
+static std::string s_vfs_root;
+
+extern "C" FILE *__real_fopen(const char *path, const char *mode);
+extern "C" DIR *__real_opendir(const char *path);
+extern "C" int __real_mkdir(const char *path, mode_t mode);
+extern "C" int __real_stat(const char *path, struct stat *st);
+extern "C" int __real_rename(const char *from, const char *to);
+extern "C" int __real_unlink(const char *path);
+
+void sim_vfs_set_root(const char *dir)
+{
+    s_vfs_root = dir ? dir : "";
+    while (s_vfs_root.size() > 1 && s_vfs_root.back() == '/') {
+        s_vfs_root.pop_back();
+    }
+}
+
+const char *sim_vfs_root(void)
+{
+    return s_vfs_root.empty() ? nullptr : s_vfs_root.c_str();
+}
+
+static bool map_path(const char *path, std::string *out)
+{
+    static const char kMount[] = "/sdcard";
+    const size_t n = sizeof(kMount) - 1;
+    if (s_vfs_root.empty() || !path || strncmp(path, kMount, n) != 0 || (path[n] != '\0' && path[n] != '/')) {
+        return false;
+    }
+    *out = s_vfs_root + (path + n);
+    return true;
+}
+
+extern "C" FILE *__wrap_fopen(const char *path, const char *mode)
+{
+    std::string mapped;
+    return __real_fopen(map_path(path, &mapped) ? mapped.c_str() : path, mode);
+}
+
+extern "C" DIR *__wrap_opendir(const char *path)
+{
+    std::string mapped;
+    return __real_opendir(map_path(path, &mapped) ? mapped.c_str() : path);
+}
+
+extern "C" int __wrap_mkdir(const char *path, mode_t mode)
+{
+    std::string mapped;
+    return __real_mkdir(map_path(path, &mapped) ? mapped.c_str() : path, mode);
+}
+
+extern "C" int __wrap_stat(const char *path, struct stat *st)
+{
+    std::string mapped;
+    return __real_stat(map_path(path, &mapped) ? mapped.c_str() : path, st);
+}
+
+extern "C" int __wrap_rename(const char *from, const char *to)
+{
+    std::string mapped_from;
+    std::string mapped_to;
+    return __real_rename(map_path(from, &mapped_from) ? mapped_from.c_str() : from,
+                         map_path(to, &mapped_to) ? mapped_to.c_str() : to);
+}
+
+extern "C" int __wrap_unlink(const char *path)
+{
+    std::string mapped;
+    return __real_unlink(map_path(path, &mapped) ? mapped.c_str() : path);
+}
@@ -0,0 +1,249 @@
+// FreeRTOS shim for the host build: tasks on std::thread, 1 ms ticks, item ring buffers.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "sim.h"
+#include "sim_tick.h"
+
+static const char *TAG = "sim_rtos";
+
+struct sim_task {
+    std::string name;
+    std::atomic<bool> deleted{false};
+};
+
+// Thrown at a blocking call of a task that was deleted; unwinds to the thread entry.
+struct sim_task_exit {};
+
+static thread_local sim_task *t_current = nullptr;
+static std::mutex s_tasks_mux;
+static std::vector<sim_task *> s_tasks;
+
+static const auto s_start = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+uint32_t sim_tick_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Cancellation point for cooperative vTaskDelete() of another task.
+extern "C" void sim_task_check_deleted(void)
+{
+    if (t_current && t_current->deleted.load(std::memory_order_relaxed)) {
+        throw sim_task_exit();
+    }
+}
+
+static void task_entry(sim_task *task, TaskFunction_t fn, void *arg)
+{
+    t_current = task;
+    try {
+        fn(arg);
+        ESP_LOGW(TAG, "task %s returned without vTaskDelete()", task->name.c_str());
+    } catch (const sim_task_exit &) {
+    }
+    std::lock_guard<std::mutex> guard(s_tasks_mux);
+    for (size_t i = 0; i < s_tasks.size(); i++) {
+        if (s_tasks[i] == task) {
+            s_tasks.erase(s_tasks.begin() + (long)i);
+            break;
+        }
+    }
+    delete task;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t, void *arg, UBaseType_t,
+                                   TaskHandle_t *out_handle, BaseType_t)
+{
+    sim_task *task = new sim_task();
+    task->name = name ? name : "";
+    {
+        std::lock_guard<std::mutex> guard(s_tasks_mux);
+        s_tasks.push_back(task);
+    }
+    if (out_handle) {
+        *out_handle = task;
+    }
+    std::thread(task_entry, task, fn, arg).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *out_handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, out_handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (!task || task == t_current) {
+        if (!t_current) {
+            ESP_LOGE(TAG, "vTaskDelete(NULL) outside a task");
+            abort();
+        }
+        throw sim_task_exit();
+    }
+    std::lock_guard<std::mutex> guard(s_tasks_mux);
+    for (sim_task *t : s_tasks) {
+        if (t == task) {
+            t->deleted.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sim_task_check_deleted();
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+    sim_task_check_deleted();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)sim_tick_ms();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return t_current;
+}
+
+void sim_tasks_shutdown(void)
+{
+    std::lock_guard<std::mutex> guard(s_tasks_mux);
+    for (sim_task *t : s_tasks) {
+        t->deleted.store(true, std::memory_order_relaxed);
+    }
+}
+
+struct sim_ringbuf {
+    std::mutex mux;
+    std::condition_variable cv;
+    std::deque<std::vector<char>> items;
+    size_t capacity;
+    size_t used;
+    // vRingbufferDelete() can race a receiver whose task was deleted but has not noticed yet;
+    // the last one out frees the buffer.
+    int waiters;
+    bool dead;
+};
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t)
+{
+    sim_ringbuf *rb = new sim_ringbuf();
+    rb->capacity = size;
+    rb->used = 0;
+    rb->waiters = 0;
+    rb->dead = false;
+    return rb;
+}
+
+void vRingbufferDelete(RingbufHandle_t rb)
+{
+    if (!rb) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(rb->mux);
+    rb->dead = true;
+    if (rb->waiters > 0) {
+        rb->cv.notify_all();
+        return;
+    }
+    lock.unlock();
+    delete rb;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *data, size_t size, TickType_t)
+{
+    if (!rb) {
+        return pdFALSE;
+    }
+    {
+        std::lock_guard<std::mutex> guard(rb->mux);
+        // Item header overhead on the device is 8 bytes.
+        if (rb->dead || rb->used + size + 8 > rb->capacity) {
+            return pdFALSE;
+        }
+        rb->items.emplace_back((const char *)data, (const char *)data + size);
+        rb->used += size + 8;
+    }
+    rb->cv.notify_one();
+    return pdTRUE;
+}
+
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *item_size, TickType_t ticks)
+{
+    sim_task_check_deleted();
+    if (!rb) {
+        return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(rb->mux);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks);
+    rb->waiters++;
+    while (rb->items.empty() && !rb->dead) {
+        if (ticks != portMAX_DELAY && std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        // Wake periodically so a deleted task notices.
+        rb->cv.wait_for(lock, std::chrono::milliseconds(20));
+        if (t_current && t_current->deleted.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    rb->waiters--;
+    if (rb->dead) {
+        const bool last = rb->waiters == 0;
+        lock.unlock();
+        if (last) {
+            delete rb;
+        }
+        sim_task_check_deleted();
+        return nullptr;
+    }
+    if (rb->items.empty()) {
+        lock.unlock();
+        sim_task_check_deleted();
+        return nullptr;
+    }
+
+    std::vector<char> &front = rb->items.front();
+    char *item = (char *)malloc(front.size() + 1);
+    if (!item) {
+        return nullptr;
+    }
+    memcpy(item, front.data(), front.size());
+    item[front.size()] = '\0';
+    if (item_size) {
+        *item_size = front.size();
+    }
+    rb->used -= front.size() + 8;
+    rb->items.pop_front();
+    return item;
+}
+
+void vRingbufferReturnItem(RingbufHandle_t, void *item)
+{
+    free(item);
+}
@@ -0,0 +1,438 @@
+// Headless launcher simulator: boots the carousel like app_main(), replays a touch script and
+// reports per-frame LVGL timings for each marked section of the script.
+//
+//   launcher_sim [--script FILE] [--sdcard DIR] [--stripe-lines N] [--csv FILE] [--max-p95-us N]
+//                [--mirror FILE] [--pcm-out FILE] [--quiet]
+//
+// --mirror records the screen_mirror stream the device serves at /mirror/ws, each message prefixed
+// with its length as a little-endian u32; tools/mirror_decode.py turns it back into images.
+// --pcm-out writes what the MP3 player sends to I2S as raw S16LE stereo.
+//
+// Script commands (one per line, '#' starts a comment):
+//   mark NAME                    start a new report section
+//   wait MS                      run the UI for MS milliseconds
+//   tap X Y                      press and release at X,Y
+//   press X Y / release          hold or lift the pointer
+//   move X Y MS                  drag the held pointer to X,Y over MS milliseconds
+//   swipe X0 Y0 X1 Y1 MS         press, drag, release
+//   screenshot FILE.ppm          dump the framebuffer
+//   repeat N ... end             replay the enclosed lines N times (no nesting)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lvgl.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "display_lvgl.h"
+#include "lvgl_fs_sdcard.h"
+#include "screen_mirror.h"
+#include "ui_app_carousel.h"
+#include "ui_launcher.h"
+
+#include "sim.h"
+
+static const char *TAG = "sim";
+
+// Longest sleep between lv_timer_handler() passes. Worker tasks queue UI work with
+// display_lvgl_async_call(), which cannot wake this loop, so it must poll.
+#define SIM_MAX_IDLE_MS 10
+// Pointer position updates while dragging (the FT5x06 reports at about this rate).
+#define SIM_MOVE_STEP_MS 10
+#define SIM_TAP_HOLD_MS 60
+
+// Default script: walk the carousel, open and leave each built-in app twice (cold, then from
+// the screen cache), with coordinates for the 368x448 layout.
+static const char *kDefaultScript = R"(
+mark boot_idle
+wait 1000
+
+mark carousel_swipe
+repeat 4
+swipe 300 210 60 210 150
+wait 300
+end
+repeat 4
+swipe 60 210 300 210 150
+wait 300
+end
+
+mark settings
+tap 184 423
+wait 1000
+tap 324 30
+wait 600
+
+mark terminal
+tap 343 204
+wait 300
+tap 184 423
+wait 1000
+tap 44 22
+wait 600
+
+mark media_cold
+tap 343 204
+wait 300
+tap 184 423
+wait 1500
+tap 324 30
+wait 600
+
+mark mp3_cold
+tap 343 204
+wait 300
+tap 184 423
+wait 1500
+tap 44 30
+wait 600
+
+mark media_warm
+tap 27 204
+wait 300
+tap 184 423
+wait 1000
+tap 324 30
+wait 600
+
+mark mp3_warm
+tap 343 204
+wait 300
+tap 184 423
+wait 1000
+tap 44 30
+wait 600
+)";
+
+struct Section {
+    std::string name;
+    std::vector<uint32_t> frame_us;
+    uint64_t flush_us = 0;
+    uint64_t px = 0;
+    uint64_t areas = 0;
+    uint64_t flushes = 0;
+    uint32_t passes = 0;
+};
+
+static std::vector<Section> s_sections;
+static FILE *s_csv = nullptr;
+static FILE *s_mirror = nullptr;
+static std::atomic<bool> s_mirror_done{false};
+static int s_ptr_x = 0;
+static int s_ptr_y = 0;
+
+static Section &current_section(void)
+{
+    if (s_sections.empty()) {
+        s_sections.push_back(Section{"start", {}, 0, 0, 0, 0, 0});
+    }
+    return s_sections.back();
+}
+
+static void run_for(uint32_t ms)
+{
+    const int64_t end_us = esp_timer_get_time() + (int64_t)ms * 1000;
+    do {
+        sim_frame_t f;
+        sim_display_step(&f);
+        Section &sec = current_section();
+        sec.passes++;
+        if (f.px > 0) {
+            sec.frame_us.push_back(f.handler_us);
+            sec.flush_us += f.flush_us;
+            sec.px += f.px;
+            sec.areas += f.areas;
+            sec.flushes += f.flushes;
+            if (s_csv) {
+                fprintf(s_csv, "%s,%u,%u,%u,%u,%u,%u\n", sec.name.c_str(), (unsigned)(esp_timer_get_time() / 1000),
+                        (unsigned)f.handler_us, (unsigned)f.flush_us, (unsigned)f.px, (unsigned)f.areas,
+                        (unsigned)f.flushes);
+            }
+        }
+        const int64_t left_us = end_us - esp_timer_get_time();
+        if (left_us <= 0) {
+            break;
+        }
+        const uint32_t sleep_ms = std::min<uint32_t>(std::max<uint32_t>(f.next_ms, 1), SIM_MAX_IDLE_MS);
+        std::this_thread::sleep_for(std::min(std::chrono::microseconds(sleep_ms * 1000),
+                                             std::chrono::microseconds(left_us)));
+    } while (true);
+}
+
+static void pointer(int x, int y, bool down)
+{
+    s_ptr_x = x;
+    s_ptr_y = y;
+    sim_display_set_pointer(x, y, down);
+}
+
+static void drag_to(int x, int y, uint32_t ms)
+{
+    const int x0 = s_ptr_x;
+    const int y0 = s_ptr_y;
+    const uint32_t steps = std::max<uint32_t>(ms / SIM_MOVE_STEP_MS, 1);
+    for (uint32_t i = 1; i <= steps; i++) {
+        pointer(x0 + (x - x0) * (int)i / (int)steps, y0 + (y - y0) * (int)i / (int)steps, true);
+        run_for(SIM_MOVE_STEP_MS);
+    }
+}
+
+static bool run_line(const std::string &line, int line_no)
+{
+    std::istringstream in(line);
+    std::string cmd;
+    if (!(in >> cmd) || cmd[0] == '#') {
+        return true;
+    }
+    int a = 0, b = 0, c = 0, d = 0, e = 0;
+    if (cmd == "mark") {
+        std::string name;
+        in >> name;
+        s_sections.push_back(Section{name, {}, 0, 0, 0, 0, 0});
+    } else if (cmd == "wait" && (in >> a)) {
+        run_for((uint32_t)a);
+    } else if (cmd == "tap" && (in >> a >> b)) {
+        pointer(a, b, true);
+        run_for(SIM_TAP_HOLD_MS);
+        pointer(a, b, false);
+        run_for(SIM_MOVE_STEP_MS * 2);
+    } else if (cmd == "press" && (in >> a >> b)) {
+        pointer(a, b, true);
+        run_for(SIM_MOVE_STEP_MS);
+    } else if (cmd == "move" && (in >> a >> b >> c)) {
+        drag_to(a, b, (uint32_t)c);
+    } else if (cmd == "release") {
+        pointer(s_ptr_x, s_ptr_y, false);
+        run_for(SIM_MOVE_STEP_MS * 2);
+    } else if (cmd == "swipe" && (in >> a >> b >> c >> d >> e)) {
+        pointer(a, b, true);
+        run_for(SIM_MOVE_STEP_MS);
+        drag_to(c, d, (uint32_t)e);
+        pointer(c, d, false);
+        run_for(SIM_MOVE_STEP_MS * 2);
+    } else if (cmd == "screenshot") {
+        std::string path;
+        in >> path;
+        if (path.empty() || !sim_display_write_ppm(path.c_str())) {
+            return false;
+        }
+    } else {
+        ESP_LOGE(TAG, "script line %d: cannot parse '%s'", line_no, line.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool run_script(std::istream &script)
+{
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(script, line);) {
+        lines.push_back(line);
+    }
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::istringstream in(lines[i]);
+        std::string cmd;
+        int count = 0;
+        if ((in >> cmd) && cmd == "repeat" && (in >> count)) {
+            size_t end = i + 1;
+            while (end < lines.size() && lines[end].find("end") != 0) {
+                end++;
+            }
+            for (int r = 0; r < count; r++) {
+                for (size_t j = i + 1; j < end; j++) {
+                    if (!run_line(lines[j], (int)j + 1)) {
+                        return false;
+                    }
+                }
+            }
+            i = end;
+            continue;
+        }
+        if (!run_line(lines[i], (int)i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t percentile(std::vector<uint32_t> v, double p)
+{
+    if (v.empty()) {
+        return 0;
+    }
+    std::sort(v.begin(), v.end());
+    const size_t idx = std::min(v.size() - 1, (size_t)(p * (double)(v.size() - 1) + 0.5));
+    return v[idx];
+}
+
+// Returns the worst p95 of all sections.
+static uint32_t print_report(void)
+{
+    uint32_t worst_p95 = 0;
+    printf("\n%-16s %7s %7s %9s %9s %9s %9s %9s %9s %9s %8s\n", "section", "passes", "frames", "avg_us", "p50_us",
+           "p95_us", "p99_us", "max_us", "flush_us", "kpx/frm", "txn/frm");
+    for (const Section &s : s_sections) {
+        const size_t n = s.frame_us.size();
+        uint64_t sum = 0;
+        uint32_t max_us = 0;
+        for (uint32_t us : s.frame_us) {
+            sum += us;
+            max_us = std::max(max_us, us);
+        }
+        const uint32_t p95 = percentile(s.frame_us, 0.95);
+        worst_p95 = std::max(worst_p95, p95);
+        printf("%-16s %7u %7zu %9u %9u %9u %9u %9u %9u %9.1f %8.1f\n", s.name.c_str(), (unsigned)s.passes, n,
+               (unsigned)(n ? sum / n : 0), (unsigned)percentile(s.frame_us, 0.50), (unsigned)p95,
+               (unsigned)percentile(s.frame_us, 0.99), (unsigned)max_us, (unsigned)(n ? s.flush_us / n : 0),
+               n ? (double)s.px / (double)n / 1000.0 : 0.0, n ? (double)s.flushes / (double)n : 0.0);
+    }
+    return worst_p95;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--script FILE] [--sdcard DIR] [--stripe-lines N] [--csv FILE] [--max-p95-us N]\n"
+            "       [--mirror FILE] [--pcm-out FILE] [--quiet]\n",
+            argv0);
+}
+
+static bool mirror_write(const uint8_t *data, size_t len, void *)
+{
+    const uint8_t hdr[4] = {(uint8_t)len, (uint8_t)(len >> 8), (uint8_t)(len >> 16), (uint8_t)(len >> 24)};
+    return fwrite(hdr, 1, sizeof(hdr), s_mirror) == sizeof(hdr) && fwrite(data, 1, len, s_mirror) == len;
+}
+
+static void mirror_done(void *)
+{
+    s_mirror_done.store(true);
+}
+
+int main(int argc, char **argv)
+{
+    const char *script_path = nullptr;
+    const char *csv_path = nullptr;
+    const char *mirror_path = nullptr;
+    FILE *pcm_out = nullptr;
+    int stripe_lines = 0;
+    uint32_t max_p95_us = 0;
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--script") && has_value) {
+            script_path = argv[++i];
+        } else if (!strcmp(argv[i], "--sdcard") && has_value) {
+            sim_vfs_set_root(argv[++i]);
+        } else if (!strcmp(argv[i], "--stripe-lines") && has_value) {
+            stripe_lines = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--csv") && has_value) {
+            csv_path = argv[++i];
+        } else if (!strcmp(argv[i], "--max-p95-us") && has_value) {
+            max_p95_us = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--mirror") && has_value) {
+            mirror_path = argv[++i];
+        } else if (!strcmp(argv[i], "--pcm-out") && has_value) {
+            pcm_out = fopen(argv[++i], "wb");
+            if (!pcm_out) {
+                ESP_LOGE(TAG, "cannot write %s", argv[i]);
+                return 2;
+            }
+            sim_audio_set_pcm_out(pcm_out);
+        } else if (!strcmp(argv[i], "--quiet")) {
+            sim_log_set_level(ESP_LOG_WARN);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (csv_path) {
+        s_csv = fopen(csv_path, "w");
+        if (!s_csv) {
+            ESP_LOGE(TAG, "cannot write %s", csv_path);
+            return 2;
+        }
+        fprintf(s_csv, "section,t_ms,handler_us,flush_us,px,areas,flushes\n");
+    }
+
+    if (sim_display_init(stripe_lines) != ESP_OK) {
+        ESP_LOGE(TAG, "display init failed");
+        return 1;
+    }
+
+    // Same UI bring-up as app_main().
+    display_lvgl_lock(-1);
+    lvgl_fs_sdcard_init();
+    if (ui_app_carousel_init() != ESP_OK) {
+        ui_launcher_init();
+    }
+    display_lvgl_unlock();
+
+    if (mirror_path) {
+        s_mirror = fopen(mirror_path, "wb");
+        screen_mirror_config_t cfg = {};
+        cfg.sink = mirror_write;
+        cfg.on_stop = mirror_done;
+        if (!s_mirror || screen_mirror_start(&cfg) != ESP_OK) {
+            ESP_LOGE(TAG, "cannot record the mirror to %s", mirror_path);
+            return 2;
+        }
+    }
+
+    bool ok;
+    if (script_path) {
+        std::ifstream f(script_path);
+        if (!f) {
+            ESP_LOGE(TAG, "cannot open %s", script_path);
+            return 2;
+        }
+        ok = run_script(f);
+    } else {
+        std::istringstream f(kDefaultScript);
+        ok = run_script(f);
+    }
+
+    const uint32_t worst_p95 = print_report();
+    if (s_csv) {
+        fclose(s_csv);
+    }
+    if (s_mirror) {
+        // Let the sender catch up with the last frame, then stop it before closing the file.
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        screen_mirror_stop();
+        while (!s_mirror_done.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        fclose(s_mirror);
+        screen_mirror_stats_t st;
+        screen_mirror_get_stats(&st);
+        printf("mirror: %u frames, %u messages, %u KB for %u KB of pixels, %u throttled passes\n", (unsigned)st.frames,
+               (unsigned)st.messages, (unsigned)(st.bytes / 1024), (unsigned)(st.raw_bytes / 1024),
+               (unsigned)st.throttled);
+    }
+    fflush(stdout);
+    sim_tasks_shutdown();
+    if (pcm_out) {
+        sim_audio_set_pcm_out(nullptr);
+        fclose(pcm_out);
+    }
+
+    int rc = ok ? 0 : 1;
+    if (ok && max_p95_us && worst_p95 > max_p95_us) {
+        printf("p95 frame time %u us exceeds --max-p95-us %u\n", (unsigned)worst_p95, (unsigned)max_p95_us);
+        rc = 3;
+    }
+    // Worker tasks are detached threads; skip static destructors they might still be using.
+    quick_exit(rc);
+}
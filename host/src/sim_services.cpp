@@ -0,0 +1,248 @@
+// Service stubs for the host build. They return plausible board state so the UI lays out as on
+// the device; audio output is paced in real time so the MP3 tasks run at speed, and is discarded
+// unless --pcm-out gives it a file.
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "esp_log.h"
+#include "media_index.h"
+
+#include "services/app_manager.h"
+#include "services/audio_es8311.h"
+#include "services/ble_service.h"
+#include "services/imu_qmi8658.h"
+#include "services/ota_service.h"
+#include "services/power_axp2101.h"
+#include "services/power_manager.h"
+#include "services/sdcard_service.h"
+#include "services/time_service.h"
+#include "services/wifi_service.h"
+#include "ui_fileserver.h"
+#include "ui_radio.h"
+
+#include "sim.h"
+
+static const char *TAG = "sim_svc";
+
+// ---- app manager: no installed .app files ----
+
+int app_manager_get_app_count(void)
+{
+    return 0;
+}
+
+const app_metadata_t *app_manager_get_app(int)
+{
+    return nullptr;
+}
+
+// ---- audio ----
+
+static int s_volume = 60;
+static int s_mic_gain = 50;
+static bool s_muted = false;
+static bool s_audio_enabled = true;
+static bool s_ui_sounds = true;
+static int s_stream_rate_hz = 0;
+static std::mutex s_pcm_out_mux; // the output task may still be writing when main() clears the file
+static FILE *s_pcm_out = nullptr;
+
+void sim_audio_set_pcm_out(FILE *f)
+{
+    std::lock_guard<std::mutex> guard(s_pcm_out_mux);
+    s_pcm_out = f;
+}
+
+bool audio_es8311_get_enabled(void) { return s_audio_enabled; }
+void audio_es8311_set_enabled(bool enabled) { s_audio_enabled = enabled; }
+int audio_es8311_get_volume(void) { return s_volume; }
+void audio_es8311_set_volume(int volume_0_100) { s_volume = volume_0_100; }
+bool audio_es8311_get_muted(void) { return s_muted; }
+void audio_es8311_set_muted(bool muted) { s_muted = muted; }
+int audio_es8311_get_mic_gain(void) { return s_mic_gain; }
+void audio_es8311_set_mic_gain(int gain_0_100) { s_mic_gain = gain_0_100; }
+int audio_es8311_get_mic_level(void) { return 0; }
+bool audio_es8311_get_ui_sounds_enabled(void) { return s_ui_sounds; }
+void audio_es8311_set_ui_sounds_enabled(bool enabled) { s_ui_sounds = enabled; }
+esp_err_t audio_es8311_play_beep(void) { return ESP_OK; }
+esp_err_t audio_es8311_play_click(void) { return ESP_OK; }
+
+esp_err_t audio_es8311_stream_begin(int sample_rate_hz)
+{
+    s_stream_rate_hz = sample_rate_hz;
+    return ESP_OK;
+}
+
+void audio_es8311_stream_end(void)
+{
+    s_stream_rate_hz = 0;
+}
+
+esp_err_t audio_es8311_stream_write(const void *pcm_s16_interleaved, size_t bytes, int)
+{
+    if (s_stream_rate_hz <= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    {
+        std::lock_guard<std::mutex> guard(s_pcm_out_mux);
+        if (s_pcm_out && fwrite(pcm_s16_interleaved, 1, bytes, s_pcm_out) != bytes) {
+            return ESP_FAIL;
+        }
+    }
+    // Stereo S16: block for as long as the I2S DMA would take to drain the data.
+    const int64_t us = (int64_t)bytes * 1000000LL / ((int64_t)s_stream_rate_hz * 4);
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    sim_task_check_deleted();
+    return ESP_OK;
+}
+
+// ---- power ----
+
+int power_axp2101_get_battery_percent(void) { return 80; }
+bool power_axp2101_is_charging(void) { return false; }
+
+static uint32_t s_idle_timeout_sec = 30;
+static uint32_t s_sleep_timeout_sec = 120;
+
+uint32_t power_manager_get_idle_timeout_sec(void) { return s_idle_timeout_sec; }
+void power_manager_set_idle_timeout_sec(uint32_t sec) { s_idle_timeout_sec = sec; }
+uint32_t power_manager_get_sleep_timeout_sec(void) { return s_sleep_timeout_sec; }
+void power_manager_set_sleep_timeout_sec(uint32_t sec) { s_sleep_timeout_sec = sec; }
+void power_manager_reboot_now(void) { ESP_LOGW(TAG, "reboot requested (ignored)"); }
+void power_manager_shutdown_now(void) { ESP_LOGW(TAG, "shutdown requested (ignored)"); }
+void power_manager_sleep_now(void) { ESP_LOGW(TAG, "sleep requested (ignored)"); }
+
+// ---- radios ----
+
+static bool s_ble_enabled = false;
+
+bool ble_service_is_enabled(void) { return s_ble_enabled; }
+
+esp_err_t ble_service_set_enabled(bool enabled)
+{
+    s_ble_enabled = enabled;
+    return ESP_OK;
+}
+
+bool wifi_service_is_connected(void) { return false; }
+
+esp_err_t wifi_service_connect(const char *ssid, const char *)
+{
+    ESP_LOGI(TAG, "wifi connect to %s (ignored)", ssid ? ssid : "");
+    return ESP_OK;
+}
+
+void wifi_service_get_ip(char *out, int out_len)
+{
+    if (out && out_len > 0) {
+        snprintf(out, (size_t)out_len, "0.0.0.0");
+    }
+}
+
+bool wifi_service_get_saved_credentials(char *ssid_out, size_t ssid_out_len, char *pass_out, size_t pass_out_len)
+{
+    if (ssid_out && ssid_out_len) ssid_out[0] = '\0';
+    if (pass_out && pass_out_len) pass_out[0] = '\0';
+    return false;
+}
+
+esp_err_t wifi_service_scan(wifi_ap_record_simple_t *list, uint16_t *count, uint16_t max_count)
+{
+    // A scan takes a couple of seconds on the device; keep the UI's spinner path realistic.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    static const wifi_ap_record_simple_t kAps[] = {
+        {"HomeNetwork", -48, 3},
+        {"Office-5G", -61, 3},
+        {"CoffeeShop", -72, 0},
+        {"Neighbour", -85, 4},
+    };
+    uint16_t n = 0;
+    for (; list && n < max_count && n < sizeof(kAps) / sizeof(kAps[0]); n++) {
+        list[n] = kAps[n];
+    }
+    if (count) {
+        *count = n;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ota_service_start_from_url(const char *url)
+{
+    ESP_LOGW(TAG, "OTA from %s not available on host", url ? url : "");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+// ---- sensors / time ----
+
+bool imu_qmi8658_read(float *ax, float *ay, float *az, float *gx, float *gy, float *gz)
+{
+    if (ax) *ax = 0.0f;
+    if (ay) *ay = 0.0f;
+    if (az) *az = 1.0f;
+    if (gx) *gx = 0.0f;
+    if (gy) *gy = 0.0f;
+    if (gz) *gz = 0.0f;
+    return true;
+}
+
+void time_service_format(char *out_time, size_t out_time_len, char *out_date, size_t out_date_len)
+{
+    const time_t now = time(nullptr);
+    struct tm tm_now;
+    localtime_r(&now, &tm_now);
+    if (out_time && out_time_len) strftime(out_time, out_time_len, "%H:%M", &tm_now);
+    if (out_date && out_date_len) strftime(out_date, out_date_len, "%Y-%m-%d", &tm_now);
+}
+
+void time_service_start_sntp(void) {}
+
+// ---- SD card: mounted when --sdcard points at a directory ----
+
+static bool s_sd_mounted = false;
+static esp_err_t s_sd_last_error = ESP_OK;
+static const char *s_sd_status = "Not mounted";
+
+esp_err_t sdcard_service_mount(void)
+{
+    if (s_sd_mounted) {
+        return ESP_OK;
+    }
+    struct stat st;
+    const char *root = sim_vfs_root();
+    if (!root || stat(root, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        s_sd_last_error = ESP_ERR_NOT_FOUND;
+        s_sd_status = "No card (run with --sdcard DIR)";
+        return s_sd_last_error;
+    }
+    s_sd_mounted = true;
+    s_sd_last_error = ESP_OK;
+    s_sd_status = "Mounted";
+    media_index_start();
+    return ESP_OK;
+}
+
+bool sdcard_service_is_mounted(void) { return s_sd_mounted; }
+esp_err_t sdcard_service_last_error(void) { return s_sd_last_error; }
+const char *sdcard_service_last_status(void) { return s_sd_status; }
+const char *sdcard_service_mount_point(void) { return "/sdcard"; }
+
+// ---- apps outside the host build ----
+
+esp_err_t ui_fileserver_open(void)
+{
+    ESP_LOGW(TAG, "File server is not part of the host build");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t ui_radio_open(void)
+{
+    ESP_LOGW(TAG, "Radio is not part of the host build");
+    return ESP_ERR_NOT_SUPPORTED;
+}
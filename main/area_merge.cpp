@@ -0,0 +1,77 @@
+#include "area_merge.h"
+
+static uint32_t area_txns(const lv_area_t *a, uint32_t buf_px)
+{
+    const uint32_t w = (uint32_t)lv_area_get_width(a);
+    const uint32_t h = (uint32_t)lv_area_get_height(a);
+    uint32_t rows = w ? buf_px / w : 1;
+    if (rows == 0) {
+        rows = 1;
+    }
+    return (h + rows - 1) / rows;
+}
+
+static uint64_t area_cost(const lv_area_t *a, uint32_t buf_px, uint32_t txn_cost_px)
+{
+    return (uint64_t)area_txns(a, buf_px) * txn_cost_px + lv_area_get_size(a);
+}
+
+static void area_union(lv_area_t *out, const lv_area_t *a, const lv_area_t *b)
+{
+    out->x1 = LV_MIN(a->x1, b->x1);
+    out->y1 = LV_MIN(a->y1, b->y1);
+    out->x2 = LV_MAX(a->x2, b->x2);
+    out->y2 = LV_MAX(a->y2, b->y2);
+}
+
+static void tally(const lv_area_t *areas, const uint8_t *joined, uint16_t count, uint32_t buf_px, uint16_t *n,
+                  uint32_t *px, uint16_t *txns)
+{
+    *n = 0;
+    *px = 0;
+    *txns = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (!joined[i]) {
+            (*n)++;
+            *px += lv_area_get_size(&areas[i]);
+            *txns += (uint16_t)area_txns(&areas[i], buf_px);
+        }
+    }
+}
+
+void area_merge_run(lv_area_t *areas, uint8_t *joined, uint16_t count, uint32_t buf_px, uint32_t txn_cost_px,
+                    area_merge_result_t *out)
+{
+    area_merge_result_t r = {};
+    tally(areas, joined, count, buf_px, &r.areas_in, &r.px_in, &r.txns_in);
+
+    // Greedy pairwise merging until nothing improves. count is at most LV_INV_BUF_SIZE (32).
+    bool merged = r.areas_in > 1;
+    while (merged) {
+        merged = false;
+        for (uint16_t i = 0; i < count && !merged; i++) {
+            if (joined[i]) {
+                continue;
+            }
+            const uint64_t cost_i = area_cost(&areas[i], buf_px, txn_cost_px);
+            for (uint16_t j = i + 1; j < count; j++) {
+                if (joined[j]) {
+                    continue;
+                }
+                lv_area_t u;
+                area_union(&u, &areas[i], &areas[j]);
+                if (area_cost(&u, buf_px, txn_cost_px) <= cost_i + area_cost(&areas[j], buf_px, txn_cost_px)) {
+                    areas[j] = u;
+                    joined[i] = 1;
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    tally(areas, joined, count, buf_px, &r.areas_out, &r.px_out, &r.txns_out);
+    if (out) {
+        *out = r;
+    }
+}
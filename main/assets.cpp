@@ -0,0 +1,85 @@
+#include "assets.h"
+
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "assets";
+
+#define ASSET_MAX_UNPACKED 8
+
+typedef struct {
+    const asset_img_t *asset;
+    lv_img_dsc_t dsc;
+} unpacked_t;
+
+static unpacked_t s_unpacked[ASSET_MAX_UNPACKED];
+
+static bool rle_unpack(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_len, uint32_t bpp)
+{
+    const uint8_t *in_end = in + in_len;
+    const uint8_t *out_end = out + out_len;
+    while (in < in_end) {
+        const uint8_t ctrl = *in++;
+        const uint32_t bytes = ((ctrl & 0x7F) + 1) * bpp;
+        if ((uint32_t)(out_end - out) < bytes) {
+            return false;
+        }
+        if (ctrl & 0x80) {
+            if ((uint32_t)(in_end - in) < bytes) {
+                return false;
+            }
+            memcpy(out, in, bytes);
+            in += bytes;
+        } else {
+            if ((uint32_t)(in_end - in) < bpp) {
+                return false;
+            }
+            for (uint32_t i = 0; i < bytes; i += bpp) {
+                memcpy(out + i, in, bpp);
+            }
+            in += bpp;
+        }
+        out += bytes;
+    }
+    return out == out_end;
+}
+
+const lv_img_dsc_t *asset_img(const asset_img_t *asset)
+{
+    if (!asset->rle) {
+        return &asset->dsc;
+    }
+    unpacked_t *slot = nullptr;
+    for (unpacked_t &u : s_unpacked) {
+        if (u.asset == asset) {
+            return &u.dsc;
+        }
+        if (!u.asset && !slot) {
+            slot = &u;
+        }
+    }
+    if (!slot) {
+        ESP_LOGE(TAG, "more than %d RLE assets in use", ASSET_MAX_UNPACKED);
+        return nullptr;
+    }
+
+    const uint32_t bpp = asset->dsc.header.cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? LV_IMG_PX_SIZE_ALPHA_BYTE
+                                                                            : sizeof(lv_color_t);
+    uint8_t *pixels = (uint8_t *)heap_caps_malloc(asset->raw_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!pixels) {
+        ESP_LOGE(TAG, "no memory to unpack %u bytes", (unsigned)asset->raw_size);
+        return nullptr;
+    }
+    if (!rle_unpack(asset->dsc.data, asset->dsc.data_size, pixels, asset->raw_size, bpp)) {
+        ESP_LOGE(TAG, "corrupt RLE asset");
+        heap_caps_free(pixels);
+        return nullptr;
+    }
+    slot->asset = asset;
+    slot->dsc = asset->dsc;
+    slot->dsc.data = pixels;
+    slot->dsc.data_size = asset->raw_size;
+    return &slot->dsc;
+}
@@ -0,0 +1,246 @@
+#include "audio_mixer.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+// Voice slot states, in the low two bits of voice.state. The upper bits count plays of the slot so
+// that a handle only matches the play() that returned it.
+#define VOICE_FREE 0u
+#define VOICE_CLAIMED 1u  // play() is filling the slot
+#define VOICE_PLAYING 2u
+#define VOICE_STOPPING 3u // stop() asked; the mixer frees it
+#define VOICE_STATE_MASK 3u
+#define VOICE_SLOT_BITS 4 // slots in the low bits of a handle
+#define VOICE_GEN_MASK 0x7FFFFFu
+
+static_assert(AUDIO_MIXER_VOICES <= (1 << VOICE_SLOT_BITS), "voice handle slot bits");
+
+struct audio_mixer_voice {
+    // play() moves FREE -> CLAIMED -> PLAYING, stop() PLAYING -> STOPPING, and only the mixer
+    // returns a slot to FREE, so the fields below are never rewritten while the mixer reads them.
+    std::atomic<uint32_t> state;
+    audio_mixer_sound_t sound;
+    uint32_t gain;
+    int64_t queued_us;
+    uint32_t pos; // mixer-owned: frames already mixed
+};
+
+struct audio_mixer {
+    audio_mixer_voice voices[AUDIO_MIXER_VOICES];
+    pcm_ring_t *stream;
+    uint32_t stream_gain;
+    bool stream_started;
+    int32_t acc[AUDIO_MIXER_MAX_BLOCK * 2];
+
+    audio_mixer_stats_t stats; // mixer-owned, except `dropped`
+    std::atomic<uint32_t> dropped;
+};
+
+static int64_t now_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+audio_mixer_t *audio_mixer_create(void)
+{
+    return new (std::nothrow) audio_mixer_t();
+}
+
+void audio_mixer_destroy(audio_mixer_t *m)
+{
+    delete m;
+}
+
+audio_mixer_voice_t audio_mixer_play(audio_mixer_t *m, const audio_mixer_sound_t *sound, uint32_t gain_q15)
+{
+    if (!sound || !sound->pcm || sound->frames == 0 || (sound->channels != 1 && sound->channels != 2)) {
+        return AUDIO_MIXER_NO_VOICE;
+    }
+    for (uint32_t i = 0; i < AUDIO_MIXER_VOICES; i++) {
+        audio_mixer_voice &v = m->voices[i];
+        uint32_t s = v.state.load(std::memory_order_relaxed);
+        if ((s & VOICE_STATE_MASK) != VOICE_FREE) {
+            continue;
+        }
+        const uint32_t gen = (s >> 2) + 1;
+        if (!v.state.compare_exchange_strong(s, (gen << 2) | VOICE_CLAIMED, std::memory_order_acquire)) {
+            continue;
+        }
+        v.sound = *sound;
+        v.gain = gain_q15;
+        v.queued_us = now_us();
+        v.pos = 0;
+        v.state.store((gen << 2) | VOICE_PLAYING, std::memory_order_release);
+        return (audio_mixer_voice_t)(((gen & VOICE_GEN_MASK) << VOICE_SLOT_BITS) | i);
+    }
+    m->dropped.fetch_add(1, std::memory_order_relaxed);
+    return AUDIO_MIXER_NO_VOICE;
+}
+
+void audio_mixer_stop(audio_mixer_t *m, audio_mixer_voice_t voice)
+{
+    if (voice < 0) {
+        return;
+    }
+    const uint32_t slot = (uint32_t)voice & ((1u << VOICE_SLOT_BITS) - 1);
+    const uint32_t gen = (uint32_t)voice >> VOICE_SLOT_BITS;
+    if (slot >= AUDIO_MIXER_VOICES) {
+        return;
+    }
+    audio_mixer_voice &v = m->voices[slot];
+    uint32_t s = v.state.load(std::memory_order_relaxed);
+    if ((s & VOICE_STATE_MASK) != VOICE_PLAYING || ((s >> 2) & VOICE_GEN_MASK) != gen) {
+        return;
+    }
+    // Fails harmlessly if the voice finished in the meantime.
+    v.state.compare_exchange_strong(s, (s & ~VOICE_STATE_MASK) | VOICE_STOPPING, std::memory_order_relaxed);
+}
+
+void audio_mixer_set_stream(audio_mixer_t *m, pcm_ring_t *ring, uint32_t gain_q15)
+{
+    m->stream = ring;
+    m->stream_gain = gain_q15;
+    m->stream_started = false;
+}
+
+// Adds `frames` frames of `pcm` times gain to acc. Unity gain skips the multiply.
+static void accumulate(int32_t *acc, const int16_t *pcm, uint32_t frames, uint8_t channels, uint32_t gain)
+{
+    const int32_t g = (int32_t)gain;
+    if (channels == 2) {
+        if (gain == AUDIO_MIXER_UNITY) {
+            for (uint32_t i = 0; i < frames * 2; i++) {
+                acc[i] += pcm[i];
+            }
+        } else {
+            for (uint32_t i = 0; i < frames * 2; i++) {
+                acc[i] += (pcm[i] * g + (1 << 14)) >> 15;
+            }
+        }
+    } else {
+        for (uint32_t i = 0; i < frames; i++) {
+            const int32_t s = gain == AUDIO_MIXER_UNITY ? pcm[i] : (pcm[i] * g + (1 << 14)) >> 15;
+            acc[2 * i] += s;
+            acc[2 * i + 1] += s;
+        }
+    }
+}
+
+// Adds up to `frames` stream frames to acc; returns how many there were.
+static uint32_t mix_stream(audio_mixer_t *m, uint32_t frames)
+{
+    pcm_ring_t *r = m->stream;
+    if (!r) {
+        return 0;
+    }
+    if (!m->stream_started) {
+        if (pcm_ring_fill(r) < frames && !pcm_ring_is_closed(r)) {
+            return 0;
+        }
+        m->stream_started = true;
+    }
+    uint32_t done = 0;
+    while (done < frames) {
+        uint32_t n = 0;
+        const int16_t *pcm = pcm_ring_peek(r, &n);
+        if (n == 0) {
+            break;
+        }
+        n = n < frames - done ? n : frames - done;
+        accumulate(m->acc + (size_t)done * 2, pcm, n, 2, m->stream_gain);
+        pcm_ring_release(r, n);
+        done += n;
+    }
+    return done;
+}
+
+bool audio_mixer_mix(audio_mixer_t *m, int16_t *out, uint32_t frames)
+{
+    if (frames > AUDIO_MIXER_MAX_BLOCK) {
+        frames = AUDIO_MIXER_MAX_BLOCK;
+    }
+    const int64_t t0_us = now_us();
+    memset(m->acc, 0, (size_t)frames * 2 * sizeof(int32_t));
+
+    bool active = mix_stream(m, frames) > 0;
+    for (uint32_t i = 0; i < AUDIO_MIXER_VOICES; i++) {
+        audio_mixer_voice &v = m->voices[i];
+        const uint32_t s = v.state.load(std::memory_order_acquire);
+        const uint32_t st = s & VOICE_STATE_MASK;
+        if (st == VOICE_STOPPING) {
+            v.state.store(s & ~VOICE_STATE_MASK, std::memory_order_release);
+            continue;
+        }
+        if (st != VOICE_PLAYING) {
+            continue;
+        }
+        if (v.pos == 0) {
+            const uint32_t latency_us = (uint32_t)(t0_us - v.queued_us);
+            m->stats.started++;
+            m->stats.latency_us_sum += latency_us;
+            if (latency_us > m->stats.latency_us_max) {
+                m->stats.latency_us_max = latency_us;
+            }
+        }
+        const uint32_t left = v.sound.frames - v.pos;
+        const uint32_t n = left < frames ? left : frames;
+        accumulate(m->acc, v.sound.pcm + (size_t)v.pos * v.sound.channels, n, v.sound.channels, v.gain);
+        v.pos += n;
+        active = true;
+        if (v.pos == v.sound.frames) {
+            // Done: hand the slot back, keeping its play count. A stop() racing with this fails its
+            // compare-and-swap.
+            v.state.store(s & ~VOICE_STATE_MASK, std::memory_order_release);
+        }
+    }
+    if (!active) {
+        return false;
+    }
+
+    uint32_t clipped = 0;
+    for (uint32_t i = 0; i < frames * 2; i++) {
+        const int32_t a = m->acc[i];
+        if (a > 32767) {
+            out[i] = 32767;
+            clipped++;
+        } else if (a < -32768) {
+            out[i] = -32768;
+            clipped++;
+        } else {
+            out[i] = (int16_t)a;
+        }
+    }
+
+    const uint32_t mix_us = (uint32_t)(now_us() - t0_us);
+    m->stats.blocks++;
+    m->stats.frames += frames;
+    m->stats.mix_us += mix_us;
+    if (mix_us > m->stats.mix_us_max) {
+        m->stats.mix_us_max = mix_us;
+    }
+    m->stats.clipped += clipped;
+    return true;
+}
+
+void audio_mixer_get_stats(const audio_mixer_t *m, audio_mixer_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = m->stats;
+    out->dropped = m->dropped.load(std::memory_order_relaxed);
+}
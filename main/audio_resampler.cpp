@@ -0,0 +1,203 @@
+#include "audio_resampler.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+#define AUDIO_RESAMPLER_BLOCK 256      // input frames appended to the window per pass
+#define AUDIO_RESAMPLER_CUTOFF 0.45    // of the input rate
+#define AUDIO_RESAMPLER_KAISER_BETA 8.0
+
+struct audio_resampler {
+    uint32_t in_rate;
+    uint32_t L; // output frames per M input frames
+    uint32_t M;
+    int16_t *coef; // L phases of AUDIO_RESAMPLER_TAPS, oldest input first; NULL when L == M
+    // Input window: the last TAPS - 1 frames already used, then new input.
+    int16_t win[(AUDIO_RESAMPLER_TAPS - 1 + AUDIO_RESAMPLER_BLOCK) * 2];
+    uint32_t fill;  // frames in win
+    uint32_t next;  // win index of the newest input frame of the next output
+    uint32_t phase; // (n * M) % L of the next output
+};
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Prototype low-pass at L times the input rate, split into L phases. Each phase is scaled to a DC
+// gain of exactly 1.0 in Q15 so that every output position passes a constant through unchanged.
+static void build_phases(audio_resampler_t *r)
+{
+    const uint32_t len = r->L * AUDIO_RESAMPLER_TAPS;
+    const double center = (len - 1) / 2.0;
+    const double fc = AUDIO_RESAMPLER_CUTOFF / r->L; // cycles per upsampled sample
+    const double i0_beta = bessel_i0(AUDIO_RESAMPLER_KAISER_BETA);
+
+    for (uint32_t p = 0; p < r->L; p++) {
+        double h[AUDIO_RESAMPLER_TAPS];
+        double sum = 0.0;
+        for (uint32_t k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+            const double t = (double)(p + k * r->L) - center;
+            const double sinc = t == 0.0 ? 1.0 : sin(2.0 * M_PI * fc * t) / (2.0 * M_PI * fc * t);
+            const double w = t / (center + 1.0);
+            h[k] = sinc * bessel_i0(AUDIO_RESAMPLER_KAISER_BETA * sqrt(1.0 - w * w)) / i0_beta;
+            sum += h[k];
+        }
+        // Tap k multiplies the input k frames before the newest, so store them oldest first.
+        int16_t *c = r->coef + (size_t)p * AUDIO_RESAMPLER_TAPS;
+        int32_t total = 0;
+        uint32_t peak = 0;
+        for (uint32_t k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+            const int32_t q = (int32_t)lround(h[k] / sum * 32768.0);
+            const uint32_t j = AUDIO_RESAMPLER_TAPS - 1 - k;
+            c[j] = (int16_t)(q > 32767 ? 32767 : q);
+            total += c[j];
+            if (abs(c[j]) > abs(c[peak])) {
+                peak = j;
+            }
+        }
+        c[peak] = (int16_t)(c[peak] + (32768 - total)); // rounding residue onto the largest tap
+    }
+}
+
+audio_resampler_t *audio_resampler_create(uint32_t in_rate, uint32_t out_rate)
+{
+    if (in_rate == 0 || in_rate > out_rate || (uint64_t)in_rate * AUDIO_RESAMPLER_MAX_RATIO < out_rate) {
+        return NULL;
+    }
+    const uint32_t g = gcd(in_rate, out_rate);
+    if (out_rate / g > AUDIO_RESAMPLER_MAX_PHASES) {
+        return NULL;
+    }
+    audio_resampler_t *r = new (std::nothrow) audio_resampler_t();
+    if (!r) {
+        return NULL;
+    }
+    r->in_rate = in_rate;
+    r->L = out_rate / g;
+    r->M = in_rate / g;
+    if (r->L != r->M) {
+        const size_t bytes = (size_t)r->L * AUDIO_RESAMPLER_TAPS * sizeof(int16_t);
+#ifdef ESP_PLATFORM
+        // Every output frame reads a different phase: keep the table out of PSRAM when possible.
+        r->coef = (int16_t *)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!r->coef) {
+            r->coef = (int16_t *)malloc(bytes);
+        }
+#else
+        r->coef = (int16_t *)malloc(bytes);
+#endif
+        if (!r->coef) {
+            delete r;
+            return NULL;
+        }
+        build_phases(r);
+    }
+    audio_resampler_reset(r);
+    return r;
+}
+
+void audio_resampler_destroy(audio_resampler_t *r)
+{
+    if (!r) {
+        return;
+    }
+    free(r->coef);
+    delete r;
+}
+
+uint32_t audio_resampler_in_rate(const audio_resampler_t *r)
+{
+    return r->in_rate;
+}
+
+void audio_resampler_reset(audio_resampler_t *r)
+{
+    memset(r->win, 0, sizeof(r->win));
+    r->fill = AUDIO_RESAMPLER_TAPS - 1;
+    r->next = AUDIO_RESAMPLER_TAPS - 1;
+    r->phase = 0;
+}
+
+uint32_t audio_resampler_max_out(const audio_resampler_t *r, uint32_t in_frames)
+{
+    if (r->L == r->M) {
+        return in_frames;
+    }
+    return (uint32_t)(((uint64_t)in_frames * r->L + r->L) / r->M + 1);
+}
+
+static inline int16_t sat16(int32_t v)
+{
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+uint32_t audio_resampler_process(audio_resampler_t *r, const int16_t *in, uint32_t in_frames, int16_t *out)
+{
+    if (r->L == r->M) {
+        memcpy(out, in, (size_t)in_frames * 2 * sizeof(int16_t));
+        return in_frames;
+    }
+
+    const uint32_t cap = AUDIO_RESAMPLER_TAPS - 1 + AUDIO_RESAMPLER_BLOCK;
+    uint32_t produced = 0;
+    while (in_frames > 0) {
+        const uint32_t n = in_frames < cap - r->fill ? in_frames : cap - r->fill;
+        memcpy(r->win + (size_t)r->fill * 2, in, (size_t)n * 2 * sizeof(int16_t));
+        r->fill += n;
+        in += (size_t)n * 2;
+        in_frames -= n;
+
+        while (r->next < r->fill) {
+            const int16_t *x = r->win + (size_t)(r->next - (AUDIO_RESAMPLER_TAPS - 1)) * 2;
+            const int16_t *c = r->coef + (size_t)r->phase * AUDIO_RESAMPLER_TAPS;
+            // Both channels share each coefficient load; Q15 products summed in 32 bits.
+            int32_t acc_l = 1 << 14;
+            int32_t acc_r = 1 << 14;
+            for (uint32_t k = 0; k < AUDIO_RESAMPLER_TAPS; k += 4) {
+                acc_l += c[k] * x[2 * k] + c[k + 1] * x[2 * k + 2] + c[k + 2] * x[2 * k + 4] + c[k + 3] * x[2 * k + 6];
+                acc_r += c[k] * x[2 * k + 1] + c[k + 1] * x[2 * k + 3] + c[k + 2] * x[2 * k + 5] +
+                         c[k + 3] * x[2 * k + 7];
+            }
+            out[2 * produced] = sat16(acc_l >> 15);
+            out[2 * produced + 1] = sat16(acc_r >> 15);
+            produced++;
+
+            r->phase += r->M;
+            while (r->phase >= r->L) {
+                r->phase -= r->L;
+                r->next++;
+            }
+        }
+
+        // Keep the TAPS - 1 frames before the next output's newest frame.
+        const uint32_t drop = r->next - (AUDIO_RESAMPLER_TAPS - 1);
+        memmove(r->win, r->win + (size_t)drop * 2, (size_t)(r->fill - drop) * 2 * sizeof(int16_t));
+        r->fill -= drop;
+        r->next -= drop;
+    }
+    return produced;
+}
@@ -0,0 +1,442 @@
+#include "block_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+typedef struct {
+    uint8_t *data;
+    uint64_t key;       // owning file, 0 = free
+    uint32_t index;     // block number within the file
+    uint32_t len;       // valid bytes (short at end of file)
+    uint32_t last_use;  // LRU stamp
+    bool readahead;     // fetched ahead and not hit yet
+    bool loading;       // being filled with s_mux released: lookups wait, eviction skips it
+    bool dropped;       // invalidated while loading, freed when the load lands
+} cache_block_t;
+
+struct block_cache_file {
+    void *handle;
+    uint64_t key;
+    uint32_t size;
+    uint32_t pos;
+    uint32_t last_index; // last block touched, for sequential detection
+    uint32_t window;     // blocks fetched per miss, doubles while sequential
+    bool random;         // last block change was a jump
+};
+
+// Guards the pool and the stats. Backend reads run with it released, so a task reading from the
+// card does not hold up hits from other tasks; a handle itself belongs to one task at a time.
+static std::mutex s_mux;
+static std::condition_variable s_loaded; // a loading block was filled (or failed)
+static bool s_inited = false;
+static block_cache_config_t s_cfg;
+static uint32_t s_shift;
+static uint8_t *s_pool = NULL;
+static cache_block_t *s_blocks = NULL;
+static uint32_t s_tick = 0;
+static block_cache_stats_t s_stats;
+
+// ---- Default backend: unbuffered stdio, skipping the fseek when the position already matches ----
+
+typedef struct {
+    FILE *fp;
+    uint32_t pos;
+} stdio_handle_t;
+
+static void *stdio_open(const char *path, uint32_t *size, uint32_t *mtime)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    stdio_handle_t *h = (stdio_handle_t *)calloc(1, sizeof(*h));
+    if (!h) {
+        fclose(fp);
+        return NULL;
+    }
+    // Reads are block sized already; the stdio buffer would only add a copy.
+    setvbuf(fp, NULL, _IONBF, 0);
+    h->fp = fp;
+    *size = (uint32_t)st.st_size;
+    *mtime = (uint32_t)st.st_mtime;
+    return h;
+}
+
+static size_t stdio_read_at(void *handle, uint32_t offset, void *buf, size_t len)
+{
+    stdio_handle_t *h = (stdio_handle_t *)handle;
+    if (h->pos != offset) {
+        if (fseek(h->fp, (long)offset, SEEK_SET) != 0) {
+            return 0;
+        }
+        h->pos = offset;
+    }
+    const size_t got = fread(buf, 1, len, h->fp);
+    h->pos += (uint32_t)got;
+    return got;
+}
+
+static void stdio_close(void *handle)
+{
+    stdio_handle_t *h = (stdio_handle_t *)handle;
+    fclose(h->fp);
+    free(h);
+}
+
+static const block_cache_io_t s_stdio_io = {stdio_open, stdio_read_at, stdio_close};
+
+// ---- Pool ----
+
+static uint64_t file_key(const char *path, uint32_t size, uint32_t mtime)
+{
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (const char *p = path; *p; p++) {
+        h = (h ^ (uint8_t)*p) * 0x100000001b3ULL;
+    }
+    h ^= ((uint64_t)size << 32) | mtime;
+    h *= 0x100000001b3ULL;
+    return h ? h : 1;
+}
+
+static cache_block_t *find_block(uint64_t key, uint32_t index)
+{
+    for (size_t i = 0; i < s_cfg.block_count; i++) {
+        if (s_blocks[i].key == key && s_blocks[i].index == index) {
+            return &s_blocks[i];
+        }
+    }
+    return NULL;
+}
+
+// Least recently used block that is not loading; NULL if every block is.
+static cache_block_t *victim_block(void)
+{
+    cache_block_t *v = NULL;
+    for (size_t i = 0; i < s_cfg.block_count; i++) {
+        cache_block_t *b = &s_blocks[i];
+        if (b->loading) {
+            continue;
+        }
+        if (b->key == 0) {
+            return b;
+        }
+        if (!v || (int32_t)(b->last_use - v->last_use) < 0) {
+            v = b;
+        }
+    }
+    if (v) {
+        s_stats.evictions++;
+    }
+    return v;
+}
+
+// Fills victim b with block `index` of f. The block is marked loading and s_mux is released for the
+// backend read. Returns b with the lock held again, or NULL if nothing was read. A block dropped by
+// block_cache_invalidate() meanwhile is still returned for the caller's copy but is not kept.
+static cache_block_t *load_block(block_cache_file_t *f, cache_block_t *b, uint32_t index, bool readahead,
+                                 std::unique_lock<std::mutex> &lock)
+{
+    b->key = f->key;
+    b->index = index;
+    b->len = 0;
+    b->last_use = ++s_tick;
+    b->readahead = readahead;
+    b->loading = true;
+    b->dropped = false;
+    const uint32_t offset = index << s_shift;
+    const size_t want = (f->size - offset < s_cfg.block_size) ? f->size - offset : s_cfg.block_size;
+
+    lock.unlock();
+    const size_t got = s_cfg.io->read_at(f->handle, offset, b->data, want);
+    lock.lock();
+
+    b->loading = false;
+    s_loaded.notify_all();
+    s_stats.backend_reads++;
+    s_stats.bytes_fetched += got;
+    if (got == 0 || b->dropped) {
+        b->key = 0;
+    }
+    if (got == 0) {
+        return NULL;
+    }
+    b->len = (uint32_t)got;
+    if (readahead) {
+        s_stats.readahead_blocks++;
+    }
+    return b;
+}
+
+// Fetches the rest of the read-ahead window after a miss on `index`. Blocks go in ascending order,
+// so the backend sees one forward run of aligned reads. Called once the missed block has been
+// copied out, so the read-ahead cannot evict it first.
+static void read_ahead(block_cache_file_t *f, uint32_t index, std::unique_lock<std::mutex> &lock)
+{
+    const uint32_t last = (f->size - 1) >> s_shift;
+    for (uint32_t i = 1; i < f->window && index + i <= last; i++) {
+        if (find_block(f->key, index + i)) {
+            break;
+        }
+        cache_block_t *b = victim_block();
+        if (!b || !load_block(f, b, index + i, true, lock)) {
+            break;
+        }
+    }
+}
+
+static void track_access(block_cache_file_t *f, uint32_t index)
+{
+    if (index == f->last_index) {
+        return;
+    }
+    if (index == f->last_index + 1) {
+        f->window = f->window * 2 > s_cfg.max_readahead_blocks ? (uint32_t)s_cfg.max_readahead_blocks
+                                                               : f->window * 2;
+        f->random = false;
+    } else {
+        f->window = 1;
+        f->random = f->last_index != UINT32_MAX;
+    }
+    f->last_index = index;
+}
+
+bool block_cache_init(const block_cache_config_t *config)
+{
+    std::lock_guard<std::mutex> guard(s_mux);
+    if (s_inited) {
+        return s_pool != NULL;
+    }
+
+    const block_cache_config_t def = BLOCK_CACHE_DEFAULT_CONFIG();
+    s_cfg = config ? *config : def;
+    if (!s_cfg.io) {
+        s_cfg.io = &s_stdio_io;
+    }
+    if (s_cfg.block_size < 512 || (s_cfg.block_size & (s_cfg.block_size - 1))) {
+        s_cfg.block_size = def.block_size;
+    }
+    s_shift = (uint32_t)__builtin_ctz((unsigned)s_cfg.block_size);
+    if (s_cfg.max_readahead_blocks < 1) {
+        s_cfg.max_readahead_blocks = 1;
+    }
+    // Keep at least half the pool out of any one read-ahead run.
+    if (s_cfg.block_count && s_cfg.max_readahead_blocks > s_cfg.block_count / 2) {
+        s_cfg.max_readahead_blocks = s_cfg.block_count / 2 ? s_cfg.block_count / 2 : 1;
+    }
+    s_inited = true;
+
+    if (s_cfg.block_count == 0) {
+        return false;
+    }
+    const size_t bytes = s_cfg.block_size * s_cfg.block_count;
+#ifdef ESP_PLATFORM
+    s_pool = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#else
+    s_pool = (uint8_t *)malloc(bytes);
+#endif
+    s_blocks = (cache_block_t *)calloc(s_cfg.block_count, sizeof(cache_block_t));
+    if (!s_pool || !s_blocks) {
+        free(s_pool);
+        free(s_blocks);
+        s_pool = NULL;
+        s_blocks = NULL;
+        s_cfg.block_count = 0;
+        return false;
+    }
+    for (size_t i = 0; i < s_cfg.block_count; i++) {
+        s_blocks[i].data = s_pool + i * s_cfg.block_size;
+    }
+    return true;
+}
+
+block_cache_file_t *block_cache_open(const char *path)
+{
+    if (!path) {
+        return NULL;
+    }
+    if (!s_inited) {
+        block_cache_init(NULL);
+    }
+
+    uint32_t size = 0;
+    uint32_t mtime = 0;
+    void *h = s_cfg.io->open(path, &size, &mtime);
+    if (!h) {
+        return NULL;
+    }
+    block_cache_file_t *f = (block_cache_file_t *)calloc(1, sizeof(*f));
+    if (!f) {
+        s_cfg.io->close(h);
+        return NULL;
+    }
+    f->handle = h;
+    f->key = file_key(path, size, mtime);
+    f->size = size;
+    f->last_index = UINT32_MAX;
+    f->window = 1;
+    return f;
+}
+
+void block_cache_close(block_cache_file_t *f)
+{
+    if (!f) {
+        return;
+    }
+    // Blocks stay in the pool: reopening an unchanged file hits them again.
+    s_cfg.io->close(f->handle);
+    free(f);
+}
+
+size_t block_cache_read(block_cache_file_t *f, void *buf, size_t len)
+{
+    if (!f || !buf) {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(s_mux);
+    uint8_t *out = (uint8_t *)buf;
+    const uint32_t mask = (uint32_t)s_cfg.block_size - 1;
+    size_t done = 0;
+
+    while (done < len && f->pos < f->size) {
+        const uint32_t index = f->pos >> s_shift;
+        const uint32_t off = f->pos & mask;
+        const size_t want = (len - done < f->size - f->pos) ? len - done : f->size - f->pos;
+        track_access(f, index);
+
+        cache_block_t *b = s_pool ? find_block(f->key, index) : NULL;
+        if (b && b->loading) {
+            s_loaded.wait(lock); // another task is reading it; look again once a load lands
+            continue;
+        }
+        const bool missed = b == NULL;
+        if (b) {
+            s_stats.hits++;
+            if (b->readahead) {
+                b->readahead = false;
+                s_stats.readahead_used++;
+            }
+            b->last_use = ++s_tick;
+        } else {
+            // Whole aligned blocks the pool does not hold go straight to the caller, and so do
+            // large reads after a jump: fetching the whole block would mostly move unused bytes.
+            const bool whole = off == 0 && want >= s_cfg.block_size;
+            const bool scattered = f->random && want >= s_cfg.block_size / 16;
+            const bool bypass = !s_pool || whole || scattered;
+            cache_block_t *victim = bypass ? NULL : victim_block();
+            if (!bypass && !victim) {
+                s_loaded.wait(lock); // every block is loading
+                continue;
+            }
+            s_stats.misses++;
+            if (bypass) {
+                const size_t n = whole ? want & ~(size_t)mask : want;
+                lock.unlock();
+                const size_t got = s_cfg.io->read_at(f->handle, f->pos, out + done, n);
+                lock.lock();
+                s_stats.backend_reads++;
+                s_stats.bytes_fetched += got;
+                if (s_pool) {
+                    s_stats.bypass_reads++;
+                }
+                done += got;
+                f->pos += (uint32_t)got;
+                if (got < n) {
+                    break;
+                }
+                if (got) {
+                    f->last_index = (f->pos - 1) >> s_shift;
+                }
+                continue;
+            }
+            b = load_block(f, victim, index, false, lock);
+            if (!b) {
+                break;
+            }
+        }
+
+        if (off >= b->len) {
+            break; // backend returned a short block: file shrank or read error
+        }
+        const size_t n = (want < b->len - off) ? want : b->len - off;
+        memcpy(out + done, b->data + off, n);
+        done += n;
+        f->pos += (uint32_t)n;
+        if (missed) {
+            read_ahead(f, index, lock);
+        }
+    }
+
+    s_stats.bytes_requested += done;
+    return done;
+}
+
+bool block_cache_seek(block_cache_file_t *f, int32_t offset, int whence)
+{
+    if (!f) {
+        return false;
+    }
+    int64_t base = 0;
+    if (whence == SEEK_CUR) {
+        base = f->pos;
+    } else if (whence == SEEK_END) {
+        base = f->size;
+    }
+    const int64_t pos = base + offset;
+    if (pos < 0) {
+        return false;
+    }
+    // Past the end is allowed, as with fseek; reads there return 0.
+    f->pos = pos > UINT32_MAX ? UINT32_MAX : (uint32_t)pos;
+    return true;
+}
+
+uint32_t block_cache_tell(const block_cache_file_t *f)
+{
+    return f ? f->pos : 0;
+}
+
+uint32_t block_cache_size(const block_cache_file_t *f)
+{
+    return f ? f->size : 0;
+}
+
+void block_cache_invalidate(void)
+{
+    std::lock_guard<std::mutex> guard(s_mux);
+    for (size_t i = 0; i < s_cfg.block_count; i++) {
+        if (s_blocks[i].loading) {
+            s_blocks[i].dropped = true;
+        } else {
+            s_blocks[i].key = 0;
+        }
+    }
+}
+
+void block_cache_get_stats(block_cache_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(s_mux);
+    *out = s_stats;
+}
+
+void block_cache_reset_stats(void)
+{
+    std::lock_guard<std::mutex> guard(s_mux);
+    memset(&s_stats, 0, sizeof(s_stats));
+}
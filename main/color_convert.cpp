@@ -0,0 +1,51 @@
+#include "color_convert.h"
+
+#include <string.h>
+
+// Works on 32-bit words (SWAR): four XRGB pixels become three output words. Loads happen before
+// stores within a block, so in-place conversion is safe as long as dst does not run ahead of src.
+// Assumes a little-endian CPU (Xtensa, x86, ARM).
+//
+// Not PIE: GCC has no intrinsics for the S3's vector unit, and its 128-bit stores need 16-byte
+// alignment, which neither LVGL's flush areas nor the 3-byte in-place output stride provide; the
+// 4 -> 3 byte repack would also need a shuffle per vector.
+
+static inline uint32_t load_u32(const void *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store_u32(void *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+// B,G,R,A in memory -> 0x00BBGGRR, i.e. R,G,B bytes in memory order.
+static inline uint32_t xrgb_to_rgb_word(uint32_t p)
+{
+    return __builtin_bswap32(p) >> 8;
+}
+
+void color_convert_xrgb8888_to_rgb888(uint8_t *dst, const uint32_t *src, size_t px)
+{
+    size_t i = 0;
+    for (; i + 4 <= px; i += 4) {
+        const uint32_t q0 = xrgb_to_rgb_word(load_u32(&src[i + 0]));
+        const uint32_t q1 = xrgb_to_rgb_word(load_u32(&src[i + 1]));
+        const uint32_t q2 = xrgb_to_rgb_word(load_u32(&src[i + 2]));
+        const uint32_t q3 = xrgb_to_rgb_word(load_u32(&src[i + 3]));
+        store_u32(dst + 0, q0 | (q1 << 24));
+        store_u32(dst + 4, (q1 >> 8) | (q2 << 16));
+        store_u32(dst + 8, (q2 >> 16) | (q3 << 8));
+        dst += 12;
+    }
+    for (; i < px; i++) {
+        const uint32_t q = xrgb_to_rgb_word(load_u32(&src[i]));
+        dst[0] = (uint8_t)q;
+        dst[1] = (uint8_t)(q >> 8);
+        dst[2] = (uint8_t)(q >> 16);
+        dst += 3;
+    }
+}
@@ -3,6 +3,7 @@
 #include <assert.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 
@@ -17,22 +18,28 @@
 #include "esp_log.h"
 #include "esp_timer.h"
 
-#include "nvs.h"
-
 #include "lvgl.h"
 
 #include "esp_lcd_sh8601.h"
-#include "esp_lcd_touch_ft5x06.h"
 
 #include "esp_io_expander_tca9554.h"
 
 #include "app_pins.h"
+#include "area_merge.h"
+#include "color_convert.h"
 #include "i2c_bus.h"
+#include "screen_mirror.h"
+#include "touch_input.h"
+#include "services/settings_service.h"
 
 static const char *TAG = "display";
 
 static SemaphoreHandle_t s_lvgl_mux = nullptr;
-static esp_lcd_touch_handle_t s_touch = nullptr;
+static TaskHandle_t s_lvgl_task = nullptr;
+static lv_indev_t *s_touch_indev = nullptr;
+static volatile bool s_touch_pending = false;
+// Serializes panel IO between the flush task and brightness / on-off commands from other tasks.
+static SemaphoreHandle_t s_panel_io_mux = nullptr;
 static esp_lcd_panel_handle_t s_panel_handle = nullptr;
 static esp_lcd_panel_io_handle_t s_panel_io = nullptr;
 static uint8_t s_brightness = 100;
@@ -55,26 +62,29 @@ static inline int sh8601_encode_cmd(int lcd_cmd)
 
 static void nvs_load_brightness(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("disp", NVS_READONLY, &h) != ESP_OK) {
-        return;
-    }
     uint8_t v = 0;
-    if (nvs_get_u8(h, "bri", &v) == ESP_OK && v <= 100) {
+    if (settings_service_get_u8("disp", "bri", &v) && v <= 100) {
         s_brightness = v;
     }
-    nvs_close(h);
 }
 
 static void nvs_save_brightness(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("disp", NVS_READWRITE, &h) != ESP_OK) {
-        return;
+    settings_service_set_u8("disp", "bri", s_brightness);
+}
+
+static void panel_io_lock(void)
+{
+    if (s_panel_io_mux) {
+        xSemaphoreTake(s_panel_io_mux, portMAX_DELAY);
+    }
+}
+
+static void panel_io_unlock(void)
+{
+    if (s_panel_io_mux) {
+        xSemaphoreGive(s_panel_io_mux);
     }
-    nvs_set_u8(h, "bri", s_brightness);
-    nvs_commit(h);
-    nvs_close(h);
 }
 
 static void apply_brightness_hw(uint8_t brightness_percent)
@@ -88,8 +98,10 @@ static void apply_brightness_hw(uint8_t brightness_percent)
     if (brightness_percent > 0 && val == 0) val = 1;
 
     const uint8_t ctrl = 0x20;
+    panel_io_lock();
     (void)esp_lcd_panel_io_tx_param(s_panel_io, sh8601_encode_cmd(0x53), &ctrl, 1);
     esp_err_t err = esp_lcd_panel_io_tx_param(s_panel_io, sh8601_encode_cmd(0x51), &val, 1);
+    panel_io_unlock();
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "brightness tx failed: %s", esp_err_to_name(err));
     }
@@ -106,6 +118,9 @@ static void apply_brightness_hw(uint8_t brightness_percent)
 #endif
 
 #define LVGL_TICK_PERIOD_MS 2
+// The LVGL task sleeps on a task notification until its next timer deadline. Touch IRQs, flush
+// completion, display_lvgl_async_call() and unlocks from other tasks wake it early; the max delay
+// only bounds how long a lost wakeup (or a wedged flush) can go unnoticed.
 #define LVGL_TASK_MAX_DELAY_MS 500
 #define LVGL_TASK_MIN_DELAY_MS 1
 #define LVGL_TASK_STACK_SIZE (8 * 1024)
@@ -120,10 +135,381 @@ static void apply_brightness_hw(uint8_t brightness_percent)
 // Use a conservative timeout to fail-open and keep the UI responsive.
 #define LVGL_FLUSH_TIMEOUT_MS 1000
 
+// Period of the frame-metrics log dump; 0 leaves it off. Set it with
+// target_compile_definitions(${COMPONENT_LIB} PRIVATE DISPLAY_METRICS_LOG_PERIOD_MS=10000) in main/CMakeLists.txt.
+#ifndef DISPLAY_METRICS_LOG_PERIOD_MS
+#define DISPLAY_METRICS_LOG_PERIOD_MS 0
+#endif
+
+// Flush engine: LVGL renders into DMA-sized horizontal stripes taken from a small pool.
+// flush_cb hands a finished stripe to the flush task and immediately gives LVGL a free
+// stripe to render the next band into, so CPU rendering and the QSPI DMA overlap.
+// The SPI panel IO waits for queued colour data before it sends the next CASET/RASET,
+// so one stripe is on the wire, one waits in the flush task and one is being rendered.
+#define LVGL_STRIPE_POOL_SIZE 3
+#define LVGL_FLUSH_TASK_STACK_SIZE (3 * 1024)
+#define LVGL_FLUSH_TASK_PRIORITY (LVGL_TASK_PRIORITY + 1)
+
+typedef enum {
+    STRIPE_FREE = 0,
+    STRIPE_LVGL,     // referenced by draw_buf->buf1/buf2 (rendering or reserved)
+    STRIPE_FLUSHING, // queued for, or on, the QSPI bus
+} stripe_state_t;
+
+typedef struct {
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+    uint8_t slot;
+} flush_job_t;
+
+static lv_color_t *s_stripe_buf[LVGL_STRIPE_POOL_SIZE] = {};
+static stripe_state_t s_stripe_state[LVGL_STRIPE_POOL_SIZE] = {};
+static int s_stripe_count = 0;
+static int s_stripe_lines = 0;
+
+// In-flight stripes in submission order. The panel completes transfers in FIFO order,
+// so the DMA-done callback always retires the oldest entry.
+static uint8_t s_inflight_slot[LVGL_STRIPE_POOL_SIZE] = {};
+static bool s_inflight_failed[LVGL_STRIPE_POOL_SIZE] = {};
+static int s_inflight_head = 0;
+static int s_inflight_count = 0;
+
+// LVGL is blocked in wait_cb until a stripe is recycled into *s_pending_ptr.
 static volatile bool s_flush_inflight = false;
 static volatile uint32_t s_flush_start_ms = 0;
+static lv_color_t **s_pending_ptr = nullptr;
+
+static portMUX_TYPE s_flush_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t s_flush_queue = nullptr;
+static SemaphoreHandle_t s_flush_done_sem = nullptr;
 static lv_disp_drv_t *s_disp_drv_ptr = nullptr;
 
+// Per-frame pipeline timing. Transfer time is the span during which at least one stripe
+// was on the bus; any part of it not spent with LVGL blocked in wait_cb overlapped rendering.
+static int64_t s_xfer_busy_since_us = 0;
+static uint32_t s_xfer_accum_us = 0;
+static uint32_t s_wait_accum_us = 0;
+static display_lvgl_flush_stats_t s_flush_stats = {};
+
+// Frame-timing metrics, dumped by the log timer. Histogram bucket upper bounds in ms:
+// 1, 2, 4, 8, 16, 33, 66, +inf.
+#define METRICS_HIST_BUCKETS 8
+
+typedef struct {
+    uint32_t count[METRICS_HIST_BUCKETS];
+    uint32_t samples;
+    uint32_t max_us;
+    uint64_t sum_us;
+} metrics_hist_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t uptime_ms;       // esp_timer time of the snapshot, for FPS between two dumps
+    metrics_hist_t render;    // per frame
+    metrics_hist_t flush;     // per frame, QSPI busy time
+    metrics_hist_t wait;      // per frame, LVGL blocked on a free stripe
+    metrics_hist_t lock_hold; // per display_lvgl_lock()/unlock() pair, any task
+    uint32_t dirty_areas;     // invalidated areas after LVGL and area_merge joined them
+    uint64_t dirty_px;
+    uint32_t merged_areas;    // areas folded into a neighbour by area_merge
+    uint64_t changed_px;      // invalidated pixels before area_merge (what actually changed)
+    uint32_t flushes;         // flush_cb calls (stripes)
+    uint64_t flushed_px;
+    uint32_t flush_timeouts;  // forced flush_ready() after LVGL_FLUSH_TIMEOUT_MS
+    uint32_t flush_errors;    // esp_lcd_panel_draw_bitmap() failures
+} metrics_t;
+
+// Written from the LVGL task, the flush task and whichever task holds the LVGL lock; read from the
+// log timer.
+static portMUX_TYPE s_metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+static metrics_t s_metrics = {};
+static bool s_frame_areas_counted = false;
+static int64_t s_lock_taken_us = 0;
+static esp_timer_handle_t s_metrics_log_timer = nullptr;
+
+static void hist_add_locked(metrics_hist_t *h, uint32_t us)
+{
+    static const uint32_t kBoundsUs[METRICS_HIST_BUCKETS - 1] = {1000, 2000, 4000, 8000, 16000, 33000, 66000};
+    int b = 0;
+    while (b < METRICS_HIST_BUCKETS - 1 && us > kBoundsUs[b]) {
+        b++;
+    }
+    h->count[b]++;
+    h->samples++;
+    h->sum_us += us;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+}
+
+static void metrics_count_flush(const lv_area_t *area)
+{
+    uint32_t areas = 0;
+    uint64_t area_px = 0;
+    if (!s_frame_areas_counted) {
+        // First flush of a frame: the invalidated area list is still intact (LVGL clears it after the last flush).
+        s_frame_areas_counted = true;
+        lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+        for (uint16_t i = 0; disp && i < disp->inv_p; i++) {
+            if (!disp->inv_area_joined[i]) {
+                areas++;
+                area_px += lv_area_get_size(&disp->inv_areas[i]);
+            }
+        }
+    }
+    const uint32_t px = lv_area_get_size(area);
+
+    portENTER_CRITICAL(&s_metrics_lock);
+    s_metrics.flushes++;
+    s_metrics.flushed_px += px;
+    s_metrics.dirty_areas += areas;
+    s_metrics.dirty_px += area_px;
+    portEXIT_CRITICAL(&s_metrics_lock);
+}
+
+static void metrics_count_flush_event(uint32_t *counter)
+{
+    portENTER_CRITICAL(&s_metrics_lock);
+    (*counter)++;
+    portEXIT_CRITICAL(&s_metrics_lock);
+}
+
+static void metrics_snapshot(metrics_t *out)
+{
+    portENTER_CRITICAL(&s_metrics_lock);
+    *out = s_metrics;
+    portEXIT_CRITICAL(&s_metrics_lock);
+    out->uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static uint32_t hist_window_avg_us(const metrics_hist_t *now, const metrics_hist_t *prev)
+{
+    const uint32_t n = now->samples - prev->samples;
+    return n ? (uint32_t)((now->sum_us - prev->sum_us) / n) : 0;
+}
+
+static void hist_log(const char *name, const metrics_hist_t *now, const metrics_hist_t *prev)
+{
+    uint32_t c[METRICS_HIST_BUCKETS];
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        c[i] = now->count[i] - prev->count[i];
+    }
+    ESP_LOGI(TAG, "  %-9s avg=%5uus max=%6uus  <=1:%u <=2:%u <=4:%u <=8:%u <=16:%u <=33:%u <=66:%u >66:%u", name,
+             (unsigned)hist_window_avg_us(now, prev), (unsigned)now->max_us, (unsigned)c[0], (unsigned)c[1], (unsigned)c[2],
+             (unsigned)c[3], (unsigned)c[4], (unsigned)c[5], (unsigned)c[6], (unsigned)c[7]);
+}
+
+static void metrics_log_cb(void *)
+{
+    // Counters are cumulative; log the delta since the previous dump. max_us stays cumulative.
+    static metrics_t s_prev = {};
+    metrics_t m;
+    metrics_snapshot(&m);
+
+    const uint32_t dt_ms = m.uptime_ms - s_prev.uptime_ms;
+    const uint32_t frames = m.frames - s_prev.frames;
+    const uint32_t fps_x10 = dt_ms ? (uint32_t)((uint64_t)frames * 10000U / dt_ms) : 0;
+    const uint32_t flushes = m.flushes - s_prev.flushes;
+    const uint32_t txn_x10 = frames ? flushes * 10U / frames : 0;
+    ESP_LOGI(TAG, "frames=%u fps=%u.%u areas=%u (merged %u) dirty_px=%u flushes=%u flushed_px=%u timeouts=%u errors=%u",
+             (unsigned)frames, (unsigned)(fps_x10 / 10), (unsigned)(fps_x10 % 10),
+             (unsigned)(m.dirty_areas - s_prev.dirty_areas), (unsigned)(m.merged_areas - s_prev.merged_areas),
+             (unsigned)(m.dirty_px - s_prev.dirty_px), (unsigned)flushes, (unsigned)(m.flushed_px - s_prev.flushed_px),
+             (unsigned)m.flush_timeouts, (unsigned)m.flush_errors);
+    ESP_LOGI(TAG, "  txn/frame=%u.%u pushed=%uKB changed=%uKB", (unsigned)(txn_x10 / 10), (unsigned)(txn_x10 % 10),
+             (unsigned)((m.flushed_px - s_prev.flushed_px) * (LCD_BIT_PER_PIXEL / 8) / 1024),
+             (unsigned)((m.changed_px - s_prev.changed_px) * (LCD_BIT_PER_PIXEL / 8) / 1024));
+    hist_log("render", &m.render, &s_prev.render);
+    hist_log("flush", &m.flush, &s_prev.flush);
+    hist_log("wait", &m.wait, &s_prev.wait);
+    hist_log("lock_hold", &m.lock_hold, &s_prev.lock_hold);
+    s_prev = m;
+}
+
+static void metrics_log_start(uint32_t period_ms)
+{
+    const esp_timer_create_args_t args = {
+        .callback = &metrics_log_cb,
+        .arg = NULL,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "disp_metrics",
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&args, &s_metrics_log_timer) != ESP_OK) {
+        ESP_LOGW(TAG, "metrics log timer create failed");
+        return;
+    }
+    esp_timer_start_periodic(s_metrics_log_timer, (uint64_t)period_ms * 1000ULL);
+}
+
+static int stripe_slot_of(const lv_color_t *buf)
+{
+    for (int i = 0; i < s_stripe_count; i++) {
+        if (s_stripe_buf[i] == buf) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int stripe_take_free_locked(void)
+{
+    for (int i = 0; i < s_stripe_count; i++) {
+        if (s_stripe_state[i] == STRIPE_FREE) {
+            s_stripe_state[i] = STRIPE_LVGL;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Hands a recycled stripe to LVGL if it is blocked waiting for one. Returns true if LVGL was released.
+static bool stripe_release_pending_locked(void)
+{
+    if (!s_pending_ptr || !s_disp_drv_ptr) {
+        return false;
+    }
+    const int slot = stripe_take_free_locked();
+    if (slot < 0) {
+        return false;
+    }
+    *s_pending_ptr = s_stripe_buf[slot];
+    s_pending_ptr = nullptr;
+    s_flush_inflight = false;
+    lv_disp_flush_ready(s_disp_drv_ptr);
+    return true;
+}
+
+static void xfer_busy_end_locked(int64_t now_us)
+{
+    if (s_inflight_count == 0 && s_xfer_busy_since_us != 0) {
+        s_xfer_accum_us += (uint32_t)(now_us - s_xfer_busy_since_us);
+        s_xfer_busy_since_us = 0;
+    }
+}
+
+// Retires the oldest in-flight stripe, plus any stripes behind it whose submission already failed.
+static bool stripe_retire_oldest_locked(int64_t now_us)
+{
+    if (s_inflight_count == 0) {
+        return false;
+    }
+    do {
+        s_stripe_state[s_inflight_slot[s_inflight_head]] = STRIPE_FREE;
+        s_inflight_failed[s_inflight_head] = false;
+        s_inflight_head = (s_inflight_head + 1) % LVGL_STRIPE_POOL_SIZE;
+        s_inflight_count--;
+    } while (s_inflight_count > 0 && s_inflight_failed[s_inflight_head]);
+
+    xfer_busy_end_locked(now_us);
+    return stripe_release_pending_locked();
+}
+
+static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t, esp_lcd_panel_io_event_data_t *, void *)
+{
+    bool released;
+    portENTER_CRITICAL_ISR(&s_flush_lock);
+    released = stripe_retire_oldest_locked(esp_timer_get_time());
+    portEXIT_CRITICAL_ISR(&s_flush_lock);
+
+    BaseType_t woken = pdFALSE;
+    if (released && s_flush_done_sem) {
+        xSemaphoreGiveFromISR(s_flush_done_sem, &woken);
+    }
+    if (released && s_lvgl_task) {
+        vTaskNotifyGiveFromISR(s_lvgl_task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+// Called from the flush task when a stripe could not be queued: its DMA-done callback will never fire.
+static void stripe_submit_failed(uint8_t slot)
+{
+    bool released = false;
+    portENTER_CRITICAL(&s_flush_lock);
+    for (int i = 0; i < s_inflight_count; i++) {
+        const int idx = (s_inflight_head + i) % LVGL_STRIPE_POOL_SIZE;
+        if (s_inflight_slot[idx] != slot) {
+            continue;
+        }
+        if (i == 0) {
+            released = stripe_retire_oldest_locked(esp_timer_get_time());
+        } else {
+            // Older stripes are still on the wire; retire this one right after them.
+            s_inflight_failed[idx] = true;
+        }
+        break;
+    }
+    portEXIT_CRITICAL(&s_flush_lock);
+    if (released && s_flush_done_sem) {
+        xSemaphoreGive(s_flush_done_sem);
+    }
+}
+
+// Fail-open when the panel IO stops completing transfers: reclaim every stripe and release LVGL.
+static void flush_engine_check_timeout(const char *where)
+{
+    if (!s_flush_inflight) {
+        return;
+    }
+    uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    if (now_ms - s_flush_start_ms <= LVGL_FLUSH_TIMEOUT_MS) {
+        return;
+    }
+    static uint32_t s_last_timeout_log_ms = 0;
+    if (now_ms - s_last_timeout_log_ms > 2000) {
+        s_last_timeout_log_ms = now_ms;
+        ESP_LOGE(TAG, "LVGL flush timeout in %s (> %u ms). Forcing flush_ready().", where, LVGL_FLUSH_TIMEOUT_MS);
+    }
+    metrics_count_flush_event(&s_metrics.flush_timeouts);
+
+    portENTER_CRITICAL(&s_flush_lock);
+    const int64_t now_us = esp_timer_get_time();
+    while (s_inflight_count > 0 && !stripe_retire_oldest_locked(now_us)) {
+    }
+    if (s_pending_ptr && s_disp_drv_ptr) {
+        // Nothing could be recycled (bookkeeping lost); let LVGL reuse the stripe it just flushed.
+        s_pending_ptr = nullptr;
+        s_flush_inflight = false;
+        lv_disp_flush_ready(s_disp_drv_ptr);
+    }
+    portEXIT_CRITICAL(&s_flush_lock);
+}
+
+static void lvgl_flush_task(void *)
+{
+    flush_job_t job;
+    while (true) {
+        if (xQueueReceive(s_flush_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        portENTER_CRITICAL(&s_flush_lock);
+        if (s_xfer_busy_since_us == 0) {
+            s_xfer_busy_since_us = esp_timer_get_time();
+        }
+        portEXIT_CRITICAL(&s_flush_lock);
+
+        panel_io_lock();
+        esp_err_t err = esp_lcd_panel_draw_bitmap(s_panel_handle, job.x1, job.y1, job.x2 + 1, job.y2 + 1, s_stripe_buf[job.slot]);
+        panel_io_unlock();
+        if (err != ESP_OK) {
+            // If the transfer wasn't queued, the IO "flush ready" callback will never fire.
+            // Recycle the stripe here to avoid a permanent busy state + task watchdog.
+            static uint32_t s_last_log_ms = 0;
+            uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+            if (now_ms - s_last_log_ms > 1000) {
+                s_last_log_ms = now_ms;
+                ESP_LOGW(TAG, "panel_draw_bitmap failed: %s (unblocking LVGL)", esp_err_to_name(err));
+            }
+            metrics_count_flush_event(&s_metrics.flush_errors);
+            stripe_submit_failed(job.slot);
+        }
+    }
+}
+
 static const sh8601_lcd_init_cmd_t kLcdInitCmds[] = {
     {0x11, (uint8_t[]){0x00}, 0, 120},
     {0x44, (uint8_t[]){0x01, 0xD1}, 2, 0},
@@ -136,53 +522,47 @@ static const sh8601_lcd_init_cmd_t kLcdInitCmds[] = {
     {0x51, (uint8_t[]){0xFF}, 1, 0},
 };
 
-static bool notify_lvgl_flush_ready(esp_lcd_panel_io_handle_t, esp_lcd_panel_io_event_data_t *, void *user_ctx)
-{
-    lv_disp_drv_t *disp_driver = (lv_disp_drv_t *)user_ctx;
-    s_flush_inflight = false;
-    lv_disp_flush_ready(disp_driver);
-    return false;
-}
-
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map)
 {
-    esp_lcd_panel_handle_t panel_handle = (esp_lcd_panel_handle_t)drv->user_data;
-    const int offsetx1 = area->x1;
-    const int offsetx2 = area->x2;
-    const int offsety1 = area->y1;
-    const int offsety2 = area->y2;
+    const int slot = stripe_slot_of(color_map);
+    assert(slot >= 0 && "flush_cb called with a buffer outside the stripe pool");
+
+    metrics_count_flush(area);
+    screen_mirror_tap(area, color_map);
 
 #if LCD_BIT_PER_PIXEL == 24
-    uint8_t *to = (uint8_t *)color_map;
-    uint16_t pixel_num = (offsetx2 - offsetx1 + 1) * (offsety2 - offsety1 + 1);
-
-    uint8_t temp = color_map[0].ch.blue;
-    *to++ = color_map[0].ch.red;
-    *to++ = color_map[0].ch.green;
-    *to++ = temp;
-    for (int i = 1; i < pixel_num; i++) {
-        *to++ = color_map[i].ch.red;
-        *to++ = color_map[i].ch.green;
-        *to++ = color_map[i].ch.blue;
-    }
+    // Repack XRGB8888 to RGB888 in place; size_t so a full 368x448 area doesn't wrap.
+    const size_t pixel_num = (size_t)(area->x2 - area->x1 + 1) * (size_t)(area->y2 - area->y1 + 1);
+    color_convert_xrgb8888_to_rgb888((uint8_t *)color_map, (const uint32_t *)color_map, pixel_num);
 #endif
 
+    flush_job_t job = {
+        .x1 = area->x1,
+        .y1 = area->y1,
+        .x2 = area->x2,
+        .y2 = area->y2,
+        .slot = (uint8_t)slot,
+    };
+
+    // LVGL renders the next band into the other draw buffer, then waits for flush_ready before
+    // flushing it and rendering into this one again. Swap this stripe out of draw_buf now so
+    // LVGL can keep going as long as the pool has a free stripe.
+    lv_disp_draw_buf_t *draw_buf = drv->draw_buf;
+    lv_color_t **slot_ptr = (draw_buf->buf1 == color_map) ? (lv_color_t **)&draw_buf->buf1 : (lv_color_t **)&draw_buf->buf2;
+
+    portENTER_CRITICAL(&s_flush_lock);
+    s_stripe_state[slot] = STRIPE_FLUSHING;
+    const int tail = (s_inflight_head + s_inflight_count) % LVGL_STRIPE_POOL_SIZE;
+    s_inflight_slot[tail] = (uint8_t)slot;
+    s_inflight_failed[tail] = false;
+    s_inflight_count++;
+    s_pending_ptr = slot_ptr;
     s_flush_inflight = true;
     s_flush_start_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    (void)stripe_release_pending_locked();
+    portEXIT_CRITICAL(&s_flush_lock);
 
-    esp_err_t err = esp_lcd_panel_draw_bitmap(panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1, color_map);
-    if (err != ESP_OK) {
-        // If the transfer wasn't queued, the IO "flush ready" callback will never fire.
-        // Unblock LVGL to avoid a permanent busy state + task watchdog.
-        static uint32_t s_last_log_ms = 0;
-        uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
-        if (now_ms - s_last_log_ms > 1000) {
-            s_last_log_ms = now_ms;
-            ESP_LOGW(TAG, "panel_draw_bitmap failed: %s (unblocking LVGL)", esp_err_to_name(err));
-        }
-        s_flush_inflight = false;
-        lv_disp_flush_ready(drv);
-    }
+    xQueueSend(s_flush_queue, &job, portMAX_DELAY);
 }
 
 static void lvgl_update_cb(lv_disp_drv_t *drv)
@@ -209,32 +589,93 @@ static void lvgl_update_cb(lv_disp_drv_t *drv)
     }
 }
 
-static void lvgl_wait_cb(lv_disp_drv_t *drv)
+static void lvgl_wait_cb(lv_disp_drv_t *)
 {
-    // LVGL can enter a busy-wait loop (while(draw_buf->flushing)) if it believes a previous flush
-    // is still in progress. If the panel IO completion callback is missed (e.g., SPI queue failure),
-    // LVGL will spin forever unless we yield here.
-    //
-    // Only yield when a flush is actually in flight; otherwise this unnecessarily throttles
-    // `lv_timer_handler()` and reduces UI responsiveness.
+    // LVGL busy-waits (while(draw_buf->flushing)) when it has no free stripe to render into.
+    // Block until the DMA-done callback recycles one; the short timeout keeps the
+    // fail-open check running if the panel IO completion callback is missed.
     if (!s_flush_inflight) {
         return;
     }
 
-    vTaskDelay(pdMS_TO_TICKS(1));
+    const int64_t t0_us = esp_timer_get_time();
+    if (s_flush_done_sem) {
+        xSemaphoreTake(s_flush_done_sem, pdMS_TO_TICKS(2));
+    } else {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    s_wait_accum_us += (uint32_t)(esp_timer_get_time() - t0_us);
 
-    if (s_flush_inflight) {
-        uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
-        if (now_ms - s_flush_start_ms > LVGL_FLUSH_TIMEOUT_MS) {
-            static uint32_t s_last_timeout_log_ms = 0;
-            if (now_ms - s_last_timeout_log_ms > 2000) {
-                s_last_timeout_log_ms = now_ms;
-                ESP_LOGE(TAG, "LVGL flush timeout in wait_cb (> %u ms). Forcing flush_ready().", LVGL_FLUSH_TIMEOUT_MS);
-            }
-            s_flush_inflight = false;
-            lv_disp_flush_ready(drv);
-        }
+    flush_engine_check_timeout("wait_cb");
+}
+
+static void lvgl_monitor_cb(lv_disp_drv_t *, uint32_t time_ms, uint32_t px)
+{
+    const int64_t now_us = esp_timer_get_time();
+
+    uint32_t xfer_us;
+    portENTER_CRITICAL(&s_flush_lock);
+    if (s_xfer_busy_since_us != 0) {
+        // Bill the part of the current transfer that ran during this frame; the rest goes to the next one.
+        s_xfer_accum_us += (uint32_t)(now_us - s_xfer_busy_since_us);
+        s_xfer_busy_since_us = now_us;
+    }
+    xfer_us = s_xfer_accum_us;
+    s_xfer_accum_us = 0;
+    portEXIT_CRITICAL(&s_flush_lock);
+
+    const uint32_t wait_us = s_wait_accum_us;
+    s_wait_accum_us = 0;
+
+    const uint32_t frame_us = time_ms * 1000U;
+    const uint32_t render_us = (frame_us > wait_us) ? (frame_us - wait_us) : 0;
+    uint32_t overlap_us = (xfer_us > wait_us) ? (xfer_us - wait_us) : 0;
+    if (overlap_us > render_us) {
+        overlap_us = render_us;
+    }
+
+    display_lvgl_flush_stats_t *st = &s_flush_stats;
+    st->frames++;
+    st->last_render_us = render_us;
+    st->last_transfer_us = xfer_us;
+    st->last_overlap_us = overlap_us;
+    st->last_wait_us = wait_us;
+    st->last_px = px;
+    // Exponential moving averages (1/8 weight) keep the numbers readable in a periodic log.
+    if (st->frames == 1) {
+        st->avg_render_us = render_us;
+        st->avg_transfer_us = xfer_us;
+        st->avg_overlap_us = overlap_us;
+    } else {
+        st->avg_render_us = (st->avg_render_us * 7U + render_us) / 8U;
+        st->avg_transfer_us = (st->avg_transfer_us * 7U + xfer_us) / 8U;
+        st->avg_overlap_us = (st->avg_overlap_us * 7U + overlap_us) / 8U;
+    }
+
+    s_frame_areas_counted = false;
+    portENTER_CRITICAL(&s_metrics_lock);
+    s_metrics.frames++;
+    hist_add_locked(&s_metrics.render, render_us);
+    hist_add_locked(&s_metrics.flush, xfer_us);
+    hist_add_locked(&s_metrics.wait, wait_us);
+    portEXIT_CRITICAL(&s_metrics_lock);
+}
+
+// Runs after LVGL joined overlapping areas and before it renders them: fold nearby small areas
+// (status-bar clock, battery, page indicator) so they go out in fewer panel transactions.
+static void lvgl_render_start_cb(lv_disp_drv_t *drv)
+{
+    lv_disp_t *disp = _lv_refr_get_disp_refreshing();
+    if (!disp || disp->inv_p == 0) {
+        return;
     }
+    area_merge_result_t r;
+    area_merge_run(disp->inv_areas, disp->inv_area_joined, disp->inv_p, drv->draw_buf->size, AREA_MERGE_TXN_COST_PX, &r);
+
+    portENTER_CRITICAL(&s_metrics_lock);
+    s_metrics.merged_areas += (uint32_t)(r.areas_in - r.areas_out);
+    s_metrics.changed_px += r.px_in;
+    portEXIT_CRITICAL(&s_metrics_lock);
 }
 
 static void lvgl_rounder_cb(lv_disp_drv_t *, lv_area_t *area)
@@ -247,39 +688,89 @@ static void lvgl_rounder_cb(lv_disp_drv_t *, lv_area_t *area)
 
 static void lvgl_touch_cb(lv_indev_drv_t *drv, lv_indev_data_t *data)
 {
-    esp_lcd_touch_handle_t tp = (esp_lcd_touch_handle_t)drv->user_data;
-    assert(tp);
-
-    uint16_t tp_x;
-    uint16_t tp_y;
-    uint8_t tp_cnt = 0;
-    esp_lcd_touch_read_data(tp);
-    bool pressed = esp_lcd_touch_get_coordinates(tp, &tp_x, &tp_y, NULL, &tp_cnt, 1);
-    if (pressed && tp_cnt > 0) {
-        data->point.x = tp_x;
-        data->point.y = tp_y;
-        data->state = LV_INDEV_STATE_PRESSED;
-    } else {
-        data->state = LV_INDEV_STATE_RELEASED;
+    // Samples come from the touch task (I2C reads only after the INT line fires). Drain one per
+    // call and let LVGL come back for the rest, so each report is processed at its own position.
+    static touch_input_sample_t s_last = {};
+    touch_input_sample_t sample;
+    if (touch_input_pop(&sample)) {
+        s_last = sample;
+        data->continue_reading = touch_input_has_samples();
+    }
+    data->point.x = s_last.x;
+    data->point.y = s_last.y;
+    data->state = s_last.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+
+    // Nothing to read until the touch task queues a new sample; it resumes the timer via lvgl_task.
+    // Keep polling while pressed so LVGL's long-press and scroll timing still advance.
+    if (!s_last.pressed && !data->continue_reading) {
+        lv_timer_pause(drv->read_timer);
     }
 }
 
+// Runs in the touch task after it queued samples.
+static void lvgl_touch_sample_ready(void)
+{
+    s_touch_pending = true;
+    display_lvgl_wake();
+}
+
+#if !CONFIG_LV_TICK_CUSTOM
 static void increase_lvgl_tick(void *)
 {
     lv_tick_inc(LVGL_TICK_PERIOD_MS);
 }
+#endif
+
+// Recursive so LVGL callbacks (already under the lock) can call helpers that lock again.
+static int s_lock_depth = 0;
 
 bool display_lvgl_lock(int timeout_ms)
 {
     assert(s_lvgl_mux && "display_lvgl_init must be called first");
     const TickType_t timeout_ticks = (timeout_ms == -1) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    return xSemaphoreTake(s_lvgl_mux, timeout_ticks) == pdTRUE;
+    if (xSemaphoreTakeRecursive(s_lvgl_mux, timeout_ticks) != pdTRUE) {
+        return false;
+    }
+    if (s_lock_depth++ == 0) {
+        s_lock_taken_us = esp_timer_get_time();
+    }
+    return true;
 }
 
 void display_lvgl_unlock(void)
 {
     assert(s_lvgl_mux && "display_lvgl_init must be called first");
-    xSemaphoreGive(s_lvgl_mux);
+    const bool outermost = (--s_lock_depth == 0);
+    if (outermost) {
+        const uint32_t held_us = (uint32_t)(esp_timer_get_time() - s_lock_taken_us);
+        portENTER_CRITICAL(&s_metrics_lock);
+        hist_add_locked(&s_metrics.lock_hold, held_us);
+        portEXIT_CRITICAL(&s_metrics_lock);
+    }
+    xSemaphoreGiveRecursive(s_lvgl_mux);
+
+    // Another task may have invalidated objects or created timers; let LVGL re-plan its sleep.
+    if (outermost && s_lvgl_task && xTaskGetCurrentTaskHandle() != s_lvgl_task) {
+        xTaskNotifyGive(s_lvgl_task);
+    }
+}
+
+void display_lvgl_wake(void)
+{
+    if (s_lvgl_task) {
+        xTaskNotifyGive(s_lvgl_task);
+    }
+}
+
+esp_err_t display_lvgl_async_call(void (*cb)(void *), void *user_data)
+{
+    if (!display_lvgl_lock(-1)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    const lv_res_t res = lv_async_call(cb, user_data);
+    display_lvgl_unlock();
+    display_lvgl_wake();
+    return (res == LV_RES_OK) ? ESP_OK : ESP_ERR_NO_MEM;
 }
 
 static void lvgl_task(void *)
@@ -288,18 +779,14 @@ static void lvgl_task(void *)
     uint32_t task_delay_ms = LVGL_TASK_MAX_DELAY_MS;
     while (true) {
         if (display_lvgl_lock(-1)) {
-            if (s_flush_inflight && s_disp_drv_ptr) {
-                uint32_t now_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
-                if (now_ms - s_flush_start_ms > LVGL_FLUSH_TIMEOUT_MS) {
-                    static uint32_t s_last_timeout_log_ms = 0;
-                    if (now_ms - s_last_timeout_log_ms > 2000) {
-                        s_last_timeout_log_ms = now_ms;
-                        ESP_LOGE(TAG, "LVGL flush timeout (> %u ms). Forcing flush_ready() to avoid WDT.", LVGL_FLUSH_TIMEOUT_MS);
-                    }
-                    s_flush_inflight = false;
-                    lv_disp_flush_ready(s_disp_drv_ptr);
-                }
+            if (s_touch_pending && s_touch_indev) {
+                // New touch samples: resume the (paused) indev timer and read them right away.
+                s_touch_pending = false;
+                lv_timer_t *read_timer = s_touch_indev->driver->read_timer;
+                lv_timer_resume(read_timer);
+                lv_timer_ready(read_timer);
             }
+            flush_engine_check_timeout("lvgl_task");
             task_delay_ms = lv_timer_handler();
             display_lvgl_unlock();
         }
@@ -308,7 +795,7 @@ static void lvgl_task(void *)
         } else if (task_delay_ms < LVGL_TASK_MIN_DELAY_MS) {
             task_delay_ms = LVGL_TASK_MIN_DELAY_MS;
         }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(task_delay_ms));
     }
 }
 
@@ -344,10 +831,13 @@ esp_err_t display_lvgl_init(void)
         APP_LCD_H_RES * APP_LCD_V_RES * LCD_BIT_PER_PIXEL / 8);
     ESP_RETURN_ON_ERROR(spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO), TAG, "spi_bus_initialize failed");
 
+    s_panel_io_mux = xSemaphoreCreateMutex();
+    assert(s_panel_io_mux);
+
     ESP_LOGI(TAG, "Install panel IO");
     static lv_disp_drv_t disp_drv;
     esp_lcd_panel_io_handle_t io_handle = NULL;
-    esp_lcd_panel_io_spi_config_t io_config = SH8601_PANEL_IO_QSPI_CONFIG(APP_PIN_NUM_LCD_CS, notify_lvgl_flush_ready, &disp_drv);
+    esp_lcd_panel_io_spi_config_t io_config = SH8601_PANEL_IO_QSPI_CONFIG(APP_PIN_NUM_LCD_CS, notify_lvgl_flush_ready, NULL);
     // Push more bandwidth than the driver default (40MHz) for better FPS on QSPI panels.
     // If you see flicker/tearing/IO timeouts on a specific board spin, reduce this back to 40MHz.
     io_config.pclk_hz = 80 * 1000 * 1000;
@@ -391,106 +881,92 @@ esp_err_t display_lvgl_init(void)
     static lv_disp_draw_buf_t disp_buf;
     // IMPORTANT: For SPI LCD panel IO (esp_lcd_panel_io_spi), tx buffers must be DMA-capable.
     // On ESP32-S3, PSRAM is *sometimes* DMA-capable, but in practice the SPI path can still reject
-    // external buffers. Prefer INTERNAL+DMA buffers (smaller partial buffers) for reliability.
-    // With 8MB PSRAM, prefer larger partial buffers to reduce flush calls and improve FPS.
-    // We still fall back to smaller heights if DMA-capable allocation isn't available.
+    // external buffers, so every stripe is checked with esp_ptr_dma_capable().
+    // The flush engine overlaps rendering with transfers, so a pool of moderate stripes beats one
+    // big frame buffer: the first stripe reaches the panel sooner and the CPU never idles on DMA.
     const int desired_heights[] = {
-        APP_LCD_V_RES,       // full frame
-        APP_LCD_V_RES / 2,
-        APP_LCD_V_RES / 3,
-        APP_LCD_V_RES / 4,
-        APP_LCD_V_RES / 6,
         APP_LCD_V_RES / 8,
         APP_LCD_V_RES / 10,
-        80,
-        60,
         40,
-        30,
+        32,
         20,
     };
 
-    lv_color_t *buf1 = nullptr;
-    lv_color_t *buf2 = nullptr;
     int chosen_height = 0;
 
     // Wi-Fi (especially SoftAP) needs contiguous INTERNAL heap. Prefer PSRAM DMA buffers for LVGL
     // when available to reduce internal memory pressure.
-    const uint32_t caps_try[][2] = {
-        {MALLOC_CAP_SPIRAM | MALLOC_CAP_DMA, 1},
-        {MALLOC_CAP_SPIRAM | MALLOC_CAP_DMA, 0},
-        {MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA, 1}, // fallback
-        {MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA, 0},
+    const uint32_t caps_try[] = {
+        MALLOC_CAP_SPIRAM | MALLOC_CAP_DMA,
+        MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA, // fallback
     };
 
     for (size_t ci = 0; ci < sizeof(caps_try) / sizeof(caps_try[0]) && chosen_height == 0; ci++) {
-        const uint32_t caps = caps_try[ci][0];
+        const uint32_t caps = caps_try[ci];
         const bool is_internal_caps = (caps & MALLOC_CAP_INTERNAL) != 0;
-        bool want_double = caps_try[ci][1] != 0;
 
         // INTERNAL heap is scarce and is also used by I2C/Wi-Fi and other system components.
-        // Never double-buffer in INTERNAL, and keep the buffer height small to avoid runtime
-        // malloc failures (which can crash I2C command link creation).
-        if (is_internal_caps) {
-            want_double = false;
-        }
-        for (size_t hi = 0; hi < sizeof(desired_heights) / sizeof(desired_heights[0]); hi++) {
-            int h = desired_heights[hi];
-            if (h <= 0) {
-                continue;
-            }
-            if (h > APP_LCD_V_RES) {
-                h = APP_LCD_V_RES;
-            }
+        // Never double-buffer in INTERNAL (no overlap, but no failure either), and keep the stripe
+        // small to avoid runtime malloc failures (which can crash I2C command link creation).
+        const int min_count = is_internal_caps ? 1 : 2;
+        const int max_count = is_internal_caps ? 1 : LVGL_STRIPE_POOL_SIZE;
 
-            if (is_internal_caps && h > 40) {
+        for (size_t hi = 0; hi < sizeof(desired_heights) / sizeof(desired_heights[0]); hi++) {
+            const int h = desired_heights[hi];
+            if (h <= 0 || (is_internal_caps && h > 40)) {
                 continue;
             }
             const size_t px = (size_t)APP_LCD_H_RES * (size_t)h;
             const size_t bytes = px * sizeof(lv_color_t);
 
-            buf1 = (lv_color_t *)heap_caps_malloc(bytes, caps);
-            if (!buf1) {
-                continue;
+            int count = 0;
+            while (count < max_count) {
+                lv_color_t *buf = (lv_color_t *)heap_caps_malloc(bytes, caps);
+                if (!buf) {
+                    break;
+                }
+                // Ensure the buffer is DMA-capable for the SPI panel IO.
+                if (!esp_ptr_dma_capable(buf)) {
+                    heap_caps_free(buf);
+                    break;
+                }
+                s_stripe_buf[count++] = buf;
             }
 
-            // Ensure the buffer is DMA-capable for the SPI panel IO.
-            if (!esp_ptr_dma_capable(buf1)) {
-                heap_caps_free(buf1);
-                buf1 = nullptr;
+            if (count < min_count) {
+                for (int i = 0; i < count; i++) {
+                    heap_caps_free(s_stripe_buf[i]);
+                    s_stripe_buf[i] = nullptr;
+                }
                 continue;
             }
-            if (want_double) {
-                buf2 = (lv_color_t *)heap_caps_malloc(bytes, caps);
-                if (!buf2) {
-                    heap_caps_free(buf1);
-                    buf1 = nullptr;
-                    continue;
-                }
 
-                if (!esp_ptr_dma_capable(buf2)) {
-                    heap_caps_free(buf2);
-                    heap_caps_free(buf1);
-                    buf2 = nullptr;
-                    buf1 = nullptr;
-                    continue;
-                }
-            } else {
-                buf2 = nullptr;
+            s_stripe_count = count;
+            s_stripe_lines = h;
+            for (int i = 0; i < count; i++) {
+                s_stripe_state[i] = (i < 2) ? STRIPE_LVGL : STRIPE_FREE;
             }
-
             chosen_height = h;
-            const bool is_internal = (caps & MALLOC_CAP_INTERNAL) != 0;
-            ESP_LOGI(TAG, "LVGL draw buffers: %s x %dx%d (%s, dma=%d)", want_double ? "2" : "1", APP_LCD_H_RES, chosen_height,
-                     is_internal ? "INTERNAL" : "PSRAM", esp_ptr_dma_capable(buf1));
-            lv_disp_draw_buf_init(&disp_buf, buf1, buf2, (uint32_t)px);
+            ESP_LOGI(TAG, "LVGL draw stripes: %d x %dx%d (%s, dma=%d)", count, APP_LCD_H_RES, chosen_height,
+                     is_internal_caps ? "INTERNAL" : "PSRAM", esp_ptr_dma_capable(s_stripe_buf[0]));
+            lv_disp_draw_buf_init(&disp_buf, s_stripe_buf[0], count > 1 ? s_stripe_buf[1] : nullptr, (uint32_t)px);
             break;
         }
     }
 
-    if (chosen_height == 0 || !buf1) {
+    if (chosen_height == 0) {
         ESP_LOGE(TAG, "Failed to allocate any LVGL draw buffer");
         return ESP_ERR_NO_MEM;
     }
+    s_flush_stats.stripe_lines = (uint16_t)s_stripe_lines;
+    s_flush_stats.pool_size = (uint8_t)s_stripe_count;
+
+    s_flush_queue = xQueueCreate(LVGL_STRIPE_POOL_SIZE, sizeof(flush_job_t));
+    s_flush_done_sem = xSemaphoreCreateBinary();
+    if (!s_flush_queue || !s_flush_done_sem) {
+        ESP_LOGE(TAG, "Failed to create flush queue");
+        return ESP_ERR_NO_MEM;
+    }
 
     ESP_LOGI(TAG, "Register display driver to LVGL");
     lv_disp_drv_init(&disp_drv);
@@ -499,14 +975,17 @@ esp_err_t display_lvgl_init(void)
     disp_drv.ver_res = APP_LCD_V_RES;  // 448
     disp_drv.flush_cb = lvgl_flush_cb;
     disp_drv.rounder_cb = lvgl_rounder_cb;
+    disp_drv.render_start_cb = lvgl_render_start_cb;
     disp_drv.drv_update_cb = lvgl_update_cb;
     disp_drv.wait_cb = lvgl_wait_cb;
+    disp_drv.monitor_cb = lvgl_monitor_cb;
     disp_drv.draw_buf = &disp_buf;
     disp_drv.user_data = s_panel_handle;
     // Keep portrait mode for now
     disp_drv.rotated = LV_DISP_ROT_NONE;
     lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
 
+#if !CONFIG_LV_TICK_CUSTOM
     ESP_LOGI(TAG, "Install LVGL tick timer");
     const esp_timer_create_args_t lvgl_tick_timer_args = {
         .callback = &increase_lvgl_tick,
@@ -518,44 +997,28 @@ esp_err_t display_lvgl_init(void)
     esp_timer_handle_t lvgl_tick_timer = NULL;
     ESP_RETURN_ON_ERROR(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer), TAG, "esp_timer_create failed");
     ESP_RETURN_ON_ERROR(esp_timer_start_periodic(lvgl_tick_timer, LVGL_TICK_PERIOD_MS * 1000), TAG, "esp_timer_start_periodic failed");
+#else
+    // Tickless: lv_tick_get() reads esp_timer_get_time() (LV_TICK_CUSTOM), so no periodic tick interrupt.
+#endif
 
-    ESP_LOGI(TAG, "Init touch controller (FT5x06)");
-    esp_lcd_panel_io_handle_t tp_io_handle = NULL;
-    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_FT5x06_CONFIG();
-    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c(app_i2c_bus(), &tp_io_config, &tp_io_handle), TAG,
-                        "esp_lcd_new_panel_io_i2c failed");
-    const esp_lcd_touch_config_t tp_cfg = {
-        .x_max = APP_LCD_H_RES,
-        .y_max = APP_LCD_V_RES,
-        .rst_gpio_num = APP_PIN_NUM_TOUCH_RST,
-        .int_gpio_num = APP_PIN_NUM_TOUCH_INT,
-        .levels = {
-            .reset = 0,
-            .interrupt = 0,
-        },
-        .flags = {
-            .swap_xy = 0,
-            .mirror_x = 0,
-            .mirror_y = 0,
-        },
-        .process_coordinates = NULL,
-        .interrupt_callback = NULL,
-        .user_data = NULL,
-        .driver_data = NULL,
-    };
-    ESP_RETURN_ON_ERROR(esp_lcd_touch_new_i2c_ft5x06(tp_io_handle, &tp_cfg, &s_touch), TAG, "touch init failed");
+    ESP_RETURN_ON_ERROR(touch_input_init(lvgl_touch_sample_ready), TAG, "touch init failed");
 
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
     indev_drv.type = LV_INDEV_TYPE_POINTER;
     indev_drv.disp = disp;
     indev_drv.read_cb = lvgl_touch_cb;
-    indev_drv.user_data = s_touch;
-    lv_indev_drv_register(&indev_drv);
+    s_touch_indev = lv_indev_drv_register(&indev_drv);
 
-    s_lvgl_mux = xSemaphoreCreateMutex();
+    s_lvgl_mux = xSemaphoreCreateRecursiveMutex();
     assert(s_lvgl_mux);
-    xTaskCreatePinnedToCore(lvgl_task, "LVGL", LVGL_TASK_STACK_SIZE, NULL, LVGL_TASK_PRIORITY, NULL, LVGL_TASK_CORE);
+    if (DISPLAY_METRICS_LOG_PERIOD_MS > 0) {
+        metrics_log_start(DISPLAY_METRICS_LOG_PERIOD_MS);
+    }
+    // The flush task sits one priority above LVGL so a finished stripe goes on the bus right away.
+    xTaskCreatePinnedToCore(lvgl_flush_task, "LVGL_flush", LVGL_FLUSH_TASK_STACK_SIZE, NULL, LVGL_FLUSH_TASK_PRIORITY, NULL,
+                            LVGL_TASK_CORE);
+    xTaskCreatePinnedToCore(lvgl_task, "LVGL", LVGL_TASK_STACK_SIZE, NULL, LVGL_TASK_PRIORITY, &s_lvgl_task, LVGL_TASK_CORE);
 
     return ESP_OK;
 }
@@ -563,7 +1026,9 @@ esp_err_t display_lvgl_init(void)
 void display_lvgl_set_on(bool on)
 {
     if (s_panel_handle) {
+        panel_io_lock();
         esp_lcd_panel_disp_on_off(s_panel_handle, on);
+        panel_io_unlock();
     }
 }
 
@@ -579,3 +1044,11 @@ uint8_t display_lvgl_get_brightness(void)
 {
     return s_brightness;
 }
+
+void display_lvgl_get_flush_stats(display_lvgl_flush_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = s_flush_stats;
+}
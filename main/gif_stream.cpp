@@ -0,0 +1,293 @@
+#include "gif_stream.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if LV_USE_GIF
+#include "extra/libs/gif/gifdec.h"
+#endif
+
+static const char *TAG = "gif_stream";
+
+#define GIF_STREAM_TASK_STACK_SIZE (6 * 1024)
+#define GIF_STREAM_TASK_PRIORITY 2
+#define GIF_STREAM_TASK_CORE 0
+#define GIF_STREAM_MAX_FRAMES 3
+// PSRAM for the ring; large GIFs get two frames, larger ones are refused.
+#define GIF_STREAM_RING_BUDGET (2 * 1024 * 1024)
+// Browsers treat delays under 20 ms as 100 ms; so do we.
+#define GIF_STREAM_MIN_DELAY_MS 20
+#define GIF_STREAM_DEFAULT_DELAY_MS 100
+
+typedef enum {
+    GIF_STATE_OPENING = 0,
+    GIF_STATE_PLAYING,
+    GIF_STATE_ENDED, // no more frames will be decoded
+    GIF_STATE_FAILED,
+} gif_state_t;
+
+typedef struct {
+    std::atomic<int> refs; // object + worker
+    std::atomic<bool> stop;
+    std::atomic<int> state;
+    // Frame N lives in slot N % ring_frames. tail is on screen, tail+1..head-1 are ready.
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    uint8_t ring_frames;
+    uint8_t *slot[GIF_STREAM_MAX_FRAMES];
+    uint16_t slot_delay_ms[GIF_STREAM_MAX_FRAMES];
+    uint16_t w;
+    uint16_t h;
+    char lv_path[260];
+
+    // Worker-side decode timing, read by the LVGL side for stats.
+    std::atomic<uint32_t> decode_us_total;
+    std::atomic<uint32_t> decode_us_max;
+    std::atomic<uint32_t> decoded;
+
+    // LVGL side.
+    lv_img_dsc_t img;
+    lv_timer_t *timer;
+    bool started;
+    bool stalled;
+    uint32_t due_ms; // when the frame on screen has had its time
+    gif_stream_stats_t stats;
+} gif_stream_t;
+
+static void stream_unref(gif_stream_t *gs)
+{
+    if (gs->refs.fetch_sub(1) != 1) {
+        return;
+    }
+    for (uint8_t i = 0; i < gs->ring_frames; i++) {
+        heap_caps_free(gs->slot[i]);
+    }
+    delete gs;
+}
+
+// ---- Worker ----
+
+#if LV_USE_GIF
+static void gif_task(void *arg)
+{
+    gif_stream_t *gs = (gif_stream_t *)arg;
+    gd_GIF *gif = gd_open_gif_file(gs->lv_path);
+    if (!gif) {
+        ESP_LOGW(TAG, "Cannot open %s", gs->lv_path);
+        gs->state.store(GIF_STATE_FAILED);
+        stream_unref(gs);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    const size_t bytes = (size_t)gif->width * gif->height * LV_IMG_PX_SIZE_ALPHA_BYTE;
+    uint8_t frames = (uint8_t)(GIF_STREAM_RING_BUDGET / (bytes ? bytes : 1));
+    frames = frames > GIF_STREAM_MAX_FRAMES ? GIF_STREAM_MAX_FRAMES : frames;
+    for (uint8_t i = 0; i < frames; i++) {
+        gs->slot[i] = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!gs->slot[i]) {
+            frames = i;
+            break;
+        }
+    }
+    gs->ring_frames = frames;
+    if (frames < 2) {
+        ESP_LOGW(TAG, "%s: %ux%u is too large to stream", gs->lv_path, (unsigned)gif->width, (unsigned)gif->height);
+        gd_close_gif(gif);
+        gs->state.store(GIF_STATE_FAILED);
+        stream_unref(gs);
+        vTaskDelete(NULL);
+        return;
+    }
+    gs->w = gif->width;
+    gs->h = gif->height;
+    gs->state.store(GIF_STATE_PLAYING);
+
+    int end_state = GIF_STATE_ENDED;
+    while (!gs->stop.load()) {
+        const uint32_t head = gs->head.load();
+        if (head - gs->tail.load() >= gs->ring_frames) {
+            vTaskDelay(pdMS_TO_TICKS(5)); // ring full: the screen is behind us
+            continue;
+        }
+
+        const int64_t t0 = esp_timer_get_time();
+        // gifdec rewinds by itself for the NETSCAPE loop count; 0 means the last repeat is done
+        // and the final frame stays on screen.
+        const int r = gd_get_frame(gif);
+        if (r <= 0) {
+            if (r < 0) {
+                ESP_LOGW(TAG, "%s: decode error", gs->lv_path);
+            }
+            if (head == 0) {
+                end_state = GIF_STATE_FAILED;
+            }
+            break;
+        }
+        const uint8_t s = (uint8_t)(head % gs->ring_frames);
+        gd_render_frame(gif, gs->slot[s]);
+        const uint32_t delay = gif->gce.delay * 10U;
+        gs->slot_delay_ms[s] = (uint16_t)(delay < GIF_STREAM_MIN_DELAY_MS ? GIF_STREAM_DEFAULT_DELAY_MS : delay);
+
+        const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+        gs->decode_us_total.fetch_add(us);
+        gs->decoded.fetch_add(1);
+        if (us > gs->decode_us_max.load()) {
+            gs->decode_us_max.store(us);
+        }
+        gs->head.store(head + 1);
+    }
+
+    gd_close_gif(gif);
+    gs->state.store(end_state);
+    stream_unref(gs);
+    vTaskDelete(NULL);
+}
+#endif
+
+// ---- LVGL side ----
+
+static void show_frame(lv_obj_t *obj, gif_stream_t *gs, uint32_t frame)
+{
+    gs->img.data = gs->slot[frame % gs->ring_frames];
+    // The image cache holds the old data pointer for this descriptor.
+    lv_img_cache_invalidate_src(&gs->img);
+    lv_obj_invalidate(obj);
+    gs->stats.frames_shown++;
+}
+
+static void gif_timer_cb(lv_timer_t *t)
+{
+    lv_obj_t *obj = (lv_obj_t *)t->user_data;
+    gif_stream_t *gs = (gif_stream_t *)lv_obj_get_user_data(obj);
+    const int state = gs->state.load();
+    if (state == GIF_STATE_FAILED) {
+        lv_timer_pause(t);
+        lv_event_send(obj, LV_EVENT_CANCEL, NULL);
+        return;
+    }
+    if (state == GIF_STATE_OPENING || gs->head.load() == 0) {
+        return;
+    }
+
+    const uint32_t now = lv_tick_get();
+    uint32_t tail = gs->tail.load();
+    if (!gs->started) {
+        gs->img.header.always_zero = 0;
+        gs->img.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        gs->img.header.w = gs->w;
+        gs->img.header.h = gs->h;
+        gs->img.data_size = (uint32_t)gs->w * gs->h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+        gs->img.data = gs->slot[0];
+        lv_img_set_src(obj, &gs->img);
+        gs->stats.frames_shown++;
+        gs->started = true;
+        gs->due_ms = now + gs->slot_delay_ms[0];
+        lv_event_send(obj, LV_EVENT_READY, NULL);
+    } else if ((int32_t)(now - gs->due_ms) >= 0) {
+        if (gs->head.load() - tail < 2) {
+            if (state == GIF_STATE_ENDED) {
+                lv_timer_pause(t); // played out; keep the last frame
+                return;
+            }
+            // Next frame is not decoded yet; count the stall once.
+            if (!gs->stalled) {
+                gs->stats.underruns++;
+                gs->stalled = true;
+            }
+            lv_timer_set_period(t, 5);
+            return;
+        }
+        tail++;
+        if (gs->stalled) {
+            gs->due_ms = now; // restart the timeline rather than rushing to catch up
+            gs->stalled = false;
+        }
+        gs->due_ms += gs->slot_delay_ms[tail % gs->ring_frames];
+        // Behind by more than a whole frame and the next one is ready: skip ahead.
+        while (gs->head.load() - tail >= 2 && (int32_t)(now - gs->due_ms) >= 0) {
+            tail++;
+            gs->stats.frames_dropped++;
+            gs->due_ms += gs->slot_delay_ms[tail % gs->ring_frames];
+        }
+        show_frame(obj, gs, tail);
+        gs->tail.store(tail); // frees the previous slots for the worker
+    }
+
+    const int32_t wait = (int32_t)(gs->due_ms - lv_tick_get());
+    lv_timer_set_period(t, wait > 5 ? (uint32_t)wait : 5);
+}
+
+static void gif_delete_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target(e);
+    gif_stream_t *gs = (gif_stream_t *)lv_obj_get_user_data(obj);
+    if (!gs) {
+        return;
+    }
+    lv_timer_del(gs->timer);
+    gif_stream_stats_t st;
+    gif_stream_get_stats(obj, &st);
+    ESP_LOGI(TAG, "%s: %u shown, %u dropped, %u underruns, decode avg %u us max %u us, %u-frame ring", gs->lv_path,
+             (unsigned)st.frames_shown, (unsigned)st.frames_dropped, (unsigned)st.underruns,
+             (unsigned)st.decode_us_avg, (unsigned)st.decode_us_max, (unsigned)st.ring_frames);
+    lv_img_cache_invalidate_src(&gs->img);
+    gs->stop.store(true);
+    lv_obj_set_user_data(obj, NULL);
+    stream_unref(gs);
+}
+
+lv_obj_t *gif_stream_create(lv_obj_t *parent, const char *vfs_path)
+{
+    lv_obj_t *obj = lv_img_create(parent);
+#if LV_USE_GIF
+    gif_stream_t *gs = vfs_path ? new (std::nothrow) gif_stream_t() : nullptr;
+    if (!gs) {
+        return obj;
+    }
+    const char *rel = vfs_path;
+    if (strncmp(vfs_path, "/sdcard/", 8) == 0) rel = vfs_path + 8;
+    snprintf(gs->lv_path, sizeof(gs->lv_path), "S:/%s", rel);
+    gs->refs.store(2);
+
+    lv_obj_set_user_data(obj, gs);
+    gs->timer = lv_timer_create(gif_timer_cb, 10, obj);
+    lv_obj_add_event_cb(obj, gif_delete_cb, LV_EVENT_DELETE, NULL);
+
+    if (xTaskCreatePinnedToCore(gif_task, "gif_stream", GIF_STREAM_TASK_STACK_SIZE, gs, GIF_STREAM_TASK_PRIORITY, NULL,
+                                GIF_STREAM_TASK_CORE) != pdPASS) {
+        gs->refs.fetch_sub(1);
+        gs->state.store(GIF_STATE_FAILED);
+    }
+#else
+    (void)vfs_path;
+#endif
+    return obj;
+}
+
+void gif_stream_get_stats(lv_obj_t *obj, gif_stream_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    gif_stream_t *gs = obj ? (gif_stream_t *)lv_obj_get_user_data(obj) : nullptr;
+    if (!gs) {
+        return;
+    }
+    *out = gs->stats;
+    const uint32_t n = gs->decoded.load();
+    out->decode_us_avg = n ? gs->decode_us_total.load() / n : 0;
+    out->decode_us_max = gs->decode_us_max.load();
+    out->ring_frames = gs->ring_frames;
+}
@@ -0,0 +1,76 @@
+#include "id3_tag.h"
+
+#include <string.h>
+
+static uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint32_t syncsafe32(const uint8_t *p)
+{
+    return ((uint32_t)(p[0] & 0x7F) << 21) | ((uint32_t)(p[1] & 0x7F) << 14) | ((uint32_t)(p[2] & 0x7F) << 7) |
+           (p[3] & 0x7F);
+}
+
+bool id3_tag_open(FILE *f, id3_tag_t *tag)
+{
+    uint8_t hdr[10];
+    if (fseek(f, 0, SEEK_SET) != 0 || fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "ID3", 3) != 0) {
+        return false;
+    }
+    tag->version = hdr[3];
+    tag->flags = hdr[5];
+    tag->end = 10 + syncsafe32(hdr + 6);
+    tag->audio_start = tag->end + ((tag->version == 4 && (tag->flags & 0x10)) ? 10 : 0);
+    tag->pos = tag->end;
+    if (tag->version < 2 || tag->version > 4 || (tag->flags & 0x80)) {
+        return true; // unknown version or unsynchronised tag: skip it
+    }
+    uint32_t pos = 10;
+    if (tag->version > 2 && (tag->flags & 0x40)) {
+        uint8_t ext[4];
+        if (fread(ext, 1, 4, f) != 4) {
+            return true;
+        }
+        // v2.4 counts the size field itself, v2.3 does not.
+        const uint32_t ext_len = (tag->version == 4) ? syncsafe32(ext) : be32(ext);
+        if (tag->end < pos + 4 || ext_len > tag->end - pos - 4) {
+            return true;
+        }
+        pos += (tag->version == 4) ? ext_len : 4 + ext_len;
+    }
+    tag->pos = pos;
+    return true;
+}
+
+bool id3_tag_next(FILE *f, id3_tag_t *tag, id3_frame_t *frame)
+{
+    const uint32_t fh_len = tag->version == 2 ? 6 : 10;
+    if (tag->pos >= tag->end || tag->end - tag->pos < fh_len) {
+        return false;
+    }
+    uint8_t fh[10];
+    if (fseek(f, (long)tag->pos, SEEK_SET) != 0 || fread(fh, 1, fh_len, f) != fh_len || fh[0] == 0) {
+        tag->pos = tag->end; // padding or truncated
+        return false;
+    }
+    uint32_t size;
+    if (tag->version == 2) {
+        size = ((uint32_t)fh[3] << 16) | ((uint32_t)fh[4] << 8) | fh[5];
+        memcpy(frame->id, fh, 3);
+        frame->id[3] = '\0';
+    } else {
+        size = (tag->version == 4) ? syncsafe32(fh + 4) : be32(fh + 4);
+        memcpy(frame->id, fh, 4);
+        frame->id[4] = '\0';
+    }
+    if (size > tag->end - tag->pos - fh_len) {
+        tag->pos = tag->end; // runs past the tag; pos + size could wrap
+        return false;
+    }
+    frame->size = size;
+    frame->offset = tag->pos + fh_len;
+    tag->pos = frame->offset + size;
+    return true;
+}
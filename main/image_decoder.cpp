@@ -0,0 +1,398 @@
+#include "image_decoder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+
+#include "block_cache.h"
+#include "display_lvgl.h"
+#include "jpeg_backend.h"
+
+static const char *TAG = "img_dec";
+
+#define IMAGE_DECODER_TASK_STACK_SIZE (6 * 1024)
+#define IMAGE_DECODER_TASK_PRIORITY 2
+#define IMAGE_DECODER_TASK_CORE 0
+#define IMAGE_DECODER_QUEUE_LEN 8
+// Minimum spacing of PROGRESS events; each one costs a redraw of the visible part of the image.
+#define IMAGE_DECODER_PROGRESS_MS 100
+
+struct image_decode_job {
+    std::atomic<int> refs; // owner + worker + each pending async event
+    std::atomic<bool> cancelled;
+    image_decode_cb_t cb;
+    void *user_data;
+    lv_img_dsc_t img; // data is NULL until STARTED
+    char path[256];
+    uint32_t offset;
+    uint32_t length; // 0: to the end of the file
+    uint16_t max_w;
+    uint16_t max_h;
+    image_decode_mode_t mode;
+    esp_err_t err; // why the job failed; read after IMAGE_DECODE_FAILED
+
+    // Worker-side decode state.
+    block_cache_file_t *file;
+    uint32_t src_left; // JPEG bytes the backend may still read; reads stop at the end of length
+    bool read_failed;  // a read came up short before the end of the file
+    uint16_t scaled_w;
+    uint16_t scaled_h;
+    uint16_t crop_x;
+    uint16_t crop_y;
+    int64_t last_progress_us;
+};
+
+static RingbufHandle_t s_queue = nullptr;
+
+// Tried in order. The SIMD decoder is preferred; tjpgd streams what it cannot take.
+static const jpeg_backend_t *const s_backends[] = {
+#if JPEG_BACKEND_HAVE_ESP
+    &jpeg_backend_esp,
+#endif
+#if JPEG_BACKEND_HAVE_TJPGD
+    &jpeg_backend_tjpgd,
+#endif
+    nullptr,
+};
+
+static void job_unref(image_decode_job_t *job)
+{
+    if (job->refs.fetch_sub(1) != 1) {
+        return;
+    }
+    if (job->img.data) {
+        heap_caps_free((void *)job->img.data);
+    }
+    delete job;
+}
+
+// ---- Events (LVGL task) ----
+
+static void deliver(image_decode_job_t *job, image_decode_event_t event)
+{
+    if (!job->cancelled.load() && job->cb) {
+        job->cb(job, event, job->user_data);
+    }
+}
+
+static void on_started(void *p)
+{
+    image_decode_job_t *job = (image_decode_job_t *)p;
+    deliver(job, IMAGE_DECODE_STARTED);
+    job_unref(job);
+}
+
+static void on_progress(void *p)
+{
+    image_decode_job_t *job = (image_decode_job_t *)p;
+    deliver(job, IMAGE_DECODE_PROGRESS);
+    job_unref(job);
+}
+
+// The worker's own reference is dropped with the final event.
+static void on_done(void *p)
+{
+    image_decode_job_t *job = (image_decode_job_t *)p;
+    deliver(job, IMAGE_DECODE_DONE);
+    job_unref(job);
+}
+
+static void on_failed(void *p)
+{
+    image_decode_job_t *job = (image_decode_job_t *)p;
+    deliver(job, IMAGE_DECODE_FAILED);
+    job_unref(job);
+}
+
+static void post(image_decode_job_t *job, void (*cb)(void *), bool consume_ref)
+{
+    if (!consume_ref) {
+        job->refs.fetch_add(1);
+    }
+    if (display_lvgl_async_call(cb, job) != ESP_OK) {
+        job_unref(job);
+    }
+}
+
+// ---- Decoding (worker task) ----
+
+static size_t src_read(void *ctx, uint8_t *buf, size_t len)
+{
+    image_decode_job_t *job = (image_decode_job_t *)ctx;
+    if (job->cancelled.load()) {
+        return 0; // makes the backend bail out
+    }
+    // tjpgd fills its buffer in fixed-size reads; without the clamp a picture embedded in an MP3
+    // (or a truncated one) would be decoded on into whatever follows it.
+    if (len > job->src_left) {
+        len = job->src_left;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    if (!buf) {
+        if (!block_cache_seek(job->file, (int32_t)len, SEEK_CUR)) {
+            return 0;
+        }
+        job->src_left -= (uint32_t)len;
+        return len;
+    }
+    const uint32_t pos = block_cache_tell(job->file);
+    const size_t got = block_cache_read(job->file, buf, len);
+    if (got < len && pos + got < block_cache_size(job->file)) {
+        job->read_failed = true; // SD error rather than a truncated JPEG
+    }
+    job->src_left -= (uint32_t)got;
+    return got;
+}
+
+static bool on_block(const jpeg_block_t *blk, void *user_data)
+{
+    image_decode_job_t *job = (image_decode_job_t *)user_data;
+    if (job->cancelled.load()) {
+        return false;
+    }
+
+    const int out_w = job->img.header.w;
+    const int out_h = job->img.header.h;
+    const bool fit = job->mode == IMAGE_DECODE_FIT;
+    lv_color_t *dst = (lv_color_t *)job->img.data;
+    for (int by = 0; by < blk->h; by++) {
+        const int y = blk->y + by;
+        // FIT: nearest-neighbour subsampling of what the DCT scale left over.
+        const int oy = fit ? y * out_h / job->scaled_h : y - job->crop_y;
+        if (oy < 0 || oy >= out_h) {
+            continue;
+        }
+        const lv_color_t *row = blk->px + by * blk->w;
+        if (!fit) {
+            // CROP keeps 1:1 pixels: copy the visible span of the row.
+            const int x0 = blk->x < job->crop_x ? job->crop_x : blk->x;
+            const int x1 = blk->x + blk->w < job->crop_x + out_w ? blk->x + blk->w : job->crop_x + out_w;
+            if (x1 > x0) {
+                memcpy(&dst[oy * out_w + (x0 - job->crop_x)], row + (x0 - blk->x), (size_t)(x1 - x0) * sizeof(lv_color_t));
+            }
+            continue;
+        }
+        for (int bx = 0; bx < blk->w; bx++) {
+            const int ox = (blk->x + bx) * out_w / job->scaled_w;
+            if (ox < out_w) {
+                dst[oy * out_w + ox] = row[bx];
+            }
+        }
+    }
+
+    // End of a row of blocks: let the viewer redraw what is there so far.
+    if (blk->x + blk->w >= job->scaled_w) {
+        const int64_t now = esp_timer_get_time();
+        if (now - job->last_progress_us >= IMAGE_DECODER_PROGRESS_MS * 1000) {
+            job->last_progress_us = now;
+            post(job, on_progress, false);
+        }
+    }
+    return true;
+}
+
+static bool decode_jpeg(image_decode_job_t *job)
+{
+    const uint16_t max_w = job->max_w;
+    const uint16_t max_h = job->max_h;
+    const uint32_t file_size = block_cache_size(job->file);
+    jpeg_source_t src;
+    src.read = src_read;
+    src.ctx = job;
+    src.size = file_size > job->offset ? file_size - job->offset : 0;
+    if (job->length && job->length < src.size) {
+        src.size = job->length;
+    }
+
+    // First backend that accepts the stream wins; each one starts from the JPEG's first byte.
+    const jpeg_backend_t *be = nullptr;
+    void *dec = nullptr;
+    uint16_t jw = 0;
+    uint16_t jh = 0;
+    for (size_t i = 0; s_backends[i] && !dec; i++) {
+        if (job->cancelled.load() || !block_cache_seek(job->file, (int32_t)job->offset, SEEK_SET)) {
+            return false;
+        }
+        job->src_left = src.size;
+        be = s_backends[i];
+        dec = be->open(&src, &jw, &jh);
+    }
+    if (!dec) {
+        if (job->read_failed) {
+            ESP_LOGW(TAG, "%s: read error", job->path);
+            return false;
+        }
+        ESP_LOGW(TAG, "%s: not a baseline JPEG", job->path);
+        job->err = ESP_ERR_INVALID_RESPONSE;
+        return false;
+    }
+
+    // Smallest DCT scale that fits; whatever is still too large is cropped or subsampled.
+    uint8_t scale = 0;
+    uint16_t sw = 0;
+    uint16_t sh = 0;
+    be->scaled_size(dec, scale, &sw, &sh);
+    while (scale < 3 && (sw > max_w || sh > max_h)) {
+        scale++;
+        be->scaled_size(dec, scale, &sw, &sh);
+    }
+    uint16_t w = sw < max_w ? sw : max_w;
+    uint16_t h = sh < max_h ? sh : max_h;
+    if (job->mode == IMAGE_DECODE_FIT && (sw > max_w || sh > max_h)) {
+        if ((uint32_t)sw * max_h > (uint32_t)sh * max_w) {
+            h = (uint16_t)((uint32_t)sh * max_w / sw);
+        } else {
+            w = (uint16_t)((uint32_t)sw * max_h / sh);
+        }
+        w = w ? w : 1;
+        h = h ? h : 1;
+    }
+    const size_t bytes = (size_t)w * h * sizeof(lv_color_t);
+    void *buf = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf || w == 0 || h == 0) {
+        ESP_LOGW(TAG, "%s: no memory for %ux%u", job->path, (unsigned)w, (unsigned)h);
+        heap_caps_free(buf);
+        be->close(dec);
+        job->err = ESP_ERR_NO_MEM;
+        return false;
+    }
+    memset(buf, 0, bytes);
+
+    job->scaled_w = sw;
+    job->scaled_h = sh;
+    job->crop_x = (uint16_t)((sw - w) / 2);
+    job->crop_y = (uint16_t)((sh - h) / 2);
+    job->img.header.always_zero = 0;
+    job->img.header.cf = LV_IMG_CF_TRUE_COLOR;
+    job->img.header.w = w;
+    job->img.header.h = h;
+    job->img.data_size = (uint32_t)bytes;
+    job->img.data = (const uint8_t *)buf;
+    job->last_progress_us = esp_timer_get_time();
+    post(job, on_started, false);
+
+    const int64_t t0 = esp_timer_get_time();
+    const bool ok = be->decode(dec, scale, on_block, job);
+    be->close(dec);
+    if (!ok) {
+        if (!job->cancelled.load()) {
+            ESP_LOGW(TAG, "%s: decode failed (%s)%s", job->path, be->name, job->read_failed ? ", read error" : "");
+            if (!job->read_failed) {
+                job->err = ESP_ERR_INVALID_RESPONSE;
+            }
+        }
+        return false;
+    }
+    ESP_LOGI(TAG, "%s: %ux%u -> %ux%u (1/%u, %s) in %u ms", job->path, (unsigned)jw, (unsigned)jh, (unsigned)w,
+             (unsigned)h, 1U << scale, be->name, (unsigned)((esp_timer_get_time() - t0) / 1000));
+    return true;
+}
+
+static void decoder_task(void *arg)
+{
+    RingbufHandle_t queue = (RingbufHandle_t)arg;
+    while (true) {
+        size_t len = 0;
+        void *item = xRingbufferReceive(queue, &len, portMAX_DELAY);
+        if (!item) {
+            continue;
+        }
+        image_decode_job_t *job = nullptr;
+        memcpy(&job, item, sizeof(job));
+        vRingbufferReturnItem(queue, item);
+
+        bool ok = false;
+        if (!job->cancelled.load()) {
+            job->file = block_cache_open(job->path);
+            if (job->file) {
+                if (s_backends[0]) {
+                    ok = decode_jpeg(job);
+                } else {
+                    ESP_LOGW(TAG, "JPEG support is disabled in config");
+                }
+                block_cache_close(job->file);
+                job->file = nullptr;
+            } else {
+                ESP_LOGW(TAG, "Failed to open %s", job->path);
+                job->err = ESP_ERR_NOT_FOUND;
+            }
+        }
+        post(job, ok ? on_done : on_failed, true);
+    }
+}
+
+image_decode_job_t *image_decoder_submit(const image_decode_req_t *req)
+{
+    if (!req || !req->vfs_path || req->max_w == 0 || req->max_h == 0) {
+        return nullptr;
+    }
+    if (!s_queue) {
+        // NOSPLIT items carry an 8-byte header; each item is one job pointer.
+        RingbufHandle_t q = xRingbufferCreate(IMAGE_DECODER_QUEUE_LEN * (8 + sizeof(void *)), RINGBUF_TYPE_NOSPLIT);
+        if (!q) {
+            return nullptr;
+        }
+        if (xTaskCreatePinnedToCore(decoder_task, "img_decode", IMAGE_DECODER_TASK_STACK_SIZE, q,
+                                    IMAGE_DECODER_TASK_PRIORITY, NULL, IMAGE_DECODER_TASK_CORE) != pdPASS) {
+            vRingbufferDelete(q);
+            return nullptr;
+        }
+        s_queue = q;
+    }
+
+    image_decode_job_t *job = new (std::nothrow) image_decode_job_t();
+    if (!job) {
+        return nullptr;
+    }
+    job->refs.store(2); // owner + worker
+    job->cb = req->cb;
+    job->user_data = req->user_data;
+    job->offset = req->offset;
+    job->length = req->length;
+    job->max_w = req->max_w;
+    job->max_h = req->max_h;
+    job->mode = req->mode;
+    job->err = ESP_FAIL;
+    strncpy(job->path, req->vfs_path, sizeof(job->path) - 1);
+
+    if (xRingbufferSend(s_queue, &job, sizeof(job), 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Decode queue full");
+        delete job;
+        return nullptr;
+    }
+    return job;
+}
+
+const lv_img_dsc_t *image_decoder_image(const image_decode_job_t *job)
+{
+    return (job && job->img.data) ? &job->img : nullptr;
+}
+
+esp_err_t image_decoder_error(const image_decode_job_t *job)
+{
+    return job ? job->err : ESP_ERR_INVALID_ARG;
+}
+
+void image_decoder_release(image_decode_job_t *job)
+{
+    if (!job) {
+        return;
+    }
+    job->cancelled.store(true);
+    // LVGL's image cache keys entries by source pointer.
+    lv_img_cache_invalidate_src(&job->img);
+    job_unref(job);
+}
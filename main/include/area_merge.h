@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cost-model combiner for LVGL's invalidated areas, run from the display driver's render_start_cb.
+// Every area LVGL refreshes becomes at least one esp_lcd_panel_draw_bitmap() call, and each call
+// pays CASET/RASET/RAMWR setup plus a pipeline drain on the QSPI bus. Two areas are merged when
+// rendering and pushing their bounding box costs less than two separate transactions.
+//
+// Cost of an area = transactions * txn_cost_px + pixels, where transactions is the number of
+// draw-buffer bands LVGL splits the area into (a narrow area fits more rows per band).
+
+// Default per-transaction overhead in pixel-equivalents: ~100 us of command setup, bus drain and
+// LVGL per-area work, which is what 2048 RGB565 pixels take on the 80 MHz QSPI bus (4 bits per
+// clock, 40 MB/s).
+#define AREA_MERGE_TXN_COST_PX 2048
+
+typedef struct {
+    uint16_t areas_in;  // areas not joined on entry
+    uint16_t areas_out; // areas left after merging
+    uint32_t px_in;     // pixels covered on entry (what actually changed)
+    uint32_t px_out;    // pixels that will be rendered and pushed
+    uint16_t txns_in;   // estimated transactions before / after
+    uint16_t txns_out;
+} area_merge_result_t;
+
+// Merges areas[] in place. A merged-away area is marked in joined[] (LVGL's inv_area_joined);
+// the survivor is always the later index, so LVGL's "last area" bookkeeping stays valid.
+// buf_px: draw buffer size in pixels.
+void area_merge_run(lv_area_t *areas, uint8_t *joined, uint16_t count, uint32_t buf_px, uint32_t txn_cost_px,
+                    area_merge_result_t *out);
+
+#ifdef __cplusplus
+}
+#endif
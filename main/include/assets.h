@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Images built into the firmware. tools/img_conv.py converts the source PNGs at build time (see
+// main/CMakeLists.txt) into asset_<name>.h headers holding a constexpr asset_img_t whose pixels are
+// already lv_color_t (+ alpha), in the configured LV_COLOR_16_SWAP byte order. Raw assets are used
+// straight from flash; nothing is decoded or converted at runtime.
+//
+// RLE assets trade flash for a one-time unpack: a control byte n < 0x80 repeats the next pixel n + 1
+// times, n >= 0x80 is followed by (n & 0x7F) + 1 literal pixels.
+
+typedef struct {
+    lv_img_dsc_t dsc;  // data_size/data hold the packed stream when rle is set
+    uint32_t raw_size; // unpacked pixel bytes
+    bool rle;
+} asset_img_t;
+
+// Image to hand to lv_img_set_src(). RLE assets are unpacked into PSRAM on first use and kept.
+// Returns NULL if that allocation fails. Must be called with the LVGL lock held.
+const lv_img_dsc_t *asset_img(const asset_img_t *asset);
+
+#ifdef __cplusplus
+}
+#endif
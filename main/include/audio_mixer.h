@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pcm_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-point mixer for interleaved stereo S16 PCM at the output rate.
+//
+// Sources are one stream (a pcm_ring filled by a decoder) and up to AUDIO_MIXER_VOICES one-shot
+// sounds. Each source is scaled by its own Q15 gain and summed in 32 bits; the sum is saturated to
+// S16 once per sample, and saturated samples are counted.
+//
+// audio_mixer_play() and audio_mixer_stop() may be called from any task and never block: a voice
+// slot is claimed with one compare-and-swap and the next audio_mixer_mix() starts it. Only one task
+// (the audio engine) calls audio_mixer_mix(), audio_mixer_set_stream() and audio_mixer_get_stats(),
+// or the caller serializes them.
+
+#define AUDIO_MIXER_VOICES 8
+#define AUDIO_MIXER_MAX_BLOCK 256 // frames per audio_mixer_mix() call
+#define AUDIO_MIXER_UNITY 32768   // Q15 gain of 1.0
+
+typedef struct audio_mixer audio_mixer_t;
+
+// A sound at the output rate, mono or interleaved stereo. The samples must stay valid while the
+// sound plays; the mixer does not copy them.
+typedef struct {
+    const int16_t *pcm;
+    uint32_t frames;
+    uint8_t channels; // 1 or 2
+} audio_mixer_sound_t;
+
+// Identifies one play() call; stale handles are ignored.
+typedef int32_t audio_mixer_voice_t;
+#define AUDIO_MIXER_NO_VOICE (-1)
+
+typedef struct {
+    uint32_t blocks;          // mix calls that produced output
+    uint64_t frames;
+    uint64_t mix_us;          // time spent in those calls
+    uint32_t mix_us_max;
+    uint32_t started;         // sounds that reached the output
+    uint32_t dropped;         // play() calls that found every voice busy
+    uint64_t latency_us_sum;  // play() to the first mixed frame, over `started`
+    uint32_t latency_us_max;
+    uint32_t clipped;         // output samples saturated
+} audio_mixer_stats_t;
+
+audio_mixer_t *audio_mixer_create(void);
+void audio_mixer_destroy(audio_mixer_t *m);
+
+// Starts `sound` on a free voice. Returns AUDIO_MIXER_NO_VOICE when all voices are busy.
+audio_mixer_voice_t audio_mixer_play(audio_mixer_t *m, const audio_mixer_sound_t *sound, uint32_t gain_q15);
+// Silences a voice from the next block on. No-op if it already finished.
+void audio_mixer_stop(audio_mixer_t *m, audio_mixer_voice_t voice);
+
+// Mixes `ring` (NULL to detach) as the stream source. The first frames are taken once a whole block
+// is buffered or the ring is closed, so a starting stream does not begin with a partial block.
+void audio_mixer_set_stream(audio_mixer_t *m, pcm_ring_t *ring, uint32_t gain_q15);
+
+// Mixes up to AUDIO_MIXER_MAX_BLOCK frames into `out`. Returns false, leaving `out` untouched, when
+// no voice is playing and the stream has nothing to give.
+bool audio_mixer_mix(audio_mixer_t *m, int16_t *out, uint32_t frames);
+
+void audio_mixer_get_stats(const audio_mixer_t *m, audio_mixer_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-point polyphase sample-rate converter for interleaved stereo S16 PCM.
+//
+// The ratio is exact: for in_rate/out_rate = M/L in lowest terms, output frame n is the dot product
+// of the last AUDIO_RESAMPLER_TAPS input frames with phase (n * M) % L of a Kaiser-windowed sinc
+// (Q15, cutoff at 45% of the input rate, ~80 dB stopband), so no rounding error accumulates
+// between the two clocks. Equal rates are copied as is. Only upsampling is supported, which covers
+// every MP3 rate into a 48 kHz output.
+//
+// The phase table (L * AUDIO_RESAMPLER_TAPS coefficients, 10 KB for 44.1 -> 48 kHz) is built when
+// the converter is created. State carries over between calls, so a stream may be fed in pieces of
+// any size.
+
+#define AUDIO_RESAMPLER_TAPS 32
+#define AUDIO_RESAMPLER_MAX_PHASES 1024
+// Largest out/in ratio supported: 8 kHz MP3 into 48 kHz.
+#define AUDIO_RESAMPLER_MAX_RATIO 6
+// Output frames one call with n input frames can produce at any supported ratio, for static buffers.
+#define AUDIO_RESAMPLER_MAX_OUT(n) (((n) + 1) * AUDIO_RESAMPLER_MAX_RATIO + 1)
+
+typedef struct audio_resampler audio_resampler_t;
+
+// NULL when the ratio is unsupported: downsampling, more than AUDIO_RESAMPLER_MAX_RATIO, or more
+// than AUDIO_RESAMPLER_MAX_PHASES phases.
+audio_resampler_t *audio_resampler_create(uint32_t in_rate, uint32_t out_rate);
+void audio_resampler_destroy(audio_resampler_t *r);
+uint32_t audio_resampler_in_rate(const audio_resampler_t *r);
+// Forgets the input history, e.g. before an unrelated sound.
+void audio_resampler_reset(audio_resampler_t *r);
+
+// Most frames one call with in_frames input frames can produce.
+uint32_t audio_resampler_max_out(const audio_resampler_t *r, uint32_t in_frames);
+// Converts in_frames frames into out, which must hold audio_resampler_max_out(in_frames) frames.
+// Returns the frames written. Output lags input by AUDIO_RESAMPLER_TAPS / 2 input frames.
+uint32_t audio_resampler_process(audio_resampler_t *r, const int16_t *in, uint32_t in_frames, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
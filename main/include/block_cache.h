@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read-only block cache for files on slow media (SD card behind the LVGL S: driver).
+// No ESP-IDF dependencies apart from the PSRAM allocation: the same file builds for host benchmarks.
+//
+// - The file is read in aligned, block-sized chunks. Small and seek-heavy reads (SJPG, PNG headers)
+//   are served from RAM.
+// - Sequential access is detected per handle, and the next blocks are fetched in one run,
+//   doubling the window up to max_readahead_blocks.
+// - One pool of blocks is shared by all open handles and evicted least-recently-used first. Blocks
+//   are keyed by path, size and mtime, so they stay valid across close/open of an unchanged file.
+// - Reads of whole blocks that miss the cache go straight into the caller's buffer.
+// All functions are thread-safe. Backend reads run outside the pool lock: a block being filled is
+// marked loading, readers of that block wait for it and eviction skips it, while hits on other
+// blocks go ahead. A handle must not be used by two tasks at once.
+
+// Storage backend. The default uses stdio (fopen/fseek/fread, unbuffered).
+typedef struct {
+    void *(*open)(const char *path, uint32_t *size, uint32_t *mtime);
+    size_t (*read_at)(void *handle, uint32_t offset, void *buf, size_t len);
+    void (*close)(void *handle);
+} block_cache_io_t;
+
+typedef struct {
+    size_t block_size;             // bytes, power of two
+    size_t block_count;            // 0 = pass-through (no pool)
+    size_t max_readahead_blocks;   // 1 disables read-ahead
+    const block_cache_io_t *io;    // NULL = stdio
+} block_cache_config_t;
+
+// 32 KB blocks (a typical SD cluster) x 16 = 512 KB pool, read-ahead up to 128 KB.
+#define BLOCK_CACHE_DEFAULT_CONFIG() {32 * 1024, 16, 4, NULL}
+
+// Allocates the pool (PSRAM on the target). If that fails, the cache runs in pass-through mode
+// and returns false. Call once before the first open.
+bool block_cache_init(const block_cache_config_t *config);
+
+typedef struct block_cache_file block_cache_file_t;
+
+block_cache_file_t *block_cache_open(const char *path);
+void block_cache_close(block_cache_file_t *f);
+// Returns the number of bytes read. Fewer than len means end of file or a read error.
+size_t block_cache_read(block_cache_file_t *f, void *buf, size_t len);
+// whence: SEEK_SET / SEEK_CUR / SEEK_END. Seeking only moves the position, it does no IO.
+bool block_cache_seek(block_cache_file_t *f, int32_t offset, int whence);
+uint32_t block_cache_tell(const block_cache_file_t *f);
+uint32_t block_cache_size(const block_cache_file_t *f);
+
+// Drops every cached block, e.g. after the card was remounted.
+void block_cache_invalidate(void);
+
+typedef struct {
+    uint64_t bytes_requested; // returned to callers
+    uint64_t bytes_fetched;   // read from the backend (blocks, read-ahead and bypass)
+    uint32_t hits;            // block lookups served from the pool
+    uint32_t misses;          // block lookups that went to the backend
+    uint32_t readahead_blocks; // blocks fetched ahead of a sequential reader
+    uint32_t readahead_used;  // of those, blocks later hit
+    uint32_t bypass_reads;    // whole-block reads copied straight into the caller's buffer
+    uint32_t backend_reads;   // read_at() calls
+    uint32_t evictions;
+} block_cache_stats_t;
+
+void block_cache_get_stats(block_cache_stats_t *out);
+void block_cache_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
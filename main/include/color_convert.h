@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pixel format conversion for the display flush path.
+// No ESP-IDF dependencies: the same file builds for the target and for host benchmarks.
+//
+// Source pixels are LVGL 32-bit colours (lv_color32_t: B, G, R, A in memory order).
+// dst == src (in-place) is allowed; the output is never larger than the input.
+
+// XRGB8888 -> packed RGB888 (R, G, B bytes), as the SH8601 expects in 24-bit mode.
+void color_convert_xrgb8888_to_rgb888(uint8_t *dst, const uint32_t *src, size_t px);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "esp_err.h"
 
@@ -10,13 +11,40 @@ extern "C" {
 
 esp_err_t display_lvgl_init(void);
 
+// Recursive: safe to call from LVGL callbacks. Unlocking from another task wakes the LVGL task.
 bool display_lvgl_lock(int timeout_ms);
 void display_lvgl_unlock(void);
 
+// Wake the LVGL task so it runs lv_timer_handler() now instead of at its next timer deadline.
+void display_lvgl_wake(void);
+
+// lv_async_call() from any task: takes the LVGL lock, queues cb and wakes the LVGL task.
+esp_err_t display_lvgl_async_call(void (*cb)(void *), void *user_data);
+
 void display_lvgl_set_on(bool on);
 void display_lvgl_set_brightness(uint8_t brightness_percent);
 uint8_t display_lvgl_get_brightness(void);
 
+// Flush pipeline statistics, updated once per refreshed frame (LVGL monitor_cb).
+// render_us: CPU time LVGL spent rendering (frame time minus time blocked on a free stripe).
+// transfer_us: time at least one stripe was on the QSPI bus during the frame.
+// overlap_us: transfer time that ran while LVGL was rendering instead of waiting.
+typedef struct {
+    uint32_t frames;
+    uint32_t last_render_us;
+    uint32_t last_transfer_us;
+    uint32_t last_overlap_us;
+    uint32_t last_wait_us;
+    uint32_t last_px;
+    uint32_t avg_render_us;
+    uint32_t avg_transfer_us;
+    uint32_t avg_overlap_us;
+    uint16_t stripe_lines;
+    uint8_t pool_size;
+} display_lvgl_flush_stats_t;
+
+void display_lvgl_get_flush_stats(display_lvgl_flush_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
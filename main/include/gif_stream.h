@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming GIF player. A worker task on core 0 reads the file through the S: driver (and its
+// block cache) with LVGL's gifdec, decoding frames ahead into a small ring of PSRAM buffers. An
+// LVGL timer shows each frame when its GIF delay has elapsed, skipping frames when it falls behind.
+// Memory is bounded by the ring (2-3 frames), not the file size.
+//
+// The returned lv_img gets LV_EVENT_READY when the first frame is shown and LV_EVENT_CANCEL if
+// the file cannot be played. Deleting it stops the worker.
+
+typedef struct {
+    uint32_t frames_shown;
+    uint32_t frames_dropped; // decoded but skipped to catch up with the timeline
+    uint32_t underruns;      // a frame was due but the decoder had not produced it yet
+    uint32_t decode_us_avg;
+    uint32_t decode_us_max;
+    uint8_t ring_frames;
+} gif_stream_stats_t;
+
+// vfs_path like "/sdcard/a.gif". Must be called with the LVGL lock held.
+lv_obj_t *gif_stream_create(lv_obj_t *parent, const char *vfs_path);
+
+void gif_stream_get_stats(lv_obj_t *obj, gif_stream_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ID3v2 tag reader shared by the media index (text frames) and the thumbnail cache (APIC).
+// It walks frame headers only; callers read the bodies they want. Every frame is bounded by the
+// tag: one that claims to run past it ends the walk, so a corrupt size cannot wrap the position.
+
+typedef struct {
+    uint8_t version;      // 2, 3 or 4
+    uint8_t flags;        // header flags byte
+    uint32_t end;         // first byte after the tag body
+    uint32_t audio_start; // end plus the v2.4 footer, if any
+    uint32_t pos;         // next frame header; end when there is nothing (more) to walk
+} id3_tag_t;
+
+typedef struct {
+    char id[5];      // "TIT2", or "TT2" in v2.2
+    uint32_t size;   // body bytes, within the tag
+    uint32_t offset; // file offset of the body
+} id3_frame_t;
+
+// Reads the tag header at the start of f. false if the file has no ID3v2 tag. Tags with an
+// unknown version or whole-tag unsynchronisation are reported (audio_start is valid) but have
+// no frames to walk.
+bool id3_tag_open(FILE *f, id3_tag_t *tag);
+// Next frame header; f is left at the frame body. false at padding, the end of the tag, a short
+// read or a frame that overruns the tag.
+bool id3_tag_next(FILE *f, id3_tag_t *tag, id3_frame_t *frame);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Background JPEG decoder. Jobs run one at a time on a worker task on core 0 and decode into a
+// PSRAM lv_color_t buffer, scaled down by 1/2, 1/4 or 1/8 to fit max_w x max_h. What is still too
+// large is center-cropped (IMAGE_DECODE_CROP) or subsampled (IMAGE_DECODE_FIT). Events are delivered
+// on the LVGL task through display_lvgl_async_call().
+//
+// IMAGE_DECODE_STARTED comes as soon as the header is parsed. The image is then valid, blank, and
+// fills in top to bottom; IMAGE_DECODE_PROGRESS asks the owner to invalidate it. No events are
+// delivered after image_decoder_release().
+
+typedef struct image_decode_job image_decode_job_t;
+
+typedef enum {
+    IMAGE_DECODE_STARTED = 0,
+    IMAGE_DECODE_PROGRESS,
+    IMAGE_DECODE_DONE,
+    IMAGE_DECODE_FAILED,
+} image_decode_event_t;
+
+typedef enum {
+    IMAGE_DECODE_CROP = 0, // viewer: keep full detail, center-crop to max_w x max_h
+    IMAGE_DECODE_FIT,      // thumbnails: whole picture, aspect kept, within max_w x max_h
+} image_decode_mode_t;
+
+typedef void (*image_decode_cb_t)(image_decode_job_t *job, image_decode_event_t event, void *user_data);
+
+typedef struct {
+    const char *vfs_path; // e.g. "/sdcard/a.jpg"
+    uint32_t offset;      // start of the JPEG data in the file (embedded cover art), normally 0
+    uint32_t length;      // bytes of JPEG data from offset; 0 for the rest of the file
+    uint16_t max_w;
+    uint16_t max_h;
+    image_decode_mode_t mode;
+    image_decode_cb_t cb;
+    void *user_data;
+} image_decode_req_t;
+
+// Queues a decode. Must be called with the LVGL lock held.
+image_decode_job_t *image_decoder_submit(const image_decode_req_t *req);
+
+// Decoded image; valid from IMAGE_DECODE_STARTED until image_decoder_release().
+const lv_img_dsc_t *image_decoder_image(const image_decode_job_t *job);
+
+// Why a job ended with IMAGE_DECODE_FAILED. ESP_ERR_INVALID_RESPONSE means the data is not a JPEG
+// any backend decodes and will fail again; ESP_ERR_NO_MEM, ESP_ERR_NOT_FOUND (open failed) and
+// ESP_FAIL (read error) may not.
+esp_err_t image_decoder_error(const image_decode_job_t *job);
+
+// Cancels the job if it is still queued or decoding and drops the owner's reference. The buffer is
+// freed once the worker lets go of it, so the caller must stop showing the image first (normally
+// called from the image object's LV_EVENT_DELETE). Must be called with the LVGL lock held.
+void image_decoder_release(image_decode_job_t *job);
+
+#ifdef __cplusplus
+}
+#endif
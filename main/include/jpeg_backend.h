@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// JPEG decoder backends used by image_decoder. A backend parses the header from a pull-style
+// source, then decodes at a DCT scale of 1/1, 1/2, 1/4 or 1/8 and hands out lv_color_t blocks in
+// scaled-image coordinates, top to bottom.
+//
+// - jpeg_backend_esp: Espressif's esp_new_jpeg, which uses the ESP32-S3 SIMD instructions for the
+//   IDCT and colour conversion. Needs the whole file in PSRAM, so large files are left to tjpgd.
+//   Built when the esp_new_jpeg component is present.
+// - jpeg_backend_tjpgd: LVGL's bundled tjpgd (LV_USE_SJPG). Streams from the source in 4 KB.
+
+#if defined(__has_include)
+#if __has_include("esp_jpeg_dec.h") && LV_COLOR_DEPTH == 16
+#define JPEG_BACKEND_HAVE_ESP 1
+#endif
+#endif
+#ifndef JPEG_BACKEND_HAVE_ESP
+#define JPEG_BACKEND_HAVE_ESP 0
+#endif
+#define JPEG_BACKEND_HAVE_TJPGD LV_USE_SJPG
+
+typedef struct {
+    // Reads up to len bytes, or skips len bytes when buf is NULL. Returns the count; 0 ends the stream.
+    size_t (*read)(void *ctx, uint8_t *buf, size_t len);
+    void *ctx;
+    uint32_t size; // bytes of JPEG data from the current position
+} jpeg_source_t;
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+    const lv_color_t *px; // w * h, rows packed
+} jpeg_block_t;
+
+// Returns false to abort the decode.
+typedef bool (*jpeg_block_cb_t)(const jpeg_block_t *blk, void *user_data);
+
+typedef struct {
+    const char *name;
+    // Parses the header. Returns NULL if this backend cannot decode the stream.
+    void *(*open)(const jpeg_source_t *src, uint16_t *width, uint16_t *height);
+    // Output size at 1 / (1 << scale). A backend may round it down to what it supports.
+    void (*scaled_size)(void *dec, uint8_t scale, uint16_t *width, uint16_t *height);
+    bool (*decode)(void *dec, uint8_t scale, jpeg_block_cb_t cb, void *user_data);
+    void (*close)(void *dec);
+} jpeg_backend_t;
+
+#if JPEG_BACKEND_HAVE_ESP
+extern const jpeg_backend_t jpeg_backend_esp;
+#endif
+// jpeg_backend_esp's scaled_size(): esp_new_jpeg scales to multiples of 8 pixels and falls back to a
+// smaller reduction for tiny images. Built without the component too, for the host bench.
+void jpeg_backend_esp_scaled_size(uint16_t width, uint16_t height, uint8_t scale, uint16_t *out_w, uint16_t *out_h);
+#if JPEG_BACKEND_HAVE_TJPGD
+extern const jpeg_backend_t jpeg_backend_tjpgd;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
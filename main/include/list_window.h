@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Virtual scroll window for lists longer than LVGL's coordinate range. lv_coord_t is 16 bits and
+// LV_COORD_MAX is 8191 px, so a list that scrolled over all of its entries would stop at about
+// 146 rows of 56 px. Instead the scrollable content spans at most `rows` rows, starting at entry
+// `base`. When the view comes within a quarter window of either edge, the base moves and the
+// scroll position moves by the same distance, so the entries on screen stay where they are.
+//
+// Scroll positions are relative to the window; absolute positions (base * row_h + scroll) are
+// only computed in 64 bits inside the helpers.
+
+typedef struct {
+    uint32_t count; // entries in the list
+    uint32_t base;  // entry at content y = 0
+    uint16_t rows;  // window size in rows
+    uint16_t row_h; // px
+} list_window_t;
+
+void list_window_init(list_window_t *w, uint16_t rows, uint16_t row_h);
+// Rows the scroll content spans: min(count, rows), at least 1.
+uint32_t list_window_span(const list_window_t *w);
+// Entry at content y (negative y, an overscroll, maps to the base). May be >= count.
+uint32_t list_window_index(const list_window_t *w, int32_t y);
+// Content y of entry i; only meaningful for base <= i < base + rows.
+int32_t list_window_y(const list_window_t *w, uint32_t i);
+// Updates the entry count and re-anchors the window. `shift`: the entry at the top of the view
+// moved down by that many places (entries were inserted above it). scroll_y is the current
+// position, view_h the viewport height. Returns the scroll position that keeps the same entries
+// in view; the caller scrolls there after resizing the content to list_window_span() rows.
+int32_t list_window_update(list_window_t *w, uint32_t count, uint32_t shift, int32_t scroll_y, int32_t view_h);
+// Puts entry `index` at the top of the view and returns the scroll position for it.
+int32_t list_window_show(list_window_t *w, uint32_t index, int32_t view_h);
+
+#ifdef __cplusplus
+}
+#endif
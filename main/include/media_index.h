@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Media library index of the SD card.
+//
+// After mount, a worker task on core 0 walks /sdcard recursively and records every JPEG/PNG, GIF and
+// MP3 with its size and mtime, image dimensions, ID3 title/artist/album and MP3 duration. The result
+// is saved to /sdcard/.index/media.idx: fixed-size records, interned strings and one precomputed
+// order per media_sort_t, so a query is a single pass. The next scan stat()s every file and only
+// re-reads files whose size or mtime changed.
+// The saved index is published as soon as it is loaded, so browsers list instantly while the scan
+// runs. Queries and subscriptions must be made on the LVGL task.
+
+typedef enum {
+    MEDIA_KIND_IMAGE = 1 << 0, // JPEG, PNG
+    MEDIA_KIND_GIF = 1 << 1,
+    MEDIA_KIND_AUDIO = 1 << 2, // MP3
+} media_kind_t;
+
+typedef enum {
+    MEDIA_SORT_PATH = 0, // folder, then file name (natural order)
+    MEDIA_SORT_DATE,     // newest first
+    MEDIA_SORT_TITLE,    // ID3 title, else file name
+    MEDIA_SORT_ARTIST,   // artist, album, path; untagged files last
+    MEDIA_SORT_COUNT,
+} media_sort_t;
+
+typedef struct {
+    const char *path;   // relative to /sdcard, e.g. "Music/Album/01 Intro.mp3"
+    const char *title;  // "" when unknown
+    const char *artist; // "" when unknown
+    const char *album;  // "" when unknown
+    uint32_t size;
+    uint32_t mtime;
+    uint32_t duration_ms; // MP3; 0 when unknown
+    uint16_t width;       // images and GIFs; 0 when unknown
+    uint16_t height;
+    uint8_t kind; // media_kind_t
+} media_index_entry_t;
+
+// Return false to stop the query. The entry is only valid during the call.
+typedef bool (*media_index_visit_t)(const media_index_entry_t *entry, void *user_data);
+typedef void (*media_index_cb_t)(void *user_data);
+
+// Starts the scan; called when the SD card is mounted. The card may be a different one, so the
+// index in use is withdrawn (subscribers are notified and media_index_ready() turns false) before
+// the card's saved index is loaded. Calling it during a scan drops that scan and queues another.
+void media_index_start(void);
+
+// True once an index (saved or freshly scanned) of the mounted card is loaded.
+bool media_index_ready(void);
+
+// Visits entries whose kind is in `kinds`, in `sort` order. Returns the number visited.
+uint32_t media_index_query(uint8_t kinds, media_sort_t sort, media_index_visit_t visit, void *user_data);
+
+// cb runs on the LVGL task each time a new index is published.
+bool media_index_subscribe(media_index_cb_t cb, void *user_data);
+void media_index_unsubscribe(media_index_cb_t cb, void *user_data);
+
+// Case-insensitive compare with digit runs compared by value: "Track 2" sorts before "Track 10".
+int media_index_name_cmp(const char *a, const char *b);
+
+#ifdef __cplusplus
+}
+#endif
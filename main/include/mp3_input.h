@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming input for the MP3 decoder.
+//
+// The file is read through block_cache in whole, aligned blocks, which the cache copies straight
+// into a ring of MP3_INPUT_SLOTS block-sized slots (no pool copy). A block is fetched as soon as a
+// whole slot has been consumed. Behind the ring sits a mirror of its first MP3_INPUT_MIRROR
+// bytes, refreshed whenever slot 0 is refilled, so a frame that crosses the wrap is still one
+// contiguous view. Consuming a frame only moves the read offset; nothing is shifted.
+//
+// A leading ID3v2 tag (often hundreds of KB of cover art) is skipped by seeking past it, and data
+// the decoder finds no frame in is dropped in bulk.
+// Not thread-safe: one decoder task owns a handle.
+
+#define MP3_INPUT_SLOTS 2
+// Larger than any MPEG audio frame plus the next header, which minimp3 checks before decoding.
+#define MP3_INPUT_MIRROR (4 * 1024)
+
+typedef struct mp3_input mp3_input_t;
+
+typedef struct {
+    uint64_t bytes_consumed;  // handed to the decoder and consumed
+    uint64_t bytes_copied;    // mirror upkeep; the only copying the ring does
+    uint64_t bytes_skipped;   // ID3v2 tag and garbage dropped without decoding
+    uint32_t refills;         // block reads
+    uint64_t refill_bytes;
+    uint64_t refill_us;       // time spent in block reads
+    uint32_t refill_us_max;
+    uint32_t stalls;          // reads made because the view ran short of a whole frame
+} mp3_input_stats_t;
+
+// Allocates the ring (PSRAM when available) and reads the first block. NULL on error.
+mp3_input_t *mp3_input_open(const char *path);
+void mp3_input_close(mp3_input_t *in);
+
+// Returns the unread bytes as one contiguous view. Unless the file ends first, the view holds at
+// least MP3_INPUT_MIRROR bytes. *len is 0 at end of file.
+const uint8_t *mp3_input_peek(mp3_input_t *in, size_t *len);
+// Marks n bytes of the last view as used.
+void mp3_input_consume(mp3_input_t *in, size_t n);
+// The decoder found no frame in a view of len bytes: drops all of it except the tail, where the
+// start of a frame cut off by the end of the view may sit. At end of file everything is dropped.
+void mp3_input_skip_garbage(mp3_input_t *in, size_t len);
+
+void mp3_input_get_stats(const mp3_input_t *in, mp3_input_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lock-free single-producer / single-consumer ring of interleaved stereo S16 PCM frames.
+//
+// The producer (a decoder) copies frames in with pcm_ring_write(); the consumer (the I2S output
+// task) takes contiguous runs with pcm_ring_peek() and returns them with pcm_ring_release() once
+// they have been written out, so an empty ring means everything has reached the sink. Neither
+// side blocks: a full or empty ring returns 0 and the caller decides how long to wait.
+//
+// Underruns count the times the consumer found the ring empty after playback started and before
+// the producer closed it. Producer waits count the times the producer found it full; that is normal
+// backpressure from a producer faster than real time and loses nothing. Each episode is counted
+// once however often the caller polls. The fill level is sampled at every release.
+
+#define PCM_RING_FILL_BUCKETS 8
+
+typedef struct pcm_ring pcm_ring_t;
+
+typedef struct {
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint32_t underruns;
+    uint32_t producer_waits;
+    uint32_t min_fill;                          // frames, lowest level seen at a release
+    uint32_t fill_hist[PCM_RING_FILL_BUCKETS]; // releases by fill level, bucket i: i/8..(i+1)/8 full
+} pcm_ring_stats_t;
+
+// Allocates room for `frames` stereo frames (PSRAM when available). NULL on error.
+pcm_ring_t *pcm_ring_create(uint32_t frames);
+void pcm_ring_destroy(pcm_ring_t *r);
+uint32_t pcm_ring_capacity(const pcm_ring_t *r);
+// Frames waiting to be read; either side may ask.
+uint32_t pcm_ring_fill(const pcm_ring_t *r);
+
+// Producer side. Copies up to `frames` frames and returns how many fit.
+uint32_t pcm_ring_write(pcm_ring_t *r, const int16_t *pcm, uint32_t frames);
+// No more frames will be written; the consumer drains what is left.
+void pcm_ring_close(pcm_ring_t *r);
+bool pcm_ring_is_closed(const pcm_ring_t *r);
+// Empties and reopens the ring for a new stream. Only while no consumer is running.
+void pcm_ring_reset(pcm_ring_t *r);
+
+// Consumer side. Returns the oldest unread frames as one contiguous run; *frames is 0 when the
+// ring is empty.
+const int16_t *pcm_ring_peek(pcm_ring_t *r, uint32_t *frames);
+// Marks `frames` frames of the last run as played.
+void pcm_ring_release(pcm_ring_t *r, uint32_t frames);
+
+void pcm_ring_get_stats(const pcm_ring_t *r, pcm_ring_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
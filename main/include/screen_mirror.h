@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Live copy of the panel for a remote viewer.
+//
+// The display flush callbacks pass every flushed area to screen_mirror_tap(), which copies it into
+// a PSRAM shadow frame and records it as dirty; it never waits on the network. A sender task on
+// core 0 wakes at most SCREEN_MIRROR_MAX_FPS times a second, and while its byte budget allows,
+// encodes the dirty rectangles from the shadow frame and hands each one to the sink as a message.
+// Rectangles it cannot afford stay dirty and are merged with later ones, so a slow link lowers the
+// mirror's frame rate, never the panel's. An area flushed while it is being encoded is sent again.
+//
+// Messages (little-endian):
+//   hello: 'H', version, u16 width, u16 height
+//   rect:  'R', codec, u16 x, u16 y, u16 w, u16 h, payload
+//   frame: 'F' after the rectangles of one sender pass
+// Payload pixels are RGB565 in row order. SCREEN_MIRROR_CODEC_RAW sends them as is;
+// SCREEN_MIRROR_CODEC_RLE sends control bytes n < 0x80 (next pixel repeated n + 1 times) and
+// n >= 0x80 ((n & 0x7F) + 1 literal pixels follow), the same scheme as RLE image assets.
+// Only 16-bit LVGL color is supported.
+
+#define SCREEN_MIRROR_VERSION 1
+#define SCREEN_MIRROR_CODEC_RAW 0
+#define SCREEN_MIRROR_CODEC_RLE 1
+
+// Sends one message; returning false ends the session. Called on the sender task.
+typedef bool (*screen_mirror_sink_t)(const uint8_t *data, size_t len, void *ctx);
+
+typedef struct {
+    screen_mirror_sink_t sink;
+    void *ctx;
+    void (*on_stop)(void *ctx); // optional; runs on the sender task once the session has ended,
+                                // before screen_mirror_start() can succeed again
+    uint32_t max_bytes_per_s;   // 0: SCREEN_MIRROR_DEFAULT_BPS
+} screen_mirror_config_t;
+
+typedef struct {
+    uint32_t messages;
+    uint64_t bytes;
+    uint64_t raw_bytes;     // the same rectangles as plain RGB565
+    uint32_t frames;        // sender passes that sent something
+    uint32_t throttled;     // sender passes cut short by the byte budget
+    uint32_t resent_px;     // pixels flushed again while being encoded
+} screen_mirror_stats_t;
+
+// Starts a session and makes LVGL redraw the whole screen so the first frame is complete.
+// Fails with ESP_ERR_INVALID_STATE while a session is running or still shutting down.
+esp_err_t screen_mirror_start(const screen_mirror_config_t *cfg);
+// Ends the session; the sender task exits and frees the shadow frame on its next pass.
+void screen_mirror_stop(void);
+bool screen_mirror_active(void);
+// Resends the whole screen, e.g. for a viewer that just joined.
+void screen_mirror_refresh(void);
+
+// Flush tap; safe from any task, a no-op without a session.
+void screen_mirror_tap(const lv_area_t *area, const lv_color_t *color_map);
+
+void screen_mirror_get_stats(screen_mirror_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
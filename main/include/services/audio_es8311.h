@@ -9,6 +9,12 @@
 extern "C" {
 #endif
 
+// I2S and the codec always run at this rate. Streams at other rates go through audio_resampler and
+// UI sounds are rendered at it, so changing rate never reclocks the hardware.
+#define AUDIO_ES8311_HW_RATE_HZ 48000
+
+// Also starts the audio engine task, which owns I2S output and mixes the stream with UI sounds
+// (audio_mixer).
 esp_err_t audio_es8311_init(void);
 
 // Global enable/disable (power saving). When disabled, codec + I2S are stopped.
@@ -29,15 +35,22 @@ int audio_es8311_get_mic_gain(void);
 int audio_es8311_get_mic_level(void);
 
 // Read raw microphone PCM samples from the codec RX path.
-// Format: 16-bit signed interleaved stereo at the current hardware sample rate (default 16000).
+// Format: 16-bit signed interleaved stereo at AUDIO_ES8311_HW_RATE_HZ.
 // Returns ESP_OK and sets bytes_read on success.
 esp_err_t audio_es8311_mic_read(void *dst, size_t dst_bytes, size_t *bytes_read, int timeout_ms);
+
+// UI sounds. Non-blocking, safe from LVGL callbacks: the sound is queued on a mixer voice and
+// plays over any stream. ESP_ERR_NO_MEM when every voice is busy.
 esp_err_t audio_es8311_play_beep(void);
 esp_err_t audio_es8311_play_click(void);
 esp_err_t audio_es8311_play_spray_rattle(void);
 
-// Stream playback (MP3 player). Temporarily reconfigures I2S+codec to a
-// different sample rate. While streaming, UI click/beep sounds are suppressed.
+// Stream playback (MP3 player). Writes are converted from sample_rate_hz to the hardware rate and
+// queued for the engine; stream_write() blocks until they fit, which paces the writer. Calling
+// stream_begin() again with another rate switches the converter between two writes, without a gap.
+// Fails with ESP_ERR_NOT_SUPPORTED for rates audio_resampler cannot convert. stream_end() lets the
+// queued audio play out and logs mixer cost and sound latency; it may run on another task than the
+// writer (set_enabled(false) calls it), and a write in progress then fails with ESP_ERR_INVALID_STATE.
 esp_err_t audio_es8311_stream_begin(int sample_rate_hz);
 esp_err_t audio_es8311_stream_write(const void *pcm_s16_interleaved, size_t bytes, int timeout_ms);
 void audio_es8311_stream_end(void);
@@ -12,8 +12,11 @@ extern "C" {
 // The server exposes a minimal web UI to upload/download and edit files on:
 // - flash: /storage
 // - sd:    /sdcard (only if mounted)
+// and a live screen mirror at /mirror (WebSocket /mirror/ws, see screen_mirror.h; only built with
+// CONFIG_HTTPD_WS_SUPPORT).
 
 esp_err_t fileserver_service_start(void);
+// While a mirror viewer is connected the server keeps running and stops when the viewer leaves.
 void fileserver_service_stop(void);
 
 bool fileserver_service_is_running(void);
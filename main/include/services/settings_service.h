@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Typed in-RAM cache of the settings namespaces (disp, audio, pwr, ble, wifi) with a write-behind
+// flush. Setters only touch RAM; a background task writes all dirty keys after the value has been
+// stable for a short while (or at most a few seconds after the first change), one commit per
+// namespace. Reboot/sleep paths call settings_service_flush() first.
+
+// Call right after nvs_flash_init(): reads every entry of the managed namespaces in one pass
+// over the NVS partition and starts the flush task.
+esp_err_t settings_service_init(void);
+
+// Getters return false (and leave *out untouched) if the key was never stored.
+bool settings_service_get_u8(const char *ns, const char *key, uint8_t *out);
+bool settings_service_get_i32(const char *ns, const char *key, int32_t *out);
+bool settings_service_get_u32(const char *ns, const char *key, uint32_t *out);
+bool settings_service_get_str(const char *ns, const char *key, char *out, size_t out_len);
+
+// Setters are cheap and safe from any task; writing the current value is a no-op.
+esp_err_t settings_service_set_u8(const char *ns, const char *key, uint8_t value);
+esp_err_t settings_service_set_i32(const char *ns, const char *key, int32_t value);
+esp_err_t settings_service_set_u32(const char *ns, const char *key, uint32_t value);
+esp_err_t settings_service_set_str(const char *ns, const char *key, const char *value);
+
+// Writes all dirty keys now (blocking). Call before restart or sleep.
+esp_err_t settings_service_flush(void);
+
+// Write-amplification counters since boot.
+typedef struct {
+    uint32_t sets;           // setter calls
+    uint32_t sets_unchanged; // setter calls that matched the cached value
+    uint32_t keys_written;   // nvs_set_*() calls
+    uint32_t commits;        // nvs_commit() calls
+    uint32_t flushes;        // flush passes that wrote something
+    uint32_t flush_errors;
+    uint32_t last_flush_us;
+    uint32_t max_flush_us;
+    uint32_t boot_load_us;   // one-pass read at init
+    uint16_t entries;        // cached keys
+} settings_service_stats_t;
+
+void settings_service_get_stats(settings_service_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
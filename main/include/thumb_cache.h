@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Thumbnails for the SD card browsers: JPEG previews and MP3 cover art (ID3v2 APIC, JPEG only).
+//
+// Thumbnails are THUMB_CACHE_SIZE x THUMB_CACHE_SIZE lv_color_t images, letterboxed on black.
+// - RAM: a PSRAM LRU of THUMB_CACHE_RAM_SLOTS entries, served directly as lv_img_dsc_t.
+// - Disk: /sdcard/.thumbs/thumbs.dat holds the pixels and thumbs.idx the keys (path, size, mtime).
+//   Files the decoder rejects are recorded too, so they are not decoded again; a decode that ran
+//   out of memory or hit a read error is not, and is retried on the next request.
+// Missing thumbnails are generated through image_decoder. Disk IO runs on a worker task on core 0.
+// All functions must be called with the LVGL lock held.
+
+#define THUMB_CACHE_SIZE 40
+
+// Called on the LVGL task when a requested thumbnail becomes available.
+typedef void (*thumb_cache_cb_t)(const char *vfs_path, const lv_img_dsc_t *img, void *user_data);
+
+// Returns the thumbnail if it is in RAM. Otherwise returns NULL and queues it; cb fires once it is
+// loaded or generated, and never if the file has no preview. Every image handed out (returned or
+// passed to cb) is pinned in RAM until thumb_cache_release().
+const lv_img_dsc_t *thumb_cache_get(const char *vfs_path, thumb_cache_cb_t cb, void *user_data);
+void thumb_cache_release(const lv_img_dsc_t *img);
+
+// Drops pending callbacks for user_data.
+void thumb_cache_cancel(void *user_data);
+
+// Adds a THUMB_CACHE_SIZE icon in front of a list button's label and fills it in when the
+// thumbnail is ready. vfs_path may be NULL for a blank icon. Cancels and releases on delete.
+lv_obj_t *thumb_cache_attach(lv_obj_t *btn, const char *vfs_path);
+
+// Points an icon from thumb_cache_attach() at another file, or blanks it (NULL). For recycled rows.
+void thumb_cache_bind(lv_obj_t *icon, const char *vfs_path);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interrupt-driven FT5x06 sampling. A touch task reads the controller over I2C only after the
+// INT line fires (and at the controller report rate while a finger is down), and publishes
+// samples through a single-producer/single-consumer queue drained by the LVGL read callback.
+
+typedef struct {
+    int16_t x;
+    int16_t y;
+    bool pressed;
+} touch_input_sample_t;
+
+// Creates the FT5x06 driver on the shared I2C bus and starts the touch task.
+// on_sample runs in the touch task after new samples were queued (e.g. to wake the LVGL task).
+esp_err_t touch_input_init(void (*on_sample)(void));
+
+// Consumer side (LVGL read callback only). Returns false if the queue is empty.
+bool touch_input_pop(touch_input_sample_t *out);
+bool touch_input_has_samples(void);
+
+#ifdef __cplusplus
+}
+#endif
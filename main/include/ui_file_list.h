@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Virtualized file list for the SD card browsers.
+//
+// A worker task on core 0 reads the directory and sends names over in sorted batches. They are merged
+// into a PSRAM entry table (one string arena plus an index, natural case-insensitive order) as they
+// arrive, so the list fills in while the scan runs. Only enough rows to cover the viewport are
+// created; scrolling rebinds them to other entries, so the widget count stays constant however many
+// files the folder holds. Rows show a thumb_cache icon for files accepted by thumb_filter.
+// With index_kinds set, the list shows the whole card from media_index instead, in index_sort order
+// and labelled "Artist - Title" where tagged, and refills itself when the index is updated. It falls
+// back to scanning dir until the first index is loaded.
+// All functions must be called with the LVGL lock held.
+
+typedef bool (*ui_file_list_filter_t)(const char *name);
+typedef void (*ui_file_list_click_cb_t)(const char *vfs_path, void *user_data);
+
+typedef struct {
+    const char *dir;                    // e.g. "/sdcard"
+    ui_file_list_filter_t filter;       // files to list (dot files are always skipped)
+    ui_file_list_filter_t thumb_filter; // files that get a thumbnail; NULL for none
+    ui_file_list_click_cb_t on_click;
+    void *user_data;
+    const char *empty_text; // shown when the scan finds nothing
+    uint8_t index_kinds;    // media_kind_t mask to list from media_index (dir must be /sdcard); 0 to scan dir
+    uint8_t index_sort;     // media_sort_t for index lists
+} ui_file_list_config_t;
+
+// Turns an empty lv_list into a virtualized list of cfg->dir and starts the scan. Calling it again
+// on the same list rescans. The config strings are copied.
+void ui_file_list_populate(lv_obj_t *list, const ui_file_list_config_t *cfg);
+
+// Writes the path of the entry `step` places after vfs_path (before, if negative) in list order to out, counting
+// only names the filter accepts (NULL accepts all) and wrapping at the ends. Returns false if
+// vfs_path is not in the list or no other entry matches.
+bool ui_file_list_step(lv_obj_t *list, const char *vfs_path, int step, ui_file_list_filter_t filter, char *out,
+                       size_t out_len);
+
+#ifdef __cplusplus
+}
+#endif
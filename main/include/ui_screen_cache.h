@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Built-in apps, in carousel order.
+typedef enum {
+    UI_SCREEN_SETTINGS = 0,
+    UI_SCREEN_TERMINAL,
+    UI_SCREEN_MEDIA,
+    UI_SCREEN_MP3,
+    UI_SCREEN_FILESERVER,
+    UI_SCREEN_COUNT,
+} ui_screen_id_t;
+
+// LRU cache of app screens for fast switching from the carousel. Two kinds of entries:
+//  - live: an app's screen kept alive (not deleted) after Exit, resumed by its open function;
+//  - snapshot: an lv_snapshot bitmap in PSRAM, shown immediately on launch while the real screen builds.
+// Both are evicted least-recently-used first when over budget or when the heap runs low.
+// All functions must be called with the LVGL lock held (normally from LVGL callbacks).
+
+// Shows the app's snapshot on a throw-away placeholder screen and renders it right away.
+// Returns false if there is no snapshot (or a live screen will be resumed instead).
+bool ui_screen_cache_show_snapshot(ui_screen_id_t id);
+
+// Captures scr (normally the app's entry screen) into the snapshot slot if it has none yet.
+void ui_screen_cache_capture(ui_screen_id_t id, lv_obj_t *scr);
+
+// Keeps scr alive after Exit instead of deleting it. The cache may delete it later (LV_EVENT_DELETE
+// fires as usual, so the owner's pointer reset keeps working). A screen already parked under id
+// is deleted first; if that one is the active screen, scr is not parked.
+void ui_screen_cache_park(ui_screen_id_t id, lv_obj_t *scr);
+
+// Called by the owner when it re-uses a parked screen; the cache stops tracking it.
+void ui_screen_cache_unpark(ui_screen_id_t id);
+bool ui_screen_cache_has_live(ui_screen_id_t id);
+
+// Drops every entry (e.g. before a memory-hungry operation).
+void ui_screen_cache_clear(void);
+
+typedef struct {
+    uint32_t snapshot_hits;
+    uint32_t snapshot_misses;
+    uint32_t live_resumes;
+    uint32_t evictions;
+    uint32_t pressure_evictions;
+    size_t snapshot_bytes;
+    uint8_t live_count;
+} ui_screen_cache_stats_t;
+
+void ui_screen_cache_get_stats(ui_screen_cache_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared styles for the built-in app screens. Each is a static lv_style_t initialized once, so
+// objects carry a pointer to it instead of their own local style entries.
+typedef enum {
+    UI_THEME_SCREEN = 0,     // black, 8 px padding (app screens)
+    UI_THEME_SCREEN_FLUSH,   // black, no padding (carousel, terminal)
+    UI_THEME_HEADER,         // 44 px dark bar across the top
+    UI_THEME_HEADER_BTN,     // 60x32 Back / Exit / action button in a header
+    UI_THEME_TITLE,          // white label text
+    UI_THEME_CONTENT,        // transparent, borderless container, 8 px padding
+    UI_THEME_CONTENT_LOOSE,  // as CONTENT with 12 px padding and 10 px row gap (forms)
+    UI_THEME_CONTENT_FLUSH,  // as CONTENT without padding (image viewers)
+    UI_THEME_LIST,           // near-black borderless list
+    UI_THEME_COUNT,
+} ui_theme_style_t;
+
+// Adds the shared style to obj (main part, default state). Must be called with the LVGL lock held.
+void ui_theme_apply(lv_obj_t *obj, ui_theme_style_t style);
+
+#ifdef __cplusplus
+}
+#endif
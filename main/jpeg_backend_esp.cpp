@@ -0,0 +1,157 @@
+#include "jpeg_backend.h"
+
+void jpeg_backend_esp_scaled_size(uint16_t width, uint16_t height, uint8_t scale, uint16_t *out_w, uint16_t *out_h)
+{
+    while (scale > 0 && ((width >> scale) < 8 || (height >> scale) < 8)) {
+        scale--;
+    }
+    if (scale == 0) {
+        *out_w = width;
+        *out_h = height;
+        return;
+    }
+    *out_w = (uint16_t)((width >> scale) & ~7U);
+    *out_h = (uint16_t)((height >> scale) & ~7U);
+}
+
+#if JPEG_BACKEND_HAVE_ESP
+
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "esp_jpeg_dec.h"
+#include "esp_log.h"
+
+static const char *TAG = "jpeg_esp";
+
+// The whole file is read into PSRAM; larger files are left to the streaming tjpgd backend.
+#define JPEG_ESP_MAX_INPUT (3 * 1024 * 1024)
+// Rows handed to the block callback at a time, so the viewer can show progress.
+#define JPEG_ESP_BAND_ROWS 16
+
+typedef struct {
+    uint8_t *in;
+    uint32_t in_len;
+    uint16_t width;
+    uint16_t height;
+} esp_dec_t;
+
+static void esp_scaled_size(void *dec, uint8_t scale, uint16_t *width, uint16_t *height)
+{
+    const esp_dec_t *d = (const esp_dec_t *)dec;
+    jpeg_backend_esp_scaled_size(d->width, d->height, scale, width, height);
+}
+
+static void *esp_open(const jpeg_source_t *src, uint16_t *width, uint16_t *height)
+{
+    if (src->size < 4 || src->size > JPEG_ESP_MAX_INPUT) {
+        return nullptr;
+    }
+    esp_dec_t *d = new (std::nothrow) esp_dec_t();
+    if (!d) {
+        return nullptr;
+    }
+    d->in_len = src->size;
+    d->in = (uint8_t *)heap_caps_malloc(d->in_len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    uint32_t got = 0;
+    while (d->in && got < d->in_len) {
+        const size_t n = src->read(src->ctx, d->in + got, d->in_len - got);
+        if (n == 0) {
+            break;
+        }
+        got += (uint32_t)n;
+    }
+
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+    jpeg_dec_handle_t h = nullptr;
+    jpeg_dec_header_info_t info = {};
+    jpeg_dec_io_t io = {};
+    io.inbuf = d->in;
+    io.inbuf_len = (int)got;
+    // Progressive and other unsupported streams fail here and go to the next backend.
+    const bool ok = d->in && got == d->in_len && jpeg_dec_open(&config, &h) == JPEG_ERR_OK &&
+                    jpeg_dec_parse_header(h, &io, &info) == JPEG_ERR_OK;
+    if (h) {
+        jpeg_dec_close(h);
+    }
+    if (!ok) {
+        heap_caps_free(d->in);
+        delete d;
+        return nullptr;
+    }
+    d->width = (uint16_t)info.width;
+    d->height = (uint16_t)info.height;
+    *width = d->width;
+    *height = d->height;
+    return d;
+}
+
+static bool esp_decode(void *dec, uint8_t scale, jpeg_block_cb_t cb, void *user_data)
+{
+    esp_dec_t *d = (esp_dec_t *)dec;
+    uint16_t w = 0;
+    uint16_t h = 0;
+    esp_scaled_size(d, scale, &w, &h);
+
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+#if LV_COLOR_16_SWAP
+    config.output_type = JPEG_PIXEL_FORMAT_RGB565_BE;
+#else
+    config.output_type = JPEG_PIXEL_FORMAT_RGB565_LE;
+#endif
+    if (w != d->width || h != d->height) {
+        config.scale.width = w;
+        config.scale.height = h;
+    }
+    jpeg_dec_handle_t handle = nullptr;
+    if (jpeg_dec_open(&config, &handle) != JPEG_ERR_OK) {
+        return false;
+    }
+    jpeg_dec_header_info_t info = {};
+    jpeg_dec_io_t io = {};
+    io.inbuf = d->in;
+    io.inbuf_len = (int)d->in_len;
+    uint8_t *out = nullptr;
+    bool ok = jpeg_dec_parse_header(handle, &io, &info) == JPEG_ERR_OK;
+    if (ok) {
+        // 16-byte alignment is required by the SIMD output stage.
+        out = (uint8_t *)jpeg_calloc_align((size_t)w * h * sizeof(lv_color_t), 16);
+        io.outbuf = out;
+        ok = out && jpeg_dec_process(handle, &io) == JPEG_ERR_OK;
+        if (!ok) {
+            ESP_LOGW(TAG, "decode failed at %ux%u", (unsigned)w, (unsigned)h);
+        }
+    }
+    jpeg_dec_close(handle);
+
+    for (uint16_t y = 0; ok && y < h; y += JPEG_ESP_BAND_ROWS) {
+        jpeg_block_t blk;
+        blk.x = 0;
+        blk.y = y;
+        blk.w = w;
+        blk.h = (uint16_t)(h - y < JPEG_ESP_BAND_ROWS ? h - y : JPEG_ESP_BAND_ROWS);
+        blk.px = (const lv_color_t *)out + (size_t)y * w;
+        ok = cb(&blk, user_data);
+    }
+    if (out) {
+        jpeg_free_align(out);
+    }
+    return ok;
+}
+
+static void esp_close(void *dec)
+{
+    esp_dec_t *d = (esp_dec_t *)dec;
+    heap_caps_free(d->in);
+    delete d;
+}
+
+const jpeg_backend_t jpeg_backend_esp = {
+    "esp_new_jpeg",
+    esp_open,
+    esp_scaled_size,
+    esp_decode,
+    esp_close,
+};
+
+#endif // JPEG_BACKEND_HAVE_ESP
@@ -0,0 +1,99 @@
+#include "jpeg_backend.h"
+
+#if JPEG_BACKEND_HAVE_TJPGD
+
+#include <stdlib.h>
+
+#include <new>
+
+#include "extra/libs/sjpg/tjpgd.h"
+
+// Same work area size LVGL's SJPG decoder gives tjpgd.
+#define TJPGD_POOL_SIZE 4096
+
+typedef struct {
+    JDEC jd;
+    jpeg_source_t src;
+    void *pool;
+    jpeg_block_cb_t cb;
+    void *user_data;
+    lv_color_t block[16 * 16]; // one MCU
+} tjpgd_dec_t;
+
+static size_t jd_input(JDEC *jd, uint8_t *buf, size_t len)
+{
+    tjpgd_dec_t *d = (tjpgd_dec_t *)jd->device;
+    return d->src.read(d->src.ctx, buf, len);
+}
+
+static int jd_output(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    tjpgd_dec_t *d = (tjpgd_dec_t *)jd->device;
+    jpeg_block_t blk;
+    blk.x = rect->left;
+    blk.y = rect->top;
+    blk.w = (uint16_t)(rect->right - rect->left + 1);
+    blk.h = (uint16_t)(rect->bottom - rect->top + 1);
+    const int n = blk.w * blk.h;
+    for (int i = 0; i < n; i++) {
+#if JD_FORMAT == 1
+        const uint16_t c = ((const uint16_t *)bitmap)[i];
+        d->block[i] = lv_color_make((c >> 8) & 0xF8, (c >> 3) & 0xFC, (c << 3) & 0xF8);
+#else
+        const uint8_t *s = (const uint8_t *)bitmap + i * 3;
+        d->block[i] = lv_color_make(s[0], s[1], s[2]);
+#endif
+    }
+    blk.px = d->block;
+    return d->cb(&blk, d->user_data) ? 1 : 0;
+}
+
+static void *tjpgd_open(const jpeg_source_t *src, uint16_t *width, uint16_t *height)
+{
+    tjpgd_dec_t *d = new (std::nothrow) tjpgd_dec_t();
+    if (!d) {
+        return nullptr;
+    }
+    d->src = *src;
+    d->pool = malloc(TJPGD_POOL_SIZE);
+    if (!d->pool || jd_prepare(&d->jd, jd_input, d->pool, TJPGD_POOL_SIZE, d) != JDR_OK) {
+        free(d->pool);
+        delete d;
+        return nullptr;
+    }
+    *width = d->jd.width;
+    *height = d->jd.height;
+    return d;
+}
+
+static void tjpgd_scaled_size(void *dec, uint8_t scale, uint16_t *width, uint16_t *height)
+{
+    const tjpgd_dec_t *d = (const tjpgd_dec_t *)dec;
+    *width = (uint16_t)(d->jd.width >> scale);
+    *height = (uint16_t)(d->jd.height >> scale);
+}
+
+static bool tjpgd_decode(void *dec, uint8_t scale, jpeg_block_cb_t cb, void *user_data)
+{
+    tjpgd_dec_t *d = (tjpgd_dec_t *)dec;
+    d->cb = cb;
+    d->user_data = user_data;
+    return jd_decomp(&d->jd, jd_output, scale) == JDR_OK;
+}
+
+static void tjpgd_close(void *dec)
+{
+    tjpgd_dec_t *d = (tjpgd_dec_t *)dec;
+    free(d->pool);
+    delete d;
+}
+
+const jpeg_backend_t jpeg_backend_tjpgd = {
+    "tjpgd",
+    tjpgd_open,
+    tjpgd_scaled_size,
+    tjpgd_decode,
+    tjpgd_close,
+};
+
+#endif // JPEG_BACKEND_HAVE_TJPGD
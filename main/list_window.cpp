@@ -0,0 +1,55 @@
+#include "list_window.h"
+
+#include <algorithm>
+
+void list_window_init(list_window_t *w, uint16_t rows, uint16_t row_h)
+{
+    w->count = 0;
+    w->base = 0;
+    w->rows = std::max<uint16_t>(rows, 4);
+    w->row_h = std::max<uint16_t>(row_h, 1);
+}
+
+uint32_t list_window_span(const list_window_t *w)
+{
+    return std::max<uint32_t>(std::min<uint32_t>(w->count, w->rows), 1);
+}
+
+uint32_t list_window_index(const list_window_t *w, int32_t y)
+{
+    return w->base + (y > 0 ? (uint32_t)y / w->row_h : 0);
+}
+
+int32_t list_window_y(const list_window_t *w, uint32_t i)
+{
+    return (int32_t)(i - w->base) * w->row_h;
+}
+
+int32_t list_window_update(list_window_t *w, uint32_t count, uint32_t shift, int32_t scroll_y, int32_t view_h)
+{
+    const int64_t row_h = w->row_h;
+    const int64_t top = ((int64_t)w->base + shift) * row_h + scroll_y; // absolute, px
+    w->count = count;
+    if (count <= w->rows) {
+        w->base = 0;
+        return (int32_t)top;
+    }
+
+    const uint32_t max_base = count - w->rows;
+    uint32_t base = (uint32_t)std::min<int64_t>((int64_t)w->base + shift, max_base);
+    const int64_t rel = top - (int64_t)base * row_h;
+    const int64_t margin = (int64_t)(w->rows / 4) * row_h;
+    // No move at the ends of the list, so LVGL's overscroll there is left alone.
+    if ((rel < margin && base > 0) || (rel + view_h > (int64_t)w->rows * row_h - margin && base < max_base)) {
+        const int64_t centre = (top + view_h / 2) / row_h - w->rows / 2;
+        base = (uint32_t)std::clamp<int64_t>(centre, 0, max_base);
+    }
+    w->base = base;
+    return (int32_t)(top - (int64_t)base * row_h);
+}
+
+int32_t list_window_show(list_window_t *w, uint32_t index, int32_t view_h)
+{
+    w->base = 0;
+    return list_window_update(w, w->count, std::min(index, w->count), 0, view_h);
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "block_cache.h"
 #include "esp_log.h"
 #include "lvgl.h"
 
@@ -13,6 +14,7 @@
 static const char *TAG = "lv_fs_sd";
 
 static bool s_inited = false;
+static lv_fs_drv_t s_drv;
 
 static void make_full_path(char *out, size_t out_len, const char *path)
 {
@@ -28,70 +30,86 @@ static void make_full_path(char *out, size_t out_len, const char *path)
 
 static void *fs_open(lv_fs_drv_t *, const char *path, lv_fs_mode_t mode)
 {
+    // Read-only driver: there is no write_cb, and opening with "wb" would only truncate the file.
+    if (mode & LV_FS_MODE_WR) return NULL;
+
     char full[256];
     make_full_path(full, sizeof(full), path);
-
-    const char *m = (mode == LV_FS_MODE_WR) ? "wb" : "rb";
-    FILE *f = fopen(full, m);
-    return (void *)f;
+    return (void *)block_cache_open(full);
 }
 
 static lv_fs_res_t fs_close(lv_fs_drv_t *, void *file_p)
 {
-    FILE *f = (FILE *)file_p;
+    block_cache_file_t *f = (block_cache_file_t *)file_p;
     if (!f) return LV_FS_RES_INV_PARAM;
-    fclose(f);
+    block_cache_close(f);
     return LV_FS_RES_OK;
 }
 
 static lv_fs_res_t fs_read(lv_fs_drv_t *, void *file_p, void *buf, uint32_t btr, uint32_t *br)
 {
-    FILE *f = (FILE *)file_p;
+    block_cache_file_t *f = (block_cache_file_t *)file_p;
     if (!f) return LV_FS_RES_INV_PARAM;
-    size_t r = fread(buf, 1, btr, f);
+    size_t r = block_cache_read(f, buf, btr);
     if (br) *br = (uint32_t)r;
-    if (r == 0 && ferror(f)) return LV_FS_RES_UNKNOWN;
+    if (r < btr && block_cache_tell(f) < block_cache_size(f)) return LV_FS_RES_UNKNOWN;
     return LV_FS_RES_OK;
 }
 
 static lv_fs_res_t fs_seek(lv_fs_drv_t *, void *file_p, uint32_t pos, lv_fs_whence_t whence)
 {
-    FILE *f = (FILE *)file_p;
+    block_cache_file_t *f = (block_cache_file_t *)file_p;
     if (!f) return LV_FS_RES_INV_PARAM;
 
     int w = SEEK_SET;
     if (whence == LV_FS_SEEK_CUR) w = SEEK_CUR;
     else if (whence == LV_FS_SEEK_END) w = SEEK_END;
 
-    return fseek(f, (long)pos, w) == 0 ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
+    return block_cache_seek(f, (int32_t)pos, w) ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN;
 }
 
 static lv_fs_res_t fs_tell(lv_fs_drv_t *, void *file_p, uint32_t *pos_p)
 {
-    FILE *f = (FILE *)file_p;
+    block_cache_file_t *f = (block_cache_file_t *)file_p;
     if (!f || !pos_p) return LV_FS_RES_INV_PARAM;
 
-    long p = ftell(f);
-    if (p < 0) return LV_FS_RES_UNKNOWN;
-    *pos_p = (uint32_t)p;
+    *pos_p = block_cache_tell(f);
     return LV_FS_RES_OK;
 }
 
+static void log_cache_stats(lv_timer_t *)
+{
+    block_cache_stats_t st;
+    block_cache_get_stats(&st);
+    const uint32_t lookups = st.hits + st.misses;
+    if (lookups == 0) return;
+    ESP_LOGI(TAG, "cache: %u%% hit (%u/%u), read-ahead %u/%u used, %u bypass, %u KB served / %u KB fetched in %u reads",
+             (unsigned)(st.hits * 100 / lookups), (unsigned)st.hits, (unsigned)lookups,
+             (unsigned)st.readahead_used, (unsigned)st.readahead_blocks, (unsigned)st.bypass_reads,
+             (unsigned)(st.bytes_requested / 1024), (unsigned)(st.bytes_fetched / 1024), (unsigned)st.backend_reads);
+    block_cache_reset_stats();
+}
+
 esp_err_t lvgl_fs_sdcard_init(void)
 {
     if (s_inited) {
         return ESP_OK;
     }
 
-    lv_fs_drv_t drv;
-    lv_fs_drv_init(&drv);
-    drv.letter = 'S';
-    drv.open_cb = fs_open;
-    drv.close_cb = fs_close;
-    drv.read_cb = fs_read;
-    drv.seek_cb = fs_seek;
-    drv.tell_cb = fs_tell;
-    lv_fs_drv_register(&drv);
+    const block_cache_config_t cache_cfg = BLOCK_CACHE_DEFAULT_CONFIG();
+    if (!block_cache_init(&cache_cfg)) {
+        ESP_LOGW(TAG, "No PSRAM for the block cache, reading uncached");
+    }
+
+    // LVGL keeps the pointer, so the driver must outlive this call.
+    lv_fs_drv_init(&s_drv);
+    s_drv.letter = 'S';
+    s_drv.open_cb = fs_open;
+    s_drv.close_cb = fs_close;
+    s_drv.read_cb = fs_read;
+    s_drv.seek_cb = fs_seek;
+    s_drv.tell_cb = fs_tell;
+    lv_fs_drv_register(&s_drv);
 
 #if LV_USE_SJPG
     // Register JPG decoder (uses lv_fs under the hood)
@@ -99,6 +117,9 @@ esp_err_t lvgl_fs_sdcard_init(void)
 #endif
 
     s_inited = true;
-    ESP_LOGI(TAG, "LVGL FS registered: S:/ -> /sdcard/");
+    ESP_LOGI(TAG, "LVGL FS registered: S:/ -> /sdcard/ (%u x %u KB block cache)",
+             (unsigned)cache_cfg.block_count, (unsigned)(cache_cfg.block_size / 1024));
+    // Hit-rate counters for tuning; logged only while images are being read.
+    lv_timer_create(log_cache_stats, 10000, NULL);
     return ESP_OK;
 }
@@ -0,0 +1,1040 @@
+#include "media_index.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "display_lvgl.h"
+#include "id3_tag.h"
+
+static const char *TAG = "media_index";
+
+#define MEDIA_INDEX_ROOT "/sdcard"
+#define MEDIA_INDEX_DIR "/sdcard/.index"
+#define MEDIA_INDEX_FILE MEDIA_INDEX_DIR "/media.idx"
+#define MEDIA_INDEX_TMP MEDIA_INDEX_DIR "/media.tmp"
+#define MEDIA_INDEX_MAGIC 0x5844494DU // "MIDX"
+#define MEDIA_INDEX_VERSION 2
+#define MEDIA_INDEX_MAX_ENTRIES 20000
+#define MEDIA_INDEX_MAX_DIRS 4096
+#define MEDIA_INDEX_MAX_DEPTH 8
+#define MEDIA_INDEX_MAX_SUBSCRIBERS 4
+#define MEDIA_INDEX_TEXT_MAX 96
+// A JPEG whose SOF is not within this many bytes (huge EXIF thumbnails) gets no dimensions.
+#define MEDIA_INDEX_JPEG_SCAN (256 * 1024)
+// MP3 bytes searched for the first frame header after the ID3 tag.
+#define MEDIA_INDEX_MP3_SCAN 4096
+
+#define MEDIA_INDEX_TASK_STACK_SIZE (6 * 1024)
+#define MEDIA_INDEX_TASK_PRIORITY 1 // below the decode workers
+#define MEDIA_INDEX_TASK_CORE 0
+
+// ---- File format ----
+//
+// header | dirs[dir_count] | entries[entry_count] | order[MEDIA_SORT_COUNT][entry_count] | strings
+// Dirs are sorted by path and entries by (dir, name), both with strcmp, for lookups during a rescan.
+// Strings are interned; offset 0 is "". Paths are relative to MEDIA_INDEX_ROOT, "" for the root.
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dir_count;
+    uint32_t entry_count;
+    uint32_t strings_len;
+    uint32_t reserved;
+} idx_header_t;
+
+typedef struct {
+    uint32_t path;
+    uint32_t first;
+    uint32_t count;
+} idx_dir_t;
+
+typedef struct {
+    uint32_t name;
+    uint32_t title;
+    uint32_t artist;
+    uint32_t album;
+    uint32_t size;
+    uint32_t mtime;
+    uint32_t duration_ms;
+    uint16_t dir;
+    uint16_t width;
+    uint16_t height;
+    uint8_t kind;
+    uint8_t reserved;
+} idx_entry_t;
+
+static_assert(sizeof(idx_entry_t) == 36, "idx_entry_t is stored on the card");
+
+// A loaded index: the file image in PSRAM.
+typedef struct {
+    uint8_t *blob;
+    uint32_t blob_len;
+    const idx_header_t *hdr;
+    const idx_dir_t *dirs;
+    const idx_entry_t *entries;
+    const uint32_t *order;
+    const char *strings;
+} idx_db_t;
+
+typedef struct {
+    media_index_cb_t cb;
+    void *user_data;
+} subscriber_t;
+
+// LVGL task
+static idx_db_t *s_db = nullptr;
+static subscriber_t s_subscribers[MEDIA_INDEX_MAX_SUBSCRIBERS];
+
+// Worker: the index it published last, which the next scan compares against. The LVGL task frees an
+// index only when its successor arrives, and only the worker publishes, so this stays valid.
+static idx_db_t *s_published = nullptr;
+
+static std::atomic<bool> s_running{false};
+static std::atomic<bool> s_rescan{false};
+static std::atomic<bool> s_remounted{false}; // possibly another card: drop what is published
+
+int media_index_name_cmp(const char *a, const char *b)
+{
+    while (*a && *b) {
+        if (isdigit((unsigned char)*a) && isdigit((unsigned char)*b)) {
+            while (*a == '0') a++;
+            while (*b == '0') b++;
+            const char *ea = a;
+            const char *eb = b;
+            while (isdigit((unsigned char)*ea)) ea++;
+            while (isdigit((unsigned char)*eb)) eb++;
+            if (ea - a != eb - b) {
+                return (ea - a) < (eb - b) ? -1 : 1;
+            }
+            for (; a < ea; a++, b++) {
+                if (*a != *b) {
+                    return *a < *b ? -1 : 1;
+                }
+            }
+            continue;
+        }
+        const int ca = tolower((unsigned char)*a);
+        const int cb = tolower((unsigned char)*b);
+        if (ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+        a++;
+        b++;
+    }
+    return (unsigned char)*a - (unsigned char)*b;
+}
+
+static bool has_ext(const char *name, const char *ext)
+{
+    const size_t n = strlen(name);
+    const size_t e = strlen(ext);
+    return n > e && strcasecmp(name + n - e, ext) == 0;
+}
+
+static uint8_t kind_of(const char *name)
+{
+    if (has_ext(name, ".jpg") || has_ext(name, ".jpeg") || has_ext(name, ".png")) return MEDIA_KIND_IMAGE;
+    if (has_ext(name, ".gif")) return MEDIA_KIND_GIF;
+    if (has_ext(name, ".mp3")) return MEDIA_KIND_AUDIO;
+    return 0;
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void db_free(idx_db_t *db)
+{
+    if (db) {
+        heap_caps_free(db->blob);
+        delete db;
+    }
+}
+
+// Takes ownership of blob. Returns NULL (and frees it) if it is not a valid index.
+static idx_db_t *db_from_blob(uint8_t *blob, uint32_t len)
+{
+    const idx_header_t *h = (const idx_header_t *)blob;
+    idx_db_t *db = nullptr;
+    if (len >= sizeof(idx_header_t) && h->magic == MEDIA_INDEX_MAGIC && h->version == MEDIA_INDEX_VERSION &&
+        h->dir_count <= MEDIA_INDEX_MAX_DIRS && h->entry_count <= MEDIA_INDEX_MAX_ENTRIES && h->strings_len > 0) {
+        const uint32_t need = sizeof(idx_header_t) + h->dir_count * sizeof(idx_dir_t) +
+                              h->entry_count * (sizeof(idx_entry_t) + MEDIA_SORT_COUNT * sizeof(uint32_t)) +
+                              h->strings_len;
+        if (need == len && blob[len - 1] == '\0') {
+            db = new (std::nothrow) idx_db_t();
+        }
+    }
+    if (!db) {
+        heap_caps_free(blob);
+        return nullptr;
+    }
+    db->blob = blob;
+    db->blob_len = len;
+    db->hdr = h;
+    db->dirs = (const idx_dir_t *)(blob + sizeof(idx_header_t));
+    db->entries = (const idx_entry_t *)(db->dirs + h->dir_count);
+    db->order = (const uint32_t *)(db->entries + h->entry_count);
+    db->strings = (const char *)(db->order + MEDIA_SORT_COUNT * h->entry_count);
+
+    // Every reference has to land inside the tables; the file comes from a card anyone can write.
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < h->dir_count; i++) {
+        const idx_dir_t &d = db->dirs[i];
+        ok = d.path < h->strings_len && d.first <= h->entry_count && d.count <= h->entry_count - d.first;
+    }
+    for (uint32_t i = 0; ok && i < h->entry_count; i++) {
+        const idx_entry_t &e = db->entries[i];
+        ok = e.name < h->strings_len && e.title < h->strings_len && e.artist < h->strings_len &&
+             e.album < h->strings_len && e.dir < h->dir_count;
+    }
+    for (uint32_t i = 0; ok && i < MEDIA_SORT_COUNT * h->entry_count; i++) {
+        ok = db->order[i] < h->entry_count;
+    }
+    if (!ok) {
+        db_free(db);
+        return nullptr;
+    }
+    return db;
+}
+
+static idx_db_t *db_load(void)
+{
+    FILE *f = fopen(MEDIA_INDEX_FILE, "rb");
+    if (!f) {
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *blob = len > 0 ? (uint8_t *)heap_caps_malloc((size_t)len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : nullptr;
+    const bool ok = blob && fread(blob, 1, (size_t)len, f) == (size_t)len;
+    fclose(f);
+    if (!ok) {
+        heap_caps_free(blob);
+        return nullptr;
+    }
+    idx_db_t *db = db_from_blob(blob, (uint32_t)len);
+    if (!db) {
+        ESP_LOGW(TAG, "%s is invalid, rebuilding", MEDIA_INDEX_FILE);
+    }
+    return db;
+}
+
+// ---- Metadata probes (worker) ----
+
+static bool probe_jpeg(FILE *f, uint16_t *w, uint16_t *h)
+{
+    uint8_t m[9];
+    if (fread(m, 1, 2, f) != 2 || m[0] != 0xFF || m[1] != 0xD8) {
+        return false;
+    }
+    long pos = 2;
+    while (pos < MEDIA_INDEX_JPEG_SCAN) {
+        if (fseek(f, pos, SEEK_SET) != 0 || fread(m, 1, 4, f) != 4 || m[0] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = m[1];
+        if (marker == 0xFF) {
+            pos++; // fill byte
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            pos += 2; // no length
+            continue;
+        }
+        const uint16_t len = (uint16_t)((m[2] << 8) | m[3]);
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            // SOFn: length, precision, height, width
+            if (fread(m, 1, 5, f) != 5) {
+                return false;
+            }
+            *h = (uint16_t)((m[1] << 8) | m[2]);
+            *w = (uint16_t)((m[3] << 8) | m[4]);
+            return true;
+        }
+        if (marker == 0xD9 || marker == 0xDA || len < 2) {
+            return false;
+        }
+        pos += 2 + len;
+    }
+    return false;
+}
+
+static bool probe_png(FILE *f, uint16_t *w, uint16_t *h)
+{
+    uint8_t b[24];
+    if (fread(b, 1, sizeof(b), f) != sizeof(b) || memcmp(b, "\x89PNG", 4) != 0 || memcmp(b + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+    const uint32_t pw = be32(b + 16);
+    const uint32_t ph = be32(b + 20);
+    *w = (uint16_t)std::min<uint32_t>(pw, UINT16_MAX);
+    *h = (uint16_t)std::min<uint32_t>(ph, UINT16_MAX);
+    return true;
+}
+
+static bool probe_gif(FILE *f, uint16_t *w, uint16_t *h)
+{
+    uint8_t b[10];
+    if (fread(b, 1, sizeof(b), f) != sizeof(b) || memcmp(b, "GIF8", 4) != 0) {
+        return false;
+    }
+    *w = (uint16_t)(b[6] | (b[7] << 8));
+    *h = (uint16_t)(b[8] | (b[9] << 8));
+    return true;
+}
+
+static void utf8_put(char *out, size_t out_len, size_t *o, uint32_t cp)
+{
+    char tmp[4];
+    size_t n;
+    if (cp < 0x80) {
+        tmp[0] = (char)cp;
+        n = 1;
+    } else if (cp < 0x800) {
+        tmp[0] = (char)(0xC0 | (cp >> 6));
+        tmp[1] = (char)(0x80 | (cp & 0x3F));
+        n = 2;
+    } else if (cp < 0x10000) {
+        tmp[0] = (char)(0xE0 | (cp >> 12));
+        tmp[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[2] = (char)(0x80 | (cp & 0x3F));
+        n = 3;
+    } else {
+        tmp[0] = (char)(0xF0 | (cp >> 18));
+        tmp[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        tmp[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        tmp[3] = (char)(0x80 | (cp & 0x3F));
+        n = 4;
+    }
+    if (*o + n < out_len) {
+        memcpy(out + *o, tmp, n);
+        *o += n;
+    }
+}
+
+// ID3 text frame body (encoding byte + text) to UTF-8. Only the first value of a v2.4 list is kept.
+static void id3_text(const uint8_t *p, uint32_t n, char *out, size_t out_len)
+{
+    size_t o = 0;
+    if (n > 1) {
+        const uint8_t enc = p[0];
+        p++;
+        n--;
+        if (enc == 1 || enc == 2) {
+            bool be = enc == 2;
+            uint32_t i = 0;
+            if (enc == 1 && n >= 2 && ((p[0] == 0xFF && p[1] == 0xFE) || (p[0] == 0xFE && p[1] == 0xFF))) {
+                be = p[0] == 0xFE;
+                i = 2;
+            }
+            for (; i + 1 < n; i += 2) {
+                uint32_t c = be ? (uint32_t)((p[i] << 8) | p[i + 1]) : (uint32_t)((p[i + 1] << 8) | p[i]);
+                if (c == 0) break;
+                if (c >= 0xD800 && c < 0xDC00 && i + 3 < n) {
+                    const uint32_t lo = be ? (uint32_t)((p[i + 2] << 8) | p[i + 3]) : (uint32_t)((p[i + 3] << 8) | p[i + 2]);
+                    if (lo >= 0xDC00 && lo < 0xE000) {
+                        c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                        i += 2;
+                    }
+                }
+                utf8_put(out, out_len, &o, c);
+            }
+        } else {
+            for (uint32_t i = 0; i < n && p[i]; i++) {
+                if (enc == 3) {
+                    // Copy UTF-8 a whole sequence at a time so truncation cannot split one.
+                    const uint32_t seq = p[i] < 0xC0 ? 1 : p[i] < 0xE0 ? 2 : p[i] < 0xF0 ? 3 : 4;
+                    if (o + seq >= out_len || i + seq > n) break;
+                    memcpy(out + o, p + i, seq);
+                    o += seq;
+                    i += seq - 1;
+                } else {
+                    utf8_put(out, out_len, &o, p[i]); // ISO-8859-1
+                }
+            }
+        }
+    }
+    while (o > 0 && out[o - 1] == ' ') o--;
+    out[o] = '\0';
+}
+
+typedef struct {
+    char title[MEDIA_INDEX_TEXT_MAX];
+    char artist[MEDIA_INDEX_TEXT_MAX];
+    char album[MEDIA_INDEX_TEXT_MAX];
+    uint32_t duration_ms;
+} audio_info_t;
+
+// Reads TIT2/TPE1/TALB (TT2/TP1/TAL in v2.2). Returns where the audio starts.
+static uint32_t probe_id3(FILE *f, audio_info_t *info)
+{
+    id3_tag_t tag;
+    if (!id3_tag_open(f, &tag)) {
+        return 0;
+    }
+    id3_frame_t fr;
+    int found = 0;
+    while (found < 3 && id3_tag_next(f, &tag, &fr)) {
+        char *dst = nullptr;
+        if (strcmp(fr.id, "TIT2") == 0 || strcmp(fr.id, "TT2") == 0) dst = info->title;
+        else if (strcmp(fr.id, "TPE1") == 0 || strcmp(fr.id, "TP1") == 0) dst = info->artist;
+        else if (strcmp(fr.id, "TALB") == 0 || strcmp(fr.id, "TAL") == 0) dst = info->album;
+        if (dst && !dst[0]) {
+            uint8_t body[2 * MEDIA_INDEX_TEXT_MAX + 4];
+            const size_t n = fread(body, 1, std::min<uint32_t>(fr.size, sizeof(body)), f);
+            id3_text(body, (uint32_t)n, dst, MEDIA_INDEX_TEXT_MAX);
+            found++;
+        }
+    }
+    return tag.audio_start;
+}
+
+static const uint16_t kBitrateV1[16] = {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0};
+static const uint16_t kBitrateV2[16] = {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0};
+static const uint32_t kSampleRate[3][3] = {{11025, 12000, 8000}, {0, 0, 0}, {22050, 24000, 16000}};
+static const uint32_t kSampleRateV1[3] = {44100, 48000, 32000};
+
+typedef struct {
+    uint32_t bitrate_kbps;
+    uint32_t sample_rate;
+    uint32_t samples; // per frame
+    uint32_t length;  // frame bytes
+    uint32_t side;    // side info bytes after the header
+} mp3_frame_t;
+
+static bool mp3_header(const uint8_t *p, mp3_frame_t *fr)
+{
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) return false;
+    const uint8_t version = (p[1] >> 3) & 3; // 0: 2.5, 2: 2, 3: 1
+    const uint8_t layer = (p[1] >> 1) & 3;   // 1: Layer III
+    const uint8_t br = p[2] >> 4;
+    const uint8_t sr = (p[2] >> 2) & 3;
+    if (version == 1 || layer != 1 || br == 0 || br == 15 || sr == 3) return false;
+    const bool v1 = version == 3;
+    const bool mono = (p[3] >> 6) == 3;
+    fr->bitrate_kbps = v1 ? kBitrateV1[br] : kBitrateV2[br];
+    fr->sample_rate = v1 ? kSampleRateV1[sr] : kSampleRate[version][sr];
+    fr->samples = v1 ? 1152 : 576;
+    fr->length = (v1 ? 144000 : 72000) * fr->bitrate_kbps / fr->sample_rate + ((p[2] >> 1) & 1);
+    fr->side = v1 ? (mono ? 17 : 32) : (mono ? 9 : 17);
+    return true;
+}
+
+// Duration from the Xing/Info or VBRI frame count, else from the bitrate of the first frame (CBR).
+static void probe_mp3(FILE *f, uint32_t file_size, audio_info_t *info)
+{
+    const uint32_t audio_start = probe_id3(f, info);
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(MEDIA_INDEX_MP3_SCAN, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) {
+        return;
+    }
+    size_t n = 0;
+    if (fseek(f, (long)audio_start, SEEK_SET) == 0) {
+        n = fread(buf, 1, MEDIA_INDEX_MP3_SCAN, f);
+    }
+    for (size_t i = 0; i + 4 <= n; i++) {
+        mp3_frame_t fr;
+        if (!mp3_header(buf + i, &fr)) continue;
+        // Require a second header where this frame ends, unless that is past the buffer.
+        mp3_frame_t next;
+        if (i + fr.length + 4 <= n && !mp3_header(buf + i + fr.length, &next)) continue;
+
+        const uint8_t *x = buf + i + 4 + fr.side;
+        const uint8_t *v = buf + i + 4 + 32;
+        uint32_t frames = 0;
+        if (x + 12 <= buf + n && (memcmp(x, "Xing", 4) == 0 || memcmp(x, "Info", 4) == 0) && (be32(x + 4) & 1)) {
+            frames = be32(x + 8);
+        } else if (v + 18 <= buf + n && memcmp(v, "VBRI", 4) == 0) {
+            frames = be32(v + 14);
+        }
+        if (frames) {
+            info->duration_ms = (uint32_t)((uint64_t)frames * fr.samples * 1000 / fr.sample_rate);
+        } else if (file_size > audio_start + i) {
+            info->duration_ms = (uint32_t)((uint64_t)(file_size - audio_start - i) * 8 / fr.bitrate_kbps);
+        }
+        break;
+    }
+    heap_caps_free(buf);
+}
+
+// ---- Builder (worker) ----
+
+typedef struct {
+    uint8_t *p;
+    uint32_t len;
+    uint32_t cap;
+} buf_t;
+
+static bool buf_reserve(buf_t *b, uint32_t add)
+{
+    if (b->len + add <= b->cap) {
+        return true;
+    }
+    const uint32_t cap = std::max<uint32_t>(std::max<uint32_t>(b->cap * 2, 4096), b->len + add);
+    uint8_t *p = (uint8_t *)heap_caps_realloc(b->p, cap, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p) {
+        return false;
+    }
+    b->p = p;
+    b->cap = cap;
+    return true;
+}
+
+static bool buf_append(buf_t *b, const void *data, uint32_t len)
+{
+    if (!buf_reserve(b, len)) {
+        return false;
+    }
+    memcpy(b->p + b->len, data, len);
+    b->len += len;
+    return true;
+}
+
+static void buf_free(buf_t *b)
+{
+    heap_caps_free(b->p);
+    *b = {};
+}
+
+typedef struct {
+    buf_t strings;
+    uint32_t *hash; // string offset per slot, 0 for empty (offset 0 is "" and never hashed)
+    uint32_t hash_cap;
+    uint32_t hash_used;
+    buf_t dirs;    // idx_dir_t in walk order; entries are grouped per dir in the same order
+    buf_t entries; // idx_entry_t
+    bool oom;
+    uint32_t probed;
+    uint32_t reused;
+} builder_t;
+
+static uint32_t fnv1a(const char *s)
+{
+    uint32_t h = 2166136261U;
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 16777619U;
+    }
+    return h;
+}
+
+static bool hash_grow(builder_t *b)
+{
+    const uint32_t cap = b->hash_cap ? b->hash_cap * 2 : 1024;
+    uint32_t *hash = (uint32_t *)heap_caps_calloc(cap, sizeof(uint32_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!hash) {
+        return false;
+    }
+    for (uint32_t i = 0; i < b->hash_cap; i++) {
+        const uint32_t off = b->hash[i];
+        if (!off) continue;
+        uint32_t s = fnv1a((const char *)b->strings.p + off) & (cap - 1);
+        while (hash[s]) s = (s + 1) & (cap - 1);
+        hash[s] = off;
+    }
+    heap_caps_free(b->hash);
+    b->hash = hash;
+    b->hash_cap = cap;
+    return true;
+}
+
+// Offset of s in the string pool, adding it the first time.
+static uint32_t intern(builder_t *b, const char *s)
+{
+    if (!s[0] || b->oom) {
+        return 0;
+    }
+    if (b->hash_used * 2 >= b->hash_cap && !hash_grow(b)) {
+        b->oom = true;
+        return 0;
+    }
+    uint32_t slot = fnv1a(s) & (b->hash_cap - 1);
+    while (b->hash[slot]) {
+        if (strcmp((const char *)b->strings.p + b->hash[slot], s) == 0) {
+            return b->hash[slot];
+        }
+        slot = (slot + 1) & (b->hash_cap - 1);
+    }
+    const uint32_t off = b->strings.len;
+    if (!buf_append(&b->strings, s, (uint32_t)strlen(s) + 1)) {
+        b->oom = true;
+        return 0;
+    }
+    b->hash[slot] = off;
+    b->hash_used++;
+    return off;
+}
+
+static void builder_free(builder_t *b)
+{
+    buf_free(&b->strings);
+    buf_free(&b->dirs);
+    buf_free(&b->entries);
+    heap_caps_free(b->hash);
+    b->hash = nullptr;
+}
+
+static const idx_dir_t *old_find_dir(const idx_db_t *old, const char *path)
+{
+    if (!old) return nullptr;
+    uint32_t lo = 0;
+    uint32_t hi = old->hdr->dir_count;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        const int c = strcmp(old->strings + old->dirs[mid].path, path);
+        if (c == 0) return &old->dirs[mid];
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return nullptr;
+}
+
+static const idx_entry_t *old_find_entry(const idx_db_t *old, const idx_dir_t *dir, const char *name)
+{
+    uint32_t lo = dir->first;
+    uint32_t hi = dir->first + dir->count;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        const int c = strcmp(old->strings + old->entries[mid].name, name);
+        if (c == 0) return &old->entries[mid];
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return nullptr;
+}
+
+// Copies an entry of the previous index, re-interning its strings.
+static void add_old_entry(builder_t *b, const idx_db_t *old, const idx_entry_t *src, uint16_t dir)
+{
+    idx_entry_t e = *src;
+    e.name = intern(b, old->strings + src->name);
+    e.title = intern(b, old->strings + src->title);
+    e.artist = intern(b, old->strings + src->artist);
+    e.album = intern(b, old->strings + src->album);
+    e.dir = dir;
+    if (!buf_append(&b->entries, &e, sizeof(e))) b->oom = true;
+    b->reused++;
+}
+
+static void add_new_entry(builder_t *b, const char *full_path, const char *name, const struct stat *st, uint16_t dir)
+{
+    idx_entry_t e = {};
+    e.name = intern(b, name);
+    e.size = (uint32_t)st->st_size;
+    e.mtime = (uint32_t)st->st_mtime;
+    e.dir = dir;
+    e.kind = kind_of(name);
+
+    FILE *f = fopen(full_path, "rb");
+    if (f) {
+        if (e.kind == MEDIA_KIND_AUDIO) {
+            audio_info_t info = {};
+            probe_mp3(f, e.size, &info);
+            e.title = intern(b, info.title);
+            e.artist = intern(b, info.artist);
+            e.album = intern(b, info.album);
+            e.duration_ms = info.duration_ms;
+        } else if (e.kind == MEDIA_KIND_GIF) {
+            probe_gif(f, &e.width, &e.height);
+        } else if (has_ext(name, ".png")) {
+            probe_png(f, &e.width, &e.height);
+        } else {
+            probe_jpeg(f, &e.width, &e.height);
+        }
+        fclose(f);
+    }
+    if (!buf_append(&b->entries, &e, sizeof(e))) b->oom = true;
+    b->probed++;
+}
+
+typedef struct {
+    buf_t names; // NUL-terminated, back to back
+    buf_t files; // uint32_t offsets into names
+    buf_t subdirs;
+} dir_listing_t;
+
+// Walks one folder: its media files are added to the builder and its subfolders appended to `todo`
+// (uint32_t string offsets).
+static void walk_dir(builder_t *b, const idx_db_t *old, uint32_t path_off, buf_t *todo)
+{
+    char rel[256];
+    snprintf(rel, sizeof(rel), "%s", (const char *)b->strings.p + path_off);
+    char full[300];
+    snprintf(full, sizeof(full), "%s%s%s", MEDIA_INDEX_ROOT, rel[0] ? "/" : "", rel);
+
+    DIR *dir = opendir(full);
+    if (!dir) {
+        return;
+    }
+    dir_listing_t ls = {};
+    struct dirent *ent;
+    while (!b->oom && (ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') {
+            continue; // also skips .thumbs and .index
+        }
+        const bool is_dir = ent->d_type == DT_DIR;
+        if (!is_dir && !kind_of(ent->d_name)) {
+            continue;
+        }
+        const uint32_t off = ls.names.len;
+        if (!buf_append(&ls.names, ent->d_name, (uint32_t)strlen(ent->d_name) + 1) ||
+            !buf_append(is_dir ? &ls.subdirs : &ls.files, &off, sizeof(off))) {
+            b->oom = true;
+        }
+    }
+    closedir(dir);
+
+    const char *names = (const char *)ls.names.p;
+    uint32_t *files = (uint32_t *)ls.files.p;
+    const uint32_t file_count = ls.files.len / sizeof(uint32_t);
+    std::sort(files, files + file_count, [names](uint32_t x, uint32_t y) { return strcmp(names + x, names + y) < 0; });
+
+    const uint32_t dir_count = b->dirs.len / sizeof(idx_dir_t);
+    if (file_count && dir_count < MEDIA_INDEX_MAX_DIRS) {
+        idx_dir_t d = {path_off, b->entries.len / (uint32_t)sizeof(idx_entry_t), 0};
+        const idx_dir_t *od = old_find_dir(old, rel);
+
+        // Every file is stat()ed, even in a folder whose mtime and names are unchanged: FAT does not
+        // touch the folder when a file is rewritten in place (upload and save open it with "wb").
+        for (uint32_t i = 0; i < file_count && !b->oom; i++) {
+            if (d.first + i >= MEDIA_INDEX_MAX_ENTRIES) {
+                break;
+            }
+            const char *name = names + files[i];
+            char path[300];
+            snprintf(path, sizeof(path), "%s/%s", full, name);
+            struct stat fst;
+            if (stat(path, &fst) != 0) {
+                continue;
+            }
+            const idx_entry_t *oe = od ? old_find_entry(old, od, name) : nullptr;
+            if (oe && oe->size == (uint32_t)fst.st_size && oe->mtime == (uint32_t)fst.st_mtime) {
+                add_old_entry(b, old, oe, (uint16_t)dir_count);
+            } else {
+                add_new_entry(b, path, name, &fst, (uint16_t)dir_count);
+            }
+        }
+        d.count = b->entries.len / (uint32_t)sizeof(idx_entry_t) - d.first;
+        if (!buf_append(&b->dirs, &d, sizeof(d))) b->oom = true;
+    }
+
+    const uint32_t *subdirs = (const uint32_t *)ls.subdirs.p;
+    for (uint32_t i = 0; i < ls.subdirs.len / sizeof(uint32_t) && !b->oom; i++) {
+        char sub[256];
+        const int n = snprintf(sub, sizeof(sub), "%s%s%s", rel, rel[0] ? "/" : "", names + subdirs[i]);
+        if (n > 0 && n < (int)sizeof(sub)) {
+            const uint32_t off = intern(b, sub);
+            if (!buf_append(todo, &off, sizeof(off))) b->oom = true;
+        }
+    }
+    buf_free(&ls.names);
+    buf_free(&ls.files);
+    buf_free(&ls.subdirs);
+}
+
+static uint32_t path_depth(const char *rel)
+{
+    uint32_t d = rel[0] ? 1 : 0;
+    for (; *rel; rel++) {
+        if (*rel == '/') d++;
+    }
+    return d;
+}
+
+// Lays the walk result out as an index file image: sorted tables and the precomputed orders.
+static idx_db_t *builder_finish(builder_t *b)
+{
+    const char *str = (const char *)b->strings.p;
+    const idx_dir_t *wdirs = (const idx_dir_t *)b->dirs.p;
+    const idx_entry_t *wentries = (const idx_entry_t *)b->entries.p;
+    const uint32_t dir_count = b->dirs.len / sizeof(idx_dir_t);
+    const uint32_t entry_count = b->entries.len / sizeof(idx_entry_t);
+
+    const uint32_t len = sizeof(idx_header_t) + dir_count * sizeof(idx_dir_t) +
+                         entry_count * (sizeof(idx_entry_t) + MEDIA_SORT_COUNT * sizeof(uint32_t)) + b->strings.len;
+    uint8_t *blob = (uint8_t *)heap_caps_calloc(1, len, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    uint16_t *dir_perm = (uint16_t *)heap_caps_malloc(dir_count * sizeof(uint16_t) + 1, MALLOC_CAP_SPIRAM);
+    uint16_t *dir_rank = (uint16_t *)heap_caps_malloc(dir_count * sizeof(uint16_t) + 1, MALLOC_CAP_SPIRAM);
+    if (!blob || !dir_perm || !dir_rank) {
+        heap_caps_free(blob);
+        heap_caps_free(dir_perm);
+        heap_caps_free(dir_rank);
+        return nullptr;
+    }
+
+    idx_header_t *h = (idx_header_t *)blob;
+    h->magic = MEDIA_INDEX_MAGIC;
+    h->version = MEDIA_INDEX_VERSION;
+    h->dir_count = dir_count;
+    h->entry_count = entry_count;
+    h->strings_len = b->strings.len;
+    idx_dir_t *dirs = (idx_dir_t *)(blob + sizeof(idx_header_t));
+    idx_entry_t *entries = (idx_entry_t *)(dirs + dir_count);
+    uint32_t *order = (uint32_t *)(entries + entry_count);
+    memcpy(order + MEDIA_SORT_COUNT * entry_count, str, b->strings.len);
+
+    // Dirs by strcmp for lookups; entries are already sorted by name within each dir.
+    for (uint32_t i = 0; i < dir_count; i++) dir_perm[i] = (uint16_t)i;
+    std::sort(dir_perm, dir_perm + dir_count,
+              [&](uint16_t x, uint16_t y) { return strcmp(str + wdirs[x].path, str + wdirs[y].path) < 0; });
+    uint32_t e = 0;
+    for (uint32_t i = 0; i < dir_count; i++) {
+        const idx_dir_t &src = wdirs[dir_perm[i]];
+        dirs[i] = src;
+        dirs[i].first = e;
+        for (uint32_t k = 0; k < src.count; k++) {
+            entries[e] = wentries[src.first + k];
+            entries[e].dir = (uint16_t)i;
+            e++;
+        }
+    }
+
+    // Natural rank of each dir path, for the path order.
+    for (uint32_t i = 0; i < dir_count; i++) dir_perm[i] = (uint16_t)i;
+    std::sort(dir_perm, dir_perm + dir_count, [&](uint16_t x, uint16_t y) {
+        return media_index_name_cmp(str + dirs[x].path, str + dirs[y].path) < 0;
+    });
+    for (uint32_t i = 0; i < dir_count; i++) dir_rank[dir_perm[i]] = (uint16_t)i;
+
+    auto by_path = [&](uint32_t x, uint32_t y) {
+        if (entries[x].dir != entries[y].dir) return dir_rank[entries[x].dir] < dir_rank[entries[y].dir];
+        return media_index_name_cmp(str + entries[x].name, str + entries[y].name) < 0;
+    };
+    auto title_of = [&](uint32_t x) { return str + (entries[x].title ? entries[x].title : entries[x].name); };
+    for (uint32_t s = 0; s < MEDIA_SORT_COUNT; s++) {
+        uint32_t *o = order + s * entry_count;
+        for (uint32_t i = 0; i < entry_count; i++) o[i] = i;
+    }
+    std::sort(order, order + entry_count, by_path);
+    // The other orders start from the path order so ties stay in path order.
+    for (uint32_t s = 1; s < MEDIA_SORT_COUNT; s++) {
+        memcpy(order + s * entry_count, order, entry_count * sizeof(uint32_t));
+    }
+    std::stable_sort(order + MEDIA_SORT_DATE * entry_count, order + (MEDIA_SORT_DATE + 1) * entry_count,
+                     [&](uint32_t x, uint32_t y) { return entries[x].mtime > entries[y].mtime; });
+    std::stable_sort(order + MEDIA_SORT_TITLE * entry_count, order + (MEDIA_SORT_TITLE + 1) * entry_count,
+                     [&](uint32_t x, uint32_t y) { return media_index_name_cmp(title_of(x), title_of(y)) < 0; });
+    std::stable_sort(order + MEDIA_SORT_ARTIST * entry_count, order + (MEDIA_SORT_ARTIST + 1) * entry_count,
+                     [&](uint32_t x, uint32_t y) {
+                         const idx_entry_t &a = entries[x];
+                         const idx_entry_t &c = entries[y];
+                         if (!a.artist != !c.artist) return a.artist != 0; // untagged last
+                         const int r = media_index_name_cmp(str + a.artist, str + c.artist);
+                         if (r != 0) return r < 0;
+                         return media_index_name_cmp(str + a.album, str + c.album) < 0;
+                     });
+
+    heap_caps_free(dir_perm);
+    heap_caps_free(dir_rank);
+    return db_from_blob(blob, len);
+}
+
+static bool db_save(const idx_db_t *db)
+{
+    mkdir(MEDIA_INDEX_DIR, 0775);
+    FILE *f = fopen(MEDIA_INDEX_TMP, "wb");
+    if (!f) {
+        return false;
+    }
+    const bool ok = fwrite(db->blob, 1, db->blob_len, f) == db->blob_len;
+    fclose(f);
+    // FATFS rename does not replace an existing file.
+    unlink(MEDIA_INDEX_FILE);
+    return ok && rename(MEDIA_INDEX_TMP, MEDIA_INDEX_FILE) == 0;
+}
+
+// ---- Publishing ----
+
+static void on_publish(void *p)
+{
+    idx_db_t *db = (idx_db_t *)p;
+    db_free(s_db);
+    s_db = db;
+    for (const subscriber_t &s : s_subscribers) {
+        if (s.cb) s.cb(s.user_data);
+    }
+}
+
+// Hands db (NULL withdraws the index) to the LVGL task. The worker may keep reading it until it
+// publishes the next one: the LVGL task frees an index only when its successor arrives.
+static bool publish(idx_db_t *db)
+{
+    return display_lvgl_async_call(on_publish, db) == ESP_OK;
+}
+
+static idx_db_t *scan(const idx_db_t *old)
+{
+    const int64_t t0 = esp_timer_get_time();
+    builder_t b = {};
+    buf_t todo = {};
+    const char nul = '\0';
+    buf_append(&b.strings, &nul, 1);
+    uint32_t root = 0;
+    b.oom = !buf_append(&todo, &root, sizeof(root));
+
+    // Breadth-first; `todo` grows while it is walked.
+    for (uint32_t i = 0; i < todo.len / sizeof(uint32_t) && !b.oom; i++) {
+        const uint32_t path = ((const uint32_t *)todo.p)[i];
+        if (path_depth((const char *)b.strings.p + path) <= MEDIA_INDEX_MAX_DEPTH) {
+            walk_dir(&b, old, path, &todo);
+        }
+    }
+    buf_free(&todo);
+
+    idx_db_t *db = b.oom ? nullptr : builder_finish(&b);
+    if (db) {
+        ESP_LOGI(TAG, "%u files in %u folders in %u ms (%u read, %u unchanged), %u KB", (unsigned)db->hdr->entry_count,
+                 (unsigned)db->hdr->dir_count, (unsigned)((esp_timer_get_time() - t0) / 1000), (unsigned)b.probed,
+                 (unsigned)b.reused, (unsigned)(db->blob_len / 1024));
+    } else {
+        ESP_LOGW(TAG, "out of memory, index not updated");
+    }
+    builder_free(&b);
+    return db;
+}
+
+static void index_task(void *)
+{
+    do {
+        s_rescan.store(false);
+        if (s_remounted.exchange(false)) {
+            // The last card's index must neither stay on screen nor seed this card's scan: the same
+            // path, size and mtime can be a different file. Lists fall back to folders until the
+            // saved index or the scan arrives. Whatever the LVGL task holds is freed on the next publish.
+            if (s_published) {
+                publish(nullptr);
+                s_published = nullptr;
+            }
+            idx_db_t *saved = db_load();
+            if (saved) {
+                ESP_LOGI(TAG, "loaded %u files from %s", (unsigned)saved->hdr->entry_count, MEDIA_INDEX_FILE);
+                if (publish(saved)) {
+                    s_published = saved;
+                } else {
+                    db_free(saved);
+                }
+            }
+        }
+        idx_db_t *db = scan(s_published);
+        if (!db) {
+            continue;
+        }
+        if (s_remounted.load()) {
+            db_free(db); // the card changed under the scan
+            continue;
+        }
+        if (s_published && db->blob_len == s_published->blob_len &&
+            memcmp(db->blob, s_published->blob, db->blob_len) == 0) {
+            db_free(db);
+            continue;
+        }
+        if (!db_save(db)) {
+            ESP_LOGW(TAG, "cannot write %s", MEDIA_INDEX_FILE);
+        }
+        if (publish(db)) {
+            s_published = db;
+        } else {
+            db_free(db);
+        }
+    } while (s_rescan.load());
+    s_running.store(false);
+    vTaskDelete(NULL);
+}
+
+// ---- API ----
+
+void media_index_start(void)
+{
+    s_remounted.store(true);
+    s_rescan.store(true);
+    if (s_running.exchange(true)) {
+        return;
+    }
+    if (xTaskCreatePinnedToCore(index_task, "media_index", MEDIA_INDEX_TASK_STACK_SIZE, NULL,
+                                MEDIA_INDEX_TASK_PRIORITY, NULL, MEDIA_INDEX_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "failed to create task");
+        s_running.store(false);
+    }
+}
+
+bool media_index_ready(void)
+{
+    return s_db != nullptr;
+}
+
+uint32_t media_index_query(uint8_t kinds, media_sort_t sort, media_index_visit_t visit, void *user_data)
+{
+    if (!s_db || !visit || sort >= MEDIA_SORT_COUNT) {
+        return 0;
+    }
+    const idx_db_t *db = s_db;
+    const uint32_t count = db->hdr->entry_count;
+    const uint32_t *order = db->order + (uint32_t)sort * count;
+    uint32_t visited = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const idx_entry_t &e = db->entries[order[i]];
+        if (!(e.kind & kinds)) {
+            continue;
+        }
+        const char *dir = db->strings + db->dirs[e.dir].path;
+        char path[300];
+        snprintf(path, sizeof(path), "%s%s%s", dir, dir[0] ? "/" : "", db->strings + e.name);
+        media_index_entry_t out;
+        out.path = path;
+        out.title = db->strings + e.title;
+        out.artist = db->strings + e.artist;
+        out.album = db->strings + e.album;
+        out.size = e.size;
+        out.mtime = e.mtime;
+        out.duration_ms = e.duration_ms;
+        out.width = e.width;
+        out.height = e.height;
+        out.kind = e.kind;
+        visited++;
+        if (!visit(&out, user_data)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+bool media_index_subscribe(media_index_cb_t cb, void *user_data)
+{
+    for (subscriber_t &s : s_subscribers) {
+        if (!s.cb) {
+            s.cb = cb;
+            s.user_data = user_data;
+            return true;
+        }
+    }
+    return false;
+}
+
+void media_index_unsubscribe(media_index_cb_t cb, void *user_data)
+{
+    for (subscriber_t &s : s_subscribers) {
+        if (s.cb == cb && s.user_data == user_data) {
+            s.cb = nullptr;
+            s.user_data = nullptr;
+        }
+    }
+}
@@ -0,0 +1,185 @@
+#include "mp3_input.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "block_cache.h"
+
+static const char *TAG = "mp3_input";
+
+// Tail kept when a view holds no frame: the largest (free-format) frame plus its header.
+#define MP3_INPUT_KEEP (2304 + 4)
+#define ID3V2_HEADER_SIZE 10
+
+struct mp3_input {
+    block_cache_file_t *file;
+    uint8_t *buf;  // ring + MP3_INPUT_MIRROR
+    size_t block;  // slot size: the block cache's block size, so reads bypass its pool
+    size_t ring;   // MP3_INPUT_SLOTS * block
+    size_t rd;     // read offset in the ring
+    size_t avail;  // unread bytes from rd, wrapping
+    bool eof;      // the file has been read to its end
+    mp3_input_stats_t stats;
+};
+
+// Reads the next block into the free slot at the write offset. Every read but the last returns a
+// whole block, so the write offset stays slot-aligned.
+static void fill_slot(mp3_input_t *in)
+{
+    const size_t wr = (in->rd + in->avail) % in->ring;
+    const int64_t t0 = esp_timer_get_time();
+    const size_t got = block_cache_read(in->file, in->buf + wr, in->block);
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    in->stats.refills++;
+    in->stats.refill_bytes += got;
+    in->stats.refill_us += us;
+    if (us > in->stats.refill_us_max) {
+        in->stats.refill_us_max = us;
+    }
+    if (got < in->block) {
+        in->eof = true;
+    }
+    if (wr == 0 && got) {
+        const size_t n = got < MP3_INPUT_MIRROR ? got : MP3_INPUT_MIRROR;
+        memcpy(in->buf + in->ring, in->buf, n);
+        in->stats.bytes_copied += n;
+    }
+    in->avail += got;
+}
+
+static void refill(mp3_input_t *in)
+{
+    while (!in->eof && in->ring - in->avail >= in->block) {
+        fill_slot(in);
+    }
+}
+
+static void advance(mp3_input_t *in, size_t n)
+{
+    if (n > in->avail) {
+        n = in->avail;
+    }
+    in->rd = (in->rd + n) % in->ring;
+    in->avail -= n;
+}
+
+static uint32_t id3v2_size(const uint8_t *h)
+{
+    if (memcmp(h, "ID3", 3) != 0 || ((h[6] | h[7] | h[8] | h[9]) & 0x80)) {
+        return 0;
+    }
+    uint32_t size = ((uint32_t)h[6] << 21) | ((uint32_t)h[7] << 14) | ((uint32_t)h[8] << 7) | h[9];
+    size += ID3V2_HEADER_SIZE;
+    if (h[5] & 0x10) {
+        size += ID3V2_HEADER_SIZE; // footer
+    }
+    return size;
+}
+
+// Skips a leading ID3v2 tag: from the first block if it ends there, else by seeking to the block
+// that holds the tag's end, so the tag itself is never read.
+static void skip_id3v2(mp3_input_t *in)
+{
+    if (in->avail < ID3V2_HEADER_SIZE) {
+        return;
+    }
+    const uint32_t size = id3v2_size(in->buf);
+    if (!size) {
+        return;
+    }
+    in->stats.bytes_skipped += size;
+    if (size <= in->avail) {
+        advance(in, size);
+        return;
+    }
+    const uint32_t aligned = size & ~(uint32_t)(in->block - 1);
+    in->rd = 0;
+    in->avail = 0;
+    in->eof = false;
+    if (!block_cache_seek(in->file, (int32_t)aligned, SEEK_SET)) {
+        in->eof = true;
+        return;
+    }
+    fill_slot(in);
+    advance(in, size - aligned);
+}
+
+mp3_input_t *mp3_input_open(const char *path)
+{
+    mp3_input_t *in = (mp3_input_t *)calloc(1, sizeof(*in));
+    if (!in) {
+        return NULL;
+    }
+    const block_cache_config_t cache_cfg = BLOCK_CACHE_DEFAULT_CONFIG();
+    in->block = cache_cfg.block_size;
+    in->ring = MP3_INPUT_SLOTS * in->block;
+    in->buf = (uint8_t *)heap_caps_malloc(in->ring + MP3_INPUT_MIRROR, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!in->buf) {
+        in->buf = (uint8_t *)malloc(in->ring + MP3_INPUT_MIRROR);
+    }
+    in->file = in->buf ? block_cache_open(path) : NULL;
+    if (!in->file) {
+        ESP_LOGW(TAG, "Cannot open %s (%s)", path, in->buf ? "file" : "no memory");
+        free(in->buf);
+        free(in);
+        return NULL;
+    }
+
+    fill_slot(in);
+    skip_id3v2(in);
+    refill(in);
+    return in;
+}
+
+void mp3_input_close(mp3_input_t *in)
+{
+    if (!in) {
+        return;
+    }
+    block_cache_close(in->file);
+    free(in->buf);
+    free(in);
+}
+
+const uint8_t *mp3_input_peek(mp3_input_t *in, size_t *len)
+{
+    if (!in->eof && in->ring - in->avail >= in->block) {
+        if (in->avail < MP3_INPUT_MIRROR) {
+            in->stats.stalls++;
+        }
+        refill(in);
+    }
+    // Past the end of the ring the mirror continues with slot 0.
+    const size_t contiguous = in->ring + MP3_INPUT_MIRROR - in->rd;
+    *len = in->avail < contiguous ? in->avail : contiguous;
+    return in->buf + in->rd;
+}
+
+void mp3_input_consume(mp3_input_t *in, size_t n)
+{
+    advance(in, n);
+    in->stats.bytes_consumed += n;
+}
+
+void mp3_input_skip_garbage(mp3_input_t *in, size_t len)
+{
+    size_t n = len;
+    if (!in->eof || len < in->avail) {
+        n = len > MP3_INPUT_KEEP ? len - MP3_INPUT_KEEP : 1;
+    }
+    advance(in, n);
+    in->stats.bytes_skipped += n;
+}
+
+void mp3_input_get_stats(const mp3_input_t *in, mp3_input_stats_t *out)
+{
+    if (out) {
+        *out = in->stats;
+    }
+}
@@ -0,0 +1,191 @@
+#include "pcm_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <new>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+#define PCM_RING_CHANNELS 2
+
+struct pcm_ring {
+    int16_t *buf;
+    uint32_t cap; // frames
+    // Positions run over 0..2*cap-1 so that a full ring (wr - rd == cap) differs from an empty one.
+    std::atomic<uint32_t> wr;
+    std::atomic<uint32_t> rd;
+    std::atomic<bool> closed;
+
+    // Producer-owned.
+    bool full;
+    uint64_t frames_in;
+    uint32_t producer_waits;
+
+    // Consumer-owned.
+    bool started;
+    bool starved;
+    uint64_t frames_out;
+    uint32_t underruns;
+    uint32_t min_fill;
+    uint32_t fill_hist[PCM_RING_FILL_BUCKETS];
+};
+
+static uint32_t fill_between(const pcm_ring_t *r, uint32_t wr, uint32_t rd)
+{
+    return wr >= rd ? wr - rd : wr + 2 * r->cap - rd;
+}
+
+static uint32_t advance(const pcm_ring_t *r, uint32_t pos, uint32_t frames)
+{
+    pos += frames;
+    return pos >= 2 * r->cap ? pos - 2 * r->cap : pos;
+}
+
+pcm_ring_t *pcm_ring_create(uint32_t frames)
+{
+    if (frames == 0 || frames > UINT32_MAX / 4) {
+        return NULL;
+    }
+    pcm_ring_t *r = new (std::nothrow) pcm_ring_t();
+    if (!r) {
+        return NULL;
+    }
+    const size_t bytes = (size_t)frames * PCM_RING_CHANNELS * sizeof(int16_t);
+#ifdef ESP_PLATFORM
+    r->buf = (int16_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!r->buf) {
+        r->buf = (int16_t *)malloc(bytes);
+    }
+#else
+    r->buf = (int16_t *)malloc(bytes);
+#endif
+    if (!r->buf) {
+        delete r;
+        return NULL;
+    }
+    r->cap = frames;
+    r->min_fill = frames;
+    return r;
+}
+
+void pcm_ring_destroy(pcm_ring_t *r)
+{
+    if (!r) {
+        return;
+    }
+    free(r->buf);
+    delete r;
+}
+
+uint32_t pcm_ring_capacity(const pcm_ring_t *r)
+{
+    return r->cap;
+}
+
+uint32_t pcm_ring_fill(const pcm_ring_t *r)
+{
+    return fill_between(r, r->wr.load(), r->rd.load());
+}
+
+uint32_t pcm_ring_write(pcm_ring_t *r, const int16_t *pcm, uint32_t frames)
+{
+    const uint32_t wr = r->wr.load();
+    const uint32_t space = r->cap - fill_between(r, wr, r->rd.load());
+    if (frames > space) {
+        if (!r->full) {
+            r->producer_waits++;
+        }
+        r->full = true;
+        frames = space;
+    } else {
+        r->full = false;
+    }
+    if (frames == 0) {
+        return 0;
+    }
+
+    const uint32_t at = wr % r->cap;
+    const uint32_t first = frames < r->cap - at ? frames : r->cap - at;
+    memcpy(r->buf + (size_t)at * PCM_RING_CHANNELS, pcm, (size_t)first * PCM_RING_CHANNELS * sizeof(int16_t));
+    if (first < frames) {
+        memcpy(r->buf, pcm + (size_t)first * PCM_RING_CHANNELS,
+               (size_t)(frames - first) * PCM_RING_CHANNELS * sizeof(int16_t));
+    }
+    r->frames_in += frames;
+    r->wr.store(advance(r, wr, frames)); // publishes the copied frames
+    return frames;
+}
+
+void pcm_ring_close(pcm_ring_t *r)
+{
+    r->closed.store(true);
+}
+
+bool pcm_ring_is_closed(const pcm_ring_t *r)
+{
+    return r->closed.load();
+}
+
+void pcm_ring_reset(pcm_ring_t *r)
+{
+    r->wr.store(0);
+    r->rd.store(0);
+    r->closed.store(false);
+    r->full = false;
+    r->started = false;
+    r->starved = false;
+}
+
+const int16_t *pcm_ring_peek(pcm_ring_t *r, uint32_t *frames)
+{
+    const uint32_t rd = r->rd.load();
+    const uint32_t fill = fill_between(r, r->wr.load(), rd);
+    if (fill == 0) {
+        if (r->started && !r->starved && !r->closed.load()) {
+            r->underruns++;
+            r->starved = true;
+        }
+        *frames = 0;
+        return NULL;
+    }
+    r->started = true;
+    r->starved = false;
+
+    const uint32_t at = rd % r->cap;
+    *frames = fill < r->cap - at ? fill : r->cap - at;
+    return r->buf + (size_t)at * PCM_RING_CHANNELS;
+}
+
+void pcm_ring_release(pcm_ring_t *r, uint32_t frames)
+{
+    const uint32_t rd = r->rd.load();
+    const uint32_t fill = fill_between(r, r->wr.load(), rd);
+    if (frames > fill) {
+        frames = fill;
+    }
+    uint32_t bucket = (uint32_t)((uint64_t)fill * PCM_RING_FILL_BUCKETS / r->cap);
+    bucket = bucket < PCM_RING_FILL_BUCKETS ? bucket : PCM_RING_FILL_BUCKETS - 1;
+    r->fill_hist[bucket]++;
+    if (fill < r->min_fill) {
+        r->min_fill = fill;
+    }
+    r->frames_out += frames;
+    r->rd.store(advance(r, rd, frames)); // hands the space back to the producer
+}
+
+void pcm_ring_get_stats(const pcm_ring_t *r, pcm_ring_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    out->frames_in = r->frames_in;
+    out->frames_out = r->frames_out;
+    out->underruns = r->underruns;
+    out->producer_waits = r->producer_waits;
+    out->min_fill = r->min_fill;
+    memcpy(out->fill_hist, r->fill_hist, sizeof(out->fill_hist));
+}
@@ -0,0 +1,406 @@
+#include "screen_mirror.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "app_pins.h"
+#include "display_lvgl.h"
+
+static const char *TAG = "mirror";
+
+#define SCREEN_MIRROR_MAX_FPS 15
+#define SCREEN_MIRROR_DEFAULT_BPS (512 * 1024)
+// At most this much unspent budget carries over, so an idle screen cannot save up for a long burst.
+#define SCREEN_MIRROR_BURST_MS 250
+#define SCREEN_MIRROR_MAX_DIRTY 16
+// Rectangles are sent in bands of at most this many pixels, which bounds the message buffers.
+#define SCREEN_MIRROR_BAND_PX (APP_LCD_H_RES * 16)
+#define SCREEN_MIRROR_HDR_BYTES 10
+#define SCREEN_MIRROR_TASK_STACK_SIZE 4096
+#define SCREEN_MIRROR_TASK_PRIORITY 1
+#define SCREEN_MIRROR_TASK_CORE 0
+
+#define FRAME_PX ((size_t)APP_LCD_H_RES * APP_LCD_V_RES)
+
+// s_mux guards everything below except the pixels of s_frame, which the sender reads unlocked
+// (a torn read is followed by a dirty mark and a resend) and the sender-owned buffers.
+static std::mutex s_mux;
+static std::atomic<bool> s_active{false};
+static bool s_running = false; // sender task alive
+static lv_color_t *s_frame = nullptr;
+static lv_area_t s_dirty[SCREEN_MIRROR_MAX_DIRTY];
+static int s_dirty_count = 0;
+static bool s_hello_pending = false;
+static lv_area_t s_encoding = {0, 0, -1, -1};
+static screen_mirror_config_t s_cfg = {};
+static screen_mirror_stats_t s_stats = {};
+
+// Sender task only.
+static uint16_t *s_band = nullptr; // one band as little-endian RGB565
+static uint8_t *s_msg = nullptr;
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void dirty_add_locked(const lv_area_t *a)
+{
+    lv_area_t grown;
+    for (int i = 0; i < s_dirty_count; i++) {
+        lv_area_t *d = &s_dirty[i];
+        if (_lv_area_is_in(a, d, 0)) {
+            return;
+        }
+        // Stripes of one refresh arrive as vertically adjacent bands of the same width.
+        if (d->x1 == a->x1 && d->x2 == a->x2 && a->y1 <= d->y2 + 1 && a->y2 + 1 >= d->y1) {
+            _lv_area_join(&grown, d, a);
+            *d = grown;
+            return;
+        }
+    }
+    if (s_dirty_count < SCREEN_MIRROR_MAX_DIRTY) {
+        s_dirty[s_dirty_count++] = *a;
+        return;
+    }
+    // Full: fold it into the rectangle whose bounding box grows least.
+    int best = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for (int i = 0; i < s_dirty_count; i++) {
+        _lv_area_join(&grown, &s_dirty[i], a);
+        const uint32_t growth = lv_area_get_size(&grown) - lv_area_get_size(&s_dirty[i]);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    _lv_area_join(&grown, &s_dirty[best], a);
+    s_dirty[best] = grown;
+}
+
+void screen_mirror_tap(const lv_area_t *area, const lv_color_t *color_map)
+{
+#if LV_COLOR_DEPTH == 16
+    if (!s_active.load(std::memory_order_relaxed) || !area || !color_map) {
+        return;
+    }
+    const lv_area_t screen = {0, 0, APP_LCD_H_RES - 1, APP_LCD_V_RES - 1};
+    lv_area_t a;
+    if (!_lv_area_intersect(&a, area, &screen)) {
+        return;
+    }
+    const int src_w = lv_area_get_width(area);
+    const size_t row_bytes = (size_t)lv_area_get_width(&a) * sizeof(lv_color_t);
+
+    std::lock_guard<std::mutex> lock(s_mux);
+    if (!s_frame) {
+        return;
+    }
+    for (int y = a.y1; y <= a.y2; y++) {
+        memcpy(&s_frame[(size_t)y * APP_LCD_H_RES + a.x1],
+               &color_map[(size_t)(y - area->y1) * src_w + (a.x1 - area->x1)], row_bytes);
+    }
+    dirty_add_locked(&a);
+    lv_area_t overlap;
+    if (_lv_area_intersect(&overlap, &a, &s_encoding)) {
+        s_stats.resent_px += lv_area_get_size(&overlap);
+    }
+#else
+    (void)area;
+    (void)color_map;
+#endif
+}
+
+// ---- Sender task ----
+
+// Same scheme as rle_unpack() in assets.cpp, on 16-bit pixels. Returns the payload size, or 0 when
+// it would not fit in cap bytes.
+static size_t rle_encode(const uint16_t *px, size_t n, uint8_t *out, size_t cap)
+{
+    size_t o = 0;
+    size_t i = 0;
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < 128 && px[i + run] == px[i]) {
+            run++;
+        }
+        if (run > 1) {
+            if (o + 3 > cap) {
+                return 0;
+            }
+            out[o] = (uint8_t)(run - 1);
+            put16(&out[o + 1], px[i]);
+            o += 3;
+            i += run;
+            continue;
+        }
+        const size_t start = i;
+        while (i < n && i - start < 128 && !(i + 1 < n && px[i + 1] == px[i])) {
+            i++;
+        }
+        const size_t lit = i - start;
+        if (o + 1 + lit * 2 > cap) {
+            return 0;
+        }
+        out[o++] = (uint8_t)(0x80 | (lit - 1));
+        for (size_t k = start; k < i; k++, o += 2) {
+            put16(&out[o], px[k]);
+        }
+    }
+    return o;
+}
+
+// Encodes rows y1..y2 of a's columns into s_msg. Returns the message size.
+static size_t encode_band(const lv_area_t *a, int y1, int y2)
+{
+    const int w = lv_area_get_width(a);
+    const size_t n = (size_t)w * (size_t)(y2 - y1 + 1);
+    size_t k = 0;
+    for (int y = y1; y <= y2; y++) {
+        const lv_color_t *row = &s_frame[(size_t)y * APP_LCD_H_RES + a->x1];
+        for (int x = 0; x < w; x++) {
+            uint16_t c = row[x].full;
+#if LV_COLOR_16_SWAP
+            c = (uint16_t)((c << 8) | (c >> 8));
+#endif
+            s_band[k++] = c;
+        }
+    }
+
+    uint8_t *hdr = s_msg;
+    uint8_t *payload = s_msg + SCREEN_MIRROR_HDR_BYTES;
+    size_t len = rle_encode(s_band, n, payload, n * 2 - 1);
+    hdr[0] = 'R';
+    hdr[1] = SCREEN_MIRROR_CODEC_RLE;
+    if (len == 0) {
+        hdr[1] = SCREEN_MIRROR_CODEC_RAW;
+        for (size_t i = 0; i < n; i++) {
+            put16(&payload[i * 2], s_band[i]);
+        }
+        len = n * 2;
+    }
+    put16(&hdr[2], (uint16_t)a->x1);
+    put16(&hdr[4], (uint16_t)y1);
+    put16(&hdr[6], (uint16_t)w);
+    put16(&hdr[8], (uint16_t)(y2 - y1 + 1));
+    return SCREEN_MIRROR_HDR_BYTES + len;
+}
+
+static void mirror_task(void *)
+{
+    const screen_mirror_config_t cfg = s_cfg;
+    const int64_t bps = cfg.max_bytes_per_s;
+    const int64_t burst = bps * SCREEN_MIRROR_BURST_MS / 1000;
+    int64_t budget = burst;
+    int64_t last_us = esp_timer_get_time();
+    bool ok = true;
+
+    while (ok && s_active.load()) {
+        vTaskDelay(pdMS_TO_TICKS(1000 / SCREEN_MIRROR_MAX_FPS));
+        const int64_t now_us = esp_timer_get_time();
+        budget = std::min(burst, budget + (now_us - last_us) * bps / 1000000);
+        last_us = now_us;
+
+        lv_area_t todo[SCREEN_MIRROR_MAX_DIRTY];
+        int n;
+        bool hello;
+        {
+            std::lock_guard<std::mutex> lock(s_mux);
+            if (budget <= 0) {
+                if (s_dirty_count > 0) {
+                    s_stats.throttled++;
+                }
+                continue;
+            }
+            n = s_dirty_count;
+            memcpy(todo, s_dirty, sizeof(lv_area_t) * (size_t)n);
+            s_dirty_count = 0;
+            hello = s_hello_pending;
+            s_hello_pending = false;
+        }
+        if (n == 0 && !hello) {
+            continue;
+        }
+
+        uint32_t messages = 0;
+        uint64_t bytes = 0;
+        uint64_t raw_bytes = 0;
+        if (hello) {
+            const uint8_t msg[6] = {'H', SCREEN_MIRROR_VERSION, (uint8_t)APP_LCD_H_RES, (uint8_t)(APP_LCD_H_RES >> 8),
+                                    (uint8_t)APP_LCD_V_RES, (uint8_t)(APP_LCD_V_RES >> 8)};
+            ok = cfg.sink(msg, sizeof(msg), cfg.ctx);
+            messages++;
+            bytes += sizeof(msg);
+        }
+        int i = 0;
+        while (ok && i < n && budget > 0) {
+            lv_area_t *a = &todo[i];
+            const int rows = std::max(1, SCREEN_MIRROR_BAND_PX / lv_area_get_width(a));
+            while (ok && a->y1 <= a->y2 && budget > 0) {
+                const int y2 = std::min<int>(a->y2, a->y1 + rows - 1);
+                {
+                    std::lock_guard<std::mutex> lock(s_mux);
+                    s_encoding = {a->x1, (lv_coord_t)a->y1, a->x2, (lv_coord_t)y2};
+                }
+                const size_t len = encode_band(a, a->y1, y2);
+                ok = cfg.sink(s_msg, len, cfg.ctx);
+                budget -= (int64_t)len;
+                messages++;
+                bytes += len;
+                raw_bytes += (uint64_t)lv_area_get_width(a) * (uint64_t)(y2 - a->y1 + 1) * 2;
+                a->y1 = (lv_coord_t)(y2 + 1);
+            }
+            if (a->y1 > a->y2) {
+                i++;
+            }
+        }
+        if (ok && n > 0) {
+            const uint8_t msg = 'F';
+            ok = cfg.sink(&msg, 1, cfg.ctx);
+            messages++;
+            bytes++;
+        }
+
+        std::lock_guard<std::mutex> lock(s_mux);
+        s_encoding = {0, 0, -1, -1};
+        // What the budget did not cover waits for the next pass, merged with anything newer.
+        for (int j = i; j < n; j++) {
+            dirty_add_locked(&todo[j]);
+        }
+        if (i < n) {
+            s_stats.throttled++;
+        }
+        s_stats.messages += messages;
+        s_stats.bytes += bytes;
+        s_stats.raw_bytes += raw_bytes;
+        s_stats.frames++;
+    }
+
+    s_active.store(false);
+    screen_mirror_stats_t st;
+    {
+        std::lock_guard<std::mutex> lock(s_mux);
+        heap_caps_free(s_frame);
+        heap_caps_free(s_band);
+        heap_caps_free(s_msg);
+        s_frame = nullptr;
+        s_band = nullptr;
+        s_msg = nullptr;
+        s_dirty_count = 0;
+        st = s_stats;
+    }
+    ESP_LOGI(TAG, "session ended: %u frames, %u KB sent for %u KB of pixels, %u throttled passes, %u px resent",
+             (unsigned)st.frames, (unsigned)(st.bytes / 1024), (unsigned)(st.raw_bytes / 1024), (unsigned)st.throttled,
+             (unsigned)st.resent_px);
+    // s_running stays set until on_stop returns, so it can only ever see this session end: a new
+    // one cannot start (and hand out new buffers or a new viewer) before that.
+    if (cfg.on_stop) {
+        cfg.on_stop(cfg.ctx);
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_mux);
+        s_running = false;
+    }
+    vTaskDelete(NULL);
+}
+
+// ---- Public API ----
+
+static void invalidate_screen(void *)
+{
+    const lv_area_t screen = {0, 0, APP_LCD_H_RES - 1, APP_LCD_V_RES - 1};
+    _lv_inv_area(lv_disp_get_default(), &screen);
+}
+
+esp_err_t screen_mirror_start(const screen_mirror_config_t *cfg)
+{
+#if LV_COLOR_DEPTH != 16
+    (void)cfg;
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    if (!cfg || !cfg->sink) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_mux);
+        if (s_running) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        const size_t msg_bytes = SCREEN_MIRROR_HDR_BYTES + SCREEN_MIRROR_BAND_PX * 2;
+        s_frame = (lv_color_t *)heap_caps_malloc(FRAME_PX * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_band = (uint16_t *)heap_caps_malloc(SCREEN_MIRROR_BAND_PX * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_msg = (uint8_t *)heap_caps_malloc(msg_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        s_cfg = *cfg;
+        if (s_cfg.max_bytes_per_s == 0) {
+            s_cfg.max_bytes_per_s = SCREEN_MIRROR_DEFAULT_BPS;
+        }
+        s_dirty_count = 0;
+        s_hello_pending = true;
+        s_stats = {};
+        s_running = s_frame && s_band && s_msg;
+        s_active.store(s_running);
+        if (!s_running || xTaskCreatePinnedToCore(mirror_task, "mirror", SCREEN_MIRROR_TASK_STACK_SIZE, NULL,
+                                                  SCREEN_MIRROR_TASK_PRIORITY, NULL,
+                                                  SCREEN_MIRROR_TASK_CORE) != pdPASS) {
+            const esp_err_t err = s_running ? ESP_FAIL : ESP_ERR_NO_MEM;
+            s_active.store(false);
+            s_running = false;
+            heap_caps_free(s_frame);
+            heap_caps_free(s_band);
+            heap_caps_free(s_msg);
+            s_frame = nullptr;
+            s_band = nullptr;
+            s_msg = nullptr;
+            ESP_LOGE(TAG, "start failed: %s", esp_err_to_name(err));
+            return err;
+        }
+    }
+    ESP_LOGI(TAG, "session started, %u KB/s max", (unsigned)(s_cfg.max_bytes_per_s / 1024));
+    // The shadow frame fills as LVGL redraws everything; never call this with s_mux held, as
+    // flushes take it under the LVGL lock.
+    display_lvgl_async_call(invalidate_screen, nullptr);
+    return ESP_OK;
+#endif
+}
+
+void screen_mirror_stop(void)
+{
+    s_active.store(false);
+}
+
+bool screen_mirror_active(void)
+{
+    return s_active.load();
+}
+
+void screen_mirror_refresh(void)
+{
+    if (!s_active.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(s_mux);
+        s_hello_pending = true;
+    }
+    display_lvgl_async_call(invalidate_screen, nullptr);
+}
+
+void screen_mirror_get_stats(screen_mirror_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(s_mux);
+    *out = s_stats;
+}
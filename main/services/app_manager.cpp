@@ -83,6 +83,14 @@ static esp_err_t load_app_icon(const char *path, app_metadata_t *meta)
         return ESP_FAIL;
     }
 
+#if LV_COLOR_16_SWAP
+    // Icons are stored as little-endian RGB565 (tools/app_builder.py); swap once to LVGL's byte order.
+    uint16_t *px = (uint16_t *)meta->icon_data;
+    for (uint32_t i = 0; i < header.icon_size / 2; i++) {
+        px[i] = (uint16_t)((px[i] << 8) | (px[i] >> 8));
+    }
+#endif
+
     // Setup LVGL image descriptor
     meta->icon.header.cf = LV_IMG_CF_TRUE_COLOR;
     meta->icon.header.w = APP_ICON_WIDTH;
@@ -7,6 +7,7 @@
 #include "driver/gpio.h"
 #include "driver/i2s_std.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_random.h"
 
@@ -14,15 +15,33 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 
-#include "nvs.h"
-
 #include "es8311.h"
 
 #include "app_pins.h"
+#include "audio_mixer.h"
+#include "audio_resampler.h"
 #include "i2c_bus.h"
+#include "services/settings_service.h"
 
 static const char *TAG = "audio";
 
+// The engine task owns I2S: it mixes the stream and UI sounds one block at a time and queues each
+// block on the DMA without blocking. The DMA depth bounds how long a new sound waits behind
+// audio that is already queued.
+#define AUDIO_ENGINE_BLOCK_FRAMES 240 // 5 ms
+#define AUDIO_ENGINE_TASK_STACK_SIZE 4096
+#define AUDIO_ENGINE_TASK_PRIORITY 6 // above the MP3 output task that fills the stream ring
+#define AUDIO_ENGINE_TASK_CORE 0
+#define AUDIO_ENGINE_DMA_WAIT_MS 50 // fallback if a DMA-sent wakeup is missed
+#define AUDIO_DMA_DESC_NUM 4
+#define AUDIO_DMA_FRAME_NUM 240 // 4 x 5 ms queued at most
+
+// Stream writes land in a short ring that the engine drains; writers wait for room in it.
+#define AUDIO_STREAM_RING_MS 60
+#define AUDIO_STREAM_POLL_MS 5
+// Input frames converted per ring write when a stream needs resampling.
+#define AUDIO_STREAM_CHUNK_FRAMES 256
+
 static i2s_chan_handle_t s_tx = NULL;
 static i2s_chan_handle_t s_rx = NULL;
 static es8311_handle_t s_codec = NULL;
@@ -30,9 +49,24 @@ static bool s_ready = false;
 static bool s_ui_sounds_enabled = true;
 
 static bool s_stream_active = false;
-static int s_hw_sample_rate = 16000;
+static audio_resampler_t *s_stream_src = NULL; // stream rate -> AUDIO_ES8311_HW_RATE_HZ, under s_hw_mutex
+static int16_t s_stream_buf[AUDIO_RESAMPLER_MAX_OUT(AUDIO_STREAM_CHUNK_FRAMES) * 2];
+static pcm_ring_t *s_stream_ring = NULL; // attached to s_mixer while a stream is open
 static SemaphoreHandle_t s_hw_mutex = NULL;
 
+// Mixing and I2S writes happen under s_hw_mutex, which is never held while waiting for the DMA.
+static audio_mixer_t *s_mixer = NULL;
+static TaskHandle_t s_engine_task = NULL;
+static volatile bool s_dma_wait = false; // engine is waiting for a DMA buffer to be sent
+static int16_t s_mix_buf[AUDIO_ENGINE_BLOCK_FRAMES * 2];
+static size_t s_mix_pos = 0; // bytes of s_mix_buf already queued
+static size_t s_mix_len = 0;
+
+// UI sounds, rendered once at the hardware rate.
+static audio_mixer_sound_t s_click = {};
+static audio_mixer_sound_t s_beep = {};
+static audio_mixer_sound_t s_rattle = {};
+
 static bool s_enabled = true;
 static bool s_muted = false;
 static int s_volume = 70;
@@ -43,44 +77,34 @@ static uint32_t s_last_mic_level_ms = 0;
 
 static void nvs_load_ui_sounds(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("audio", NVS_READONLY, &h) != ESP_OK) {
-        return;
-    }
     uint8_t v = 1;
-    if (nvs_get_u8(h, "ui_snd", &v) == ESP_OK) {
+    if (settings_service_get_u8("audio", "ui_snd", &v)) {
         s_ui_sounds_enabled = (v != 0);
     }
 
-    if (nvs_get_u8(h, "en", &v) == ESP_OK) {
+    if (settings_service_get_u8("audio", "en", &v)) {
         s_enabled = (v != 0);
     }
-    if (nvs_get_u8(h, "mute", &v) == ESP_OK) {
+    if (settings_service_get_u8("audio", "mute", &v)) {
         s_muted = (v != 0);
     }
     int32_t iv = 0;
-    if (nvs_get_i32(h, "vol", &iv) == ESP_OK) {
+    if (settings_service_get_i32("audio", "vol", &iv)) {
         s_volume = (int)iv;
     }
-    if (nvs_get_i32(h, "mic", &iv) == ESP_OK) {
+    if (settings_service_get_i32("audio", "mic", &iv)) {
         s_mic_gain_ui = (int)iv;
     }
-    nvs_close(h);
 }
 
+// Only keys whose value changed are marked dirty; the settings service batches the NVS write.
 static void nvs_save_ui_sounds(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("audio", NVS_READWRITE, &h) != ESP_OK) {
-        return;
-    }
-    nvs_set_u8(h, "ui_snd", s_ui_sounds_enabled ? 1 : 0);
-    nvs_set_u8(h, "en", s_enabled ? 1 : 0);
-    nvs_set_u8(h, "mute", s_muted ? 1 : 0);
-    nvs_set_i32(h, "vol", s_volume);
-    nvs_set_i32(h, "mic", s_mic_gain_ui);
-    nvs_commit(h);
-    nvs_close(h);
+    settings_service_set_u8("audio", "ui_snd", s_ui_sounds_enabled ? 1 : 0);
+    settings_service_set_u8("audio", "en", s_enabled ? 1 : 0);
+    settings_service_set_u8("audio", "mute", s_muted ? 1 : 0);
+    settings_service_set_i32("audio", "vol", s_volume);
+    settings_service_set_i32("audio", "mic", s_mic_gain_ui);
 }
 
 static void pa_gpio_init(void)
@@ -128,46 +152,71 @@ static void apply_codec_settings(void)
     es8311_microphone_gain_set(s_codec, mic_gain_from_ui(s_mic_gain_ui));
 }
 
-static esp_err_t ensure_audio_ready(void)
+// I2S ISR: a DMA buffer has been sent, so there is room for more.
+static bool IRAM_ATTR engine_on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
 {
-    if (!s_enabled) {
-        return ESP_ERR_INVALID_STATE;
-    }
-    if (s_ready) {
-        // Best-effort: keep PA on.
-        pa_set_enabled(true);
-        return ESP_OK;
-    }
-    return init_audio_hw();
+    (void)handle;
+    (void)event;
+    (void)user_ctx;
+    BaseType_t woken = pdFALSE;
+    if (s_dma_wait) {
+        s_dma_wait = false;
+        vTaskNotifyGiveFromISR(s_engine_task, &woken);
+    }
+    return woken == pdTRUE;
 }
 
-static esp_err_t write_with_recover(const void *data, size_t len, TickType_t timeout)
+// Under s_hw_mutex. Mixes blocks and queues them on I2S until the DMA is full (returns true) or
+// nothing is playing (returns false). Never waits: a block that does not fit is finished next time.
+static bool engine_fill_dma(void)
 {
-    if (!data || len == 0) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    esp_err_t err = ensure_audio_ready();
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    size_t bytes_written = 0;
-    err = i2s_channel_write(s_tx, data, len, &bytes_written, timeout);
-    if (err == ESP_OK) {
-        return ESP_OK;
+    if (!s_ready || !s_tx) {
+        s_mix_pos = s_mix_len = 0;
+        return false;
+    }
+    for (;;) {
+        if (s_mix_pos == s_mix_len) {
+            if (!audio_mixer_mix(s_mixer, s_mix_buf, AUDIO_ENGINE_BLOCK_FRAMES)) {
+                return false;
+            }
+            s_mix_pos = 0;
+            s_mix_len = sizeof(s_mix_buf);
+        }
+        // Armed before the write, so a buffer sent while it runs still wakes the engine.
+        s_dma_wait = true;
+        size_t bytes_written = 0;
+        esp_err_t err =
+            i2s_channel_write(s_tx, (const uint8_t *)s_mix_buf + s_mix_pos, s_mix_len - s_mix_pos, &bytes_written, 0);
+        s_mix_pos += bytes_written;
+        if (err == ESP_ERR_TIMEOUT) {
+            return true;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "i2s write failed (%s); reinitializing audio", esp_err_to_name(err));
+            s_mix_pos = s_mix_len = 0;
+            deinit_audio_hw();
+            err = init_audio_hw();
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "audio reinit failed: %s", esp_err_to_name(err));
+            }
+            return false;
+        }
     }
+}
 
-    ESP_LOGW(TAG, "i2s write failed (%s); reinitializing audio and retrying", esp_err_to_name(err));
-    deinit_audio_hw();
-    err = init_audio_hw();
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "audio reinit failed: %s", esp_err_to_name(err));
-        return err;
+// Sleeps until a sound is played, stream data arrives (both notify) or, while the DMA is full,
+// until it has sent a buffer.
+static void engine_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        bool dma_full = false;
+        if (xSemaphoreTake(s_hw_mutex, portMAX_DELAY) == pdTRUE) {
+            dma_full = engine_fill_dma();
+            xSemaphoreGive(s_hw_mutex);
+        }
+        ulTaskNotifyTake(pdTRUE, dma_full ? pdMS_TO_TICKS(AUDIO_ENGINE_DMA_WAIT_MS) : portMAX_DELAY);
     }
-
-    bytes_written = 0;
-    return i2s_channel_write(s_tx, data, len, &bytes_written, timeout);
 }
 
 static void deinit_audio_hw(void)
@@ -190,7 +239,7 @@ static void deinit_audio_hw(void)
     s_ready = false;
 }
 
-static esp_err_t init_audio_hw_with_rate(int sample_rate_hz)
+static esp_err_t init_audio_hw(void)
 {
     pa_gpio_init();
     pa_set_enabled(true);
@@ -198,9 +247,11 @@ static esp_err_t init_audio_hw_with_rate(int sample_rate_hz)
     // I2S TX + RX
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
     chan_cfg.auto_clear = true;
+    chan_cfg.dma_desc_num = AUDIO_DMA_DESC_NUM;
+    chan_cfg.dma_frame_num = AUDIO_DMA_FRAME_NUM;
     ESP_RETURN_ON_ERROR(i2s_new_channel(&chan_cfg, &s_tx, &s_rx), TAG, "i2s_new_channel failed");
 
-    const uint32_t rate_hz = (sample_rate_hz <= 0) ? 16000u : (uint32_t)sample_rate_hz;
+    const uint32_t rate_hz = AUDIO_ES8311_HW_RATE_HZ;
     i2s_std_config_t std_cfg = {
         .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(rate_hz),
         .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
@@ -220,6 +271,9 @@ static esp_err_t init_audio_hw_with_rate(int sample_rate_hz)
     std_cfg.clk_cfg.mclk_multiple = I2S_MCLK_MULTIPLE_384;
     ESP_RETURN_ON_ERROR(i2s_channel_init_std_mode(s_tx, &std_cfg), TAG, "i2s tx init failed");
     ESP_RETURN_ON_ERROR(i2s_channel_init_std_mode(s_rx, &std_cfg), TAG, "i2s rx init failed");
+    i2s_event_callbacks_t tx_cbs = {};
+    tx_cbs.on_sent = engine_on_sent;
+    ESP_RETURN_ON_ERROR(i2s_channel_register_event_callback(s_tx, &tx_cbs, NULL), TAG, "i2s tx callback failed");
     ESP_RETURN_ON_ERROR(i2s_channel_enable(s_tx), TAG, "i2s tx enable failed");
     ESP_RETURN_ON_ERROR(i2s_channel_enable(s_rx), TAG, "i2s rx enable failed");
 
@@ -238,14 +292,137 @@ static esp_err_t init_audio_hw_with_rate(int sample_rate_hz)
     apply_codec_settings();
 
     s_ready = true;
-    s_hw_sample_rate = (int)rate_hz;
     ESP_LOGI(TAG, "Audio init OK (rate=%d enabled=%d muted=%d vol=%d mic=%d)", (int)rate_hz, (int)s_enabled, (int)s_muted, s_volume, s_mic_gain_ui);
     return ESP_OK;
 }
 
-static esp_err_t init_audio_hw(void)
+static int16_t *alloc_sound(size_t samples)
+{
+    const size_t bytes = samples * sizeof(int16_t);
+    int16_t *pcm = (int16_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!pcm) {
+        pcm = (int16_t *)malloc(bytes);
+    }
+    return pcm;
+}
+
+static bool render_click(audio_mixer_sound_t *out)
+{
+    constexpr int kSampleRate = AUDIO_ES8311_HW_RATE_HZ;
+    constexpr float kFreq = 1200.0f;
+    constexpr int kMs = 35;
+    constexpr int kSamples = (kSampleRate * kMs) / 1000;
+
+    int16_t *samples = alloc_sound(kSamples);
+    if (!samples) {
+        return false;
+    }
+    for (int i = 0; i < kSamples; i++) {
+        const float env = 1.0f - ((float)i / (float)kSamples);
+        const float x = sinf(2.0f * (float)M_PI * kFreq * (float)i / (float)kSampleRate);
+        samples[i] = (int16_t)(x * env * 5000);
+    }
+    *out = {samples, (uint32_t)kSamples, 1};
+    return true;
+}
+
+static bool render_beep(audio_mixer_sound_t *out)
+{
+    constexpr int kSampleRate = AUDIO_ES8311_HW_RATE_HZ;
+    constexpr float kFreq = 880.0f;
+    constexpr int kMs = 200;
+    constexpr int kSamples = (kSampleRate * kMs) / 1000;
+
+    int16_t *samples = alloc_sound(kSamples);
+    if (!samples) {
+        return false;
+    }
+    for (int i = 0; i < kSamples; i++) {
+        float x = sinf(2.0f * (float)M_PI * kFreq * (float)i / (float)kSampleRate);
+        samples[i] = (int16_t)(x * 8000);
+    }
+    *out = {samples, (uint32_t)kSamples, 1};
+    return true;
+}
+
+static bool render_spray_rattle(audio_mixer_sound_t *out)
 {
-    return init_audio_hw_with_rate(16000);
+    constexpr int kSampleRate = AUDIO_ES8311_HW_RATE_HZ;
+    constexpr int kDurationMs = 800;  // 800ms spray can rattle
+    constexpr int kTotalSamples = (kSampleRate * kDurationMs) / 1000;
+    constexpr int kAttackSamples = kSampleRate / 160; // ~6 ms
+
+    int16_t *samples = alloc_sound(kTotalSamples);
+    if (!samples) {
+        return false;
+    }
+
+    // Generate spray paint can rattle effect:
+    // 3 short bursts of noise with decay envelope
+    const int burst_positions[] = {0, kSampleRate * 150 / 1000, kSampleRate * 300 / 1000};   // 0, 150, 300 ms
+    const int burst_lengths[] = {kSampleRate * 125 / 1000, kSampleRate * 1125 / 10000, kSampleRate * 100 / 1000};
+
+    memset(samples, 0, kTotalSamples * sizeof(int16_t));
+
+    for (int b = 0; b < 3; b++) {
+        int start = burst_positions[b];
+        int length = burst_lengths[b];
+
+        for (int i = 0; i < length && (start + i) < kTotalSamples; i++) {
+            // Generate white noise
+            int16_t noise = (int16_t)((esp_random() % 16000) - 8000);
+
+            // Apply envelope (attack + exponential decay)
+            float envelope;
+            if (i < kAttackSamples) {
+                // Fast attack
+                envelope = (float)i / (float)kAttackSamples;
+            } else {
+                // Exponential decay
+                float decay_pos = (float)(i - kAttackSamples) / (float)(length - kAttackSamples);
+                envelope = expf(-decay_pos * 3.0f);
+            }
+
+            // Apply high-pass character (spray can metallic rattle)
+            float hp_factor = 0.7f + 0.3f * sinf(2.0f * M_PI * 3000.0f * (float)i / (float)kSampleRate);
+
+            samples[start + i] = (int16_t)(noise * envelope * hp_factor * 0.6f);
+        }
+    }
+    *out = {samples, (uint32_t)kTotalSamples, 1};
+    return true;
+}
+
+static esp_err_t engine_start(void)
+{
+    if (s_engine_task) {
+        return ESP_OK;
+    }
+    s_mixer = audio_mixer_create();
+    if (!s_mixer || !render_click(&s_click) || !render_beep(&s_beep) || !render_spray_rattle(&s_rattle)) {
+        return ESP_ERR_NO_MEM;
+    }
+#if CONFIG_FREERTOS_UNICORE
+    const BaseType_t ok = xTaskCreate(engine_task, "audio_mix", AUDIO_ENGINE_TASK_STACK_SIZE, NULL,
+                                      AUDIO_ENGINE_TASK_PRIORITY, &s_engine_task);
+#else
+    const BaseType_t ok = xTaskCreatePinnedToCore(engine_task, "audio_mix", AUDIO_ENGINE_TASK_STACK_SIZE, NULL,
+                                                  AUDIO_ENGINE_TASK_PRIORITY, &s_engine_task, AUDIO_ENGINE_TASK_CORE);
+#endif
+    return ok == pdPASS ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Queues a sound on a mixer voice and wakes the engine; returns at once.
+static esp_err_t play_sound(const audio_mixer_sound_t *sound)
+{
+    if (!s_engine_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (audio_mixer_play(s_mixer, sound, AUDIO_MIXER_UNITY) == AUDIO_MIXER_NO_VOICE) {
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(s_engine_task);
+    return ESP_OK;
 }
 
 esp_err_t audio_es8311_init(void)
@@ -253,6 +430,8 @@ esp_err_t audio_es8311_init(void)
     if (!s_hw_mutex) {
         s_hw_mutex = xSemaphoreCreateMutex();
     }
+    ESP_RETURN_ON_FALSE(s_hw_mutex, ESP_ERR_NO_MEM, TAG, "hw mutex alloc failed");
+    ESP_RETURN_ON_ERROR(engine_start(), TAG, "audio engine start failed");
     nvs_load_ui_sounds();
     if (!s_enabled) {
         // Respect power-saving disable on boot.
@@ -272,13 +451,18 @@ void audio_es8311_set_enabled(bool enabled)
         audio_es8311_stream_end();
     }
 
+    // The engine writes to I2S under the mutex.
+    if (s_hw_mutex) {
+        xSemaphoreTake(s_hw_mutex, portMAX_DELAY);
+    }
     if (!enabled) {
         deinit_audio_hw();
-        return;
-    }
-    if (!s_ready) {
+    } else if (!s_ready) {
         init_audio_hw();
     }
+    if (s_hw_mutex) {
+        xSemaphoreGive(s_hw_mutex);
+    }
 }
 
 bool audio_es8311_get_enabled(void)
@@ -380,7 +564,7 @@ esp_err_t audio_es8311_mic_read(void *dst, size_t dst_bytes, size_t *bytes_read,
         return ESP_ERR_INVALID_STATE;
     }
     if (s_stream_active) {
-        // Avoid fighting with stream reconfiguration.
+        // A blocking read holds the hardware mutex, which the engine needs to keep the stream playing.
         return ESP_ERR_INVALID_STATE;
     }
 
@@ -414,31 +598,13 @@ esp_err_t audio_es8311_play_click(void)
     if (!s_enabled) {
         return ESP_ERR_INVALID_STATE;
     }
-    if (s_stream_active) {
-        return ESP_OK;
-    }
     if (s_muted) {
         return ESP_OK;
     }
     if (!s_ui_sounds_enabled) {
         return ESP_OK;
     }
-
-    constexpr int kSampleRate = 16000;
-    constexpr float kFreq = 1200.0f;
-    constexpr int kMs = 35;
-    constexpr int kSamples = (kSampleRate * kMs) / 1000;
-
-    static int16_t samples[kSamples * 2];
-    for (int i = 0; i < kSamples; i++) {
-        const float env = 1.0f - ((float)i / (float)kSamples);
-        const float x = sinf(2.0f * (float)M_PI * kFreq * (float)i / (float)kSampleRate);
-        const int16_t s = (int16_t)(x * env * 5000);
-        samples[i * 2 + 0] = s;
-        samples[i * 2 + 1] = s;
-    }
-
-    return write_with_recover(samples, sizeof(samples), pdMS_TO_TICKS(250));
+    return play_sound(&s_click);
 }
 
 esp_err_t audio_es8311_play_beep(void)
@@ -446,27 +612,10 @@ esp_err_t audio_es8311_play_beep(void)
     if (!s_enabled) {
         return ESP_ERR_INVALID_STATE;
     }
-    if (s_stream_active) {
-        return ESP_OK;
-    }
     if (s_muted) {
         return ESP_OK;
     }
-    constexpr int kSampleRate = 16000;
-    constexpr float kFreq = 880.0f;
-    constexpr int kMs = 200;
-    constexpr int kSamples = (kSampleRate * kMs) / 1000;
-
-    // 16-bit stereo interleaved
-    static int16_t samples[kSamples * 2];
-    for (int i = 0; i < kSamples; i++) {
-        float x = sinf(2.0f * (float)M_PI * kFreq * (float)i / (float)kSampleRate);
-        int16_t s = (int16_t)(x * 8000);
-        samples[i * 2 + 0] = s;
-        samples[i * 2 + 1] = s;
-    }
-
-    return write_with_recover(samples, sizeof(samples), pdMS_TO_TICKS(1000));
+    return play_sound(&s_beep);
 }
 
 esp_err_t audio_es8311_play_spray_rattle(void)
@@ -474,67 +623,16 @@ esp_err_t audio_es8311_play_spray_rattle(void)
     if (!s_enabled) {
         return ESP_ERR_INVALID_STATE;
     }
-    if (s_stream_active) {
-        return ESP_OK;
-    }
     if (s_muted) {
         return ESP_OK;
     }
-    
-    constexpr int kSampleRate = 16000;
-    constexpr int kDurationMs = 800;  // 800ms spray can rattle
-    constexpr int kTotalSamples = (kSampleRate * kDurationMs) / 1000;
-    
-    // Allocate buffer for stereo interleaved samples
-    static int16_t samples[kTotalSamples * 2];
-    
-    // Generate spray paint can rattle effect:
-    // 3 short bursts of noise with decay envelope
-    int burst_positions[] = {0, 2400, 4800};  // Start times in samples
-    int burst_lengths[] = {2000, 1800, 1600}; // Decreasing burst lengths
-    
-    memset(samples, 0, sizeof(samples));
-    
-    for (int b = 0; b < 3; b++) {
-        int start = burst_positions[b];
-        int length = burst_lengths[b];
-        
-        for (int i = 0; i < length && (start + i) < kTotalSamples; i++) {
-            // Generate white noise
-            int16_t noise = (int16_t)((esp_random() % 16000) - 8000);
-            
-            // Apply envelope (attack + exponential decay)
-            float envelope;
-            if (i < 100) {
-                // Fast attack
-                envelope = (float)i / 100.0f;
-            } else {
-                // Exponential decay
-                float decay_pos = (float)(i - 100) / (float)(length - 100);
-                envelope = expf(-decay_pos * 3.0f);
-            }
-            
-            // Apply high-pass character (spray can metallic rattle)
-            float hp_factor = 0.7f + 0.3f * sinf(2.0f * M_PI * 3000.0f * (float)i / (float)kSampleRate);
-            
-            int16_t s = (int16_t)(noise * envelope * hp_factor * 0.6f);
-            
-            int idx = start + i;
-            samples[idx * 2 + 0] = s;
-            samples[idx * 2 + 1] = s;
-        }
-    }
-    
-    return write_with_recover(samples, sizeof(samples), pdMS_TO_TICKS(2000));
+    return play_sound(&s_rattle);
 }
 
 esp_err_t audio_es8311_stream_begin(int sample_rate_hz)
 {
-    if (!s_hw_mutex) {
-        s_hw_mutex = xSemaphoreCreateMutex();
-    }
-    if (!s_hw_mutex) {
-        return ESP_ERR_NO_MEM;
+    if (!s_hw_mutex || !s_mixer) {
+        return ESP_ERR_INVALID_STATE;
     }
 
     if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
@@ -547,21 +645,32 @@ esp_err_t audio_es8311_stream_begin(int sample_rate_hz)
     }
 
     if (!s_ready) {
-        esp_err_t err = init_audio_hw_with_rate(sample_rate_hz);
+        esp_err_t err = init_audio_hw();
         if (err != ESP_OK) {
             xSemaphoreGive(s_hw_mutex);
             return err;
         }
-    } else if (s_hw_sample_rate != sample_rate_hz) {
-        deinit_audio_hw();
-        esp_err_t err = init_audio_hw_with_rate(sample_rate_hz);
-        if (err != ESP_OK) {
-            // Best-effort restore default rate.
-            deinit_audio_hw();
-            init_audio_hw();
+    }
+
+    // The hardware keeps its rate; only the converter changes.
+    if (!s_stream_src || audio_resampler_in_rate(s_stream_src) != (uint32_t)sample_rate_hz) {
+        audio_resampler_t *src =
+            sample_rate_hz > 0 ? audio_resampler_create((uint32_t)sample_rate_hz, AUDIO_ES8311_HW_RATE_HZ) : NULL;
+        if (!src) {
             xSemaphoreGive(s_hw_mutex);
-            return err;
+            return ESP_ERR_NOT_SUPPORTED;
         }
+        audio_resampler_destroy(s_stream_src);
+        s_stream_src = src;
+    }
+
+    if (!s_stream_ring) {
+        s_stream_ring = pcm_ring_create((uint32_t)AUDIO_ES8311_HW_RATE_HZ * AUDIO_STREAM_RING_MS / 1000);
+        if (!s_stream_ring) {
+            xSemaphoreGive(s_hw_mutex);
+            return ESP_ERR_NO_MEM;
+        }
+        audio_mixer_set_stream(s_mixer, s_stream_ring, AUDIO_MIXER_UNITY);
     }
 
     s_stream_active = true;
@@ -569,24 +678,89 @@ esp_err_t audio_es8311_stream_begin(int sample_rate_hz)
     return ESP_OK;
 }
 
-esp_err_t audio_es8311_stream_write(const void *pcm_s16_interleaved, size_t bytes, int timeout_ms)
+// Copies frames into the stream ring, waking the engine and waiting for it to make room. The ring
+// is only touched under s_hw_mutex and looked up again after every wait: stream_end() may close and
+// destroy it meanwhile, which ends the write with ESP_ERR_INVALID_STATE.
+static esp_err_t stream_push(const int16_t *pcm, uint32_t frames, TickType_t start, TickType_t timeout)
 {
-    if (!s_ready || !s_enabled || !s_tx || !pcm_s16_interleaved || bytes == 0) {
-        return ESP_ERR_INVALID_STATE;
+    for (;;) {
+        if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!s_stream_ring || pcm_ring_is_closed(s_stream_ring)) {
+            xSemaphoreGive(s_hw_mutex);
+            return ESP_ERR_INVALID_STATE;
+        }
+        const uint32_t n = pcm_ring_write(s_stream_ring, pcm, frames);
+        xSemaphoreGive(s_hw_mutex);
+        if (n > 0) {
+            xTaskNotifyGive(s_engine_task);
+        }
+        pcm += (size_t)n * 2;
+        frames -= n;
+        if (frames == 0) {
+            return ESP_OK;
+        }
+        if (timeout != portMAX_DELAY && xTaskGetTickCount() - start >= timeout) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(AUDIO_STREAM_POLL_MS));
     }
-    if (!s_hw_mutex) {
+}
+
+esp_err_t audio_es8311_stream_write(const void *pcm_s16_interleaved, size_t bytes, int timeout_ms)
+{
+    if (!s_hw_mutex || !pcm_s16_interleaved || bytes == 0) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    const TickType_t start = xTaskGetTickCount();
     const TickType_t to = (timeout_ms < 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
+    const int16_t *pcm = (const int16_t *)pcm_s16_interleaved;
+    size_t frames = bytes / (2 * sizeof(int16_t));
+    while (frames > 0) {
+        // The converter may be swapped by stream_begin() or freed by stream_end() between chunks.
+        const uint32_t n = frames < AUDIO_STREAM_CHUNK_FRAMES ? (uint32_t)frames : AUDIO_STREAM_CHUNK_FRAMES;
+        if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!s_ready || !s_enabled || !s_stream_ring || !s_stream_src) {
+            xSemaphoreGive(s_hw_mutex);
+            return ESP_ERR_INVALID_STATE;
+        }
+        const int16_t *chunk = pcm;
+        uint32_t out = n;
+        if (audio_resampler_in_rate(s_stream_src) != AUDIO_ES8311_HW_RATE_HZ) {
+            out = audio_resampler_process(s_stream_src, pcm, n, s_stream_buf);
+            chunk = s_stream_buf;
+        }
+        xSemaphoreGive(s_hw_mutex);
+        esp_err_t err = stream_push(chunk, out, start, to);
+        if (err != ESP_OK) {
+            return err;
+        }
+        pcm += (size_t)n * 2;
+        frames -= n;
     }
+    return ESP_OK;
+}
 
-    size_t bytes_written = 0;
-    esp_err_t err = i2s_channel_write(s_tx, pcm_s16_interleaved, bytes, &bytes_written, to);
-    xSemaphoreGive(s_hw_mutex);
-    return err;
+// Under s_hw_mutex. Mixer figures are since boot; the ring's are for this stream.
+static void log_engine_stats(void)
+{
+    audio_mixer_stats_t st;
+    audio_mixer_get_stats(s_mixer, &st);
+    pcm_ring_stats_t ring;
+    pcm_ring_get_stats(s_stream_ring, &ring);
+    const uint32_t block_us = AUDIO_ENGINE_BLOCK_FRAMES * 1000000u / AUDIO_ES8311_HW_RATE_HZ;
+    const uint32_t mix_avg_us = st.blocks ? (uint32_t)(st.mix_us / st.blocks) : 0;
+    ESP_LOGI(TAG, "Mixer: %u us avg / %u us max per %u us block, %u stream underruns, %u clipped samples",
+             (unsigned)mix_avg_us, (unsigned)st.mix_us_max, (unsigned)block_us, (unsigned)ring.underruns,
+             (unsigned)st.clipped);
+    ESP_LOGI(TAG, "Sounds: %u played, %u dropped, queued %u ms avg / %u ms max + up to %u ms in DMA",
+             (unsigned)st.started, (unsigned)st.dropped,
+             (unsigned)(st.started ? st.latency_us_sum / st.started / 1000 : 0), (unsigned)(st.latency_us_max / 1000),
+             (unsigned)(AUDIO_DMA_DESC_NUM * AUDIO_DMA_FRAME_NUM * 1000 / AUDIO_ES8311_HW_RATE_HZ));
 }
 
 void audio_es8311_stream_end(void)
@@ -595,15 +769,35 @@ void audio_es8311_stream_end(void)
         s_stream_active = false;
         return;
     }
-    if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
-        s_stream_active = false;
-        return;
+    // Let the engine play out what is queued (at most AUDIO_STREAM_RING_MS). The ring is looked up
+    // under the mutex on every pass, since the writer or another stream_end() may be running; the
+    // loop leaves with the mutex held.
+    for (int waited_ms = 0;; waited_ms += AUDIO_STREAM_POLL_MS) {
+        if (xSemaphoreTake(s_hw_mutex, pdMS_TO_TICKS(2000)) != pdTRUE) {
+            s_stream_active = false;
+            return;
+        }
+        if (!s_stream_ring) {
+            break;
+        }
+        pcm_ring_close(s_stream_ring);
+        if (!s_ready || pcm_ring_fill(s_stream_ring) == 0 || waited_ms >= 2 * AUDIO_STREAM_RING_MS) {
+            break;
+        }
+        xSemaphoreGive(s_hw_mutex);
+        xTaskNotifyGive(s_engine_task);
+        vTaskDelay(pdMS_TO_TICKS(AUDIO_STREAM_POLL_MS));
     }
     s_stream_active = false;
-    if (s_ready && s_hw_sample_rate != 16000) {
-        deinit_audio_hw();
-        init_audio_hw();
-    }
+    if (s_stream_ring) {
+        audio_mixer_set_stream(s_mixer, NULL, 0);
+        log_engine_stats();
+        pcm_ring_destroy(s_stream_ring);
+        s_stream_ring = NULL;
+    }
+    // Nothing to reclock: the hardware already runs at the rate UI sounds are rendered at.
+    audio_resampler_destroy(s_stream_src);
+    s_stream_src = NULL;
     xSemaphoreGive(s_hw_mutex);
 }
 
@@ -2,35 +2,23 @@
 
 #include "esp_log.h"
 
-#include "nvs.h"
-
 #include "services/ble_uart_service.h"
+#include "services/settings_service.h"
 
 static const char *TAG = "ble";
 static bool s_enabled = false;
 
 static void nvs_load(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("ble", NVS_READONLY, &h) != ESP_OK) {
-        return;
-    }
     uint8_t v = 0;
-    if (nvs_get_u8(h, "en", &v) == ESP_OK) {
+    if (settings_service_get_u8("ble", "en", &v)) {
         s_enabled = (v != 0);
     }
-    nvs_close(h);
 }
 
 static void nvs_save(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("ble", NVS_READWRITE, &h) != ESP_OK) {
-        return;
-    }
-    nvs_set_u8(h, "en", s_enabled ? 1 : 0);
-    nvs_commit(h);
-    nvs_close(h);
+    settings_service_set_u8("ble", "en", s_enabled ? 1 : 0);
 }
 
 esp_err_t ble_service_init(void)
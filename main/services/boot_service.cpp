@@ -15,6 +15,8 @@
 
 #include "lvgl.h"
 
+#include "assets.h"
+#include "asset_logo.h"
 #include "display_lvgl.h"
 #include "i2c_bus.h"
 
@@ -28,16 +30,14 @@
 #include "services/wifi_service.h"
 #include "services/pc_connect_service.h"
 #include "services/app_manager.h"
+#include "services/settings_service.h"
 #include "services/storage_service.h"
 
 static const char *TAG = "boot";
 
-// Embedded logo image
-extern const uint8_t logo_png_start[] asm("_binary_logo_png_start");
-extern const uint8_t logo_png_end[] asm("_binary_logo_png_end");
-
 static void show_boot_splash(void)
 {
+    const int64_t t0_us = esp_timer_get_time();
     if (!display_lvgl_lock(100)) {
         return;
     }
@@ -45,16 +45,9 @@ static void show_boot_splash(void)
     lv_obj_t *scr = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(scr, lv_color_black(), 0);
 
-    lv_img_dsc_t logo_img;
-    logo_img.header.always_zero = 0;
-    logo_img.header.w = 0;
-    logo_img.header.h = 0;
-    logo_img.header.cf = LV_IMG_CF_RAW_ALPHA;
-    logo_img.data_size = logo_png_end - logo_png_start;
-    logo_img.data = logo_png_start;
-
+    // Native lv_color_t pixels generated at build time; drawn straight from flash.
     lv_obj_t *img = lv_img_create(scr);
-    lv_img_set_src(img, &logo_img);
+    lv_img_set_src(img, asset_img(&asset_logo));
     lv_obj_center(img);
 
     lv_obj_t *lbl_sub = lv_label_create(scr);
@@ -73,7 +66,9 @@ static void show_boot_splash(void)
     lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
 
     lv_scr_load(scr);
+    lv_refr_now(NULL);
     display_lvgl_unlock();
+    ESP_LOGI(TAG, "Splash first frame in %u us", (unsigned)(esp_timer_get_time() - t0_us));
 
     // Play spray paint rattle sound while the logo is on-screen.
     audio_es8311_play_spray_rattle();
@@ -176,6 +171,7 @@ esp_err_t boot_service_init(boot_service_result_t *out_result)
     }
 
     ESP_RETURN_ON_ERROR(nvs_flash_init(), TAG, "nvs init failed");
+    ESP_RETURN_ON_ERROR(settings_service_init(), TAG, "settings init failed");
 
     ESP_LOGI(TAG, "Init I2C");
     ESP_RETURN_ON_ERROR(app_i2c_init(), TAG, "i2c init failed");
@@ -184,7 +180,10 @@ esp_err_t boot_service_init(boot_service_result_t *out_result)
     ESP_RETURN_ON_ERROR(display_lvgl_init(), TAG, "display/lvgl init failed");
 
     // Enable LVGL file access for SD card images (S:/ -> /sdcard/)
-    lvgl_fs_sdcard_init();
+    if (display_lvgl_lock(-1)) {
+        lvgl_fs_sdcard_init();
+        display_lvgl_unlock();
+    }
 
     ESP_LOGI(TAG, "Init audio");
     ESP_RETURN_ON_ERROR(audio_es8311_init(), TAG, "audio init failed");
@@ -14,6 +14,7 @@
 #include "esp_netif.h"
 #include "esp_wifi.h"
 
+#include "screen_mirror.h"
 #include "services/sdcard_service.h"
 #include "services/storage_service.h"
 
@@ -28,6 +29,10 @@ static bool s_prev_sta_cfg_valid = false;
 
 static esp_netif_t *s_ap_netif = nullptr;
 
+// Screen mirror viewer socket, -1 for none. The server outlives a stop request while it is set.
+static volatile int s_mirror_fd = -1;
+static volatile bool s_stop_pending = false;
+
 static char s_ap_ssid[33] = "DeviceLauncherFS";
 static const char *kApIp = "192.168.4.1";
 
@@ -41,6 +46,9 @@ static const char kIndexHtml[] =
     "pre{background:#f4f4f4;padding:8px;overflow:auto}"
     "</style></head><body>"
     "<h2>FileServer</h2>"
+#if CONFIG_HTTPD_WS_SUPPORT
+    "<p><a href='/mirror'>Screen mirror</a></p>"
+#endif
     "<div>Root: <select id='root'><option value='flash'>flash (/storage)</option><option value='sd'>sd (/sdcard)</option></select></div>"
     "<div>Path: <input id='path' placeholder='e.g. files/test.txt' size='40'> "
     "<button onclick='loadFile()'>Load</button> <button onclick='saveFile()'>Save</button> "
@@ -90,6 +98,51 @@ static const char kIndexHtml[] =
     "}"
     "</script></body></html>";
 
+#if CONFIG_HTTPD_WS_SUPPORT
+// Draws the rectangles streamed by screen_mirror (see screen_mirror.h for the message format).
+static const char kMirrorHtml[] =
+    "<!doctype html><html><head><meta charset='utf-8'>"
+    "<meta name='viewport' content='width=device-width,initial-scale=1'>"
+    "<title>Screen mirror</title>"
+    "<style>body{font-family:sans-serif;margin:16px;background:#222;color:#ddd}"
+    "canvas{border:1px solid #555;max-width:100%;image-rendering:pixelated}"
+    "button{font-size:16px;margin:4px 0}</style></head><body>"
+    "<h2>Screen mirror</h2>"
+    "<div><button onclick='snap()'>Capture PNG</button> <span id='st'>Connecting...</span></div>"
+    "<canvas id='c'></canvas>"
+    "<script>"
+    "const c=document.getElementById('c'),g=c.getContext('2d'),st=document.getElementById('st');"
+    "let live=false,frames=0,bytes=0,t0=performance.now();"
+    "function draw(d){"
+    " const x=d.getUint16(2,true),y=d.getUint16(4,true),w=d.getUint16(6,true),h=d.getUint16(8,true);"
+    " const img=g.createImageData(w,h),p=img.data,rle=d.getUint8(1)==1;let i=10,k=0;"
+    " const put=v=>{p[k]=(v>>11)*255/31;p[k+1]=(v>>5&63)*255/63;p[k+2]=(v&31)*255/31;p[k+3]=255;k+=4;};"
+    " while(k<p.length&&i<d.byteLength){"
+    "  if(!rle){put(d.getUint16(i,true));i+=2;continue;}"
+    "  const n=d.getUint8(i++),cnt=(n&127)+1;"
+    "  if(n&128){for(let j=0;j<cnt;j++,i+=2)put(d.getUint16(i,true));}"
+    "  else{const v=d.getUint16(i,true);i+=2;for(let j=0;j<cnt;j++)put(v);}"
+    " }"
+    " g.putImageData(img,x,y);"
+    "}"
+    "function conn(){"
+    " const ws=new WebSocket(`ws://${location.host}/mirror/ws`);ws.binaryType='arraybuffer';"
+    " ws.onopen=()=>{live=true;st.textContent='Connected';};"
+    " ws.onclose=()=>{live=false;st.textContent='Disconnected, retrying...';setTimeout(conn,2000);};"
+    " ws.onmessage=e=>{const d=new DataView(e.data);bytes+=e.data.byteLength;"
+    "  if(d.getUint8(0)==72){c.width=d.getUint16(2,true);c.height=d.getUint16(4,true);}"
+    "  else if(d.getUint8(0)==82)draw(d);"
+    "  else if(d.getUint8(0)==70)frames++;};"
+    "}"
+    "setInterval(()=>{const s=(performance.now()-t0)/1000;"
+    " if(live)st.textContent=`${(frames/s).toFixed(1)} fps, ${(bytes/1024/s).toFixed(0)} KB/s`;"
+    " frames=0;bytes=0;t0=performance.now();},2000);"
+    "function snap(){c.toBlob(b=>{const a=document.createElement('a');"
+    " a.href=URL.createObjectURL(b);a.download='screen.png';a.click();});}"
+    "conn();"
+    "</script></body></html>";
+#endif
+
 static bool sanitize_rel_path(const char *in, char *out, size_t out_len)
 {
     if (!out || out_len == 0) {
@@ -468,6 +521,69 @@ static esp_err_t handle_upload(httpd_req_t *req)
     return send_text(req, 200, "Uploaded");
 }
 
+#if CONFIG_HTTPD_WS_SUPPORT
+static esp_err_t handle_mirror(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, kMirrorHtml, HTTPD_RESP_USE_STRLEN);
+}
+
+static bool mirror_send(const uint8_t *data, size_t len, void *)
+{
+    const int fd = s_mirror_fd;
+    if (!s_httpd || fd < 0 || httpd_ws_get_fd_info(s_httpd, fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+        return false;
+    }
+    httpd_ws_frame_t frame = {};
+    frame.final = true;
+    frame.type = HTTPD_WS_TYPE_BINARY;
+    frame.payload = (uint8_t *)data;
+    frame.len = len;
+    return httpd_ws_send_frame_async(s_httpd, fd, &frame) == ESP_OK;
+}
+
+static void mirror_stopped(void *)
+{
+    s_mirror_fd = -1;
+    if (s_stop_pending) {
+        s_stop_pending = false;
+        ESP_LOGI(TAG, "Mirror viewer left, stopping");
+        fileserver_service_stop();
+    }
+}
+
+static esp_err_t handle_mirror_ws(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        // Handshake done. A new viewer takes over from the previous one.
+        s_mirror_fd = httpd_req_to_sockfd(req);
+        if (screen_mirror_active()) {
+            screen_mirror_refresh();
+            return ESP_OK;
+        }
+        screen_mirror_config_t cfg = {};
+        cfg.sink = mirror_send;
+        cfg.on_stop = mirror_stopped;
+        const esp_err_t err = screen_mirror_start(&cfg);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Mirror start failed: %s", esp_err_to_name(err));
+            s_mirror_fd = -1;
+        }
+        return err;
+    }
+
+    // The viewer sends nothing we use; drain small frames so the connection stays in sync.
+    uint8_t buf[64];
+    httpd_ws_frame_t frame = {};
+    ESP_RETURN_ON_ERROR(httpd_ws_recv_frame(req, &frame, 0), TAG, "ws recv failed");
+    if (frame.len > sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    frame.payload = buf;
+    return frame.len ? httpd_ws_recv_frame(req, &frame, frame.len) : ESP_OK;
+}
+#endif
+
 static esp_err_t start_httpd(void)
 {
     if (s_httpd) {
@@ -517,19 +633,37 @@ static esp_err_t start_httpd(void)
         .handler = handle_upload,
         .user_ctx = nullptr,
     };
-
     (void)httpd_register_uri_handler(s_httpd, &index_uri);
     (void)httpd_register_uri_handler(s_httpd, &list_uri);
     (void)httpd_register_uri_handler(s_httpd, &dl_uri);
     (void)httpd_register_uri_handler(s_httpd, &read_uri);
     (void)httpd_register_uri_handler(s_httpd, &save_uri);
     (void)httpd_register_uri_handler(s_httpd, &up_uri);
+#if CONFIG_HTTPD_WS_SUPPORT
+    // The viewer page is only served when it can get a stream.
+    httpd_uri_t mirror_uri = {
+        .uri = "/mirror",
+        .method = HTTP_GET,
+        .handler = handle_mirror,
+        .user_ctx = nullptr,
+    };
+    (void)httpd_register_uri_handler(s_httpd, &mirror_uri);
+    httpd_uri_t mirror_ws_uri = {
+        .uri = "/mirror/ws",
+        .method = HTTP_GET,
+        .handler = handle_mirror_ws,
+        .user_ctx = nullptr,
+        .is_websocket = true,
+    };
+    (void)httpd_register_uri_handler(s_httpd, &mirror_ws_uri);
+#endif
 
     return ESP_OK;
 }
 
 static void stop_httpd(void)
 {
+    screen_mirror_stop();
     if (s_httpd) {
         httpd_stop(s_httpd);
         s_httpd = nullptr;
@@ -592,6 +726,7 @@ static void wifi_restore_previous(void)
 
 esp_err_t fileserver_service_start(void)
 {
+    s_stop_pending = false;
     if (s_running) {
         return ESP_OK;
     }
@@ -612,6 +747,13 @@ void fileserver_service_stop(void)
     if (!s_running) {
         return;
     }
+    if (s_mirror_fd >= 0 && screen_mirror_active()) {
+        // Keep serving the mirror viewer while the user moves on to other apps; the server stops
+        // when the viewer disconnects (mirror_stopped).
+        ESP_LOGI(TAG, "Mirror viewer connected, stopping once it leaves");
+        s_stop_pending = true;
+        return;
+    }
 
     stop_httpd();
     wifi_restore_previous();
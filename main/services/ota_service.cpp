@@ -3,6 +3,8 @@
 #include "esp_https_ota.h"
 #include "esp_log.h"
 
+#include "services/settings_service.h"
+
 static const char *TAG = "ota";
 
 static void ota_task(void *arg)
@@ -21,6 +23,7 @@ static void ota_task(void *arg)
     esp_err_t ret = esp_https_ota(&ota_cfg);
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "OTA success, rebooting");
+        settings_service_flush();
         esp_restart();
     } else {
         ESP_LOGW(TAG, "OTA failed: %s", esp_err_to_name(ret));
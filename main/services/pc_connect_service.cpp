@@ -6,6 +6,8 @@
 #include "esp_log.h"
 #include "lvgl.h"
 
+#include "display_lvgl.h"
+
 #include "services/power_axp2101.h"
 #include "services/time_service.h"
 
@@ -33,7 +35,7 @@ static void pc_task(void *)
             // Best-effort time sync: if Wi-Fi is connected, SNTP will update time.
             time_service_start_sntp();
             // Auto-open terminal to show live log stream on-device.
-            lv_async_call(on_pc_connected, nullptr);
+            display_lvgl_async_call(on_pc_connected, nullptr);
         }
         s_last_vbus = vbus;
         vTaskDelay(pdMS_TO_TICKS(500));
@@ -9,12 +9,11 @@
 #include "esp_sleep.h"
 #include "esp_system.h"
 
-#include "nvs.h"
-
 #include "lvgl.h"
 
 #include "display_lvgl.h"
 #include "app_pins.h"
+#include "services/settings_service.h"
 
 static const char *TAG = "pwr_mgr";
 
@@ -27,30 +26,19 @@ static bool s_display_off = false;
 
 static void nvs_load(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("pwr", NVS_READONLY, &h) != ESP_OK) {
-        return;
-    }
     uint32_t v = 0;
-    if (nvs_get_u32(h, "idle_s", &v) == ESP_OK) {
+    if (settings_service_get_u32("pwr", "idle_s", &v)) {
         s_idle_timeout_sec = v;
     }
-    if (nvs_get_u32(h, "sleep_s", &v) == ESP_OK) {
+    if (settings_service_get_u32("pwr", "sleep_s", &v)) {
         s_sleep_timeout_sec = v;
     }
-    nvs_close(h);
 }
 
 static void nvs_save(void)
 {
-    nvs_handle_t h;
-    if (nvs_open("pwr", NVS_READWRITE, &h) != ESP_OK) {
-        return;
-    }
-    nvs_set_u32(h, "idle_s", s_idle_timeout_sec);
-    nvs_set_u32(h, "sleep_s", s_sleep_timeout_sec);
-    nvs_commit(h);
-    nvs_close(h);
+    settings_service_set_u32("pwr", "idle_s", s_idle_timeout_sec);
+    settings_service_set_u32("pwr", "sleep_s", s_sleep_timeout_sec);
 }
 
 static void ensure_wakeup_sources(void)
@@ -133,12 +121,14 @@ uint32_t power_manager_get_sleep_timeout_sec(void)
 
 void power_manager_reboot_now(void)
 {
+    settings_service_flush();
     esp_restart();
 }
 
 void power_manager_sleep_now(void)
 {
     display_lvgl_set_on(false);
+    settings_service_flush();
     ensure_wakeup_sources();
     esp_light_sleep_start();
     display_lvgl_set_on(true);
@@ -147,6 +137,7 @@ void power_manager_sleep_now(void)
 void power_manager_shutdown_now(void)
 {
     display_lvgl_set_on(false);
+    settings_service_flush();
     ensure_wakeup_sources();
     esp_deep_sleep_start();
 }
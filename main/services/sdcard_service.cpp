@@ -11,7 +11,9 @@
 
 #include "esp_io_expander_tca9554.h"
 
+#include "block_cache.h"
 #include "i2c_bus.h"
+#include "media_index.h"
 #include "app_pins.h"
 
 static const char *TAG = "sd";
@@ -132,6 +134,8 @@ esp_err_t sdcard_service_mount(void)
         sdmmc_card_t *card = NULL;
         ret = esp_vfs_fat_sdmmc_mount(kMountPoint, &host, &slot_config, &mount_config, &card);
         if (ret == ESP_OK) {
+            // A different card can hold files with the same path, size and mtime.
+            block_cache_invalidate();
             s_mounted = true;
             s_last_err = ESP_OK;
             snprintf(s_last_status, sizeof(s_last_status), "mounted");
@@ -139,6 +143,7 @@ esp_err_t sdcard_service_mount(void)
             if (card) {
                 sdmmc_card_print_info(stdout, card);
             }
+            media_index_start();
             return ESP_OK;
         }
 
@@ -0,0 +1,462 @@
+#include "services/settings_service.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "nvs.h"
+
+static const char *TAG = "settings";
+
+// Namespaces read at boot. Keys written to other namespaces are cached and flushed as well.
+static const char *const kNamespaces[] = {"disp", "audio", "pwr", "ble", "wifi"};
+#define SETTINGS_NS_COUNT (sizeof(kNamespaces) / sizeof(kNamespaces[0]))
+
+#define SETTINGS_MAX_ENTRIES 32
+#define SETTINGS_STR_MAX 65 // WiFi password (64) + NUL
+// Flush once a value has been stable this long (slider drags produce a change every frame)...
+#define SETTINGS_FLUSH_DEBOUNCE_MS 1500
+// ...but never hold a change back longer than this.
+#define SETTINGS_FLUSH_MAX_DELAY_MS 5000
+#define SETTINGS_TASK_STACK_SIZE (3 * 1024)
+#define SETTINGS_TASK_PRIORITY 1
+
+typedef struct {
+    char ns[NVS_NS_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_type_t type;
+    bool dirty;
+    uint32_t num; // U8 / I32 / U32, stored as raw bits
+    char str[SETTINGS_STR_MAX];
+} entry_t;
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static entry_t s_entries[SETTINGS_MAX_ENTRIES];
+static int s_entry_count = 0;
+static int s_dirty_count = 0;
+static int64_t s_first_dirty_us = 0;
+static int64_t s_last_set_us = 0;
+
+static TaskHandle_t s_task = nullptr;
+static SemaphoreHandle_t s_flush_mux = nullptr;
+// Snapshot of the dirty entries taken by a flush; guarded by s_flush_mux.
+static entry_t s_batch[SETTINGS_MAX_ENTRIES];
+
+static settings_service_stats_t s_stats = {};
+
+// Call with s_lock held.
+static entry_t *find_locked(const char *ns, const char *key)
+{
+    for (int i = 0; i < s_entry_count; i++) {
+        if (strcmp(s_entries[i].key, key) == 0 && strcmp(s_entries[i].ns, ns) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return nullptr;
+}
+
+// Call with s_lock held.
+static entry_t *insert_locked(const char *ns, const char *key, nvs_type_t type)
+{
+    if (s_entry_count >= SETTINGS_MAX_ENTRIES || strlen(ns) >= NVS_NS_NAME_MAX_SIZE ||
+        strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return nullptr;
+    }
+    entry_t *e = &s_entries[s_entry_count++];
+    memset(e, 0, sizeof(*e));
+    strcpy(e->ns, ns);
+    strcpy(e->key, key);
+    e->type = type;
+    return e;
+}
+
+static bool get_num(const char *ns, const char *key, nvs_type_t type, uint32_t *out)
+{
+    if (!ns || !key || !out) {
+        return false;
+    }
+    bool found = false;
+    portENTER_CRITICAL(&s_lock);
+    const entry_t *e = find_locked(ns, key);
+    if (e && e->type == type) {
+        *out = e->num;
+        found = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+static esp_err_t set_value(const char *ns, const char *key, nvs_type_t type, uint32_t num, const char *str)
+{
+    if (!ns || !key || (type == NVS_TYPE_STR && (!str || strlen(str) >= SETTINGS_STR_MAX))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bool changed = false;
+    esp_err_t err = ESP_OK;
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.sets++;
+    entry_t *e = find_locked(ns, key);
+    if (!e) {
+        e = insert_locked(ns, key, type);
+        changed = (e != nullptr);
+    } else if (e->type != type) {
+        e->type = type;
+        changed = true;
+    } else if (type == NVS_TYPE_STR) {
+        changed = strcmp(e->str, str) != 0;
+    } else {
+        changed = e->num != num;
+    }
+
+    if (!e) {
+        err = ESP_ERR_NO_MEM;
+    } else if (changed) {
+        if (type == NVS_TYPE_STR) {
+            strcpy(e->str, str);
+        } else {
+            e->num = num;
+        }
+        const int64_t now = esp_timer_get_time();
+        if (!e->dirty) {
+            e->dirty = true;
+            if (s_dirty_count++ == 0) {
+                s_first_dirty_us = now;
+            }
+        }
+        s_last_set_us = now;
+    } else {
+        s_stats.sets_unchanged++;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "no room for %s/%s", ns, key);
+    } else if (changed && s_task) {
+        xTaskNotifyGive(s_task);
+    }
+    return err;
+}
+
+static esp_err_t write_namespace(const char *ns, const entry_t *batch, int count, bool *written)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(ns, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint32_t keys = 0;
+    for (int i = 0; i < count && err == ESP_OK; i++) {
+        const entry_t *e = &batch[i];
+        if (written[i] || strcmp(e->ns, ns) != 0) {
+            continue;
+        }
+        switch (e->type) {
+        case NVS_TYPE_U8:
+            err = nvs_set_u8(h, e->key, (uint8_t)e->num);
+            break;
+        case NVS_TYPE_I32:
+            err = nvs_set_i32(h, e->key, (int32_t)e->num);
+            break;
+        case NVS_TYPE_U32:
+            err = nvs_set_u32(h, e->key, e->num);
+            break;
+        default:
+            err = nvs_set_str(h, e->key, e->str);
+            break;
+        }
+        written[i] = true;
+        keys++;
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+    nvs_close(h);
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.keys_written += keys;
+    s_stats.commits++;
+    portEXIT_CRITICAL(&s_lock);
+    return err;
+}
+
+static esp_err_t flush_dirty(void)
+{
+    if (!s_flush_mux) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_flush_mux, portMAX_DELAY);
+
+    int count = 0;
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < s_entry_count; i++) {
+        if (s_entries[i].dirty) {
+            s_batch[count] = s_entries[i];
+            s_batch[count++].dirty = false; // reused below as "write failed"
+            s_entries[i].dirty = false;
+        }
+    }
+    s_dirty_count = 0;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (count == 0) {
+        xSemaphoreGive(s_flush_mux);
+        return ESP_OK;
+    }
+
+    const int64_t t0 = esp_timer_get_time();
+    bool written[SETTINGS_MAX_ENTRIES] = {};
+    esp_err_t result = ESP_OK;
+    // One open/commit per namespace, in the order the namespaces first appear in the batch.
+    for (int i = 0; i < count; i++) {
+        if (written[i]) {
+            continue;
+        }
+        const esp_err_t err = write_namespace(s_batch[i].ns, s_batch, count, written);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "flush of namespace %s failed: %s", s_batch[i].ns, esp_err_to_name(err));
+            result = err;
+            // Mark the namespace written so the loop moves on; its keys are re-queued below.
+            for (int j = i; j < count; j++) {
+                if (strcmp(s_batch[j].ns, s_batch[i].ns) == 0) {
+                    written[j] = true;
+                    s_batch[j].dirty = true;
+                }
+            }
+        }
+    }
+    const uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < count; i++) {
+        // Re-queue keys whose write failed, unless a newer value already made them dirty again.
+        entry_t *e = s_batch[i].dirty ? find_locked(s_batch[i].ns, s_batch[i].key) : nullptr;
+        if (e && !e->dirty) {
+            e->dirty = true;
+            if (s_dirty_count++ == 0) {
+                s_first_dirty_us = esp_timer_get_time();
+            }
+        }
+    }
+    s_stats.flushes++;
+    s_stats.flush_errors += (result != ESP_OK) ? 1 : 0;
+    s_stats.last_flush_us = us;
+    if (us > s_stats.max_flush_us) {
+        s_stats.max_flush_us = us;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    xSemaphoreGive(s_flush_mux);
+    ESP_LOGD(TAG, "flushed %d keys in %u us (sets=%u commits=%u)", count, (unsigned)us, (unsigned)s_stats.sets,
+             (unsigned)s_stats.commits);
+    return result;
+}
+
+static void settings_task(void *)
+{
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Debounce: wait for the value to settle, bounded by the max delay since the first change.
+        while (true) {
+            portENTER_CRITICAL(&s_lock);
+            const bool pending = s_dirty_count > 0;
+            int64_t due_us = s_last_set_us + SETTINGS_FLUSH_DEBOUNCE_MS * 1000LL;
+            const int64_t limit_us = s_first_dirty_us + SETTINGS_FLUSH_MAX_DELAY_MS * 1000LL;
+            portEXIT_CRITICAL(&s_lock);
+            if (!pending) {
+                break;
+            }
+            if (due_us > limit_us) {
+                due_us = limit_us;
+            }
+            const int64_t now_us = esp_timer_get_time();
+            if (now_us >= due_us) {
+                flush_dirty();
+                break;
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((due_us - now_us) / 1000 + 1));
+        }
+    }
+}
+
+static void load_entry(nvs_handle_t h, const nvs_entry_info_t *info)
+{
+    uint32_t num = 0;
+    char str[SETTINGS_STR_MAX] = {0};
+    esp_err_t err;
+    switch (info->type) {
+    case NVS_TYPE_U8: {
+        uint8_t v = 0;
+        err = nvs_get_u8(h, info->key, &v);
+        num = v;
+        break;
+    }
+    case NVS_TYPE_I32: {
+        int32_t v = 0;
+        err = nvs_get_i32(h, info->key, &v);
+        num = (uint32_t)v;
+        break;
+    }
+    case NVS_TYPE_U32:
+        err = nvs_get_u32(h, info->key, &num);
+        break;
+    case NVS_TYPE_STR: {
+        size_t len = sizeof(str);
+        err = nvs_get_str(h, info->key, str, &len);
+        break;
+    }
+    default:
+        // Blobs and other widths are not used by the settings namespaces.
+        return;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "skip %s/%s: %s", info->namespace_name, info->key, esp_err_to_name(err));
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    // A setter that ran before init holds the newer value.
+    entry_t *e = find_locked(info->namespace_name, info->key) ? nullptr
+                                                               : insert_locked(info->namespace_name, info->key, info->type);
+    if (e) {
+        e->num = num;
+        memcpy(e->str, str, sizeof(e->str));
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t settings_service_init(void)
+{
+    if (s_task) {
+        return ESP_OK;
+    }
+    s_flush_mux = xSemaphoreCreateMutex();
+    if (!s_flush_mux) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // One walk over the partition instead of an open/get/close per service at boot.
+    const int64_t t0 = esp_timer_get_time();
+    nvs_handle_t handles[SETTINGS_NS_COUNT] = {};
+    bool opened[SETTINGS_NS_COUNT] = {};
+    nvs_iterator_t it = nullptr;
+    esp_err_t res = nvs_entry_find(NVS_DEFAULT_PART_NAME, NULL, NVS_TYPE_ANY, &it);
+    while (res == ESP_OK) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        for (size_t n = 0; n < SETTINGS_NS_COUNT; n++) {
+            if (strcmp(info.namespace_name, kNamespaces[n]) != 0) {
+                continue;
+            }
+            if (!opened[n]) {
+                opened[n] = nvs_open(kNamespaces[n], NVS_READONLY, &handles[n]) == ESP_OK;
+            }
+            if (opened[n]) {
+                load_entry(handles[n], &info);
+            }
+            break;
+        }
+        res = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    for (size_t n = 0; n < SETTINGS_NS_COUNT; n++) {
+        if (opened[n]) {
+            nvs_close(handles[n]);
+        }
+    }
+    s_stats.boot_load_us = (uint32_t)(esp_timer_get_time() - t0);
+    ESP_LOGI(TAG, "Loaded %d settings in %u us", s_entry_count, (unsigned)s_stats.boot_load_us);
+
+    if (xTaskCreate(settings_task, "settings", SETTINGS_TASK_STACK_SIZE, NULL, SETTINGS_TASK_PRIORITY, &s_task) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "settings task create failed");
+        return ESP_ERR_NO_MEM;
+    }
+    if (s_dirty_count > 0) {
+        xTaskNotifyGive(s_task);
+    }
+    return ESP_OK;
+}
+
+bool settings_service_get_u8(const char *ns, const char *key, uint8_t *out)
+{
+    uint32_t v = 0;
+    if (!out || !get_num(ns, key, NVS_TYPE_U8, &v)) {
+        return false;
+    }
+    *out = (uint8_t)v;
+    return true;
+}
+
+bool settings_service_get_i32(const char *ns, const char *key, int32_t *out)
+{
+    uint32_t v = 0;
+    if (!out || !get_num(ns, key, NVS_TYPE_I32, &v)) {
+        return false;
+    }
+    *out = (int32_t)v;
+    return true;
+}
+
+bool settings_service_get_u32(const char *ns, const char *key, uint32_t *out)
+{
+    return get_num(ns, key, NVS_TYPE_U32, out);
+}
+
+bool settings_service_get_str(const char *ns, const char *key, char *out, size_t out_len)
+{
+    if (!ns || !key || !out || out_len == 0) {
+        return false;
+    }
+    bool found = false;
+    portENTER_CRITICAL(&s_lock);
+    const entry_t *e = find_locked(ns, key);
+    if (e && e->type == NVS_TYPE_STR && strlen(e->str) < out_len) {
+        strcpy(out, e->str);
+        found = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+esp_err_t settings_service_set_u8(const char *ns, const char *key, uint8_t value)
+{
+    return set_value(ns, key, NVS_TYPE_U8, value, nullptr);
+}
+
+esp_err_t settings_service_set_i32(const char *ns, const char *key, int32_t value)
+{
+    return set_value(ns, key, NVS_TYPE_I32, (uint32_t)value, nullptr);
+}
+
+esp_err_t settings_service_set_u32(const char *ns, const char *key, uint32_t value)
+{
+    return set_value(ns, key, NVS_TYPE_U32, value, nullptr);
+}
+
+esp_err_t settings_service_set_str(const char *ns, const char *key, const char *value)
+{
+    return set_value(ns, key, NVS_TYPE_STR, 0, value);
+}
+
+esp_err_t settings_service_flush(void)
+{
+    return flush_dirty();
+}
+
+void settings_service_get_stats(settings_service_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    portENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    out->entries = (uint16_t)s_entry_count;
+    portEXIT_CRITICAL(&s_lock);
+}
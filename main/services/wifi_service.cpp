@@ -8,8 +8,8 @@
 #include "esp_netif.h"
 #include "esp_check.h"
 #include "esp_wifi.h"
-#include "nvs.h"
-#include "nvs_flash.h"
+
+#include "services/settings_service.h"
 
 static const char *TAG = "wifi";
 
@@ -47,28 +47,15 @@ static void on_wifi_event(void *, esp_event_base_t event_base, int32_t event_id,
 
 static void nvs_save_creds(const char *ssid, const char *pass)
 {
-    nvs_handle_t h;
-    if (nvs_open("wifi", NVS_READWRITE, &h) != ESP_OK) {
-        return;
-    }
-    nvs_set_str(h, "ssid", ssid ? ssid : "");
-    nvs_set_str(h, "pass", pass ? pass : "");
-    nvs_commit(h);
-    nvs_close(h);
+    settings_service_set_str("wifi", "ssid", ssid ? ssid : "");
+    settings_service_set_str("wifi", "pass", pass ? pass : "");
 }
 
 static bool nvs_load_creds(char *ssid, size_t ssid_len, char *pass, size_t pass_len)
 {
-    nvs_handle_t h;
-    if (nvs_open("wifi", NVS_READONLY, &h) != ESP_OK) {
-        return false;
-    }
-    size_t s_len = ssid_len;
-    size_t p_len = pass_len;
-    esp_err_t s_err = nvs_get_str(h, "ssid", ssid, &s_len);
-    esp_err_t p_err = nvs_get_str(h, "pass", pass, &p_len);
-    nvs_close(h);
-    return (s_err == ESP_OK && p_err == ESP_OK && ssid[0] != '\0');
+    const bool s_ok = settings_service_get_str("wifi", "ssid", ssid, ssid_len);
+    const bool p_ok = settings_service_get_str("wifi", "pass", pass, pass_len);
+    return (s_ok && p_ok && ssid[0] != '\0');
 }
 
 bool wifi_service_get_saved_credentials(char *ssid_out, size_t ssid_out_len, char *pass_out, size_t pass_out_len)
@@ -0,0 +1,582 @@
+#include "thumb_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+
+#include "display_lvgl.h"
+#include "id3_tag.h"
+#include "image_decoder.h"
+
+static const char *TAG = "thumbs";
+
+#define THUMB_CACHE_DIR "/sdcard/.thumbs"
+#define THUMB_CACHE_DAT THUMB_CACHE_DIR "/thumbs.dat"
+#define THUMB_CACHE_IDX THUMB_CACHE_DIR "/thumbs.idx"
+#define THUMB_CACHE_RAM_SLOTS 64
+// Disk entries before both files are reset (~6.5 MB of pixels at 40x40 RGB565).
+#define THUMB_CACHE_MAX_ENTRIES 2048
+#define THUMB_CACHE_MAX_WAITERS 64
+#define THUMB_CACHE_MAX_DECODES 2 // concurrent generate jobs in the image_decoder queue
+#define THUMB_CACHE_TASK_STACK_SIZE 4096
+#define THUMB_CACHE_TASK_PRIORITY 2
+#define THUMB_CACHE_TASK_CORE 0
+
+#define THUMB_PX (THUMB_CACHE_SIZE * THUMB_CACHE_SIZE)
+#define THUMB_BYTES (THUMB_PX * sizeof(lv_color_t))
+#define THUMB_NONE 0xFFFFFFFFu
+#define THUMB_PATH_LEN 256
+
+// thumbs.idx record; slot indexes thumbs.dat in THUMB_BYTES units, THUMB_NONE = no preview.
+typedef struct {
+    uint64_t key;
+    uint32_t slot;
+    uint32_t reserved;
+} thumb_idx_entry_t;
+
+typedef enum {
+    OP_LOOKUP = 0, // worker: find on disk, or work out how to generate
+    OP_STORE,      // worker: append pixels (or a "no preview" record)
+    OP_FOUND,      // LVGL: pixels read from disk
+    OP_GENERATE,   // LVGL: decode from path at offset
+    OP_NONE,       // LVGL: file has no preview
+} thumb_op_kind_t;
+
+typedef struct {
+    thumb_op_kind_t kind;
+    uint64_t path_hash;
+    uint64_t key;
+    uint32_t offset;
+    uint32_t length; // of the embedded picture; 0 when the whole file is the image
+    uint8_t *pixels; // THUMB_BYTES, heap_caps; owned by the op
+    char path[THUMB_PATH_LEN];
+} thumb_op_t;
+
+typedef struct {
+    uint64_t path_hash; // 0 = free
+    char *path;         // THUMB_PATH_LEN bytes in PSRAM after the pixels; compared on lookup, not just the hash
+    uint32_t last_use;
+    uint16_t pins;
+    lv_img_dsc_t img;
+} thumb_slot_t;
+
+typedef struct {
+    uint64_t path_hash; // 0 = free
+    thumb_cache_cb_t cb;
+    void *user_data;
+} thumb_waiter_t;
+
+// LVGL task state.
+static thumb_slot_t s_slots[THUMB_CACHE_RAM_SLOTS];
+static uint8_t *s_pixels = nullptr;
+static uint32_t s_tick = 0;
+static thumb_waiter_t s_waiters[THUMB_CACHE_MAX_WAITERS];
+static thumb_op_t *s_gen_queue[THUMB_CACHE_MAX_WAITERS];
+static int s_gen_count = 0;
+static int s_gen_active = 0;
+static RingbufHandle_t s_queue = nullptr;
+
+// Worker state.
+static thumb_idx_entry_t *s_index = nullptr;
+static uint32_t s_index_count = 0;
+static uint32_t s_dat_slots = 0;
+
+static uint64_t fnv1a(const char *s, uint64_t h = 0xcbf29ce484222325ULL)
+{
+    for (; *s; s++) {
+        h = (h ^ (uint8_t)*s) * 0x100000001b3ULL;
+    }
+    return h ? h : 1;
+}
+
+static bool has_ext(const char *name, const char *ext)
+{
+    const size_t n = strlen(name);
+    const size_t e = strlen(ext);
+    return n > e && strcasecmp(name + n - e, ext) == 0;
+}
+
+// ---- Worker: disk cache ----
+
+static void index_load(void)
+{
+    if (s_index) {
+        return;
+    }
+    s_index = (thumb_idx_entry_t *)heap_caps_malloc(THUMB_CACHE_MAX_ENTRIES * sizeof(thumb_idx_entry_t),
+                                                    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_index) {
+        return;
+    }
+    mkdir(THUMB_CACHE_DIR, 0775);
+
+    FILE *f = fopen(THUMB_CACHE_DAT, "rb");
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        s_dat_slots = (uint32_t)(ftell(f) / (long)THUMB_BYTES);
+        fclose(f);
+    }
+    f = fopen(THUMB_CACHE_IDX, "rb");
+    if (f) {
+        s_index_count = (uint32_t)fread(s_index, sizeof(thumb_idx_entry_t), THUMB_CACHE_MAX_ENTRIES, f);
+        fclose(f);
+    }
+    // An entry whose pixels never made it to thumbs.dat (power loss mid-append) ends the index.
+    for (uint32_t i = 0; i < s_index_count; i++) {
+        if (s_index[i].slot != THUMB_NONE && s_index[i].slot >= s_dat_slots) {
+            s_index_count = i;
+            break;
+        }
+    }
+    ESP_LOGI(TAG, "%u cached thumbnails", (unsigned)s_index_count);
+}
+
+static const thumb_idx_entry_t *index_find(uint64_t key)
+{
+    for (uint32_t i = s_index_count; i-- > 0;) {
+        if (s_index[i].key == key) {
+            return &s_index[i];
+        }
+    }
+    return nullptr;
+}
+
+static void index_append(uint64_t key, const uint8_t *pixels)
+{
+    if (!s_index) {
+        return;
+    }
+    if (s_index_count >= THUMB_CACHE_MAX_ENTRIES) {
+        // Start over rather than compact; the thumbnails regenerate as folders are visited.
+        FILE *f = fopen(THUMB_CACHE_IDX, "wb");
+        if (f) fclose(f);
+        f = fopen(THUMB_CACHE_DAT, "wb");
+        if (f) fclose(f);
+        s_index_count = 0;
+        s_dat_slots = 0;
+    }
+
+    thumb_idx_entry_t e = {key, THUMB_NONE, 0};
+    if (pixels) {
+        FILE *f = fopen(THUMB_CACHE_DAT, "ab");
+        if (!f) {
+            return;
+        }
+        const bool ok = fwrite(pixels, 1, THUMB_BYTES, f) == THUMB_BYTES;
+        fclose(f);
+        if (!ok) {
+            return;
+        }
+        e.slot = s_dat_slots++;
+    }
+    FILE *f = fopen(THUMB_CACHE_IDX, "ab");
+    if (!f) {
+        return;
+    }
+    if (fwrite(&e, sizeof(e), 1, f) == 1) {
+        s_index[s_index_count++] = e;
+    }
+    fclose(f);
+}
+
+// Offset of the first JPEG picture in an ID3v2.3/2.4 APIC frame, 0 if there is none. *length gets
+// the picture's size, so the decoder does not read on into the audio.
+static uint32_t id3_cover_offset(FILE *f, uint32_t *length)
+{
+    id3_tag_t tag;
+    if (!id3_tag_open(f, &tag) || tag.version < 3) {
+        return 0; // v2.2 PIC frames are not supported
+    }
+    id3_frame_t fr;
+    while (id3_tag_next(f, &tag, &fr)) {
+        if (strcmp(fr.id, "APIC") != 0) {
+            continue;
+        }
+        // encoding, MIME\0, picture type, description\0 (\0\0 for UTF-16), data
+        uint8_t b[160];
+        const size_t n = fread(b, 1, fr.size < sizeof(b) ? fr.size : sizeof(b), f);
+        size_t i = 1;
+        while (i < n && b[i]) i++;
+        i += 2; // MIME terminator, picture type
+        if (b[0] == 1 || b[0] == 2) {
+            while (i + 1 < n && (b[i] || b[i + 1])) i += 2;
+            i += 2;
+        } else {
+            while (i < n && b[i]) i++;
+            i += 1;
+        }
+        if (i + 1 < n && b[i] == 0xFF && b[i + 1] == 0xD8) {
+            *length = fr.size - (uint32_t)i;
+            return fr.offset + (uint32_t)i;
+        }
+    }
+    return 0;
+}
+
+static void worker_lookup(thumb_op_t *op)
+{
+    index_load();
+
+    FILE *f = fopen(op->path, "rb");
+    struct stat st;
+    if (!f || fstat(fileno(f), &st) != 0) {
+        if (f) fclose(f);
+        op->kind = OP_NONE;
+        return;
+    }
+    char stamp[24];
+    snprintf(stamp, sizeof(stamp), "|%lu|%lu", (unsigned long)st.st_size, (unsigned long)st.st_mtime);
+    op->key = fnv1a(stamp, op->path_hash);
+
+    const thumb_idx_entry_t *e = s_index ? index_find(op->key) : nullptr;
+    if (e && e->slot == THUMB_NONE) {
+        op->kind = OP_NONE;
+    } else if (e) {
+        FILE *dat = fopen(THUMB_CACHE_DAT, "rb");
+        op->pixels = (uint8_t *)heap_caps_malloc(THUMB_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        const bool ok = dat && op->pixels && fseek(dat, (long)(e->slot * THUMB_BYTES), SEEK_SET) == 0 &&
+                        fread(op->pixels, 1, THUMB_BYTES, dat) == THUMB_BYTES;
+        if (dat) fclose(dat);
+        op->kind = ok ? OP_FOUND : OP_GENERATE;
+    } else if (has_ext(op->path, ".mp3")) {
+        op->offset = id3_cover_offset(f, &op->length);
+        op->kind = op->offset ? OP_GENERATE : OP_NONE;
+        if (!op->offset) {
+            index_append(op->key, nullptr);
+        }
+    } else {
+        op->kind = OP_GENERATE;
+    }
+    fclose(f);
+    if (op->kind == OP_GENERATE && op->pixels) {
+        heap_caps_free(op->pixels);
+        op->pixels = nullptr;
+    }
+}
+
+static void on_worker_result(void *p);
+
+static void thumb_task(void *arg)
+{
+    RingbufHandle_t queue = (RingbufHandle_t)arg;
+    while (true) {
+        size_t len = 0;
+        void *item = xRingbufferReceive(queue, &len, portMAX_DELAY);
+        if (!item) {
+            continue;
+        }
+        thumb_op_t *op = nullptr;
+        memcpy(&op, item, sizeof(op));
+        vRingbufferReturnItem(queue, item);
+
+        if (op->kind == OP_STORE) {
+            index_load();
+            index_append(op->key, op->pixels);
+            heap_caps_free(op->pixels);
+            free(op);
+            continue;
+        }
+        worker_lookup(op);
+        if (display_lvgl_async_call(on_worker_result, op) != ESP_OK) {
+            heap_caps_free(op->pixels);
+            free(op);
+        }
+    }
+}
+
+static bool send_op(thumb_op_t *op)
+{
+    if (!s_queue) {
+        RingbufHandle_t q = xRingbufferCreate(THUMB_CACHE_MAX_WAITERS * (8 + sizeof(void *)), RINGBUF_TYPE_NOSPLIT);
+        if (!q) {
+            return false;
+        }
+        if (xTaskCreatePinnedToCore(thumb_task, "thumbs", THUMB_CACHE_TASK_STACK_SIZE, q, THUMB_CACHE_TASK_PRIORITY,
+                                    NULL, THUMB_CACHE_TASK_CORE) != pdPASS) {
+            vRingbufferDelete(q);
+            return false;
+        }
+        s_queue = q;
+    }
+    return xRingbufferSend(s_queue, &op, sizeof(op), 0) == pdTRUE;
+}
+
+// ---- LVGL task ----
+
+static thumb_slot_t *slot_find(uint64_t path_hash, const char *path)
+{
+    for (thumb_slot_t &s : s_slots) {
+        if (s.path_hash == path_hash && s.path && strncmp(s.path, path, THUMB_PATH_LEN) == 0) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+static thumb_slot_t *slot_install(uint64_t path_hash, const char *path, const uint8_t *pixels)
+{
+    if (!s_pixels) {
+        s_pixels = (uint8_t *)heap_caps_malloc(THUMB_CACHE_RAM_SLOTS * (THUMB_BYTES + THUMB_PATH_LEN),
+                                               MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_pixels) {
+            return nullptr;
+        }
+        for (int i = 0; i < THUMB_CACHE_RAM_SLOTS; i++) {
+            s_slots[i].path = (char *)s_pixels + THUMB_CACHE_RAM_SLOTS * THUMB_BYTES + i * THUMB_PATH_LEN;
+            lv_img_dsc_t *img = &s_slots[i].img;
+            img->header.always_zero = 0;
+            img->header.cf = LV_IMG_CF_TRUE_COLOR;
+            img->header.w = THUMB_CACHE_SIZE;
+            img->header.h = THUMB_CACHE_SIZE;
+            img->data_size = THUMB_BYTES;
+            img->data = s_pixels + i * THUMB_BYTES;
+        }
+    }
+
+    // Least recently used slot that no row is showing.
+    thumb_slot_t *v = nullptr;
+    for (thumb_slot_t &s : s_slots) {
+        if (s.pins) {
+            continue;
+        }
+        if (s.path_hash == 0) {
+            v = &s;
+            break;
+        }
+        if (!v || (int32_t)(s.last_use - v->last_use) < 0) {
+            v = &s;
+        }
+    }
+    if (!v) {
+        return nullptr;
+    }
+    lv_img_cache_invalidate_src(&v->img);
+    memcpy((void *)v->img.data, pixels, THUMB_BYTES);
+    snprintf(v->path, THUMB_PATH_LEN, "%s", path);
+    v->path_hash = path_hash;
+    v->last_use = ++s_tick;
+    return v;
+}
+
+static bool waiting(uint64_t path_hash)
+{
+    for (const thumb_waiter_t &w : s_waiters) {
+        if (w.path_hash == path_hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Hands the slot to everyone waiting for it (pinned once per callback), or just clears them.
+static void notify(uint64_t path_hash, const char *path, thumb_slot_t *slot)
+{
+    for (thumb_waiter_t &w : s_waiters) {
+        if (w.path_hash != path_hash) {
+            continue;
+        }
+        thumb_waiter_t copy = w;
+        w.path_hash = 0;
+        if (slot && copy.cb) {
+            slot->pins++;
+            copy.cb(path, &slot->img, copy.user_data);
+        }
+    }
+}
+
+static void gen_pump(void);
+
+static void thumb_decoded(image_decode_job_t *job, image_decode_event_t event, void *user_data)
+{
+    if (event != IMAGE_DECODE_DONE && event != IMAGE_DECODE_FAILED) {
+        return;
+    }
+    thumb_op_t *op = (thumb_op_t *)user_data;
+    s_gen_active--;
+
+    op->kind = OP_STORE;
+    const lv_img_dsc_t *img = (event == IMAGE_DECODE_DONE) ? image_decoder_image(job) : nullptr;
+    // Only a file the decoder rejects is recorded as "no preview"; out of memory or a read error is
+    // retried on the next visit.
+    const bool invalid = event == IMAGE_DECODE_FAILED && image_decoder_error(job) == ESP_ERR_INVALID_RESPONSE;
+    if (img) {
+        op->pixels = (uint8_t *)heap_caps_calloc(1, THUMB_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (op->pixels) {
+        // Letterbox onto black.
+        const int w = img->header.w;
+        const int h = img->header.h;
+        lv_color_t *dst = (lv_color_t *)op->pixels;
+        const lv_color_t *src = (const lv_color_t *)img->data;
+        const int x0 = (THUMB_CACHE_SIZE - w) / 2;
+        const int y0 = (THUMB_CACHE_SIZE - h) / 2;
+        for (int y = 0; y < h; y++) {
+            memcpy(&dst[(y0 + y) * THUMB_CACHE_SIZE + x0], &src[y * w], w * sizeof(lv_color_t));
+        }
+        notify(op->path_hash, op->path, slot_install(op->path_hash, op->path, op->pixels));
+    } else {
+        notify(op->path_hash, op->path, nullptr);
+    }
+    image_decoder_release(job);
+
+    if ((!op->pixels && !invalid) || !send_op(op)) {
+        heap_caps_free(op->pixels);
+        free(op);
+    }
+    gen_pump();
+}
+
+static void gen_pump(void)
+{
+    while (s_gen_active < THUMB_CACHE_MAX_DECODES && s_gen_count > 0) {
+        thumb_op_t *op = s_gen_queue[0];
+        memmove(&s_gen_queue[0], &s_gen_queue[1], (size_t)(--s_gen_count) * sizeof(s_gen_queue[0]));
+
+        if (!waiting(op->path_hash)) {
+            free(op); // every row that wanted it is gone
+            continue;
+        }
+        image_decode_req_t req = {};
+        req.vfs_path = op->path;
+        req.offset = op->offset;
+        req.length = op->length;
+        req.max_w = THUMB_CACHE_SIZE;
+        req.max_h = THUMB_CACHE_SIZE;
+        req.mode = IMAGE_DECODE_FIT;
+        req.cb = thumb_decoded;
+        req.user_data = op;
+        if (!image_decoder_submit(&req)) {
+            notify(op->path_hash, op->path, nullptr);
+            free(op);
+            continue;
+        }
+        s_gen_active++;
+    }
+}
+
+static void on_worker_result(void *p)
+{
+    thumb_op_t *op = (thumb_op_t *)p;
+    switch (op->kind) {
+    case OP_FOUND:
+        notify(op->path_hash, op->path, slot_install(op->path_hash, op->path, op->pixels));
+        break;
+    case OP_GENERATE:
+        if (s_gen_count < THUMB_CACHE_MAX_WAITERS) {
+            s_gen_queue[s_gen_count++] = op;
+            gen_pump();
+            return;
+        }
+        notify(op->path_hash, op->path, nullptr);
+        break;
+    default:
+        notify(op->path_hash, op->path, nullptr);
+        break;
+    }
+    heap_caps_free(op->pixels);
+    free(op);
+}
+
+const lv_img_dsc_t *thumb_cache_get(const char *vfs_path, thumb_cache_cb_t cb, void *user_data)
+{
+    if (!vfs_path) {
+        return nullptr;
+    }
+    const uint64_t path_hash = fnv1a(vfs_path);
+    thumb_slot_t *slot = slot_find(path_hash, vfs_path);
+    if (slot) {
+        slot->pins++;
+        slot->last_use = ++s_tick;
+        return &slot->img;
+    }
+
+    thumb_waiter_t *free_w = nullptr;
+    for (thumb_waiter_t &w : s_waiters) {
+        if (w.path_hash == 0) {
+            free_w = &w;
+            break;
+        }
+    }
+    if (!free_w) {
+        return nullptr;
+    }
+    const bool in_flight = waiting(path_hash);
+    *free_w = {path_hash, cb, user_data};
+    if (in_flight) {
+        return nullptr;
+    }
+
+    thumb_op_t *op = (thumb_op_t *)calloc(1, sizeof(thumb_op_t));
+    if (op) {
+        op->kind = OP_LOOKUP;
+        op->path_hash = path_hash;
+        strncpy(op->path, vfs_path, sizeof(op->path) - 1);
+    }
+    if (!op || !send_op(op)) {
+        free(op);
+        free_w->path_hash = 0;
+    }
+    return nullptr;
+}
+
+void thumb_cache_release(const lv_img_dsc_t *img)
+{
+    for (thumb_slot_t &s : s_slots) {
+        if (&s.img == img && s.pins) {
+            s.pins--;
+            return;
+        }
+    }
+}
+
+void thumb_cache_cancel(void *user_data)
+{
+    for (thumb_waiter_t &w : s_waiters) {
+        if (w.user_data == user_data) {
+            w.path_hash = 0;
+        }
+    }
+}
+
+lv_obj_t *thumb_cache_attach(lv_obj_t *btn, const char *vfs_path)
+{
+    lv_obj_t *icon = lv_img_create(btn);
+    lv_obj_set_size(icon, THUMB_CACHE_SIZE, THUMB_CACHE_SIZE);
+    lv_obj_move_to_index(icon, 0);
+    lv_obj_add_event_cb(icon, [](lv_event_t *e) {
+        lv_obj_t *obj = lv_event_get_target(e);
+        thumb_cache_cancel(obj);
+        thumb_cache_release((const lv_img_dsc_t *)lv_img_get_src(obj));
+    }, LV_EVENT_DELETE, NULL);
+    thumb_cache_bind(icon, vfs_path);
+    return icon;
+}
+
+void thumb_cache_bind(lv_obj_t *icon, const char *vfs_path)
+{
+    thumb_cache_cancel(icon);
+    const lv_img_dsc_t *old = (const lv_img_dsc_t *)lv_img_get_src(icon);
+    if (old) {
+        lv_img_set_src(icon, NULL);
+        thumb_cache_release(old);
+    }
+    if (!vfs_path) {
+        return;
+    }
+
+    const lv_img_dsc_t *img = thumb_cache_get(vfs_path, [](const char *, const lv_img_dsc_t *img, void *user_data) {
+        lv_img_set_src((lv_obj_t *)user_data, img);
+    }, icon);
+    if (img) {
+        lv_img_set_src(icon, img);
+    }
+}
@@ -0,0 +1,171 @@
+#include "touch_input.h"
+
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_check.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_log.h"
+
+#include "esp_lcd_touch_ft5x06.h"
+
+#include "app_pins.h"
+#include "i2c_bus.h"
+
+static const char *TAG = "touch";
+
+// Power of two so the free-running indices wrap cleanly.
+#define TOUCH_QUEUE_LEN 32
+#define TOUCH_TASK_STACK_SIZE (3 * 1024)
+// Above LVGL (2) and its flush task (3): a sample should be on the queue before LVGL wakes.
+#define TOUCH_TASK_PRIORITY 4
+// While a finger is down the FT5x06 pulses INT once per report. If no pulse arrives in this
+// window (trigger mode holds INT low, or the finger lifted), read anyway to catch the release.
+#define TOUCH_ACTIVE_TIMEOUT_MS 30
+// Fallback when the board has no INT line wired.
+#define TOUCH_POLL_PERIOD_MS 10
+
+static esp_lcd_touch_handle_t s_tp = nullptr;
+static TaskHandle_t s_task = nullptr;
+static void (*s_on_sample)(void) = nullptr;
+
+// SPSC ring: the touch task only advances s_tail, the LVGL read callback only advances s_head.
+static touch_input_sample_t s_queue[TOUCH_QUEUE_LEN];
+static std::atomic<uint32_t> s_head{0};
+static std::atomic<uint32_t> s_tail{0};
+
+static bool queue_push(const touch_input_sample_t *sample)
+{
+    const uint32_t tail = s_tail.load(std::memory_order_relaxed);
+    const uint32_t head = s_head.load(std::memory_order_acquire);
+    if (tail - head >= TOUCH_QUEUE_LEN) {
+        return false;
+    }
+    s_queue[tail % TOUCH_QUEUE_LEN] = *sample;
+    s_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool touch_input_pop(touch_input_sample_t *out)
+{
+    const uint32_t head = s_head.load(std::memory_order_relaxed);
+    const uint32_t tail = s_tail.load(std::memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    *out = s_queue[head % TOUCH_QUEUE_LEN];
+    s_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool touch_input_has_samples(void)
+{
+    return s_head.load(std::memory_order_relaxed) != s_tail.load(std::memory_order_acquire);
+}
+
+static void IRAM_ATTR touch_isr_cb(esp_lcd_touch_handle_t)
+{
+    BaseType_t woken = pdFALSE;
+    if (s_task) {
+        vTaskNotifyGiveFromISR(s_task, &woken);
+    }
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static void touch_task(void *)
+{
+    const bool has_int = APP_PIN_NUM_TOUCH_INT != GPIO_NUM_NC;
+    bool release_pending = false;
+    touch_input_sample_t last = {}; // most recent sample queued (or pending)
+
+    while (true) {
+        TickType_t wait = portMAX_DELAY;
+        if (!has_int) {
+            wait = pdMS_TO_TICKS(TOUCH_POLL_PERIOD_MS);
+        } else if (last.pressed || release_pending) {
+            wait = pdMS_TO_TICKS(TOUCH_ACTIVE_TIMEOUT_MS);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        if (release_pending) {
+            // A release must never be lost or LVGL would see a stuck press.
+            if (!queue_push(&last)) {
+                if (s_on_sample) {
+                    s_on_sample();
+                }
+                continue;
+            }
+            release_pending = false;
+        }
+
+        uint16_t x = 0;
+        uint16_t y = 0;
+        uint8_t cnt = 0;
+        esp_lcd_touch_read_data(s_tp);
+        const bool down = esp_lcd_touch_get_coordinates(s_tp, &x, &y, NULL, &cnt, 1) && cnt > 0;
+
+        if (down) {
+            last.x = (int16_t)x;
+            last.y = (int16_t)y;
+            last.pressed = true;
+            // A move lost to a full queue is superseded by the next one.
+            queue_push(&last);
+        } else if (last.pressed) {
+            // Release at the last position reported.
+            last.pressed = false;
+            release_pending = !queue_push(&last);
+        } else {
+            // INT without a finger (spurious edge or controller wake-up): nothing to report.
+            continue;
+        }
+
+        if (s_on_sample) {
+            s_on_sample();
+        }
+    }
+}
+
+esp_err_t touch_input_init(void (*on_sample)(void))
+{
+    if (s_tp) {
+        return ESP_OK;
+    }
+    s_on_sample = on_sample;
+
+    ESP_LOGI(TAG, "Init touch controller (FT5x06)");
+    esp_lcd_panel_io_handle_t tp_io_handle = NULL;
+    const esp_lcd_panel_io_i2c_config_t tp_io_config = ESP_LCD_TOUCH_IO_I2C_FT5x06_CONFIG();
+    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_i2c(app_i2c_bus(), &tp_io_config, &tp_io_handle), TAG,
+                        "esp_lcd_new_panel_io_i2c failed");
+    const esp_lcd_touch_config_t tp_cfg = {
+        .x_max = APP_LCD_H_RES,
+        .y_max = APP_LCD_V_RES,
+        .rst_gpio_num = APP_PIN_NUM_TOUCH_RST,
+        .int_gpio_num = APP_PIN_NUM_TOUCH_INT,
+        .levels = {
+            .reset = 0,
+            .interrupt = 0,
+        },
+        .flags = {
+            .swap_xy = 0,
+            .mirror_x = 0,
+            .mirror_y = 0,
+        },
+        .process_coordinates = NULL,
+        .interrupt_callback = (APP_PIN_NUM_TOUCH_INT != GPIO_NUM_NC) ? touch_isr_cb : NULL,
+        .user_data = NULL,
+        .driver_data = NULL,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_touch_new_i2c_ft5x06(tp_io_handle, &tp_cfg, &s_tp), TAG, "touch init failed");
+
+    if (xTaskCreatePinnedToCore(touch_task, "touch", TOUCH_TASK_STACK_SIZE, NULL, TOUCH_TASK_PRIORITY, &s_task,
+                                tskNO_AFFINITY) != pdPASS) {
+        ESP_LOGE(TAG, "touch task create failed");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -18,6 +18,8 @@
 #include "ui_media.h"
 #include "ui_mp3.h"
 #include "ui_fileserver.h"
+#include "ui_screen_cache.h"
+#include "ui_theme.h"
 
 static const char *TAG = "app_carousel";
 
@@ -49,6 +51,11 @@ static lv_obj_t *s_right_arrow = nullptr;
 static int s_current_app_index = 0;
 static int s_total_apps = 0;
 
+// Built-in app entry screens are captured once, shortly after launch, so the next launch can show
+// the snapshot while the app rebuilds. Long enough for lists and labels to settle.
+#define CAROUSEL_SNAPSHOT_DELAY_MS 800
+static lv_timer_t *s_snapshot_timer = nullptr;
+
 // Built-in app metadata
 static app_metadata_t s_builtin_settings;
 static app_metadata_t s_builtin_terminal;
@@ -256,6 +263,28 @@ static void launch_current_app(void)
     if (!meta) return;
     
     ESP_LOGI(TAG, "Launching app: %s", meta->name);
+
+    if (s_current_app_index < UI_SCREEN_COUNT) {
+        const ui_screen_id_t id = (ui_screen_id_t)s_current_app_index;
+        // Parked screens come back instantly through the app's own open(); otherwise show the
+        // cached bitmap while the screen is rebuilt, and capture one if there is none yet.
+        if (!ui_screen_cache_has_live(id)) {
+            ui_screen_cache_show_snapshot(id);
+        }
+        if (s_snapshot_timer) {
+            lv_timer_del(s_snapshot_timer);
+        }
+        s_snapshot_timer = lv_timer_create(
+            [](lv_timer_t *t) {
+                s_snapshot_timer = nullptr;
+                lv_obj_t *act = lv_scr_act();
+                if (act != s_carousel_screen) {
+                    ui_screen_cache_capture((ui_screen_id_t)(intptr_t)t->user_data, act);
+                }
+            },
+            CAROUSEL_SNAPSHOT_DELAY_MS, (void *)(intptr_t)id);
+        lv_timer_set_repeat_count(s_snapshot_timer, 1);
+    }
     
     if (s_current_app_index == 0) {
         // Open full Settings menu directly, with Back returning to the carousel.
@@ -283,17 +312,15 @@ static void launch_current_app(void)
     // Filesystem apps exist in the registry, but dynamic loading is not implemented.
     // Show a clear screen instead of appearing to hang.
     lv_obj_t *scr = lv_obj_create(NULL);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
+    ui_theme_apply(scr, UI_THEME_SCREEN_FLUSH);
 
     lv_obj_t *header = lv_obj_create(scr);
-    lv_obj_set_size(header, APP_LCD_H_RES, 44);
+    ui_theme_apply(header, UI_THEME_HEADER);
     lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_bg_color(header, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(header, 0, 0);
     lv_obj_clear_flag(header, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t *btn_exit = lv_btn_create(header);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_LEFT_MID, 4, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
@@ -309,12 +336,12 @@ static void launch_current_app(void)
 
     lv_obj_t *lbl_title = lv_label_create(header);
     lv_label_set_text(lbl_title, meta->name);
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
 
     lv_obj_t *msg = lv_label_create(scr);
     lv_label_set_text(msg, "This app type isn't supported yet\n(.app code loading is not implemented)");
-    lv_obj_set_style_text_color(msg, lv_color_white(), 0);
+    ui_theme_apply(msg, UI_THEME_TITLE);
     lv_obj_set_style_text_align(msg, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_align(msg, LV_ALIGN_CENTER, 0, 0);
 
@@ -345,7 +372,7 @@ esp_err_t ui_app_carousel_init(void)
     
     // Create screen
     s_carousel_screen = lv_obj_create(NULL);
-    lv_obj_set_style_bg_color(s_carousel_screen, lv_color_hex(0x000000), 0);
+    ui_theme_apply(s_carousel_screen, UI_THEME_SCREEN_FLUSH);
 
     // Ensure the global timer/pointers are cleaned up if this screen is deleted.
     lv_obj_add_event_cb(s_carousel_screen, [](lv_event_t *) {
@@ -365,10 +392,9 @@ esp_err_t ui_app_carousel_init(void)
     
     // Status bar (32px tall)
     lv_obj_t *status_bar = lv_obj_create(s_carousel_screen);
-    lv_obj_set_size(status_bar, APP_LCD_H_RES, 32);
+    ui_theme_apply(status_bar, UI_THEME_HEADER);
+    lv_obj_set_height(status_bar, 32);
     lv_obj_align(status_bar, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_bg_color(status_bar, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(status_bar, 0, 0);
     lv_obj_clear_flag(status_bar, LV_OBJ_FLAG_SCROLLABLE);
 
     s_status_wifi = lv_label_create(status_bar);
@@ -377,12 +403,12 @@ esp_err_t ui_app_carousel_init(void)
 
     s_status_time = lv_label_create(status_bar);
     lv_label_set_text(s_status_time, "--:--");
-    lv_obj_set_style_text_color(s_status_time, lv_color_white(), 0);
+    ui_theme_apply(s_status_time, UI_THEME_TITLE);
     lv_obj_align(s_status_time, LV_ALIGN_CENTER, 0, 0);
 
     s_status_batt = lv_label_create(status_bar);
     lv_label_set_text(s_status_batt, LV_SYMBOL_BATTERY_EMPTY);
-    lv_obj_set_style_text_color(s_status_batt, lv_color_white(), 0);
+    ui_theme_apply(s_status_batt, UI_THEME_TITLE);
     lv_obj_align(s_status_batt, LV_ALIGN_RIGHT_MID, -5, 0);
     
     auto make_tile = [](lv_obj_t *parent, int w, int h, int icon_px, const lv_font_t *sym_font, bool selected,
@@ -405,13 +431,13 @@ esp_err_t ui_app_carousel_init(void)
         if (sym_font) {
             lv_obj_set_style_text_font(sym, sym_font, 0);
         }
-        lv_obj_set_style_text_color(sym, lv_color_white(), 0);
+        ui_theme_apply(sym, UI_THEME_TITLE);
         lv_obj_align(sym, LV_ALIGN_TOP_MID, 0, 34);
         lv_obj_add_flag(sym, LV_OBJ_FLAG_HIDDEN);
 
         lv_obj_t *lbl = lv_label_create(tile);
         lv_label_set_text(lbl, "App");
-        lv_obj_set_style_text_color(lbl, lv_color_white(), 0);
+        ui_theme_apply(lbl, UI_THEME_TITLE);
         lv_obj_set_style_text_font(lbl, &lv_font_montserrat_16, 0);
         lv_obj_align(lbl, LV_ALIGN_BOTTOM_MID, 0, -8);
 
@@ -440,7 +466,7 @@ esp_err_t ui_app_carousel_init(void)
     s_left_arrow = lv_label_create(s_carousel_screen);
     lv_label_set_text(s_left_arrow, "< <");
     lv_obj_set_style_text_font(s_left_arrow, &lv_font_montserrat_16, 0);
-    lv_obj_set_style_text_color(s_left_arrow, lv_color_white(), 0);
+    ui_theme_apply(s_left_arrow, UI_THEME_TITLE);
     lv_obj_align(s_left_arrow, LV_ALIGN_LEFT_MID, 15, -20);
     lv_obj_add_flag(s_left_arrow, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_add_event_cb(s_left_arrow, [](lv_event_t *) {
@@ -455,7 +481,7 @@ esp_err_t ui_app_carousel_init(void)
     s_right_arrow = lv_label_create(s_carousel_screen);
     lv_label_set_text(s_right_arrow, "> >");
     lv_obj_set_style_text_font(s_right_arrow, &lv_font_montserrat_16, 0);
-    lv_obj_set_style_text_color(s_right_arrow, lv_color_white(), 0);
+    ui_theme_apply(s_right_arrow, UI_THEME_TITLE);
     lv_obj_align(s_right_arrow, LV_ALIGN_RIGHT_MID, -15, -20);
     lv_obj_add_flag(s_right_arrow, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_add_event_cb(s_right_arrow, [](lv_event_t *) {
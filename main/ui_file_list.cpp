@@ -0,0 +1,591 @@
+#include "ui_file_list.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "display_lvgl.h"
+#include "list_window.h"
+#include "media_index.h"
+#include "thumb_cache.h"
+
+static const char *TAG = "file_list";
+
+#define FILE_LIST_TASK_STACK_SIZE (4 * 1024)
+#define FILE_LIST_TASK_PRIORITY 2
+#define FILE_LIST_TASK_CORE 0
+// A batch goes to the LVGL task when it is full or has waited this long.
+#define FILE_LIST_BATCH_NAMES 64
+#define FILE_LIST_BATCH_BYTES 4096
+#define FILE_LIST_BATCH_MS 100
+#define FILE_LIST_ROW_H (THUMB_CACHE_SIZE + 16)
+// Rows beyond the viewport, so a fling does not reveal unbound rows.
+#define FILE_LIST_SPARE_ROWS 2
+#define FILE_LIST_MAX_ROWS 16
+// Rows the scroll content spans at most; the window slides over longer lists (list_window.h).
+#define FILE_LIST_WINDOW_ROWS 128
+#define FILE_LIST_NO_ENTRY UINT32_MAX
+
+static_assert(FILE_LIST_WINDOW_ROWS * FILE_LIST_ROW_H <= LV_COORD_MAX, "file list window exceeds lv_coord_t");
+
+typedef struct {
+    std::atomic<int> refs; // list + worker + each batch in flight
+    std::atomic<bool> cancelled;
+    char dir[128];
+    ui_file_list_filter_t filter;
+    void *owner; // file_list_t; only touched on the LVGL task while not cancelled
+} file_scan_t;
+
+typedef struct {
+    file_scan_t *scan;
+    uint16_t count;
+    uint16_t len;
+    bool done;
+    bool failed; // the directory could not be opened
+    uint16_t off[FILE_LIST_BATCH_NAMES]; // sorted
+    char names[FILE_LIST_BATCH_BYTES];
+} file_batch_t;
+
+typedef struct {
+    lv_obj_t *btn;
+    lv_obj_t *label;
+    lv_obj_t *icon;    // NULL without thumbnails
+    uint32_t name_off; // bound entry, FILE_LIST_NO_ENTRY for none
+} file_row_t;
+
+typedef struct {
+    lv_obj_t *list;
+    ui_file_list_config_t cfg;
+    char dir[128];
+    char empty_text[64];
+    file_scan_t *scan;
+    int64_t scan_start_us;
+    bool done;
+    bool failed;
+    bool from_index; // names are paths relative to dir, each followed by its label
+    bool subscribed;
+
+    // Entry table in PSRAM: NUL-terminated names back to back, and offsets in display order.
+    char *names;
+    uint32_t names_len;
+    uint32_t names_cap;
+    uint32_t *order;
+    uint32_t count;
+    uint32_t order_cap;
+
+    lv_obj_t *spacer; // sets the scroll extent to the window's rows
+    list_window_t win;
+    file_row_t rows[FILE_LIST_MAX_ROWS];
+    uint8_t row_count;
+} file_list_t;
+
+static void scan_unref(file_scan_t *scan)
+{
+    if (scan->refs.fetch_sub(1) == 1) {
+        delete scan;
+    }
+}
+
+// ---- Worker ----
+
+static void on_batch(void *p);
+
+static void post_batch(file_batch_t *b)
+{
+    std::sort(b->off, b->off + b->count, [b](uint16_t x, uint16_t y) {
+        return media_index_name_cmp(b->names + x, b->names + y) < 0;
+    });
+    b->scan->refs.fetch_add(1);
+    if (display_lvgl_async_call(on_batch, b) != ESP_OK) {
+        scan_unref(b->scan);
+        delete b;
+    }
+}
+
+static file_batch_t *new_batch(file_scan_t *scan)
+{
+    file_batch_t *b = new (std::nothrow) file_batch_t();
+    if (b) {
+        b->scan = scan;
+    }
+    return b;
+}
+
+static void scan_task(void *arg)
+{
+    file_scan_t *scan = (file_scan_t *)arg;
+    DIR *dir = opendir(scan->dir);
+    file_batch_t *b = new_batch(scan);
+    if (!dir) {
+        if (b) {
+            b->done = true;
+            b->failed = true;
+            post_batch(b);
+        }
+        scan_unref(scan);
+        vTaskDelete(NULL);
+        return;
+    }
+
+    int64_t last_post_us = esp_timer_get_time();
+    struct dirent *ent;
+    while (b && !scan->cancelled.load() && (ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.' || ent->d_type == DT_DIR || !scan->filter(ent->d_name)) {
+            continue;
+        }
+        const size_t len = strlen(ent->d_name) + 1;
+        if (b->count == FILE_LIST_BATCH_NAMES || b->len + len > sizeof(b->names)) {
+            post_batch(b);
+            b = new_batch(scan);
+            last_post_us = esp_timer_get_time();
+            if (!b) {
+                break;
+            }
+        }
+        b->off[b->count++] = b->len;
+        memcpy(b->names + b->len, ent->d_name, len);
+        b->len = (uint16_t)(b->len + len);
+
+        const int64_t now = esp_timer_get_time();
+        if (now - last_post_us >= FILE_LIST_BATCH_MS * 1000) {
+            post_batch(b);
+            b = new_batch(scan);
+            last_post_us = now;
+        }
+    }
+    closedir(dir);
+    if (b) {
+        b->done = true;
+        post_batch(b);
+    } else {
+        ESP_LOGW(TAG, "%s: out of memory, list is incomplete", scan->dir);
+    }
+    scan_unref(scan);
+    vTaskDelete(NULL);
+}
+
+// ---- Rows (LVGL task) ----
+
+static void row_click_cb(lv_event_t *e)
+{
+    file_list_t *fl = (file_list_t *)lv_obj_get_user_data((lv_obj_t *)lv_event_get_user_data(e));
+    const file_row_t *row = fl ? &fl->rows[(uintptr_t)lv_obj_get_user_data(lv_event_get_target(e))] : nullptr;
+    if (!row || row->name_off == FILE_LIST_NO_ENTRY || !fl->cfg.on_click) {
+        return;
+    }
+    char path[300];
+    snprintf(path, sizeof(path), "%s/%s", fl->dir, fl->names + row->name_off);
+    fl->cfg.on_click(path, fl->cfg.user_data);
+}
+
+static void bind_row(file_list_t *fl, file_row_t *row, uint32_t name_off)
+{
+    row->name_off = name_off;
+    const char *name = fl->names + name_off;
+    lv_label_set_text(row->label, fl->from_index ? name + strlen(name) + 1 : name);
+    lv_obj_clear_state(row->btn, LV_STATE_DISABLED);
+    if (!row->icon) {
+        return;
+    }
+    if (fl->cfg.thumb_filter(name)) {
+        char path[300];
+        snprintf(path, sizeof(path), "%s/%s", fl->dir, name);
+        thumb_cache_bind(row->icon, path);
+    } else {
+        thumb_cache_bind(row->icon, NULL);
+    }
+}
+
+static void ensure_rows(file_list_t *fl)
+{
+    const lv_coord_t view_h = lv_obj_get_content_height(fl->list);
+    uint32_t want = (uint32_t)(view_h + FILE_LIST_ROW_H - 1) / FILE_LIST_ROW_H + FILE_LIST_SPARE_ROWS;
+    want = std::min<uint32_t>(want, FILE_LIST_MAX_ROWS);
+    while (fl->row_count < want) {
+        file_row_t *row = &fl->rows[fl->row_count];
+        row->btn = lv_list_add_btn(fl->list, NULL, "");
+        row->label = lv_obj_get_child(row->btn, 0);
+        row->icon = fl->cfg.thumb_filter ? thumb_cache_attach(row->btn, NULL) : nullptr;
+        row->name_off = FILE_LIST_NO_ENTRY;
+        lv_obj_set_size(row->btn, lv_pct(100), FILE_LIST_ROW_H);
+        lv_obj_set_user_data(row->btn, (void *)(uintptr_t)fl->row_count);
+        lv_obj_add_event_cb(row->btn, row_click_cb, LV_EVENT_CLICKED, fl->list);
+        lv_obj_add_flag(row->btn, LV_OBJ_FLAG_HIDDEN);
+        fl->row_count++;
+    }
+}
+
+// Moves the window for a changed count or scroll position; see list_window_update().
+static lv_coord_t slide_window(file_list_t *fl, uint32_t shift)
+{
+    const lv_coord_t scroll_y = lv_obj_get_scroll_y(fl->list);
+    const lv_coord_t y = (lv_coord_t)list_window_update(&fl->win, fl->count, shift, scroll_y,
+                                                        lv_obj_get_content_height(fl->list));
+    lv_obj_set_height(fl->spacer, (lv_coord_t)(list_window_span(&fl->win) * FILE_LIST_ROW_H));
+    if (y != scroll_y) {
+        lv_obj_scroll_by(fl->list, 0, scroll_y - y, LV_ANIM_OFF);
+    }
+    return y;
+}
+
+// Entry i is drawn by row i % row_count, so rows that stay in view keep their binding.
+static void refresh(file_list_t *fl)
+{
+    if (!fl->spacer) {
+        return; // between lv_obj_clean() and the rebuild
+    }
+    ensure_rows(fl);
+    const lv_coord_t scroll_y = slide_window(fl, 0);
+
+    if (fl->count == 0) {
+        file_row_t *row = &fl->rows[0];
+        row->name_off = FILE_LIST_NO_ENTRY;
+        if (row->icon) {
+            thumb_cache_bind(row->icon, NULL);
+        }
+        if (fl->failed) {
+            lv_label_set_text_fmt(row->label, "No %s directory", fl->dir);
+        } else {
+            lv_label_set_text(row->label, fl->done ? fl->empty_text : "Loading...");
+        }
+        lv_obj_add_state(row->btn, LV_STATE_DISABLED);
+        lv_obj_set_y(row->btn, 0);
+        lv_obj_clear_flag(row->btn, LV_OBJ_FLAG_HIDDEN);
+        for (uint8_t i = 1; i < fl->row_count; i++) {
+            lv_obj_add_flag(fl->rows[i].btn, LV_OBJ_FLAG_HIDDEN);
+        }
+        return;
+    }
+
+    const uint32_t first = list_window_index(&fl->win, scroll_y - FILE_LIST_ROW_H);
+    for (uint32_t i = first; i < first + fl->row_count; i++) {
+        file_row_t *row = &fl->rows[i % fl->row_count];
+        if (i >= fl->count) {
+            row->name_off = FILE_LIST_NO_ENTRY;
+            lv_obj_add_flag(row->btn, LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        if (row->name_off != fl->order[i]) {
+            bind_row(fl, row, fl->order[i]);
+        }
+        lv_obj_set_y(row->btn, (lv_coord_t)list_window_y(&fl->win, i));
+        lv_obj_clear_flag(row->btn, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// ---- Entry table (LVGL task) ----
+
+static bool table_reserve(file_list_t *fl, uint32_t add_bytes, uint32_t add_count)
+{
+    if (fl->names_len + add_bytes > fl->names_cap) {
+        const uint32_t cap = std::max<uint32_t>(std::max<uint32_t>(fl->names_cap * 2, 16 * 1024), fl->names_len + add_bytes);
+        char *p = (char *)heap_caps_realloc(fl->names, cap, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) {
+            return false;
+        }
+        fl->names = p;
+        fl->names_cap = cap;
+    }
+    if (fl->count + add_count > fl->order_cap) {
+        const uint32_t cap = std::max<uint32_t>(std::max<uint32_t>(fl->order_cap * 2, 512), fl->count + add_count);
+        uint32_t *p = (uint32_t *)heap_caps_realloc(fl->order, cap * sizeof(uint32_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) {
+            return false;
+        }
+        fl->order = p;
+        fl->order_cap = cap;
+    }
+    return true;
+}
+
+// Merges a sorted batch into the table. Returns how many new entries sort before entry `anchor`.
+static uint32_t table_merge(file_list_t *fl, const file_batch_t *b, uint32_t anchor)
+{
+    uint32_t added[FILE_LIST_BATCH_NAMES];
+    for (uint16_t i = 0; i < b->count; i++) {
+        const char *name = b->names + b->off[i];
+        const uint32_t len = (uint32_t)strlen(name) + 1;
+        memcpy(fl->names + fl->names_len, name, len);
+        added[i] = fl->names_len;
+        fl->names_len += len;
+    }
+
+    uint32_t before_anchor = 0;
+    const char *anchor_name = anchor < fl->count ? fl->names + fl->order[anchor] : nullptr;
+    int32_t i = (int32_t)fl->count - 1;
+    int32_t j = (int32_t)b->count - 1;
+    uint32_t w = fl->count + b->count;
+    while (j >= 0) {
+        if (i >= 0 && media_index_name_cmp(fl->names + fl->order[i], fl->names + added[j]) > 0) {
+            fl->order[--w] = fl->order[i--];
+        } else {
+            if (anchor_name && media_index_name_cmp(fl->names + added[j], anchor_name) < 0) {
+                before_anchor++;
+            }
+            fl->order[--w] = added[j--];
+        }
+    }
+    fl->count += b->count;
+    return before_anchor;
+}
+
+static void on_batch(void *p)
+{
+    file_batch_t *b = (file_batch_t *)p;
+    file_scan_t *scan = b->scan;
+    file_list_t *fl = scan->cancelled.load() ? nullptr : (file_list_t *)scan->owner;
+    if (fl && fl->spacer) {
+        if (b->count && table_reserve(fl, b->len, b->count)) {
+            // Keep the entry at the top of the view in place while names land above it.
+            const lv_coord_t scroll_y = lv_obj_get_scroll_y(fl->list);
+            const bool at_top = scroll_y <= 0 && fl->win.base == 0;
+            const uint32_t top = list_window_index(&fl->win, scroll_y);
+            slide_window(fl, table_merge(fl, b, at_top ? FILE_LIST_NO_ENTRY : top));
+        } else if (b->count) {
+            ESP_LOGW(TAG, "%s: out of memory at %u entries", fl->dir, (unsigned)fl->count);
+        }
+        if (b->done) {
+            fl->done = true;
+            fl->failed = b->failed;
+            ESP_LOGI(TAG, "%s: %u entries in %u ms, %u KB", fl->dir, (unsigned)fl->count,
+                     (unsigned)((esp_timer_get_time() - fl->scan_start_us) / 1000),
+                     (unsigned)((fl->names_len + fl->count * sizeof(uint32_t)) / 1024));
+        }
+        refresh(fl);
+    }
+    delete b;
+    scan_unref(scan);
+}
+
+// ---- Index lists (LVGL task) ----
+
+static bool index_visit(const media_index_entry_t *e, void *user_data)
+{
+    file_list_t *fl = (file_list_t *)user_data;
+    const char *base = strrchr(e->path, '/');
+    if (!fl->cfg.filter(base ? base + 1 : e->path)) {
+        return true;
+    }
+    char label[200];
+    if (e->title[0] && e->artist[0]) {
+        snprintf(label, sizeof(label), "%s - %s", e->artist, e->title);
+    } else {
+        snprintf(label, sizeof(label), "%s", e->title[0] ? e->title : e->path);
+    }
+    const uint32_t path_len = (uint32_t)strlen(e->path) + 1;
+    const uint32_t label_len = (uint32_t)strlen(label) + 1;
+    if (!table_reserve(fl, path_len + label_len, 1)) {
+        ESP_LOGW(TAG, "out of memory at %u entries", (unsigned)fl->count);
+        return false;
+    }
+    fl->order[fl->count++] = fl->names_len;
+    memcpy(fl->names + fl->names_len, e->path, path_len);
+    memcpy(fl->names + fl->names_len + path_len, label, label_len);
+    fl->names_len += path_len + label_len;
+    return true;
+}
+
+static void fill_from_index(file_list_t *fl)
+{
+    const int64_t t0 = esp_timer_get_time();
+    fl->from_index = true;
+    media_index_query(fl->cfg.index_kinds, (media_sort_t)fl->cfg.index_sort, index_visit, fl);
+    fl->done = true;
+    ESP_LOGI(TAG, "index: %u entries in %u ms", (unsigned)fl->count, (unsigned)((esp_timer_get_time() - t0) / 1000));
+    refresh(fl);
+}
+
+static void on_index_update(void *user_data)
+{
+    file_list_t *fl = (file_list_t *)user_data;
+    char dir[sizeof(fl->dir)];
+    char empty_text[sizeof(fl->empty_text)];
+    snprintf(dir, sizeof(dir), "%s", fl->dir);
+    snprintf(empty_text, sizeof(empty_text), "%s", fl->empty_text);
+    ui_file_list_config_t cfg = fl->cfg;
+    cfg.dir = dir;
+    cfg.empty_text = empty_text;
+    const lv_coord_t scroll_y = lv_obj_get_scroll_y(fl->list);
+    const uint32_t top = list_window_index(&fl->win, scroll_y);
+    const lv_coord_t in_row = scroll_y > 0 ? scroll_y % FILE_LIST_ROW_H : 0;
+    ui_file_list_populate(fl->list, &cfg);
+    const lv_coord_t y = (lv_coord_t)list_window_show(&fl->win, top, lv_obj_get_content_height(fl->list));
+    lv_obj_set_height(fl->spacer, (lv_coord_t)(list_window_span(&fl->win) * FILE_LIST_ROW_H));
+    lv_obj_update_layout(fl->list);
+    lv_obj_scroll_to_y(fl->list, y + in_row, LV_ANIM_OFF);
+    refresh(fl);
+}
+
+// ---- Lifecycle ----
+
+static void stop_scan(file_list_t *fl)
+{
+    if (fl->scan) {
+        fl->scan->cancelled.store(true);
+        scan_unref(fl->scan);
+        fl->scan = nullptr;
+    }
+}
+
+static void list_event_cb(lv_event_t *e)
+{
+    lv_obj_t *list = lv_event_get_target(e);
+    file_list_t *fl = (file_list_t *)lv_obj_get_user_data(list);
+    if (!fl) {
+        return;
+    }
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_SCROLL:
+    case LV_EVENT_SIZE_CHANGED:
+        refresh(fl);
+        break;
+    case LV_EVENT_DELETE:
+        stop_scan(fl);
+        if (fl->subscribed) {
+            media_index_unsubscribe(on_index_update, fl);
+        }
+        heap_caps_free(fl->names);
+        heap_caps_free(fl->order);
+        lv_obj_set_user_data(list, NULL);
+        delete fl;
+        break;
+    default:
+        break;
+    }
+}
+
+bool ui_file_list_step(lv_obj_t *list, const char *vfs_path, int step, ui_file_list_filter_t filter, char *out,
+                       size_t out_len)
+{
+    file_list_t *fl = (list && lv_obj_is_valid(list)) ? (file_list_t *)lv_obj_get_user_data(list) : nullptr;
+    const size_t dir_len = fl ? strlen(fl->dir) : 0;
+    if (!fl || !vfs_path || fl->count == 0 || strncmp(vfs_path, fl->dir, dir_len) != 0 || vfs_path[dir_len] != '/') {
+        return false;
+    }
+    const char *name = vfs_path + dir_len + 1;
+
+    uint32_t lo = 0;
+    uint32_t hi = fl->count;
+    if (fl->from_index) {
+        // Index lists are in the index's sort order, not by name.
+        while (lo < fl->count && strcmp(fl->names + fl->order[lo], name) != 0) {
+            lo++;
+        }
+        hi = lo;
+    }
+    // Scanned lists are sorted by media_index_name_cmp.
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (media_index_name_cmp(fl->names + fl->order[mid], name) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // Names that only differ in leading zeros compare equal; step over them.
+    while (lo < fl->count && strcmp(fl->names + fl->order[lo], name) != 0 &&
+           media_index_name_cmp(fl->names + fl->order[lo], name) == 0) {
+        lo++;
+    }
+    if (lo == fl->count || strcmp(fl->names + fl->order[lo], name) != 0) {
+        return false;
+    }
+
+    const int dir = step < 0 ? -1 : 1;
+    int remaining = step < 0 ? -step : step;
+    uint32_t i = lo;
+    for (uint32_t n = 1; n < fl->count && remaining > 0; n++) {
+        i = (i + fl->count + dir) % fl->count;
+        if (!filter || filter(fl->names + fl->order[i])) {
+            remaining--;
+        }
+    }
+    if (remaining > 0 || i == lo) {
+        return false;
+    }
+    snprintf(out, out_len, "%s/%s", fl->dir, fl->names + fl->order[i]);
+    return true;
+}
+
+void ui_file_list_populate(lv_obj_t *list, const ui_file_list_config_t *cfg)
+{
+    if (!list || !cfg || !cfg->dir || !cfg->filter) {
+        return;
+    }
+    file_list_t *fl = (file_list_t *)lv_obj_get_user_data(list);
+    if (fl) {
+        // Rescan: drop rows and entries, keep the allocations.
+        stop_scan(fl);
+        fl->spacer = nullptr;
+        fl->row_count = 0;
+        fl->names_len = 0;
+        fl->count = 0;
+        lv_obj_clean(list);
+    } else {
+        fl = new (std::nothrow) file_list_t();
+        if (!fl) {
+            return;
+        }
+        fl->list = list;
+        lv_obj_set_user_data(list, fl);
+        lv_obj_add_event_cb(list, list_event_cb, LV_EVENT_ALL, NULL);
+        lv_obj_clean(list);
+    }
+    fl->cfg = *cfg;
+    snprintf(fl->dir, sizeof(fl->dir), "%s", cfg->dir);
+    snprintf(fl->empty_text, sizeof(fl->empty_text), "%s", cfg->empty_text ? cfg->empty_text : "No files");
+    fl->cfg.dir = fl->dir;
+    fl->cfg.empty_text = fl->empty_text;
+    fl->done = false;
+    fl->failed = false;
+    fl->from_index = false;
+    list_window_init(&fl->win, FILE_LIST_WINDOW_ROWS, FILE_LIST_ROW_H);
+    if (cfg->index_kinds && !fl->subscribed) {
+        fl->subscribed = media_index_subscribe(on_index_update, fl);
+    }
+
+    // Rows are placed by hand; the spacer gives the list the scroll height of the window.
+    lv_obj_set_layout(list, 0);
+    lv_obj_scroll_to_y(list, 0, LV_ANIM_OFF);
+    fl->spacer = lv_obj_create(list);
+    lv_obj_remove_style_all(fl->spacer);
+    lv_obj_clear_flag(fl->spacer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_size(fl->spacer, 1, FILE_LIST_ROW_H);
+    lv_obj_update_layout(list);
+    if (cfg->index_kinds && media_index_ready()) {
+        fill_from_index(fl);
+        return;
+    }
+    refresh(fl);
+
+    file_scan_t *scan = new (std::nothrow) file_scan_t();
+    if (!scan) {
+        fl->done = true;
+        refresh(fl);
+        return;
+    }
+    scan->refs.store(2); // list + worker
+    snprintf(scan->dir, sizeof(scan->dir), "%s", cfg->dir);
+    scan->filter = cfg->filter;
+    scan->owner = fl;
+    fl->scan = scan;
+    fl->scan_start_us = esp_timer_get_time();
+    if (xTaskCreatePinnedToCore(scan_task, "file_scan", FILE_LIST_TASK_STACK_SIZE, scan, FILE_LIST_TASK_PRIORITY, NULL,
+                                FILE_LIST_TASK_CORE) != pdPASS) {
+        scan->refs.fetch_sub(1);
+        fl->done = true;
+        refresh(fl);
+    }
+}
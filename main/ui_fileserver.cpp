@@ -5,7 +5,9 @@
 #include "lvgl.h"
 
 #include "app_pins.h"
+#include "display_lvgl.h"
 #include "ui_app_carousel.h"
+#include "ui_theme.h"
 
 #include "services/audio_es8311.h"
 #include "services/fileserver_service.h"
@@ -39,7 +41,7 @@ static inline void ui_load_screen_deferred(lv_obj_t *scr, bool auto_del)
     }
     req->scr = scr;
     req->auto_del = auto_del;
-    lv_async_call(ui_screen_load_async_cb, req);
+    display_lvgl_async_call(ui_screen_load_async_cb, req);
 }
 
 static inline void ui_click(void)
@@ -57,19 +59,14 @@ static void set_content_area(lv_obj_t *cont)
 static lv_obj_t *make_screen(const char *title)
 {
     lv_obj_t *scr = lv_obj_create(NULL);
-    lv_obj_set_style_pad_all(scr, 8, 0);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
+    ui_theme_apply(scr, UI_THEME_SCREEN);
 
     lv_obj_t *hdr = lv_obj_create(scr);
-    lv_obj_set_width(hdr, lv_pct(100));
-    lv_obj_set_height(hdr, 44);
-    lv_obj_set_style_pad_all(hdr, 6, 0);
-    lv_obj_set_style_bg_color(hdr, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(hdr, 0, 0);
+    ui_theme_apply(hdr, UI_THEME_HEADER);
     lv_obj_clear_flag(hdr, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t *btn_exit = lv_btn_create(hdr);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
@@ -87,7 +84,7 @@ static lv_obj_t *make_screen(const char *title)
 
     lv_obj_t *lbl_title = lv_label_create(hdr);
     lv_label_set_text(lbl_title, title);
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
 
     return scr;
@@ -109,17 +106,15 @@ esp_err_t ui_fileserver_open(void)
 
     lv_obj_t *cont = lv_obj_create(s_screen);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 8, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT);
 
     lv_obj_t *lbl = lv_label_create(cont);
     lv_label_set_text(lbl, "Starting SoftAP + Web UI...\n");
-    lv_obj_set_style_text_color(lbl, lv_color_white(), 0);
+    ui_theme_apply(lbl, UI_THEME_TITLE);
     lv_obj_align(lbl, LV_ALIGN_TOP_LEFT, 0, 0);
 
     s_lbl_status = lv_label_create(cont);
-    lv_obj_set_style_text_color(s_lbl_status, lv_color_white(), 0);
+    ui_theme_apply(s_lbl_status, UI_THEME_TITLE);
     lv_obj_align(s_lbl_status, LV_ALIGN_TOP_LEFT, 0, 40);
 
     // Best-effort SD mount so /sdcard is available from the web UI.
@@ -129,9 +124,15 @@ esp_err_t ui_fileserver_open(void)
 
     const esp_err_t err = fileserver_service_start();
     if (err == ESP_OK) {
+#if CONFIG_HTTPD_WS_SUPPORT
         lv_label_set_text_fmt(s_lbl_status,
-                              "AP SSID: %s\nIP: http://%s/\nRoots: flash=/storage, sd=/sdcard\n",
+                              "AP SSID: %s\nIP: http://%s/\nRoots: flash=/storage, sd=/sdcard\n"
+                              "Mirror: http://%s/mirror\n",
+                              fileserver_service_ap_ssid(), fileserver_service_ap_ip(), fileserver_service_ap_ip());
+#else
+        lv_label_set_text_fmt(s_lbl_status, "AP SSID: %s\nIP: http://%s/\nRoots: flash=/storage, sd=/sdcard\n",
                               fileserver_service_ap_ssid(), fileserver_service_ap_ip());
+#endif
     } else {
         lv_label_set_text_fmt(s_lbl_status, "Start failed: %d", (int)err);
     }
@@ -1,14 +1,18 @@
 #include "ui_launcher.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include "lvgl.h"
 #include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "display_lvgl.h"
 #include "app_pins.h"
 #include "ui_app_carousel.h"
 #include "ui_radio.h"
+#include "ui_theme.h"
 
 #include "services/power_axp2101.h"
 #include "services/power_manager.h"
@@ -60,7 +64,7 @@ static inline void ui_load_screen_deferred(lv_obj_t *scr, bool auto_del)
     }
     req->scr = scr;
     req->auto_del = auto_del;
-    lv_async_call(ui_screen_load_async_cb, req);
+    display_lvgl_async_call(ui_screen_load_async_cb, req);
 }
 
 static inline void ui_push_screen(lv_obj_t *scr)
@@ -78,19 +82,14 @@ static inline void ui_replace_screen(lv_obj_t *scr)
 static lv_obj_t *make_app_screen(const char *title)
 {
     lv_obj_t *scr = lv_obj_create(NULL);
-    lv_obj_set_style_pad_all(scr, 8, 0);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
+    ui_theme_apply(scr, UI_THEME_SCREEN);
 
     lv_obj_t *hdr = lv_obj_create(scr);
-    lv_obj_set_width(hdr, lv_pct(100));
-    lv_obj_set_height(hdr, 44);
-    lv_obj_set_style_pad_all(hdr, 6, 0);
-    lv_obj_set_style_bg_color(hdr, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(hdr, 0, 0);
+    ui_theme_apply(hdr, UI_THEME_HEADER);
     lv_obj_clear_flag(hdr, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t *btn_back = lv_btn_create(hdr);
-    lv_obj_set_size(btn_back, 60, 32);
+    ui_theme_apply(btn_back, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_back, LV_ALIGN_LEFT_MID, 0, 0);
     lv_obj_t *lbl = lv_label_create(btn_back);
     lv_label_set_text(lbl, "Back");
@@ -108,7 +107,7 @@ static lv_obj_t *make_app_screen(const char *title)
     
     // Exit button to return to carousel
     lv_obj_t *btn_exit = lv_btn_create(hdr);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
@@ -126,7 +125,7 @@ static lv_obj_t *make_app_screen(const char *title)
 
     lv_obj_t *lbl_title = lv_label_create(hdr);
     lv_label_set_text(lbl_title, title);
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
 
     return scr;
@@ -200,14 +199,11 @@ static void open_settings()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 8, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT);
 
     lv_obj_t *list = lv_list_create(cont);
     lv_obj_set_size(list, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_bg_color(list, lv_color_hex(0x0a0a0a), 0);
-    lv_obj_set_style_border_width(list, 0, 0);
+    ui_theme_apply(list, UI_THEME_LIST);
 
     lv_obj_t *btn_display = lv_list_add_btn(list, NULL, "Display");
     lv_obj_add_event_cb(btn_display, [](lv_event_t *) {
@@ -289,9 +285,7 @@ static void open_display_settings()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 12, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_LOOSE);
 
     // Brightness label and slider
     lv_obj_t *lbl_brightness = lv_label_create(cont);
@@ -339,11 +333,8 @@ static void open_power()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 12, 0);
-    lv_obj_set_style_pad_row(cont, 10, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_LOOSE);
     lv_obj_set_flex_flow(cont, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
 
     // UI sounds
     lv_obj_t *cb_sounds = lv_checkbox_create(cont);
@@ -445,9 +436,7 @@ static void open_wifi()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 8, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT);
 
     wifi_ui_refs_t *refs = (wifi_ui_refs_t *)lv_mem_alloc(sizeof(wifi_ui_refs_t));
     if (refs) {
@@ -541,8 +530,7 @@ static void open_wifi()
     lv_obj_set_width(list, lv_pct(100));
     lv_obj_set_height(list, 140);
     lv_obj_align_to(list, lbl_networks, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 4);
-    lv_obj_set_style_border_width(list, 0, 0);
-    lv_obj_set_style_bg_color(list, lv_color_hex(0x0a0a0a), 0);
+    ui_theme_apply(list, UI_THEME_LIST);
     // Ensure list item text is visible (some themes default to dark text).
     lv_obj_set_style_text_color(list, lv_color_white(), LV_PART_ITEMS);
     if (refs) {
@@ -600,11 +588,8 @@ static void open_audio()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 12, 0);
-    lv_obj_set_style_pad_row(cont, 10, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_LOOSE);
     lv_obj_set_flex_flow(cont, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
 
     // Output enable/disable
     lv_obj_t *cb_disable = lv_checkbox_create(cont);
@@ -719,9 +704,7 @@ static void open_sd()
 
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 12, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_LOOSE);
 
     lv_obj_t *lbl = lv_label_create(cont);
     lv_obj_align(lbl, LV_ALIGN_CENTER, 0, 0);
@@ -776,7 +759,7 @@ static void open_sd()
         const esp_err_t ret = sdcard_service_mount();
 
         // Update UI in LVGL context
-        lv_async_call(
+        display_lvgl_async_call(
             [](void *p) {
                 sd_ui_ctx_t *ctx = (sd_ui_ctx_t *)p;
                 if (ctx && ctx->screen && ctx->label && lv_obj_is_valid(ctx->screen) && lv_obj_is_valid(ctx->label) &&
@@ -958,7 +941,7 @@ static void wifi_ui_start_scan(wifi_ui_refs_t *r)
             memcpy(done->aps, ap_list, sizeof(ap_list));
         }
 
-        lv_async_call(
+        display_lvgl_async_call(
             [](void *p) {
                 wifi_scan_done_t *done = (wifi_scan_done_t *)p;
                 if (!done) return;
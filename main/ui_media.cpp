@@ -1,27 +1,34 @@
 #include "ui_media.h"
 
-#include <dirent.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <new>
+
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lvgl.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "app_pins.h"
+#include "display_lvgl.h"
+#include "gif_stream.h"
+#include "image_decoder.h"
+#include "media_index.h"
 #include "ui_app_carousel.h"
+#include "ui_file_list.h"
+#include "ui_screen_cache.h"
+#include "ui_theme.h"
 
 #include "services/audio_es8311.h"
 #include "services/sdcard_service.h"
 
-#if LV_USE_GIF
-#include "extra/libs/gif/lv_gif.h"
-#endif
-
 static const char *TAG = "ui_media";
 
+static constexpr int kContentTop = 52;
+
 static lv_obj_t *s_media_screen = nullptr;
 
 typedef struct {
@@ -49,7 +56,7 @@ static inline void ui_load_screen_deferred(lv_obj_t *scr, bool auto_del)
     }
     req->scr = scr;
     req->auto_del = auto_del;
-    lv_async_call(ui_screen_load_async_cb, req);
+    display_lvgl_async_call(ui_screen_load_async_cb, req);
 }
 
 static inline void ui_click(void)
@@ -59,9 +66,8 @@ static inline void ui_click(void)
 
 static void set_content_area(lv_obj_t *cont)
 {
-    constexpr int kTop = 52;
-    lv_obj_set_size(cont, APP_LCD_H_RES, APP_LCD_V_RES - kTop);
-    lv_obj_align(cont, LV_ALIGN_TOP_MID, 0, kTop);
+    lv_obj_set_size(cont, APP_LCD_H_RES, APP_LCD_V_RES - kContentTop);
+    lv_obj_align(cont, LV_ALIGN_TOP_MID, 0, kContentTop);
 }
 
 static bool has_ext(const char *name, const char *ext)
@@ -83,20 +89,15 @@ static bool has_ext(const char *name, const char *ext)
 static lv_obj_t *make_screen(const char *title, bool show_back)
 {
     lv_obj_t *scr = lv_obj_create(NULL);
-    lv_obj_set_style_pad_all(scr, 8, 0);
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
+    ui_theme_apply(scr, UI_THEME_SCREEN);
 
     lv_obj_t *hdr = lv_obj_create(scr);
-    lv_obj_set_width(hdr, lv_pct(100));
-    lv_obj_set_height(hdr, 44);
-    lv_obj_set_style_pad_all(hdr, 6, 0);
-    lv_obj_set_style_bg_color(hdr, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(hdr, 0, 0);
+    ui_theme_apply(hdr, UI_THEME_HEADER);
     lv_obj_clear_flag(hdr, LV_OBJ_FLAG_SCROLLABLE);
 
     if (show_back) {
         lv_obj_t *btn_back = lv_btn_create(hdr);
-        lv_obj_set_size(btn_back, 60, 32);
+        ui_theme_apply(btn_back, UI_THEME_HEADER_BTN);
         lv_obj_align(btn_back, LV_ALIGN_LEFT_MID, 0, 0);
         lv_obj_t *lbl = lv_label_create(btn_back);
         lv_label_set_text(lbl, "Back");
@@ -111,7 +112,7 @@ static lv_obj_t *make_screen(const char *title, bool show_back)
     }
 
     lv_obj_t *btn_exit = lv_btn_create(hdr);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
@@ -120,8 +121,11 @@ static lv_obj_t *make_screen(const char *title, bool show_back)
         ui_click();
         lv_obj_t *carousel = ui_app_carousel_get_screen();
         if (carousel && lv_obj_is_valid(carousel)) {
+            // Keep the file list alive for the next launch; a viewer screen on top is dropped.
+            const bool on_list = (lv_scr_act() == s_media_screen);
+            ui_screen_cache_park(UI_SCREEN_MEDIA, s_media_screen);
             // Defer: don't delete the active screen inside its callback.
-            ui_load_screen_deferred(carousel, true);
+            ui_load_screen_deferred(carousel, !on_list);
         } else {
             ui_app_carousel_init();
         }
@@ -129,28 +133,303 @@ static lv_obj_t *make_screen(const char *title, bool show_back)
 
     lv_obj_t *lbl_title = lv_label_create(hdr);
     lv_label_set_text(lbl_title, title);
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
     return scr;
 }
 
-static void open_jpg_viewer(const char *vfs_path)
+static bool is_jpg_file(const char *name)
+{
+    return has_ext(name, ".jpg") || has_ext(name, ".jpeg");
+}
+
+// ---- JPG viewer ----
+//
+// The viewer keeps the previous, current and next photo of the list decoded: three PSRAM images
+// from image_decoder, decoded on core 0 while the current one is on screen. A swipe moves to a
+// neighbour that is normally finished already, and the one that fell off the far side is reused for
+// the new neighbour. Tap toggles the slideshow. Time from request to a complete image is logged.
+
+#define SLIDESHOW_INTERVAL_MS 4000
+#define SLIDE_ANIM_MS 200
+#define SLIDE_STATUS_MS 1200
+
+typedef struct {
+    image_decode_job_t *job;
+    char path[300];
+    bool done;
+    bool failed;
+} slide_t;
+
+typedef struct {
+    lv_obj_t *img[2]; // img[front] shows the current slide; the other one slides in on a swipe
+    uint8_t front;
+    lv_obj_t *status;
+    lv_timer_t *status_timer;
+    lv_timer_t *auto_timer;
+    slide_t slides[3]; // previous, current and next, rotating around cur
+    uint8_t cur;
+    int64_t requested_us; // when the current slide was asked for; 0 once it is complete on screen
+    uint32_t ttd_total_ms;
+    uint32_t ttd_count;
+} viewer_t;
+
+static lv_obj_t *s_media_list = nullptr;
+
+static slide_t *slide_at(viewer_t *v, int offset)
+{
+    return &v->slides[(v->cur + 3 + offset) % 3];
+}
+
+static void show_status(viewer_t *v, const char *text, uint32_t hide_after_ms)
+{
+    lv_label_set_text(v->status, text);
+    lv_obj_clear_flag(v->status, LV_OBJ_FLAG_HIDDEN);
+    if (hide_after_ms) {
+        lv_timer_set_period(v->status_timer, hide_after_ms);
+        lv_timer_reset(v->status_timer);
+        lv_timer_resume(v->status_timer);
+    } else {
+        lv_timer_pause(v->status_timer);
+    }
+}
+
+static void slide_on_screen(viewer_t *v)
+{
+    if (!v->requested_us) {
+        return;
+    }
+    const uint32_t ms = (uint32_t)((esp_timer_get_time() - v->requested_us) / 1000);
+    v->requested_us = 0;
+    v->ttd_total_ms += ms;
+    v->ttd_count++;
+    ESP_LOGI(TAG, "%s on screen in %u ms (avg %u ms over %u)", slide_at(v, 0)->path, (unsigned)ms,
+             (unsigned)(v->ttd_total_ms / v->ttd_count), (unsigned)v->ttd_count);
+    char text[32];
+    snprintf(text, sizeof(text), "%u ms", (unsigned)ms);
+    show_status(v, text, SLIDE_STATUS_MS);
+}
+
+static void slide_decode_cb(image_decode_job_t *job, image_decode_event_t event, void *user_data)
+{
+    viewer_t *v = (viewer_t *)user_data;
+    slide_t *slide = nullptr;
+    for (slide_t &s : v->slides) {
+        if (s.job == job) slide = &s;
+    }
+    if (!slide) return;
+    const bool current = slide == slide_at(v, 0);
+    lv_obj_t *img = v->img[v->front];
+
+    switch (event) {
+    case IMAGE_DECODE_STARTED:
+        // The current slide is shown right away; rows appear as the worker decodes them.
+        if (current) {
+            lv_img_set_src(img, image_decoder_image(job));
+            lv_obj_center(img);
+        }
+        break;
+    case IMAGE_DECODE_PROGRESS:
+        if (current) lv_obj_invalidate(img);
+        break;
+    case IMAGE_DECODE_DONE:
+        slide->done = true;
+        if (current) {
+            lv_obj_invalidate(img);
+            slide_on_screen(v);
+        }
+        break;
+    case IMAGE_DECODE_FAILED:
+        slide->failed = true;
+        if (current) {
+            v->requested_us = 0;
+            show_status(v, "Cannot decode image", 0);
+        }
+        break;
+    }
+}
+
+static void slide_submit(viewer_t *v, slide_t *slide, const char *vfs_path)
+{
+    snprintf(slide->path, sizeof(slide->path), "%s", vfs_path);
+    slide->done = false;
+    slide->failed = false;
+    image_decode_req_t req = {};
+    req.vfs_path = vfs_path;
+    req.max_w = APP_LCD_H_RES;
+    req.max_h = APP_LCD_V_RES - kContentTop;
+    req.mode = IMAGE_DECODE_CROP;
+    req.cb = slide_decode_cb;
+    req.user_data = v;
+    slide->job = image_decoder_submit(&req);
+    slide->failed = !slide->job;
+}
+
+static void slide_drop(viewer_t *v, slide_t *slide)
+{
+    if (!slide->job) return;
+    const lv_img_dsc_t *dsc = image_decoder_image(slide->job);
+    for (lv_obj_t *img : v->img) {
+        if (dsc && lv_img_get_src(img) == dsc) {
+            lv_img_set_src(img, NULL);
+        }
+    }
+    image_decoder_release(slide->job);
+    slide->job = nullptr;
+    slide->path[0] = '\0';
+}
+
+static void slide_translate_cb(void *obj, int32_t x)
 {
-    const char *rel = vfs_path;
-    if (strncmp(vfs_path, "/sdcard/", 8) == 0) rel = vfs_path + 8;
-    char lv_path[300];
-    snprintf(lv_path, sizeof(lv_path), "S:/%s", rel);
+    lv_obj_set_style_translate_x((lv_obj_t *)obj, (lv_coord_t)x, 0);
+}
+
+static void slide_anim(lv_obj_t *img, int32_t from, int32_t to, lv_anim_ready_cb_t ready)
+{
+    lv_anim_t a;
+    lv_anim_init(&a);
+    lv_anim_set_var(&a, img);
+    lv_anim_set_exec_cb(&a, slide_translate_cb);
+    lv_anim_set_values(&a, from, to);
+    lv_anim_set_time(&a, SLIDE_ANIM_MS);
+    lv_anim_set_path_cb(&a, lv_anim_path_ease_out);
+    if (ready) lv_anim_set_ready_cb(&a, ready);
+    lv_anim_start(&a);
+}
+
+// dir: +1 next, -1 previous.
+static void viewer_step(viewer_t *v, int dir)
+{
+    if (!slide_at(v, dir)->job) return;
+
+    // Settle a transition still running, so only img[front] shows anything.
+    lv_obj_t *out = v->img[v->front];
+    lv_obj_t *in = v->img[1 - v->front];
+    lv_anim_del(out, NULL);
+    lv_anim_del(in, NULL);
+    lv_img_set_src(in, NULL);
+    lv_obj_add_flag(in, LV_OBJ_FLAG_HIDDEN);
+
+    // The slide on the far side leaves the buffer; its slot becomes the new neighbour.
+    slide_t *far = slide_at(v, -dir);
+    slide_drop(v, far);
+    v->cur = (uint8_t)((v->cur + 3 + dir) % 3);
+    v->requested_us = esp_timer_get_time();
+
+    const slide_t *cur = slide_at(v, 0);
+    const lv_img_dsc_t *dsc = image_decoder_image(cur->job);
+    if (dsc) {
+        lv_img_set_src(in, dsc);
+        lv_obj_center(in);
+    }
+    lv_obj_clear_flag(in, LV_OBJ_FLAG_HIDDEN);
+    slide_anim(out, 0, -dir * APP_LCD_H_RES, [](lv_anim_t *a) {
+        lv_obj_add_flag((lv_obj_t *)a->var, LV_OBJ_FLAG_HIDDEN);
+    });
+    slide_anim(in, dir * APP_LCD_H_RES, 0, NULL);
+    v->front = (uint8_t)(1 - v->front);
+
+    if (cur->failed) {
+        v->requested_us = 0;
+        show_status(v, "Cannot decode image", 0);
+    } else if (cur->done) {
+        slide_on_screen(v);
+    } else {
+        show_status(v, "Loading...", 0);
+    }
+
+    char path[300];
+    if (ui_file_list_step(s_media_list, cur->path, dir, is_jpg_file, path, sizeof(path))) {
+        slide_submit(v, far, path);
+    }
+}
 
+static void viewer_event_cb(lv_event_t *e)
+{
+    viewer_t *v = (viewer_t *)lv_event_get_user_data(e);
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_GESTURE: {
+        lv_indev_t *indev = lv_indev_get_act();
+        const lv_dir_t dir = lv_indev_get_gesture_dir(indev);
+        if (dir != LV_DIR_LEFT && dir != LV_DIR_RIGHT) break;
+        lv_indev_wait_release(indev); // a swipe is not also a tap
+        viewer_step(v, dir == LV_DIR_LEFT ? 1 : -1);
+        if (v->auto_timer) lv_timer_reset(v->auto_timer);
+        break;
+    }
+    case LV_EVENT_CLICKED:
+        ui_click();
+        if (v->auto_timer) {
+            lv_timer_del(v->auto_timer);
+            v->auto_timer = nullptr;
+            show_status(v, "Slideshow off", SLIDE_STATUS_MS);
+        } else {
+            v->auto_timer = lv_timer_create([](lv_timer_t *t) {
+                viewer_t *v = (viewer_t *)t->user_data;
+                const slide_t *cur = slide_at(v, 0);
+                // Wait for a slide still decoding rather than skipping past it.
+                if (cur->done || cur->failed) viewer_step(v, 1);
+            }, SLIDESHOW_INTERVAL_MS, v);
+            show_status(v, "Slideshow on", SLIDE_STATUS_MS);
+        }
+        break;
+    case LV_EVENT_DELETE:
+        if (v->auto_timer) lv_timer_del(v->auto_timer);
+        lv_timer_del(v->status_timer);
+        for (slide_t &s : v->slides) {
+            slide_drop(v, &s);
+        }
+        delete v;
+        break;
+    default:
+        break;
+    }
+}
+
+static void open_jpg_viewer(const char *vfs_path)
+{
     lv_obj_t *scr = make_screen("JPG Viewer", true);
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 0, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_FLUSH);
+    lv_obj_clear_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
 
-    lv_obj_t *img = lv_img_create(cont);
-    lv_img_set_src(img, lv_path);
-    lv_obj_center(img);
+    viewer_t *v = new (std::nothrow) viewer_t();
+    if (!v) {
+        lv_obj_t *lbl = lv_label_create(cont);
+        lv_label_set_text(lbl, "No memory");
+        lv_obj_center(lbl);
+        lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+        return;
+    }
+    for (lv_obj_t *&img : v->img) {
+        img = lv_img_create(cont);
+    }
+    lv_obj_add_flag(v->img[1], LV_OBJ_FLAG_HIDDEN);
+    v->status = lv_label_create(cont);
+    ui_theme_apply(v->status, UI_THEME_TITLE);
+    lv_obj_align(v->status, LV_ALIGN_BOTTOM_MID, 0, -8);
+    v->status_timer = lv_timer_create([](lv_timer_t *t) {
+        lv_obj_add_flag(((viewer_t *)t->user_data)->status, LV_OBJ_FLAG_HIDDEN);
+        lv_timer_pause(t);
+    }, SLIDE_STATUS_MS, v);
+    lv_obj_add_event_cb(cont, viewer_event_cb, LV_EVENT_ALL, v);
+
+    // Current first: the decoder works through its queue in order.
+    v->requested_us = esp_timer_get_time();
+    slide_submit(v, slide_at(v, 0), vfs_path);
+    if (slide_at(v, 0)->job) {
+        show_status(v, "Loading...", 0);
+        char path[300];
+        if (ui_file_list_step(s_media_list, vfs_path, 1, is_jpg_file, path, sizeof(path))) {
+            slide_submit(v, slide_at(v, 1), path);
+        }
+        if (ui_file_list_step(s_media_list, vfs_path, -1, is_jpg_file, path, sizeof(path))) {
+            slide_submit(v, slide_at(v, -1), path);
+        }
+    } else {
+        show_status(v, "Cannot open image", 0);
+    }
 
     lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
 }
@@ -161,140 +440,109 @@ static void open_gif_player(const char *vfs_path)
     lv_obj_t *scr = make_screen("GIF Player", true);
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 12, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_LOOSE);
     lv_obj_t *lbl = lv_label_create(cont);
     lv_label_set_text(lbl, "GIF support is disabled in config");
     lv_obj_center(lbl);
     lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
     return;
 #else
-    FILE *f = fopen(vfs_path, "rb");
-    if (!f) {
-        ESP_LOGW(TAG, "Failed to open GIF: %s", vfs_path);
-        return;
-    }
-    fseek(f, 0, SEEK_END);
-    long sz = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    if (sz <= 0 || sz > (2 * 1024 * 1024)) {
-        fclose(f);
-        ESP_LOGW(TAG, "GIF size invalid: %ld", sz);
-        return;
-    }
-
-    uint8_t *buf = (uint8_t *)lv_mem_alloc((size_t)sz);
-    if (!buf) {
-        fclose(f);
-        ESP_LOGW(TAG, "Out of memory reading GIF");
-        return;
-    }
-    if (fread(buf, 1, (size_t)sz, f) != (size_t)sz) {
-        fclose(f);
-        lv_mem_free(buf);
-        ESP_LOGW(TAG, "Short read reading GIF");
-        return;
-    }
-    fclose(f);
-
     lv_obj_t *scr = make_screen("GIF Player", true);
     lv_obj_t *cont = lv_obj_create(scr);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 0, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT_FLUSH);
+    lv_obj_clear_flag(cont, LV_OBJ_FLAG_SCROLLABLE);
 
-    lv_obj_t *gif = lv_gif_create(cont);
+    // Frames are decoded from the file as they play, so size is no longer limited by RAM.
+    lv_obj_t *gif = gif_stream_create(cont, vfs_path);
     lv_obj_center(gif);
-
-    lv_img_dsc_t dsc;
-    memset(&dsc, 0, sizeof(dsc));
-    dsc.data = buf;
-    dsc.data_size = (uint32_t)sz;
-    lv_gif_set_src(gif, &dsc);
-
-    lv_obj_add_event_cb(scr, [](lv_event_t *e) {
-        uint8_t *buf = (uint8_t *)lv_event_get_user_data(e);
-        if (buf) lv_mem_free(buf);
-    }, LV_EVENT_DELETE, buf);
+    lv_obj_t *status = lv_label_create(cont);
+    ui_theme_apply(status, UI_THEME_TITLE);
+    lv_label_set_text(status, "Loading...");
+    lv_obj_center(status);
+
+    lv_obj_add_event_cb(gif, [](lv_event_t *e) {
+        lv_obj_center(lv_event_get_target(e));
+        lv_obj_add_flag((lv_obj_t *)lv_event_get_user_data(e), LV_OBJ_FLAG_HIDDEN);
+    }, LV_EVENT_READY, status);
+    lv_obj_add_event_cb(gif, [](lv_event_t *e) {
+        lv_label_set_text((lv_obj_t *)lv_event_get_user_data(e), "Cannot play GIF");
+    }, LV_EVENT_CANCEL, status);
 
     lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
 #endif
 }
 
-static void populate_list(lv_obj_t *list)
+static bool is_media_file(const char *name)
 {
-    DIR *dir = opendir("/sdcard");
-    if (!dir) {
-        lv_obj_t *btn = lv_list_add_btn(list, NULL, "No /sdcard directory");
-        lv_obj_add_state(btn, LV_STATE_DISABLED);
-        return;
-    }
+    return is_jpg_file(name) || has_ext(name, ".gif");
+}
 
-    int count = 0;
-    struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL) {
-        if (ent->d_name[0] == '.') continue;
-
-        const bool is_jpg = has_ext(ent->d_name, ".jpg") || has_ext(ent->d_name, ".jpeg");
-        const bool is_gif = has_ext(ent->d_name, ".gif");
-        if (!is_jpg && !is_gif) continue;
-
-        char vfs_path[300];
-        snprintf(vfs_path, sizeof(vfs_path), "/sdcard/%s", ent->d_name);
-
-        lv_obj_t *btn = lv_list_add_btn(list, NULL, ent->d_name);
-        char *p = (char *)lv_mem_alloc(strlen(vfs_path) + 1);
-        if (!p) continue;
-        strcpy(p, vfs_path);
-        lv_obj_add_event_cb(btn,
-                            [](lv_event_t *e) {
-                                ui_click();
-                                char *path = (char *)lv_event_get_user_data(e);
-                                if (!path) return;
-                                if (has_ext(path, ".gif")) open_gif_player(path);
-                                else open_jpg_viewer(path);
-                            },
-                            LV_EVENT_CLICKED, p);
-        lv_obj_add_event_cb(btn,
-                            [](lv_event_t *e) {
-                                char *path = (char *)lv_event_get_user_data(e);
-                                if (path) lv_mem_free(path);
-                            },
-                            LV_EVENT_DELETE, p);
-
-        if (++count >= 40) break;
-    }
-    closedir(dir);
+static void open_media_file(const char *vfs_path, void *)
+{
+    ui_click();
+    if (has_ext(vfs_path, ".gif")) open_gif_player(vfs_path);
+    else open_jpg_viewer(vfs_path);
+}
 
-    if (count == 0) {
-        lv_obj_t *btn = lv_list_add_btn(list, NULL, "No .jpg/.gif found in /sdcard");
-        lv_obj_add_state(btn, LV_STATE_DISABLED);
-    }
+static media_sort_t s_media_sort = MEDIA_SORT_PATH;
+
+static const char *media_sort_name(media_sort_t sort)
+{
+    return sort == MEDIA_SORT_DATE ? "Newest" : "Name";
+}
+
+static void populate_list(lv_obj_t *list)
+{
+    ui_file_list_config_t cfg = {};
+    cfg.dir = "/sdcard";
+    cfg.filter = is_media_file;
+    cfg.thumb_filter = is_jpg_file;
+    cfg.on_click = open_media_file;
+    cfg.empty_text = "No .jpg/.gif found in /sdcard";
+    cfg.index_kinds = MEDIA_KIND_IMAGE | MEDIA_KIND_GIF;
+    cfg.index_sort = (uint8_t)s_media_sort;
+    ui_file_list_populate(list, &cfg);
 }
 
 esp_err_t ui_media_open(void)
 {
     if (s_media_screen && lv_obj_is_valid(s_media_screen)) {
+        ui_screen_cache_unpark(UI_SCREEN_MEDIA);
         lv_scr_load_anim(s_media_screen, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
         return ESP_OK;
     }
 
     s_media_screen = make_screen("Media", false);
+
+    // Sort order of the library list; applies once media_index has loaded.
+    lv_obj_t *btn_sort = lv_btn_create(lv_obj_get_child(s_media_screen, 0));
+    ui_theme_apply(btn_sort, UI_THEME_HEADER_BTN);
+    lv_obj_align(btn_sort, LV_ALIGN_LEFT_MID, 0, 0);
+    lv_obj_t *lbl_sort = lv_label_create(btn_sort);
+    lv_label_set_text(lbl_sort, media_sort_name(s_media_sort));
+    lv_obj_center(lbl_sort);
+    lv_obj_add_event_cb(btn_sort, [](lv_event_t *e) {
+        ui_click();
+        s_media_sort = (s_media_sort == MEDIA_SORT_PATH) ? MEDIA_SORT_DATE : MEDIA_SORT_PATH;
+        lv_label_set_text(lv_obj_get_child(lv_event_get_target(e), 0), media_sort_name(s_media_sort));
+        if (s_media_list && sdcard_service_is_mounted()) {
+            populate_list(s_media_list);
+        }
+    }, LV_EVENT_CLICKED, NULL);
+
     lv_obj_t *cont = lv_obj_create(s_media_screen);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 8, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT);
 
     lv_obj_t *list = lv_list_create(cont);
     lv_obj_set_size(list, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_border_width(list, 0, 0);
-    lv_obj_set_style_bg_color(list, lv_color_hex(0x0a0a0a), 0);
+    ui_theme_apply(list, UI_THEME_LIST);
+    s_media_list = list;
 
     lv_obj_add_event_cb(s_media_screen, [](lv_event_t *) {
         s_media_screen = nullptr;
+        s_media_list = nullptr;
     }, LV_EVENT_DELETE, NULL);
 
     lv_scr_load_anim(s_media_screen, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
@@ -335,7 +583,7 @@ esp_err_t ui_media_open(void)
         auto mount_task = [](void *arg) {
             lv_obj_t *list = (lv_obj_t *)arg;
             sdcard_service_mount();
-            lv_async_call(
+            display_lvgl_async_call(
                 [](void *p) {
                     lv_obj_t *list = (lv_obj_t *)p;
                     if (!list || !lv_obj_is_valid(list)) return;
@@ -1,18 +1,28 @@
 #include "ui_mp3.h"
 
-#include <dirent.h>
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
+
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lvgl.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "app_pins.h"
+#include "audio_resampler.h"
+#include "display_lvgl.h"
+#include "media_index.h"
+#include "mp3_input.h"
+#include "pcm_ring.h"
 #include "ui_app_carousel.h"
+#include "ui_file_list.h"
+#include "ui_screen_cache.h"
+#include "ui_theme.h"
 
 #include "services/audio_es8311.h"
 #include "services/sdcard_service.h"
@@ -23,10 +33,23 @@
 
 static const char *TAG = "ui_mp3";
 
+// Decoded audio buffered ahead of I2S (at the hardware rate); an SD or decode stall shorter than
+// this is not heard.
+#define MP3_PCM_RING_MS 500
+// Output starts once this much is buffered (or the file has been decoded).
+#define MP3_PCM_PREBUFFER_MS 250
+#define MP3_OUT_CHUNK_FRAMES 1152 // frames per stream write: one MPEG-1 frame
+#define MP3_OUT_TASK_STACK_SIZE 4096
+#define MP3_OUT_TASK_PRIORITY 5 // above the decoder, so the audio engine is refilled as soon as it has room
+#define MP3_OUT_TASK_CORE 0
+#define MP3_RING_POLL_MS 5
+#define MP3_SRC_CHUNK_FRAMES 288 // decoded frames resampled per ring write: a quarter MPEG-1 frame
+
 static lv_obj_t *s_mp3_screen = nullptr;
 static lv_obj_t *s_list = nullptr;
 static lv_obj_t *s_status = nullptr;
 static lv_obj_t *s_btn_stop = nullptr;
+static media_sort_t s_sort = MEDIA_SORT_PATH;
 
 static TaskHandle_t s_play_task = nullptr;
 static volatile bool s_stop_req = false;
@@ -62,7 +85,7 @@ static inline void ui_load_screen_deferred(lv_obj_t *scr, bool auto_del)
     }
     req->scr = scr;
     req->auto_del = auto_del;
-    lv_async_call(ui_screen_load_async_cb, req);
+    display_lvgl_async_call(ui_screen_load_async_cb, req);
 }
 
 static inline void ui_click(void)
@@ -116,6 +139,93 @@ static void request_stop_playback(void)
     s_stop_req = true;
 }
 
+// ---- Output stage: PCM ring -> audio engine ----
+
+typedef struct {
+    pcm_ring_t *ring;
+    uint32_t prebuffer; // frames
+    std::atomic<bool> done;
+    uint32_t write_errors;
+    int64_t wait_us; // decoder time spent waiting on a full ring
+} mp3_output_t;
+
+// Stream writes block until the audio engine has room, which paces this task; the decoder only ever
+// waits on the ring.
+static void output_task(void *arg)
+{
+    mp3_output_t *out = (mp3_output_t *)arg;
+    while (!s_stop_req && !pcm_ring_is_closed(out->ring) && pcm_ring_fill(out->ring) < out->prebuffer) {
+        vTaskDelay(pdMS_TO_TICKS(MP3_RING_POLL_MS));
+    }
+    while (!s_stop_req) {
+        uint32_t frames = 0;
+        const int16_t *pcm = pcm_ring_peek(out->ring, &frames);
+        if (frames == 0) {
+            if (pcm_ring_is_closed(out->ring) && pcm_ring_fill(out->ring) == 0) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(MP3_RING_POLL_MS));
+            continue;
+        }
+        frames = frames < MP3_OUT_CHUNK_FRAMES ? frames : MP3_OUT_CHUNK_FRAMES;
+        if (audio_es8311_stream_write(pcm, (size_t)frames * 2 * sizeof(int16_t), 2000) != ESP_OK) {
+            out->write_errors++;
+        }
+        pcm_ring_release(out->ring, frames);
+    }
+    out->done.store(true);
+    vTaskDelete(NULL);
+}
+
+static bool output_start(mp3_output_t *out)
+{
+    out->done.store(false);
+#if CONFIG_FREERTOS_UNICORE
+    const BaseType_t ok = xTaskCreate(output_task, "mp3_out", MP3_OUT_TASK_STACK_SIZE, out, MP3_OUT_TASK_PRIORITY, NULL);
+#else
+    const BaseType_t ok = xTaskCreatePinnedToCore(output_task, "mp3_out", MP3_OUT_TASK_STACK_SIZE, out,
+                                                  MP3_OUT_TASK_PRIORITY, NULL, MP3_OUT_TASK_CORE);
+#endif
+    if (ok != pdPASS) {
+        out->done.store(true);
+        return false;
+    }
+    return true;
+}
+
+// Lets the output task play what is buffered (all of it unless stopping) and waits for it to exit.
+static void output_finish(mp3_output_t *out)
+{
+    if (!out->ring) {
+        return;
+    }
+    pcm_ring_close(out->ring);
+    while (!out->done.load()) {
+        vTaskDelay(pdMS_TO_TICKS(MP3_RING_POLL_MS));
+    }
+}
+
+// Waits while the ring is full; false once playback is stopped.
+static bool output_push(mp3_output_t *out, const int16_t *pcm, uint32_t frames)
+{
+    for (;;) {
+        const uint32_t n = pcm_ring_write(out->ring, pcm, frames);
+        pcm += (size_t)n * 2;
+        frames -= n;
+        if (frames == 0) {
+            return true;
+        }
+        if (s_stop_req || out->done.load()) {
+            return false;
+        }
+        const int64_t t0_us = esp_timer_get_time();
+        vTaskDelay(pdMS_TO_TICKS(MP3_RING_POLL_MS));
+        out->wait_us += esp_timer_get_time() - t0_us;
+    }
+}
+
+// ---- Decoder stage ----
+
 static void playback_task(void *arg)
 {
     mp3_play_req_t *req = (mp3_play_req_t *)arg;
@@ -128,7 +238,7 @@ static void playback_task(void *arg)
     s_stop_req = false;
     s_is_playing = true;
 
-    lv_async_call(
+    display_lvgl_async_call(
         [](void *p) {
             mp3_play_req_t *req = (mp3_play_req_t *)p;
             if (!s_mp3_screen || !lv_obj_is_valid(s_mp3_screen)) return;
@@ -142,10 +252,10 @@ static void playback_task(void *arg)
         },
         req);
 
-    FILE *f = fopen(req->path, "rb");
-    if (!f) {
+    mp3_input_t *input = mp3_input_open(req->path);
+    if (!input) {
         ESP_LOGW(TAG, "Failed to open: %s", req->path);
-        lv_async_call(
+        display_lvgl_async_call(
             [](void *) {
                 set_status_text("Open failed");
                 set_stop_enabled(false);
@@ -163,79 +273,68 @@ static void playback_task(void *arg)
     mp3dec_t dec;
     mp3dec_init(&dec);
 
-    constexpr int kInBufSize = 16 * 1024;
-    // Keep large buffers off INTERNAL heap when PSRAM is available.
-    uint8_t *inbuf = (uint8_t *)heap_caps_malloc(kInBufSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (!inbuf) {
-        inbuf = (uint8_t *)malloc(kInBufSize);
-    }
-    if (!inbuf) {
-        fclose(f);
-        lv_async_call(
-            [](void *) {
-                set_status_text("No memory");
-                set_stop_enabled(false);
-            },
-            NULL);
-        s_is_playing = false;
-        s_play_task = nullptr;
-        if (req->name) lv_mem_free(req->name);
-        lv_mem_free(req->path);
-        lv_mem_free(req);
-        vTaskDelete(NULL);
-        return;
-    }
+    mp3_output_t out = {};
+    out.done.store(true); // no output task yet
 
-    int in_len = 0;
-    bool eof = false;
+    // Decoded PCM is converted to the hardware rate before the ring, so a rate change mid-file only
+    // swaps the converter and the output stream never stops.
+    audio_resampler_t *src = nullptr;
+    int16_t *src_buf = nullptr;
     int current_rate = 0;
+    uint32_t frames = 0;
+    int64_t decode_us = 0;
+    int64_t src_us = 0;
+    int64_t audio_us = 0;
 
     mp3d_sample_t pcm[MINIMP3_MAX_SAMPLES_PER_FRAME];
     int16_t mono_to_stereo[MINIMP3_MAX_SAMPLES_PER_FRAME];
 
     while (!s_stop_req) {
-        if (!eof && in_len < (kInBufSize - 4096)) {
-            const size_t n = fread(inbuf + in_len, 1, (size_t)(kInBufSize - in_len), f);
-            if (n == 0) {
-                eof = true;
-            } else {
-                in_len += (int)n;
-            }
-        }
-
-        if (in_len <= 0) {
-            if (eof) break;
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
+        size_t in_len = 0;
+        const uint8_t *data = mp3_input_peek(input, &in_len);
+        if (in_len == 0) {
+            break;
         }
 
         mp3dec_frame_info_t info;
-        const int samples = mp3dec_decode_frame(&dec, inbuf, in_len, pcm, &info);
-
-        if (info.frame_bytes > 0 && info.frame_bytes <= in_len) {
-            memmove(inbuf, inbuf + info.frame_bytes, (size_t)(in_len - info.frame_bytes));
-            in_len -= info.frame_bytes;
-        } else if (info.frame_bytes == 0) {
-            // Need more data.
-            if (eof) break;
-            continue;
-        } else {
-            // Corrupt; resync by dropping a byte.
-            memmove(inbuf, inbuf + 1, (size_t)(in_len - 1));
-            in_len -= 1;
+        const int64_t t0_us = esp_timer_get_time();
+        const int samples = mp3dec_decode_frame(&dec, data, (int)in_len, pcm, &info);
+        decode_us += esp_timer_get_time() - t0_us;
+
+        if (samples == 0 && (size_t)info.frame_bytes >= in_len) {
+            // No frame anywhere in the view.
+            mp3_input_skip_garbage(input, in_len);
             continue;
         }
+        mp3_input_consume(input, (size_t)info.frame_bytes);
 
         if (samples <= 0 || info.hz <= 0) {
             continue;
         }
+        frames++;
+        audio_us += (int64_t)samples * 1000000 / info.hz;
 
         if (current_rate != info.hz) {
+            audio_resampler_t *next = audio_resampler_create((uint32_t)info.hz, AUDIO_ES8311_HW_RATE_HZ);
+            if (!next) {
+                ESP_LOGW(TAG, "Cannot convert %d Hz", info.hz);
+                display_lvgl_async_call(
+                    [](void *) {
+                        set_status_text("Unsupported rate");
+                        set_stop_enabled(false);
+                    },
+                    NULL);
+                break;
+            }
+            audio_resampler_destroy(src);
+            src = next;
             current_rate = info.hz;
-            esp_err_t err = audio_es8311_stream_begin(current_rate);
+        }
+        if (!out.ring) {
+            esp_err_t err = audio_es8311_stream_begin(AUDIO_ES8311_HW_RATE_HZ);
             if (err != ESP_OK) {
-                ESP_LOGW(TAG, "stream_begin(%d) failed: %s", current_rate, esp_err_to_name(err));
-                lv_async_call(
+                ESP_LOGW(TAG, "stream_begin failed: %s", esp_err_to_name(err));
+                display_lvgl_async_call(
                     [](void *) {
                         set_status_text("Audio init failed");
                         set_stop_enabled(false);
@@ -243,13 +342,26 @@ static void playback_task(void *arg)
                     NULL);
                 break;
             }
+            out.ring = pcm_ring_create((uint32_t)AUDIO_ES8311_HW_RATE_HZ * MP3_PCM_RING_MS / 1000);
+            out.prebuffer = (uint32_t)AUDIO_ES8311_HW_RATE_HZ * MP3_PCM_PREBUFFER_MS / 1000;
+            src_buf = (int16_t *)malloc(AUDIO_RESAMPLER_MAX_OUT(MP3_SRC_CHUNK_FRAMES) * 2 * sizeof(int16_t));
+            if (!out.ring || !src_buf || !output_start(&out)) {
+                ESP_LOGW(TAG, "Cannot start the output stage");
+                display_lvgl_async_call(
+                    [](void *) {
+                        set_status_text("No memory");
+                        set_stop_enabled(false);
+                    },
+                    NULL);
+                break;
+            }
         }
 
         const int channels = (info.channels == 1) ? 1 : 2;
         const int total_samples = samples * channels;
         int out_samples = (channels == 1) ? (samples * 2) : total_samples;
 
-        const int16_t *out = (const int16_t *)pcm;
+        const int16_t *out_pcm = (const int16_t *)pcm;
         if (channels == 1) {
             const int16_t *in = (const int16_t *)pcm;
             const int max_i = (samples < (int)(sizeof(mono_to_stereo) / sizeof(mono_to_stereo[0]) / 2))
@@ -259,19 +371,73 @@ static void playback_task(void *arg)
                 mono_to_stereo[2 * i + 0] = in[i];
                 mono_to_stereo[2 * i + 1] = in[i];
             }
-            out = mono_to_stereo;
+            out_pcm = mono_to_stereo;
             out_samples = max_i * 2;
         }
 
-        const size_t bytes = (size_t)out_samples * sizeof(int16_t);
-        (void)audio_es8311_stream_write(out, bytes, 2000);
+        const uint32_t out_frames = (uint32_t)(out_samples / 2);
+        bool pushed = true;
+        if (current_rate == AUDIO_ES8311_HW_RATE_HZ) {
+            pushed = output_push(&out, out_pcm, out_frames);
+        } else {
+            for (uint32_t done = 0; pushed && done < out_frames; done += MP3_SRC_CHUNK_FRAMES) {
+                const uint32_t n = out_frames - done < MP3_SRC_CHUNK_FRAMES ? out_frames - done : MP3_SRC_CHUNK_FRAMES;
+                const int64_t t1_us = esp_timer_get_time();
+                const uint32_t got = audio_resampler_process(src, out_pcm + (size_t)done * 2, n, src_buf);
+                src_us += esp_timer_get_time() - t1_us;
+                pushed = output_push(&out, src_buf, got);
+            }
+        }
+        if (!pushed) {
+            break;
+        }
     }
 
-    fclose(f);
-    free(inbuf);
+    output_finish(&out);
+    pcm_ring_stats_t ring_stats = {};
+    if (out.ring) {
+        pcm_ring_get_stats(out.ring, &ring_stats);
+        pcm_ring_destroy(out.ring);
+    }
+    audio_resampler_destroy(src);
+    free(src_buf);
+    mp3_input_stats_t in_stats;
+    mp3_input_get_stats(input, &in_stats);
+    mp3_input_close(input);
     audio_es8311_stream_end();
+    if (frames > 0 && decode_us > 0) {
+        ESP_LOGI(TAG, "Decoded %u frames: %u us/frame, %u.%02ux realtime", (unsigned)frames,
+                 (unsigned)(decode_us / frames), (unsigned)(audio_us / decode_us),
+                 (unsigned)(audio_us * 100 / decode_us % 100));
+        ESP_LOGI(TAG, "Input: %u bytes copied/frame, %u refills (%u ms, max %u ms), %u stalls, %u KB skipped",
+                 (unsigned)(in_stats.bytes_copied / frames), (unsigned)in_stats.refills,
+                 (unsigned)(in_stats.refill_us / 1000), (unsigned)(in_stats.refill_us_max / 1000),
+                 (unsigned)in_stats.stalls, (unsigned)(in_stats.bytes_skipped / 1024));
+        if (src_us > 0) {
+            ESP_LOGI(TAG, "Resampled %d -> %d Hz: %u us/frame", current_rate, AUDIO_ES8311_HW_RATE_HZ,
+                     (unsigned)(src_us / frames));
+        }
+    }
+    if (ring_stats.frames_out > 0) {
+        uint32_t releases = 0;
+        for (int i = 0; i < PCM_RING_FILL_BUCKETS; i++) {
+            releases += ring_stats.fill_hist[i];
+        }
+        unsigned pct[PCM_RING_FILL_BUCKETS];
+        for (int i = 0; i < PCM_RING_FILL_BUCKETS; i++) {
+            pct[i] = (unsigned)((uint64_t)ring_stats.fill_hist[i] * 100 / releases);
+        }
+        ESP_LOGI(TAG,
+                 "Output: %u underruns, %u write errors, min fill %u ms; decoder waited %u times (%u ms) "
+                 "on a full ring",
+                 (unsigned)ring_stats.underruns, (unsigned)out.write_errors,
+                 (unsigned)((uint64_t)ring_stats.min_fill * 1000 / AUDIO_ES8311_HW_RATE_HZ),
+                 (unsigned)ring_stats.producer_waits, (unsigned)(out.wait_us / 1000));
+        ESP_LOGI(TAG, "Ring fill at release (%% of releases by eighths): %u %u %u %u %u %u %u %u", pct[0], pct[1],
+                 pct[2], pct[3], pct[4], pct[5], pct[6], pct[7]);
+    }
 
-    lv_async_call(
+    display_lvgl_async_call(
         [](void *p) {
             mp3_play_req_t *req = (mp3_play_req_t *)p;
             if (s_mp3_screen && lv_obj_is_valid(s_mp3_screen)) {
@@ -295,122 +461,97 @@ static void playback_task(void *arg)
     vTaskDelete(NULL);
 }
 
-static void populate_list(void)
+static bool is_mp3_file(const char *name)
 {
-    if (!s_list || !lv_obj_is_valid(s_list)) return;
+    return has_ext(name, ".mp3");
+}
 
-    DIR *dir = opendir("/sdcard");
-    if (!dir) {
-        lv_obj_t *btn = lv_list_add_btn(s_list, NULL, "No /sdcard directory");
-        lv_obj_add_state(btn, LV_STATE_DISABLED);
+static void play_file(const char *path, void *)
+{
+    ui_click();
+
+    if (s_is_playing) {
+        set_status_text("Busy (stop first)");
         return;
     }
 
-    int count = 0;
-    struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL) {
-        if (ent->d_name[0] == '.') continue;
-        if (!has_ext(ent->d_name, ".mp3")) continue;
-
-        char vfs_path[300];
-        snprintf(vfs_path, sizeof(vfs_path), "/sdcard/%s", ent->d_name);
-
-        lv_obj_t *btn = lv_list_add_btn(s_list, NULL, ent->d_name);
-        char *path = (char *)lv_mem_alloc(strlen(vfs_path) + 1);
-        if (!path) continue;
-        strcpy(path, vfs_path);
-
-        lv_obj_add_event_cb(
-            btn,
-            [](lv_event_t *e) {
-                ui_click();
-                const char *path = (const char *)lv_event_get_user_data(e);
-                if (!path) return;
-
-                if (s_is_playing) {
-                    set_status_text("Busy (stop first)");
-                    return;
-                }
+    mp3_play_req_t *req = (mp3_play_req_t *)lv_mem_alloc(sizeof(mp3_play_req_t));
+    if (!req) {
+        set_status_text("No memory");
+        return;
+    }
+    memset(req, 0, sizeof(*req));
+    req->path = (char *)lv_mem_alloc(strlen(path) + 1);
+    if (req->path) strcpy(req->path, path);
 
-                mp3_play_req_t *req = (mp3_play_req_t *)lv_mem_alloc(sizeof(mp3_play_req_t));
-                if (!req) {
-                    set_status_text("No memory");
-                    return;
-                }
-                memset(req, 0, sizeof(*req));
-                req->path = (char *)lv_mem_alloc(strlen(path) + 1);
-                if (req->path) strcpy(req->path, path);
-
-                // Show just the filename in the status.
-                const char *name = strrchr(path, '/');
-                name = name ? (name + 1) : path;
-                req->name = (char *)lv_mem_alloc(strlen(name) + 1);
-                if (req->name) strcpy(req->name, name);
-
-                if (!req->path || !req->name) {
-                    if (req->name) lv_mem_free(req->name);
-                    if (req->path) lv_mem_free(req->path);
-                    lv_mem_free(req);
-                    set_status_text("No memory");
-                    return;
-                }
+    // Show just the filename in the status.
+    const char *name = strrchr(path, '/');
+    name = name ? (name + 1) : path;
+    req->name = (char *)lv_mem_alloc(strlen(name) + 1);
+    if (req->name) strcpy(req->name, name);
 
-                s_stop_req = false;
-                ESP_LOGI(TAG, "Play: %s", req->path);
+    if (!req->path || !req->name) {
+        if (req->name) lv_mem_free(req->name);
+        if (req->path) lv_mem_free(req->path);
+        lv_mem_free(req);
+        set_status_text("No memory");
+        return;
+    }
+
+    s_stop_req = false;
+    ESP_LOGI(TAG, "Play: %s", req->path);
 
-                auto task_fn = [](void *p) { playback_task(p); };
+    auto task_fn = [](void *p) { playback_task(p); };
 
 #if CONFIG_FREERTOS_UNICORE
-                xTaskCreate(task_fn, "mp3_play", 8192, req, 3, NULL);
+    xTaskCreate(task_fn, "mp3_play", 8192, req, 3, NULL);
 #else
-                // Keep decode off the LVGL core.
-                xTaskCreatePinnedToCore(task_fn, "mp3_play", 8192, req, 3, NULL, 0);
+    // Keep decode off the LVGL core.
+    xTaskCreatePinnedToCore(task_fn, "mp3_play", 8192, req, 3, NULL, 0);
 #endif
-            },
-            LV_EVENT_CLICKED,
-            path);
-
-        // If the list is deleted, free the per-item userdata.
-        lv_obj_add_event_cb(
-            btn,
-            [](lv_event_t *e) {
-                char *path = (char *)lv_event_get_user_data(e);
-                if (path) lv_mem_free(path);
-            },
-            LV_EVENT_DELETE,
-            path);
+}
 
-        if (++count >= 40) break;
-    }
-    closedir(dir);
+static void populate_list(void)
+{
+    if (!s_list || !lv_obj_is_valid(s_list)) return;
 
-    if (count == 0) {
-        lv_obj_t *btn = lv_list_add_btn(s_list, NULL, "No .mp3 found in /sdcard");
-        lv_obj_add_state(btn, LV_STATE_DISABLED);
+    ui_file_list_config_t cfg = {};
+    cfg.dir = "/sdcard";
+    cfg.filter = is_mp3_file;
+    cfg.thumb_filter = is_mp3_file; // ID3 cover art
+    cfg.on_click = play_file;
+    cfg.empty_text = "No .mp3 found in /sdcard";
+    cfg.index_kinds = MEDIA_KIND_AUDIO;
+    cfg.index_sort = (uint8_t)s_sort;
+    ui_file_list_populate(s_list, &cfg);
+}
+
+static const char *sort_name(media_sort_t sort)
+{
+    switch (sort) {
+    case MEDIA_SORT_ARTIST: return "Artist";
+    case MEDIA_SORT_TITLE: return "Title";
+    default: return "Name";
     }
 }
 
 esp_err_t ui_mp3_open(void)
 {
     if (s_mp3_screen && lv_obj_is_valid(s_mp3_screen)) {
+        ui_screen_cache_unpark(UI_SCREEN_MP3);
         lv_scr_load_anim(s_mp3_screen, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
         return ESP_OK;
     }
 
     s_mp3_screen = lv_obj_create(NULL);
-    lv_obj_set_style_pad_all(s_mp3_screen, 8, 0);
-    lv_obj_set_style_bg_color(s_mp3_screen, lv_color_hex(0x000000), 0);
+    ui_theme_apply(s_mp3_screen, UI_THEME_SCREEN);
 
     lv_obj_t *hdr = lv_obj_create(s_mp3_screen);
-    lv_obj_set_width(hdr, lv_pct(100));
-    lv_obj_set_height(hdr, 44);
-    lv_obj_set_style_pad_all(hdr, 6, 0);
-    lv_obj_set_style_bg_color(hdr, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(hdr, 0, 0);
+    ui_theme_apply(hdr, UI_THEME_HEADER);
     lv_obj_clear_flag(hdr, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t *btn_exit = lv_btn_create(hdr);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_LEFT_MID, 0, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
@@ -422,7 +563,9 @@ esp_err_t ui_mp3_open(void)
             request_stop_playback();
             lv_obj_t *carousel = ui_app_carousel_get_screen();
             if (carousel && lv_obj_is_valid(carousel)) {
-                ui_load_screen_deferred(carousel, true);
+                // Keep the screen (and its file list) for the next launch; the cache may evict it.
+                ui_screen_cache_park(UI_SCREEN_MP3, s_mp3_screen);
+                ui_load_screen_deferred(carousel, false);
             } else {
                 ui_app_carousel_init();
             }
@@ -431,7 +574,7 @@ esp_err_t ui_mp3_open(void)
         NULL);
 
     s_btn_stop = lv_btn_create(hdr);
-    lv_obj_set_size(s_btn_stop, 60, 32);
+    ui_theme_apply(s_btn_stop, UI_THEME_HEADER_BTN);
     lv_obj_align(s_btn_stop, LV_ALIGN_RIGHT_MID, 0, 0);
     lv_obj_t *lbl_stop = lv_label_create(s_btn_stop);
     lv_label_set_text(lbl_stop, "Stop");
@@ -446,16 +589,34 @@ esp_err_t ui_mp3_open(void)
         LV_EVENT_CLICKED,
         NULL);
 
+    // Sort order of the library list; applies once media_index has loaded.
+    lv_obj_t *btn_sort = lv_btn_create(hdr);
+    ui_theme_apply(btn_sort, UI_THEME_HEADER_BTN);
+    lv_obj_align_to(btn_sort, s_btn_stop, LV_ALIGN_OUT_LEFT_MID, -6, 0);
+    lv_obj_t *lbl_sort = lv_label_create(btn_sort);
+    lv_label_set_text(lbl_sort, sort_name(s_sort));
+    lv_obj_center(lbl_sort);
+    lv_obj_add_event_cb(
+        btn_sort,
+        [](lv_event_t *e) {
+            ui_click();
+            s_sort = s_sort == MEDIA_SORT_PATH ? MEDIA_SORT_ARTIST : s_sort == MEDIA_SORT_ARTIST ? MEDIA_SORT_TITLE : MEDIA_SORT_PATH;
+            lv_label_set_text(lv_obj_get_child(lv_event_get_target(e), 0), sort_name(s_sort));
+            if (sdcard_service_is_mounted()) {
+                populate_list();
+            }
+        },
+        LV_EVENT_CLICKED,
+        NULL);
+
     lv_obj_t *lbl_title = lv_label_create(hdr);
     lv_label_set_text(lbl_title, "MP3");
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
 
     lv_obj_t *cont = lv_obj_create(s_mp3_screen);
     set_content_area(cont);
-    lv_obj_set_style_pad_all(cont, 8, 0);
-    lv_obj_set_style_bg_opa(cont, LV_OPA_TRANSP, 0);
-    lv_obj_set_style_border_width(cont, 0, 0);
+    ui_theme_apply(cont, UI_THEME_CONTENT);
 
     s_status = lv_label_create(cont);
     lv_obj_set_width(s_status, lv_pct(100));
@@ -466,8 +627,7 @@ esp_err_t ui_mp3_open(void)
     s_list = lv_list_create(cont);
     lv_obj_set_size(s_list, lv_pct(100), APP_LCD_V_RES - 52 - 8 - 22);
     lv_obj_align(s_list, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_set_style_border_width(s_list, 0, 0);
-    lv_obj_set_style_bg_color(s_list, lv_color_hex(0x0a0a0a), 0);
+    ui_theme_apply(s_list, UI_THEME_LIST);
 
     set_stop_enabled(false);
 
@@ -520,7 +680,7 @@ esp_err_t ui_mp3_open(void)
         auto mount_task = [](void *arg) {
             (void)arg;
             sdcard_service_mount();
-            lv_async_call(
+            display_lvgl_async_call(
                 [](void *) {
                     if (!s_list || !lv_obj_is_valid(s_list)) return;
                     lv_obj_clean(s_list);
@@ -1,6 +1,7 @@
 #include "ui_radio.h"
 #include "lvgl.h"
 #include "radio_player.h"
+#include "ui_theme.h"
 #include "esp_log.h"
 
 static const char *TAG = "ui_radio";
@@ -30,26 +31,20 @@ esp_err_t ui_radio_open(void)
     }
 
     s_radio_screen = lv_obj_create(NULL);
-    lv_obj_set_style_pad_all(s_radio_screen, 8, 0);
-    lv_obj_set_style_bg_color(s_radio_screen, lv_color_hex(0x000000), 0);
+    ui_theme_apply(s_radio_screen, UI_THEME_SCREEN);
 
     lv_obj_t *hdr = lv_obj_create(s_radio_screen);
-    lv_obj_set_width(hdr, lv_pct(100));
-    lv_obj_set_height(hdr, 44);
-    lv_obj_set_style_pad_all(hdr, 6, 0);
-    lv_obj_set_style_bg_color(hdr, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(hdr, 0, 0);
+    ui_theme_apply(hdr, UI_THEME_HEADER);
     lv_obj_clear_flag(hdr, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t *lbl_title = lv_label_create(hdr);
     lv_label_set_text(lbl_title, "Internet Radio");
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
 
     lv_obj_t *list = lv_list_create(s_radio_screen);
     lv_obj_set_size(list, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_border_width(list, 0, 0);
-    lv_obj_set_style_bg_color(list, lv_color_hex(0x0a0a0a), 0);
+    ui_theme_apply(list, UI_THEME_LIST);
     lv_obj_align(list, LV_ALIGN_BOTTOM_MID, 0, 0);
 
     for (int i = 0; i < kStationCount; ++i) {
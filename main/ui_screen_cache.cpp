@@ -0,0 +1,334 @@
+#include "ui_screen_cache.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include "app_pins.h"
+
+static const char *TAG = "screen_cache";
+
+// One full-screen RGB565 snapshot is 368*448*2 = ~322 KB of PSRAM; keep up to three.
+#define UI_SCREEN_CACHE_SNAPSHOT_BUDGET ((size_t)3 * APP_LCD_H_RES * APP_LCD_V_RES * sizeof(lv_color_t))
+// Live screens hold LVGL objects in INTERNAL RAM (small allocations), so keep very few.
+#define UI_SCREEN_CACHE_MAX_LIVE 2
+// Below these free-heap levels the pressure timer evicts entries, least recently used first.
+#define UI_SCREEN_CACHE_MIN_INTERNAL_FREE (48 * 1024)
+#define UI_SCREEN_CACHE_MIN_PSRAM_FREE (512 * 1024)
+#define UI_SCREEN_CACHE_PRESSURE_PERIOD_MS 2000
+// If an app never replaces the placeholder (open failed), go back to where we came from.
+#define UI_SCREEN_CACHE_PLACEHOLDER_TIMEOUT_MS 3000
+
+typedef struct {
+    lv_obj_t *live;
+    uint32_t live_used;
+    uint8_t *snap_buf;
+    size_t snap_size;
+    lv_img_dsc_t snap_dsc;
+    uint32_t snap_used;
+    uint8_t snap_pins; // placeholder screens currently showing snap_buf
+} cache_entry_t;
+
+typedef struct {
+    ui_screen_id_t id;
+    lv_obj_t *scr;
+    lv_obj_t *prev;
+    lv_timer_t *timeout;
+} placeholder_ctx_t;
+
+// Marks placeholder screens so they are never captured or parked.
+#define UI_SCREEN_CACHE_PLACEHOLDER_FLAG LV_OBJ_FLAG_USER_1
+
+static cache_entry_t s_entries[UI_SCREEN_COUNT] = {};
+static uint32_t s_clock = 0;
+static lv_timer_t *s_pressure_timer = nullptr;
+static ui_screen_cache_stats_t s_stats = {};
+
+static void ensure_pressure_timer(void);
+
+static bool valid_id(ui_screen_id_t id)
+{
+    return (int)id >= 0 && id < UI_SCREEN_COUNT;
+}
+
+static void live_deleted_cb(lv_event_t *e)
+{
+    const int id = (int)(intptr_t)lv_event_get_user_data(e);
+    if (id >= 0 && id < UI_SCREEN_COUNT && s_entries[id].live == lv_event_get_target(e)) {
+        s_entries[id].live = nullptr;
+    }
+}
+
+static void snapshot_free(cache_entry_t *e)
+{
+    if (e->snap_buf) {
+        s_stats.snapshot_bytes -= e->snap_size;
+        heap_caps_free(e->snap_buf);
+    }
+    e->snap_buf = nullptr;
+    e->snap_size = 0;
+    memset(&e->snap_dsc, 0, sizeof(e->snap_dsc));
+}
+
+// Evicts the least recently used live screen (if live) or unpinned snapshot. Returns false if nothing could go.
+static bool evict_lru(bool live)
+{
+    int victim = -1;
+    uint32_t oldest = UINT32_MAX;
+    lv_obj_t *act = lv_scr_act();
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) {
+        const cache_entry_t *e = &s_entries[i];
+        if (live) {
+            if (e->live && e->live != act && e->live_used < oldest) {
+                oldest = e->live_used;
+                victim = i;
+            }
+        } else if (e->snap_buf && e->snap_pins == 0 && e->snap_used < oldest) {
+            oldest = e->snap_used;
+            victim = i;
+        }
+    }
+    if (victim < 0) {
+        return false;
+    }
+
+    cache_entry_t *e = &s_entries[victim];
+    if (live) {
+        lv_obj_t *scr = e->live;
+        e->live = nullptr;
+        ESP_LOGI(TAG, "evict live screen %d", victim);
+        lv_obj_del(scr);
+    } else {
+        ESP_LOGI(TAG, "evict snapshot %d (%u bytes)", victim, (unsigned)e->snap_size);
+        snapshot_free(e);
+    }
+    s_stats.evictions++;
+    return true;
+}
+
+static uint8_t live_count(void)
+{
+    uint8_t n = 0;
+    for (int i = 0; i < UI_SCREEN_COUNT; i++) {
+        n += s_entries[i].live ? 1 : 0;
+    }
+    return n;
+}
+
+static void pressure_timer_cb(lv_timer_t *)
+{
+    while (heap_caps_get_free_size(MALLOC_CAP_INTERNAL) < UI_SCREEN_CACHE_MIN_INTERNAL_FREE && evict_lru(true)) {
+        s_stats.pressure_evictions++;
+    }
+    while (heap_caps_get_free_size(MALLOC_CAP_SPIRAM) < UI_SCREEN_CACHE_MIN_PSRAM_FREE && evict_lru(false)) {
+        s_stats.pressure_evictions++;
+    }
+}
+
+static void ensure_pressure_timer(void)
+{
+    if (!s_pressure_timer) {
+        s_pressure_timer = lv_timer_create(pressure_timer_cb, UI_SCREEN_CACHE_PRESSURE_PERIOD_MS, NULL);
+    }
+}
+
+static void placeholder_del_timer_cb(lv_timer_t *t)
+{
+    lv_obj_t *scr = (lv_obj_t *)t->user_data;
+    // The app may have loaded its screen with auto_del and deleted the placeholder already.
+    if (lv_obj_is_valid(scr) && scr != lv_scr_act()) {
+        lv_obj_del(scr);
+    }
+}
+
+static void placeholder_timeout_cb(lv_timer_t *t)
+{
+    placeholder_ctx_t *ctx = (placeholder_ctx_t *)t->user_data;
+    ctx->timeout = nullptr;
+    lv_obj_t *act = lv_scr_act();
+    if (act == ctx->scr && ctx->prev && lv_obj_is_valid(ctx->prev)) {
+        ESP_LOGW(TAG, "app %d did not replace its placeholder; returning", (int)ctx->id);
+        lv_scr_load_anim(ctx->prev, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+    }
+}
+
+static void placeholder_event_cb(lv_event_t *e)
+{
+    lv_obj_t *scr = lv_event_get_target(e);
+    placeholder_ctx_t *ctx = (placeholder_ctx_t *)lv_event_get_user_data(e);
+    const lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_SCREEN_UNLOADED) {
+        // Never delete a screen from inside its own load sequence; do it on the next timer pass.
+        lv_timer_t *t = lv_timer_create(placeholder_del_timer_cb, 0, scr);
+        lv_timer_set_repeat_count(t, 1);
+    } else if (code == LV_EVENT_DELETE) {
+        if (ctx->timeout) {
+            lv_timer_del(ctx->timeout);
+        }
+        if (s_entries[ctx->id].snap_pins > 0) {
+            s_entries[ctx->id].snap_pins--;
+        }
+        lv_mem_free(ctx);
+    }
+}
+
+bool ui_screen_cache_show_snapshot(ui_screen_id_t id)
+{
+    if (!valid_id(id)) {
+        return false;
+    }
+    cache_entry_t *e = &s_entries[id];
+    if (e->live) {
+        return false;
+    }
+    if (!e->snap_buf) {
+        s_stats.snapshot_misses++;
+        return false;
+    }
+
+    placeholder_ctx_t *ctx = (placeholder_ctx_t *)lv_mem_alloc(sizeof(placeholder_ctx_t));
+    if (!ctx) {
+        return false;
+    }
+    ctx->id = id;
+    ctx->prev = lv_scr_act();
+
+    lv_obj_t *scr = lv_obj_create(NULL);
+    lv_obj_set_style_pad_all(scr, 0, 0);
+    lv_obj_set_style_border_width(scr, 0, 0);
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x000000), 0);
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(scr, UI_SCREEN_CACHE_PLACEHOLDER_FLAG);
+    ctx->scr = scr;
+
+    lv_obj_t *img = lv_img_create(scr);
+    lv_img_set_src(img, &e->snap_dsc);
+    lv_obj_set_pos(img, 0, 0);
+
+    e->snap_pins++;
+    e->snap_used = ++s_clock;
+    lv_obj_add_event_cb(scr, placeholder_event_cb, LV_EVENT_ALL, ctx);
+
+    ctx->timeout = lv_timer_create(placeholder_timeout_cb, UI_SCREEN_CACHE_PLACEHOLDER_TIMEOUT_MS, ctx);
+    lv_timer_set_repeat_count(ctx->timeout, 1);
+
+    lv_scr_load_anim(scr, LV_SCR_LOAD_ANIM_NONE, 0, 0, false);
+    // Put the bitmap on the panel before the caller spends time building the real screen.
+    lv_refr_now(NULL);
+    s_stats.snapshot_hits++;
+    return true;
+}
+
+void ui_screen_cache_capture(ui_screen_id_t id, lv_obj_t *scr)
+{
+    if (!valid_id(id) || !scr || !lv_obj_is_valid(scr) || lv_obj_get_parent(scr) != NULL) {
+        return;
+    }
+    if (lv_obj_has_flag(scr, UI_SCREEN_CACHE_PLACEHOLDER_FLAG)) {
+        return;
+    }
+    cache_entry_t *e = &s_entries[id];
+    if (e->snap_buf) {
+        e->snap_used = ++s_clock;
+        return;
+    }
+    ensure_pressure_timer();
+
+    lv_obj_update_layout(scr);
+    const uint32_t size = lv_snapshot_buf_size_needed(scr, LV_IMG_CF_TRUE_COLOR);
+    if (size == 0) {
+        return;
+    }
+    while (s_stats.snapshot_bytes + size > UI_SCREEN_CACHE_SNAPSHOT_BUDGET && evict_lru(false)) {
+    }
+    if (s_stats.snapshot_bytes + size > UI_SCREEN_CACHE_SNAPSHOT_BUDGET ||
+        heap_caps_get_free_size(MALLOC_CAP_SPIRAM) < UI_SCREEN_CACHE_MIN_PSRAM_FREE + size) {
+        return;
+    }
+
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!buf) {
+        return;
+    }
+    const uint32_t t0 = lv_tick_get();
+    if (lv_snapshot_take_to_buf(scr, LV_IMG_CF_TRUE_COLOR, &e->snap_dsc, buf, size) != LV_RES_OK) {
+        heap_caps_free(buf);
+        memset(&e->snap_dsc, 0, sizeof(e->snap_dsc));
+        return;
+    }
+    e->snap_buf = buf;
+    e->snap_size = size;
+    e->snap_used = ++s_clock;
+    s_stats.snapshot_bytes += size;
+    ESP_LOGI(TAG, "snapshot %d: %u bytes in %u ms (total %u)", (int)id, (unsigned)size, (unsigned)lv_tick_elaps(t0),
+             (unsigned)s_stats.snapshot_bytes);
+}
+
+void ui_screen_cache_park(ui_screen_id_t id, lv_obj_t *scr)
+{
+    if (!valid_id(id) || !scr || !lv_obj_is_valid(scr) || lv_obj_has_flag(scr, UI_SCREEN_CACHE_PLACEHOLDER_FLAG)) {
+        return;
+    }
+    cache_entry_t *e = &s_entries[id];
+    if (e->live != scr) {
+        if (e->live) {
+            // The owner built a new screen instead of resuming the parked one, which nothing else
+            // references. Delete it, unless it is somehow on the panel; then keep it and refuse scr.
+            lv_obj_t *old = e->live;
+            if (old == lv_scr_act()) {
+                ESP_LOGW(TAG, "screen %d: parked screen is active, not parking another", (int)id);
+                return;
+            }
+            ESP_LOGW(TAG, "screen %d parked again with a new screen; deleting the old one", (int)id);
+            lv_obj_remove_event_cb_with_user_data(old, live_deleted_cb, (void *)(intptr_t)id);
+            e->live = nullptr;
+            lv_obj_del(old);
+        }
+        e->live = scr;
+        lv_obj_add_event_cb(scr, live_deleted_cb, LV_EVENT_DELETE, (void *)(intptr_t)id);
+    }
+    e->live_used = ++s_clock;
+    ensure_pressure_timer();
+
+    while (live_count() > UI_SCREEN_CACHE_MAX_LIVE && evict_lru(true)) {
+    }
+    pressure_timer_cb(nullptr);
+}
+
+void ui_screen_cache_unpark(ui_screen_id_t id)
+{
+    if (!valid_id(id)) {
+        return;
+    }
+    cache_entry_t *e = &s_entries[id];
+    if (e->live) {
+        lv_obj_remove_event_cb_with_user_data(e->live, live_deleted_cb, (void *)(intptr_t)id);
+        e->live = nullptr;
+        s_stats.live_resumes++;
+    }
+}
+
+bool ui_screen_cache_has_live(ui_screen_id_t id)
+{
+    return valid_id(id) && s_entries[id].live != nullptr;
+}
+
+void ui_screen_cache_clear(void)
+{
+    while (evict_lru(true)) {
+    }
+    while (evict_lru(false)) {
+    }
+}
+
+void ui_screen_cache_get_stats(ui_screen_cache_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    *out = s_stats;
+    out->live_count = live_count();
+}
@@ -12,6 +12,7 @@
 #include "app_pins.h"
 #include "display_lvgl.h"
 #include "ui_app_carousel.h"
+#include "ui_theme.h"
 
 static const char *TAG = "terminal";
 
@@ -61,6 +62,9 @@ static void terminal_exit_to_carousel_async(void *);
 static int terminal_log_vprintf(const char *fmt, va_list args)
 {
     char line_buf[256];
+    // args is consumed twice; on ABIs where va_list is passed by reference the second use needs a copy.
+    va_list uart_args;
+    va_copy(uart_args, args);
     int len = vsnprintf(line_buf, sizeof(line_buf), fmt, args);
     
     if (s_log_buffer && len > 0) {
@@ -68,7 +72,9 @@ static int terminal_log_vprintf(const char *fmt, va_list args)
     }
     
     // Also send to UART
-    return vprintf(fmt, args);
+    const int ret = vprintf(fmt, uart_args);
+    va_end(uart_args);
+    return ret;
 }
 
 static void append_to_terminal(const char *text, size_t len)
@@ -117,7 +123,7 @@ static void terminal_exit_to_carousel_async(void *)
     // Ensure LVGL calls happen with our global LVGL lock.
     if (!display_lvgl_lock(200)) {
         // Try again soon
-        lv_async_call(terminal_exit_to_carousel_async, nullptr);
+        display_lvgl_async_call(terminal_exit_to_carousel_async, nullptr);
         return;
     }
 
@@ -160,7 +166,7 @@ static void term_load_deferred(lv_obj_t *scr, bool auto_del)
     }
     req->scr = scr;
     req->auto_del = auto_del;
-    lv_async_call(term_load_async_cb, req);
+    display_lvgl_async_call(term_load_async_cb, req);
 }
 
 static void switch_mode_event(lv_event_t *e)
@@ -217,27 +223,24 @@ esp_err_t ui_terminal_init(void)
     
     // Create terminal screen
     s_terminal_screen = lv_obj_create(NULL);
-    lv_obj_set_style_bg_color(s_terminal_screen, lv_color_hex(0x000000), 0);
-    lv_obj_set_style_pad_all(s_terminal_screen, 0, 0);
+    ui_theme_apply(s_terminal_screen, UI_THEME_SCREEN_FLUSH);
     
     // Header bar
     lv_obj_t *header = lv_obj_create(s_terminal_screen);
-    lv_obj_set_size(header, APP_LCD_H_RES, 44);
+    ui_theme_apply(header, UI_THEME_HEADER);
     lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 0);
-    lv_obj_set_style_bg_color(header, lv_color_hex(0x1a1a1a), 0);
-    lv_obj_set_style_border_width(header, 0, 0);
     lv_obj_clear_flag(header, LV_OBJ_FLAG_SCROLLABLE);
     
     // Exit button
     lv_obj_t *btn_exit = lv_btn_create(header);
-    lv_obj_set_size(btn_exit, 60, 32);
+    ui_theme_apply(btn_exit, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_exit, LV_ALIGN_LEFT_MID, 4, 0);
     lv_obj_t *lbl_exit = lv_label_create(btn_exit);
     lv_label_set_text(lbl_exit, "Exit");
     lv_obj_center(lbl_exit);
     lv_obj_add_event_cb(btn_exit, [](lv_event_t *) {
         // Defer: avoid deleting/loading screens inside event callback.
-        lv_async_call(terminal_exit_to_carousel_async, nullptr);
+        display_lvgl_async_call(terminal_exit_to_carousel_async, nullptr);
     }, LV_EVENT_CLICKED, NULL);
 
     // If the terminal screen is deleted (e.g., replaced by carousel), stop its worker task and clear pointers.
@@ -255,12 +258,12 @@ esp_err_t ui_terminal_init(void)
     // Title
     lv_obj_t *lbl_title = lv_label_create(header);
     lv_label_set_text(lbl_title, "Terminal");
-    lv_obj_set_style_text_color(lbl_title, lv_color_white(), 0);
+    ui_theme_apply(lbl_title, UI_THEME_TITLE);
     lv_obj_align(lbl_title, LV_ALIGN_CENTER, 0, 0);
     
     // Mode switch button
     lv_obj_t *btn_mode = lv_btn_create(header);
-    lv_obj_set_size(btn_mode, 60, 32);
+    ui_theme_apply(btn_mode, UI_THEME_HEADER_BTN);
     lv_obj_align(btn_mode, LV_ALIGN_RIGHT_MID, -4, 0);
     lv_obj_t *lbl_mode = lv_label_create(btn_mode);
     lv_label_set_text(lbl_mode, "Mode");
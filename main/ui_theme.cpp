@@ -0,0 +1,65 @@
+#include "ui_theme.h"
+
+static lv_style_t s_styles[UI_THEME_COUNT];
+static bool s_inited = false;
+
+static void init_content(lv_style_t *s, lv_coord_t pad)
+{
+    lv_style_init(s);
+    lv_style_set_bg_opa(s, LV_OPA_TRANSP);
+    lv_style_set_border_width(s, 0);
+    lv_style_set_pad_all(s, pad);
+}
+
+static void theme_init(void)
+{
+    lv_style_t *s = &s_styles[UI_THEME_SCREEN];
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(0x000000));
+    lv_style_set_pad_all(s, 8);
+
+    s = &s_styles[UI_THEME_SCREEN_FLUSH];
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(0x000000));
+    lv_style_set_pad_all(s, 0);
+
+    s = &s_styles[UI_THEME_HEADER];
+    lv_style_init(s);
+    lv_style_set_width(s, lv_pct(100));
+    lv_style_set_height(s, 44);
+    lv_style_set_pad_all(s, 6);
+    lv_style_set_bg_color(s, lv_color_hex(0x1a1a1a));
+    lv_style_set_border_width(s, 0);
+
+    s = &s_styles[UI_THEME_HEADER_BTN];
+    lv_style_init(s);
+    lv_style_set_width(s, 60);
+    lv_style_set_height(s, 32);
+
+    s = &s_styles[UI_THEME_TITLE];
+    lv_style_init(s);
+    lv_style_set_text_color(s, lv_color_white());
+
+    init_content(&s_styles[UI_THEME_CONTENT], 8);
+    init_content(&s_styles[UI_THEME_CONTENT_LOOSE], 12);
+    lv_style_set_pad_row(&s_styles[UI_THEME_CONTENT_LOOSE], 10);
+    init_content(&s_styles[UI_THEME_CONTENT_FLUSH], 0);
+
+    s = &s_styles[UI_THEME_LIST];
+    lv_style_init(s);
+    lv_style_set_bg_color(s, lv_color_hex(0x0a0a0a));
+    lv_style_set_border_width(s, 0);
+
+    s_inited = true;
+}
+
+void ui_theme_apply(lv_obj_t *obj, ui_theme_style_t style)
+{
+    if (!obj || style >= UI_THEME_COUNT) {
+        return;
+    }
+    if (!s_inited) {
+        theme_init();
+    }
+    lv_obj_add_style(obj, &s_styles[style], 0);
+}
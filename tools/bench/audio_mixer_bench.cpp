@@ -0,0 +1,243 @@
+// Host benchmark for main/audio_mixer.cpp.
+//
+//   g++ -O2 -std=c++17 -pthread -I main/include tools/bench/audio_mixer_bench.cpp main/audio_mixer.cpp main/pcm_ring.cpp -o /tmp/audio_mixer_bench
+//   /tmp/audio_mixer_bench
+//
+// Part 1 mixes a stream and mono/stereo sounds at several gains, loud enough to clip, and compares
+// every output sample with a reference computed the obvious way (per-source Q15 scaling, 64-bit
+// sum, saturation). Stopped sounds must fall silent from the next block.
+//
+// Part 2 runs the mixer the way the engine does, one 240-frame block per 5 ms, while three threads
+// call play() at random. Every call must end up either started or counted as dropped, and the
+// report gives play() -> first mixed frame latency and mix cost per block.
+//
+// Part 3 measures mix cost per output frame for a stream plus 0, 4 and 8 sounds.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "audio_mixer.h"
+#include "pcm_ring.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kRate = 48000;
+constexpr uint32_t kBlock = 240; // the engine's block: 5 ms
+
+std::vector<int16_t> noise(uint32_t samples, uint32_t seed, int amplitude)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> d(-amplitude, amplitude);
+    std::vector<int16_t> v(samples);
+    for (int16_t &s : v) {
+        s = (int16_t)d(rng);
+    }
+    return v;
+}
+
+struct Source {
+    const std::vector<int16_t> *pcm;
+    uint8_t channels;
+    uint32_t gain;
+    uint32_t start_block; // played just before this block is mixed
+    uint32_t stop_block;  // stopped just before this block, or UINT32_MAX
+};
+
+int64_t scaled(int16_t s, uint32_t gain)
+{
+    return gain == AUDIO_MIXER_UNITY ? s : ((int64_t)s * gain + (1 << 14)) >> 15;
+}
+
+// ---- Part 1: bit-exact against the reference ----
+
+bool exact()
+{
+    constexpr uint32_t kBlocks = 200;
+    const std::vector<int16_t> stream = noise(kBlocks * kBlock * 2, 1, 20000);
+    const std::vector<int16_t> mono = noise(3000, 2, 32767);
+    const std::vector<int16_t> stereo = noise(2 * 5000, 3, 32767);
+    const Source sources[] = {
+        {&mono, 1, AUDIO_MIXER_UNITY, 3, UINT32_MAX},
+        {&stereo, 2, AUDIO_MIXER_UNITY / 2, 5, UINT32_MAX},
+        {&mono, 1, 12345, 5, UINT32_MAX},
+        {&stereo, 2, AUDIO_MIXER_UNITY, 40, 44},
+        {&mono, 1, 40000, 60, UINT32_MAX}, // above unity
+        {&stereo, 2, 1, 100, UINT32_MAX},
+    };
+    const uint32_t stream_gain = 26000;
+
+    audio_mixer_t *m = audio_mixer_create();
+    pcm_ring_t *ring = pcm_ring_create(kBlocks * kBlock);
+    pcm_ring_write(ring, stream.data(), kBlocks * kBlock);
+    pcm_ring_close(ring);
+    audio_mixer_set_stream(m, ring, stream_gain);
+
+    std::vector<audio_mixer_voice_t> handles(std::size(sources), AUDIO_MIXER_NO_VOICE);
+    std::vector<int16_t> out(kBlock * 2);
+    uint64_t bad = 0;
+    uint32_t clipped = 0;
+    for (uint32_t b = 0; b < kBlocks; b++) {
+        for (size_t i = 0; i < std::size(sources); i++) {
+            const Source &s = sources[i];
+            if (s.start_block == b) {
+                const audio_mixer_sound_t snd = {s.pcm->data(), (uint32_t)(s.pcm->size() / s.channels), s.channels};
+                handles[i] = audio_mixer_play(m, &snd, s.gain);
+            }
+            if (s.stop_block == b) {
+                audio_mixer_stop(m, handles[i]);
+            }
+        }
+        if (!audio_mixer_mix(m, out.data(), kBlock)) {
+            printf("block %u: mixer idle with a stream queued\n", (unsigned)b);
+            return false;
+        }
+        for (uint32_t f = 0; f < kBlock; f++) {
+            for (int ch = 0; ch < 2; ch++) {
+                const uint64_t frame = (uint64_t)b * kBlock + f;
+                int64_t sum = scaled(stream[frame * 2 + ch], stream_gain);
+                for (const Source &s : sources) {
+                    const uint64_t end = s.stop_block == UINT32_MAX ? UINT64_MAX : (uint64_t)s.stop_block * kBlock;
+                    const uint64_t start = (uint64_t)s.start_block * kBlock;
+                    const uint64_t len = s.pcm->size() / s.channels;
+                    if (frame < start || frame >= start + len || frame >= end) {
+                        continue;
+                    }
+                    const uint64_t at = (frame - start) * s.channels + (s.channels == 2 ? ch : 0);
+                    sum += scaled((*s.pcm)[at], s.gain);
+                }
+                const int64_t want = std::clamp<int64_t>(sum, -32768, 32767);
+                clipped += want != sum;
+                bad += out[f * 2 + ch] != want;
+            }
+        }
+    }
+    // Everything has finished: the mixer goes idle.
+    const bool idle = !audio_mixer_mix(m, out.data(), kBlock);
+
+    audio_mixer_stats_t st;
+    audio_mixer_get_stats(m, &st);
+    audio_mixer_set_stream(m, nullptr, 0);
+    pcm_ring_destroy(ring);
+    audio_mixer_destroy(m);
+    const bool ok = bad == 0 && idle && st.clipped == clipped && st.started == std::size(sources);
+    printf("exact: %u blocks, %zu sounds, %llu samples differ, %u clipped (expected %u), idle after: %s: %s\n\n",
+           (unsigned)kBlocks, std::size(sources), (unsigned long long)bad, (unsigned)st.clipped, (unsigned)clipped,
+           idle ? "yes" : "no", ok ? "OK" : "FAIL");
+    return ok;
+}
+
+// ---- Part 2: concurrent play() against a paced mixer ----
+
+bool concurrent()
+{
+    constexpr uint32_t kSeconds = 3;
+    constexpr int kThreads = 3;
+    const std::vector<int16_t> click = noise(1680, 4, 5000); // 35 ms, like the UI click
+    const audio_mixer_sound_t snd = {click.data(), (uint32_t)click.size(), 1};
+
+    audio_mixer_t *m = audio_mixer_create();
+    std::atomic<bool> run{true};
+    std::atomic<uint32_t> calls{0};
+    std::atomic<uint32_t> stops{0};
+    std::vector<std::thread> players;
+    for (int t = 0; t < kThreads; t++) {
+        players.emplace_back([&, t] {
+            std::mt19937 rng(10 + t);
+            while (run.load()) {
+                const audio_mixer_voice_t v = audio_mixer_play(m, &snd, AUDIO_MIXER_UNITY);
+                calls++;
+                if (v != AUDIO_MIXER_NO_VOICE && rng() % 8 == 0) {
+                    audio_mixer_stop(m, v);
+                    stops++;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(rng() % 40000));
+            }
+        });
+    }
+
+    std::vector<int16_t> out(kBlock * 2);
+    Clock::time_point due = Clock::now();
+    const uint32_t blocks = kSeconds * kRate / kBlock;
+    for (uint32_t b = 0; b < blocks; b++) {
+        audio_mixer_mix(m, out.data(), kBlock);
+        due += std::chrono::microseconds(kBlock * 1000000ull / kRate);
+        std::this_thread::sleep_until(due);
+    }
+    run.store(false);
+    for (std::thread &t : players) {
+        t.join();
+    }
+    // Let the last sounds start (or be stopped) before counting.
+    for (int i = 0; i < 4; i++) {
+        audio_mixer_mix(m, out.data(), kBlock);
+    }
+
+    audio_mixer_stats_t st;
+    audio_mixer_get_stats(m, &st);
+    audio_mixer_destroy(m);
+    // A stopped voice may be freed before it ever reaches the mixer, so it is neither started nor
+    // dropped.
+    const uint32_t accounted = st.started + st.dropped;
+    const bool ok = accounted <= calls.load() && accounted + stops.load() >= calls.load();
+    printf("concurrent: %u play() calls from %d threads in %u s, %u started, %u dropped (all %u voices busy), "
+           "%u stopped\n",
+           (unsigned)calls.load(), kThreads, (unsigned)kSeconds, (unsigned)st.started, (unsigned)st.dropped,
+           (unsigned)AUDIO_MIXER_VOICES, (unsigned)stops.load());
+    printf("  latency play() -> mixed: %.2f ms avg, %.2f ms max (one block is %.1f ms)\n",
+           st.started ? st.latency_us_sum / 1000.0 / st.started : 0.0, st.latency_us_max / 1000.0,
+           kBlock * 1000.0 / kRate);
+    printf("  mix: %u blocks, %.2f us avg, %u us max per block: %s\n\n", (unsigned)st.blocks,
+           st.blocks ? (double)st.mix_us / st.blocks : 0.0, (unsigned)st.mix_us_max, ok ? "OK" : "FAIL");
+    return ok;
+}
+
+// ---- Part 3: cost ----
+
+void cost()
+{
+    constexpr uint32_t kBlocks = 20000;
+    const std::vector<int16_t> stream = noise(kBlock * 2, 5, 8000);
+    const std::vector<int16_t> sound = noise(kBlocks * kBlock, 6, 3000);
+    const audio_mixer_sound_t snd = {sound.data(), (uint32_t)sound.size(), 1};
+    std::vector<int16_t> out(kBlock * 2);
+
+    printf("%-8s %10s %12s\n", "sounds", "ns/frame", "% of 1 core");
+    for (uint32_t voices : {0u, 4u, 8u}) {
+        audio_mixer_t *m = audio_mixer_create();
+        pcm_ring_t *ring = pcm_ring_create(kBlock * 4);
+        audio_mixer_set_stream(m, ring, 30000);
+        for (uint32_t v = 0; v < voices; v++) {
+            audio_mixer_play(m, &snd, v % 2 ? AUDIO_MIXER_UNITY : 20000);
+        }
+        const Clock::time_point t0 = Clock::now();
+        for (uint32_t b = 0; b < kBlocks; b++) {
+            pcm_ring_write(ring, stream.data(), kBlock);
+            audio_mixer_mix(m, out.data(), kBlock);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / kBlocks / kBlock;
+        printf("%-8u %10.2f %11.3f%%\n", (unsigned)voices, ns, ns * kRate / 1e7);
+        audio_mixer_destroy(m);
+        pcm_ring_destroy(ring);
+    }
+    printf("(stream + sounds at %u Hz; the stream ring is refilled each block, which is included)\n",
+           (unsigned)kRate);
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = exact();
+    ok = concurrent() && ok;
+    cost();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,741 @@
+// Host benchmark for the image_decoder JPEG path (main/image_decoder.cpp, main/jpeg_backend_tjpgd.cpp).
+//
+//   LVGL=managed_components/lvgl__lvgl   # any LVGL 8.4 tree; only its tjpgd.c is compiled
+//   gcc -O2 -c -DLV_CONF_INCLUDE_SIMPLE -I host/config -I $LVGL -I $LVGL/src $LVGL/src/extra/libs/sjpg/tjpgd.c -o /tmp/tjpgd.o
+//   g++ -O2 -std=c++17 -pthread -DLV_CONF_INCLUDE_SIMPLE -I host/config -I host/include -I host/src -I main/include -I main -I $LVGL -I $LVGL/src tools/bench/jpeg_scale_bench.cpp main/image_decoder.cpp main/jpeg_backend_tjpgd.cpp main/jpeg_backend_esp.cpp main/block_cache.cpp host/src/sim_esp.cpp host/src/sim_freertos.cpp /tmp/tjpgd.o -ljpeg -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free,--wrap=fopen,--wrap=opendir,--wrap=mkdir,--wrap=stat,--wrap=rename,--wrap=unlink -o /tmp/jpeg_scale_bench
+//   /tmp/jpeg_scale_bench [corpus_dir]
+//
+// Runs the firmware's own decoder code: the tjpgd backend, image_decoder's worker task (on the
+// FreeRTOS shim from host/src) and the block cache it reads through. esp_new_jpeg only ships
+// Xtensa/RISC-V libraries, so on the host image_decoder has tjpgd as its only backend, like a build
+// without the component. Decodes every .jpg in corpus_dir (or a generated set of camera-sized
+// photos) three ways:
+//   full    tjpgd at 1/1 into a w*h*3 RGB888 frame, as lv_sjpg does for a plain JPEG file.
+//   viewer  image_decoder, IMAGE_DECODE_CROP to the viewer area: DCT-scaled, centre-cropped RGB565.
+//   thumb   image_decoder, IMAGE_DECODE_FIT to a 40x40 list thumbnail.
+// libjpeg-turbo writes the generated photos and decodes the full-resolution reference; every
+// output is checked against it, box-filtered down to the DCT scale. Peak memory counts the
+// allocations the decode makes (malloc is wrapped), not the block cache pool, which is allocated
+// once at boot. Times are host times: they show what the DCT scale saves, not the S3's numbers.
+//
+// jpeg_backend_esp's output sizes are checked first: esp_new_jpeg only scales to multiples of 8.
+// Finally a JPEG embedded in a larger file (as cover art is in an MP3) is decoded by offset and
+// length, and the same request with the length cut in half must fail rather than decode on into
+// the bytes that follow.
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <jpeglib.h>
+
+#include "block_cache.h"
+#include "display_lvgl.h"
+#include "image_decoder.h"
+#include "jpeg_backend.h"
+#include "sim.h"
+
+// ---- Allocation tracking (firmware code and the buffers below; the decoder runs on its own thread) ----
+
+static std::mutex g_mem_mux;
+static size_t g_cur = 0;
+static size_t g_peak = 0;
+
+extern "C" void *__real_malloc(size_t size);
+extern "C" void __real_free(void *p);
+
+extern "C" void *__wrap_malloc(size_t size)
+{
+    uint8_t *p = (uint8_t *)__real_malloc(size + 16);
+    if (!p) {
+        return nullptr;
+    }
+    std::memcpy(p, &size, sizeof(size));
+    std::lock_guard<std::mutex> guard(g_mem_mux);
+    g_cur += size;
+    g_peak = std::max(g_peak, g_cur);
+    return p + 16;
+}
+
+extern "C" void __wrap_free(void *p)
+{
+    if (!p) {
+        return;
+    }
+    uint8_t *b = (uint8_t *)p - 16;
+    size_t size;
+    std::memcpy(&size, b, sizeof(size));
+    {
+        std::lock_guard<std::mutex> guard(g_mem_mux);
+        g_cur -= size;
+    }
+    __real_free(b);
+}
+
+// block_cache allocates with calloc and frees with free, so these must carry the same header.
+extern "C" void *__wrap_calloc(size_t n, size_t size)
+{
+    if (size && n > SIZE_MAX / size) {
+        return nullptr;
+    }
+    void *p = __wrap_malloc(n * size);
+    if (p) {
+        std::memset(p, 0, n * size);
+    }
+    return p;
+}
+
+extern "C" void *__wrap_realloc(void *p, size_t size)
+{
+    if (!p) {
+        return __wrap_malloc(size);
+    }
+    size_t old;
+    std::memcpy(&old, (uint8_t *)p - 16, sizeof(old));
+    void *q = __wrap_malloc(size);
+    if (q) {
+        std::memcpy(q, p, std::min(old, size));
+        __wrap_free(p);
+    }
+    return q;
+}
+
+static void mem_reset(size_t *base)
+{
+    std::lock_guard<std::mutex> guard(g_mem_mux);
+    g_peak = g_cur;
+    *base = g_cur;
+}
+
+static size_t mem_peak(size_t base)
+{
+    std::lock_guard<std::mutex> guard(g_mem_mux);
+    return g_peak - base;
+}
+
+// ---- LVGL task stand-in: image_decoder delivers its events through display_lvgl_async_call() ----
+
+static std::mutex g_async_mux;
+static std::condition_variable g_async_cv;
+static std::deque<std::pair<void (*)(void *), void *>> g_async;
+
+extern "C" esp_err_t display_lvgl_async_call(void (*cb)(void *), void *user_data)
+{
+    {
+        std::lock_guard<std::mutex> guard(g_async_mux);
+        g_async.emplace_back(cb, user_data);
+    }
+    g_async_cv.notify_one();
+    return ESP_OK;
+}
+
+// image_decoder_release() drops the image from LVGL's cache; there is none here.
+void lv_img_cache_invalidate_src(const void *)
+{
+}
+
+static void run_async_one(void)
+{
+    std::unique_lock<std::mutex> lock(g_async_mux);
+    g_async_cv.wait(lock, [] { return !g_async.empty(); });
+    const auto call = g_async.front();
+    g_async.pop_front();
+    lock.unlock();
+    call.first(call.second);
+}
+
+namespace {
+
+constexpr int kMaxW = 368;      // APP_LCD_H_RES
+constexpr int kMaxH = 448 - 52; // APP_LCD_V_RES - kContentTop in ui_media
+constexpr int kThumb = 40;      // FILE_LIST_THUMB_SIZE in ui_file_list
+// tjpgd's integer IDCT, its reduced-scale output and RGB565 each add a little against libjpeg.
+constexpr double kMaxMeanErr = 8.0;
+
+// A file libjpeg cannot decode ends the run; the corpus is expected to be valid.
+void on_error(j_common_ptr cinfo)
+{
+    char msg[JMSG_LENGTH_MAX];
+    cinfo->err->format_message(cinfo, msg);
+    std::fprintf(stderr, "libjpeg: %s\n", msg);
+    std::exit(1);
+}
+
+struct Image {
+    int w = 0;
+    int h = 0;
+    std::vector<uint8_t> rgb; // w * h * 3
+};
+
+struct Result {
+    double ms = 1e9;
+    size_t peak = 0;
+    int w = 0;
+    int h = 0;
+    double err = 0.0;
+};
+
+// Full-resolution reference.
+bool decode_libjpeg(const char *path, Image &img)
+{
+    FILE *fp = std::fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr err;
+    cinfo.err = jpeg_std_error(&err);
+    err.error_exit = on_error;
+    jpeg_create_decompress(&cinfo);
+    jpeg_stdio_src(&cinfo, fp);
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&cinfo);
+    img.w = (int)cinfo.output_width;
+    img.h = (int)cinfo.output_height;
+    img.rgb.resize((size_t)img.w * img.h * 3);
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = img.rgb.data() + (size_t)img.w * 3 * cinfo.output_scanline;
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    std::fclose(fp);
+    return true;
+}
+
+// Mean of the f x f box of the reference that scaled pixel (sx, sy) was reduced from. Partial
+// boxes at the right and bottom edges repeat the last pixel.
+double box(const Image &ref, int sx, int sy, int f, int c)
+{
+    int sum = 0;
+    for (int by = 0; by < f; by++) {
+        for (int bx = 0; bx < f; bx++) {
+            const int fy = std::min(sy * f + by, ref.h - 1);
+            const int fx = std::min(sx * f + bx, ref.w - 1);
+            sum += ref.rgb[((size_t)fy * ref.w + fx) * 3 + c];
+        }
+    }
+    return (double)sum / (f * f);
+}
+
+double color_err(lv_color_t px, const Image &ref, int sx, int sy, int f)
+{
+    lv_color32_t c;
+    c.full = lv_color_to32(px);
+    return std::fabs(c.ch.red - box(ref, sx, sy, f, 0)) + std::fabs(c.ch.green - box(ref, sx, sy, f, 1)) +
+           std::fabs(c.ch.blue - box(ref, sx, sy, f, 2));
+}
+
+// ---- full: the tjpgd backend at 1/1, read straight from the file ----
+
+size_t file_read(void *ctx, uint8_t *buf, size_t len)
+{
+    FILE *fp = (FILE *)ctx;
+    if (!buf) {
+        return std::fseek(fp, (long)len, SEEK_CUR) == 0 ? len : 0;
+    }
+    return std::fread(buf, 1, len, fp);
+}
+
+struct FullFrame {
+    uint8_t *rgb;
+    int w;
+    const Image *ref;
+    double err_sum;
+    uint64_t err_n;
+};
+
+bool on_full_block(const jpeg_block_t *blk, void *user_data)
+{
+    FullFrame *ff = (FullFrame *)user_data;
+    for (int y = 0; y < blk->h; y++) {
+        for (int x = 0; x < blk->w; x++) {
+            const lv_color_t px = blk->px[y * blk->w + x];
+            lv_color32_t c;
+            c.full = lv_color_to32(px);
+            uint8_t *d = ff->rgb + ((size_t)(blk->y + y) * ff->w + blk->x + x) * 3;
+            d[0] = c.ch.red;
+            d[1] = c.ch.green;
+            d[2] = c.ch.blue;
+            if (ff->ref && ((blk->x + x) & 3) == 0) {
+                ff->err_sum += color_err(px, *ff->ref, blk->x + x, blk->y + y, 1) / 3;
+                ff->err_n++;
+            }
+        }
+    }
+    return true;
+}
+
+bool decode_full(const char *path, const Image &ref, Result &r)
+{
+    for (int rep = 0; rep < 3; rep++) {
+        FILE *fp = std::fopen(path, "rb");
+        if (!fp) {
+            return false;
+        }
+        std::fseek(fp, 0, SEEK_END);
+        jpeg_source_t src;
+        src.read = file_read;
+        src.ctx = fp;
+        src.size = (uint32_t)std::ftell(fp);
+        std::fseek(fp, 0, SEEK_SET);
+
+        size_t base;
+        mem_reset(&base);
+        const auto t0 = std::chrono::steady_clock::now();
+        uint16_t w = 0;
+        uint16_t h = 0;
+        void *dec = jpeg_backend_tjpgd.open(&src, &w, &h);
+        if (!dec) {
+            std::fclose(fp);
+            return false;
+        }
+        FullFrame ff = {(uint8_t *)std::malloc((size_t)w * h * 3), w, rep == 0 ? &ref : nullptr, 0.0, 0};
+        const bool ok = jpeg_backend_tjpgd.decode(dec, 0, on_full_block, &ff);
+        jpeg_backend_tjpgd.close(dec);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        r.ms = std::min(r.ms, ms);
+        r.peak = mem_peak(base);
+        r.w = w;
+        r.h = h;
+        if (rep == 0) {
+            r.err = ff.err_n ? ff.err_sum / ff.err_n : 0.0;
+        }
+        std::free(ff.rgb);
+        std::fclose(fp);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---- viewer and thumb: the whole image_decoder job ----
+
+struct Outcome {
+    bool finished = false;
+    bool ok = false;
+    esp_err_t err = ESP_OK;
+    int w = 0;
+    int h = 0;
+    std::vector<lv_color_t> px;
+};
+
+void on_decode_event(image_decode_job_t *job, image_decode_event_t event, void *user_data)
+{
+    Outcome *o = (Outcome *)user_data;
+    if (event == IMAGE_DECODE_DONE) {
+        const lv_img_dsc_t *img = image_decoder_image(job);
+        o->ok = img != nullptr;
+        if (img) {
+            o->w = img->header.w;
+            o->h = img->header.h;
+            const lv_color_t *p = (const lv_color_t *)img->data;
+            o->px.assign(p, p + (size_t)o->w * o->h);
+        }
+    }
+    if (event == IMAGE_DECODE_DONE || event == IMAGE_DECODE_FAILED) {
+        o->err = image_decoder_error(job);
+        o->finished = true;
+    }
+}
+
+// Submits the request and runs the async calls it posts until the job ends. Returns the wall time.
+double run_job(const char *path, uint32_t offset, uint32_t length, int max_w, int max_h, image_decode_mode_t mode,
+               Outcome &o, size_t *peak)
+{
+    o = Outcome();
+    image_decode_req_t req = {};
+    req.vfs_path = path;
+    req.offset = offset;
+    req.length = length;
+    req.max_w = (uint16_t)max_w;
+    req.max_h = (uint16_t)max_h;
+    req.mode = mode;
+    req.cb = on_decode_event;
+    req.user_data = &o;
+
+    size_t base;
+    mem_reset(&base);
+    const auto t0 = std::chrono::steady_clock::now();
+    image_decode_job_t *job = image_decoder_submit(&req);
+    if (!job) {
+        return 0.0;
+    }
+    while (!o.finished) {
+        run_async_one();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (peak) {
+        *peak = mem_peak(base);
+    }
+    image_decoder_release(job);
+    return ms;
+}
+
+// The scaled size image_decoder will pick: the smallest DCT scale that fits, as the backend reports it.
+bool scaled_geometry(const char *path, int max_w, int max_h, int *f, int *sw, int *sh)
+{
+    FILE *fp = std::fopen(path, "rb");
+    if (!fp) {
+        return false;
+    }
+    std::fseek(fp, 0, SEEK_END);
+    jpeg_source_t src;
+    src.read = file_read;
+    src.ctx = fp;
+    src.size = (uint32_t)std::ftell(fp);
+    std::fseek(fp, 0, SEEK_SET);
+    uint16_t w = 0;
+    uint16_t h = 0;
+    void *dec = jpeg_backend_tjpgd.open(&src, &w, &h);
+    std::fclose(fp);
+    if (!dec) {
+        return false;
+    }
+    uint8_t scale = 0;
+    jpeg_backend_tjpgd.scaled_size(dec, scale, &w, &h);
+    while (scale < 3 && (w > max_w || h > max_h)) {
+        scale++;
+        jpeg_backend_tjpgd.scaled_size(dec, scale, &w, &h);
+    }
+    jpeg_backend_tjpgd.close(dec);
+    *f = 1 << scale;
+    *sw = w;
+    *sh = h;
+    return true;
+}
+
+bool decode_viewer(const char *path, const Image &ref, Result &r, int *f_out)
+{
+    int f = 1;
+    int sw = 0;
+    int sh = 0;
+    if (!scaled_geometry(path, kMaxW, kMaxH, &f, &sw, &sh)) {
+        return false;
+    }
+    *f_out = f;
+    for (int rep = 0; rep < 3; rep++) {
+        Outcome o;
+        size_t peak = 0;
+        const double ms = run_job(path, 0, 0, kMaxW, kMaxH, IMAGE_DECODE_CROP, o, &peak);
+        if (!o.ok || o.w != std::min(sw, kMaxW) || o.h != std::min(sh, kMaxH)) {
+            return false;
+        }
+        r.ms = std::min(r.ms, ms);
+        r.peak = peak;
+        r.w = o.w;
+        r.h = o.h;
+        if (rep == 0) {
+            const int cx = (sw - o.w) / 2;
+            const int cy = (sh - o.h) / 2;
+            double sum = 0.0;
+            uint64_t n = 0;
+            for (int y = 0; y < o.h; y++) {
+                for (int x = 0; x < o.w; x += 4) {
+                    sum += color_err(o.px[(size_t)y * o.w + x], ref, cx + x, cy + y, f) / 3;
+                    n++;
+                }
+            }
+            r.err = n ? sum / n : 0.0;
+        }
+    }
+    return true;
+}
+
+bool decode_thumb(const char *path, const Image &ref, Result &r)
+{
+    int f = 1;
+    int sw = 0;
+    int sh = 0;
+    if (!scaled_geometry(path, kThumb, kThumb, &f, &sw, &sh)) {
+        return false;
+    }
+    for (int rep = 0; rep < 3; rep++) {
+        Outcome o;
+        size_t peak = 0;
+        const double ms = run_job(path, 0, 0, kThumb, kThumb, IMAGE_DECODE_FIT, o, &peak);
+        // FIT keeps the aspect ratio: the long side fills the box.
+        if (!o.ok || o.w > kThumb || o.h > kThumb || (o.w != std::min(sw, kThumb) && o.h != std::min(sh, kThumb))) {
+            return false;
+        }
+        r.ms = std::min(r.ms, ms);
+        r.peak = peak;
+        r.w = o.w;
+        r.h = o.h;
+        if (rep == 0) {
+            // Blocks arrive left to right, top to bottom, so output pixel (ox, oy) holds the last
+            // scaled pixel that maps onto it.
+            double sum = 0.0;
+            uint64_t n = 0;
+            for (int oy = 0; oy < o.h; oy++) {
+                const int sy = ((oy + 1) * sh + o.h - 1) / o.h - 1;
+                for (int ox = 0; ox < o.w; ox++) {
+                    const int sx = ((ox + 1) * sw + o.w - 1) / o.w - 1;
+                    sum += color_err(o.px[(size_t)oy * o.w + ox], ref, sx, sy, f) / 3;
+                    n++;
+                }
+            }
+            r.err = n ? sum / n : 0.0;
+        }
+    }
+    return true;
+}
+
+// ---- Embedded JPEG: offset and length ----
+
+bool check_embedded(const std::vector<uint8_t> &jpeg)
+{
+    const char *path = "/tmp/jpeg_scale_bench_embedded.bin";
+    // Junk before, as an ID3 header would be; after the JPEG, bytes that decode as entropy data if
+    // a reader runs on into them.
+    std::vector<uint8_t> file(1000 + 2 * jpeg.size(), 0x55);
+    std::copy(jpeg.begin(), jpeg.end(), file.begin() + 1000);
+    for (size_t i = 0; i < jpeg.size(); i++) {
+        file[1000 + jpeg.size() + i] = (uint8_t)(i * 131 + 7);
+    }
+    FILE *fp = std::fopen(path, "wb");
+    if (!fp || std::fwrite(file.data(), 1, file.size(), fp) != file.size()) {
+        if (fp) {
+            std::fclose(fp);
+        }
+        return false;
+    }
+    std::fclose(fp);
+
+    bool ok = true;
+    Outcome o;
+    run_job(path, 1000, (uint32_t)jpeg.size(), kMaxW, kMaxH, IMAGE_DECODE_CROP, o, nullptr);
+    std::printf("embedded at 1000, %u bytes: %s\n", (unsigned)jpeg.size(), o.ok ? "decoded" : "FAILED");
+    ok &= o.ok;
+    run_job(path, 1000, (uint32_t)jpeg.size() / 2, kMaxW, kMaxH, IMAGE_DECODE_CROP, o, nullptr);
+    std::printf("same, length cut to %u bytes: %s\n", (unsigned)jpeg.size() / 2,
+                o.finished && !o.ok ? "failed, as it should" : "DECODED PAST THE END");
+    ok &= o.finished && !o.ok;
+    std::remove(path);
+    return ok;
+}
+
+// ---- esp_new_jpeg output size (jpeg_backend_esp_scaled_size) ----
+
+// The decoder itself only runs on the target, but image_decoder sizes and crops its buffer from
+// this rounding, so it is checked here: a size that is not a multiple of 8 makes esp_new_jpeg fail.
+bool check_esp_sizes(void)
+{
+    const struct {
+        uint16_t w, h;
+        uint8_t scale;
+        uint16_t out_w, out_h;
+    } cases[] = {
+        {4032, 3024, 3, 504, 376}, // 378 rounds down
+        {1920, 1080, 3, 240, 128}, // 135 rounds down
+        {1280, 960, 2, 320, 240},
+        {100, 60, 3, 24, 8},       // 60 >> 3 < 8: falls back to 1/4
+        {60, 20, 3, 24, 8},        // ... and to 1/2
+        {15, 15, 1, 15, 15},       // too small for any reduction: full size, unrounded
+        {368, 396, 0, 368, 396},
+    };
+    bool ok = true;
+    for (const auto &c : cases) {
+        uint16_t w = 0;
+        uint16_t h = 0;
+        jpeg_backend_esp_scaled_size(c.w, c.h, c.scale, &w, &h);
+        if (w != c.out_w || h != c.out_h) {
+            std::printf("esp size %ux%u at 1/%u: %ux%u, want %ux%u\n", c.w, c.h, 1U << c.scale, w, h, c.out_w, c.out_h);
+            ok = false;
+        }
+    }
+    // Every result is the full size, or a reduction the decoder accepts: multiples of 8, at least
+    // 8, no larger than 1/2 and no smaller than the requested scale allows.
+    for (uint32_t iw = 1; iw <= 4096; iw += 13) {
+        for (uint32_t ih = 1; ih <= 4096; ih += 29) {
+            for (uint8_t s = 0; s <= 3; s++) {
+                uint16_t w = 0;
+                uint16_t h = 0;
+                jpeg_backend_esp_scaled_size((uint16_t)iw, (uint16_t)ih, s, &w, &h);
+                if (w == iw && h == ih) {
+                    continue;
+                }
+                if (s == 0 || w % 8 || h % 8 || w < 8 || h < 8 || w > iw / 2 || h > ih / 2 ||
+                    w < ((iw >> s) & ~7U) || h < ((ih >> s) & ~7U)) {
+                    std::printf("esp size %ux%u at 1/%u: %ux%u is not a valid output size\n", (unsigned)iw,
+                                (unsigned)ih, 1U << s, w, h);
+                    ok = false;
+                }
+            }
+        }
+    }
+    std::printf("esp_new_jpeg output sizes: %s\n\n", ok ? "OK" : "FAIL");
+    return ok;
+}
+
+// Photo-like test image: smooth gradients, some texture, noise and hard edges.
+bool write_synthetic(const std::string &path, int w, int h, uint32_t seed)
+{
+    FILE *fp = std::fopen(path.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    jpeg_stdio_dest(&cinfo, fp);
+    cinfo.image_width = (JDIMENSION)w;
+    cinfo.image_height = (JDIMENSION)h;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, 90, TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+    std::vector<uint8_t> row((size_t)w * 3);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            seed = seed * 1664525U + 1013904223U;
+            const int noise = (int)(seed >> 28) - 8;
+            const double fx = (double)x / w;
+            const double fy = (double)y / h;
+            const bool edge = ((x / (w / 7 + 1)) + (y / (h / 5 + 1))) & 1;
+            const double tex = 20.0 * std::sin(x * 0.05) * std::cos(y * 0.03);
+            const int r = (int)(200 * fx + tex) + noise + (edge ? 30 : 0);
+            const int g = (int)(180 * fy - tex) + noise;
+            const int b = (int)(120 + 100 * fx * fy) + noise - (edge ? 30 : 0);
+            row[x * 3 + 0] = (uint8_t)std::clamp(r, 0, 255);
+            row[x * 3 + 1] = (uint8_t)std::clamp(g, 0, 255);
+            row[x * 3 + 2] = (uint8_t)std::clamp(b, 0, 255);
+        }
+        JSAMPROW rp = row.data();
+        jpeg_write_scanlines(&cinfo, &rp, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    std::fclose(fp);
+    return true;
+}
+
+bool has_jpeg_ext(const std::string &name)
+{
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    auto ends = [&](const char *e) {
+        const size_t n = std::strlen(e);
+        return lower.size() > n && lower.compare(lower.size() - n, n, e) == 0;
+    };
+    return ends(".jpg") || ends(".jpeg");
+}
+
+std::string kb(size_t bytes)
+{
+    char s[32];
+    if (bytes >= 10 * 1024 * 1024) {
+        std::snprintf(s, sizeof(s), "%zu MB", bytes >> 20);
+    } else {
+        std::snprintf(s, sizeof(s), "%zu KB", (bytes + 1023) >> 10);
+    }
+    return s;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    sim_log_set_level(ESP_LOG_WARN);
+    const block_cache_config_t cache_cfg = BLOCK_CACHE_DEFAULT_CONFIG();
+    block_cache_init(&cache_cfg);
+
+    std::vector<std::string> corpus;
+    std::vector<std::string> generated;
+    if (argc > 1) {
+        DIR *dir = opendir(argv[1]);
+        if (!dir) {
+            std::perror(argv[1]);
+            return 1;
+        }
+        while (dirent *ent = readdir(dir)) {
+            if (has_jpeg_ext(ent->d_name)) {
+                corpus.push_back(std::string(argv[1]) + "/" + ent->d_name);
+            }
+        }
+        closedir(dir);
+        std::sort(corpus.begin(), corpus.end());
+    } else {
+        const struct {
+            int w, h;
+        } sizes[] = {{4032, 3024}, {3264, 2448}, {1920, 1080}, {1280, 960}, {640, 480}, {368, 396}};
+        uint32_t seed = 1;
+        for (const auto &s : sizes) {
+            const std::string path = "/tmp/jpeg_scale_bench_" + std::to_string(s.w) + "x" + std::to_string(s.h) + ".jpg";
+            if (!write_synthetic(path, s.w, s.h, seed++)) {
+                std::perror(path.c_str());
+                return 1;
+            }
+            corpus.push_back(path);
+            generated.push_back(path);
+        }
+    }
+
+    int failures = check_esp_sizes() ? 0 : 1;
+    std::printf("%-28s %9s %5s | %9s %9s %5s | %9s %9s %5s %7s | %8s %9s %5s\n", "file", "size", "scale", "full ms",
+                "full mem", "err", "viewer ms", "mem", "err", "speedup", "thumb ms", "mem", "err");
+    for (const std::string &path : corpus) {
+        const std::string name = path.substr(path.find_last_of('/') + 1);
+        Image ref;
+        Result full;
+        Result viewer;
+        Result thumb;
+        int f = 1;
+        if (!decode_libjpeg(path.c_str(), ref) || !decode_full(path.c_str(), ref, full) ||
+            !decode_viewer(path.c_str(), ref, viewer, &f) || !decode_thumb(path.c_str(), ref, thumb)) {
+            std::printf("%-28s decode failed (not a baseline JPEG?)\n", name.c_str());
+            failures++;
+            continue;
+        }
+        char dims[32];
+        std::snprintf(dims, sizeof(dims), "%dx%d", full.w, full.h);
+        std::printf("%-28s %9s %4s%d | %9.1f %9s %5.2f | %9.1f %9s %5.2f %6.1fx | %8.1f %9s %5.2f\n", name.c_str(),
+                    dims, "1/", f, full.ms, kb(full.peak).c_str(), full.err, viewer.ms, kb(viewer.peak).c_str(),
+                    viewer.err, full.ms / viewer.ms, thumb.ms, kb(thumb.peak).c_str(), thumb.err);
+        if (full.err > kMaxMeanErr || viewer.err > kMaxMeanErr || thumb.err > kMaxMeanErr) {
+            std::printf("MISMATCH on %s: mean error %.2f / %.2f / %.2f\n", name.c_str(), full.err, viewer.err,
+                        thumb.err);
+            failures++;
+        }
+    }
+
+    if (!corpus.empty()) {
+        std::vector<uint8_t> jpeg;
+        if (FILE *fp = std::fopen(corpus.back().c_str(), "rb")) {
+            std::fseek(fp, 0, SEEK_END);
+            jpeg.resize((size_t)std::ftell(fp));
+            std::fseek(fp, 0, SEEK_SET);
+            jpeg.resize(std::fread(jpeg.data(), 1, jpeg.size(), fp));
+            std::fclose(fp);
+        }
+        std::printf("\n");
+        failures += check_embedded(jpeg) ? 0 : 1;
+    }
+
+    for (const std::string &path : generated) {
+        std::remove(path.c_str());
+    }
+    sim_tasks_shutdown();
+    if (failures) {
+        std::printf("%d failures\n", failures);
+        return 1;
+    }
+    std::printf("all decodes match the libjpeg reference\n");
+    return 0;
+}
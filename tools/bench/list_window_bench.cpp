@@ -0,0 +1,174 @@
+// Host check for main/list_window.cpp, the virtual scroll window behind ui_file_list.
+//
+//   g++ -O2 -std=c++17 -I main/include tools/bench/list_window_bench.cpp main/list_window.cpp -o /tmp/list_window_bench
+//   /tmp/list_window_bench
+//
+// Models the file list as LVGL sees it: a content height of span * row_h px, a scroll position
+// LVGL clamps to that content, and row objects placed at list_window_y(). For lists from 0 to
+// 200000 entries it checks that
+//   - scrolling down to the last entry and back up in drag-sized and fling-sized steps never
+//     moves what is on screen when the window slides, and reaches both ends,
+//   - every coordinate handed to LVGL (content height, scroll position, row y) fits in
+//     LV_COORD_MAX, which the old count * row_h layout exceeded past 146 entries,
+//   - entries landing above the view while a scan streams in (as on_batch merges them) keep the
+//     top entry in place,
+//   - list_window_show() puts the requested entry at the top.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "list_window.h"
+
+namespace {
+
+// The firmware's values: LVGL 8.4 without LV_USE_LARGE_COORD, 40 px thumbnails + 16 px padding.
+constexpr int32_t kCoordMax = (1 << 13) - 1;
+constexpr uint16_t kRowH = 56;
+constexpr uint16_t kWindowRows = 128;
+constexpr int32_t kViewH = 392;
+constexpr uint32_t kRowObjs = (kViewH + kRowH - 1) / kRowH + 2;
+
+struct Sim {
+    list_window_t w;
+    int32_t scroll_y = 0;
+    uint32_t slides = 0;
+    bool ok = true;
+
+    Sim() { list_window_init(&w, kWindowRows, kRowH); }
+
+    int64_t abs_top() const { return (int64_t)w.base * kRowH + scroll_y; }
+    int32_t content_h() const { return (int32_t)list_window_span(&w) * kRowH; }
+    int32_t max_scroll() const { return std::max(content_h() - kViewH, 0); }
+
+    void fail(const char *what)
+    {
+        if (ok) {
+            printf("  %s (count %u, base %u, scroll %d)\n", what, (unsigned)w.count, (unsigned)w.base, (int)scroll_y);
+        }
+        ok = false;
+    }
+
+    // What refresh() does: re-anchor, then lay out the row objects.
+    void refresh(uint32_t count, uint32_t shift)
+    {
+        const int64_t want = abs_top() + (int64_t)shift * kRowH;
+        const uint32_t base = w.base;
+        scroll_y = list_window_update(&w, count, shift, scroll_y, kViewH);
+        slides += w.base != base;
+        if (abs_top() != want) {
+            fail("view moved when the window slid");
+        }
+        if (content_h() > kCoordMax || scroll_y > kCoordMax || scroll_y < -kCoordMax) {
+            fail("coordinate out of lv_coord_t range");
+        }
+        const uint32_t first = list_window_index(&w, scroll_y - kRowH);
+        for (uint32_t i = first; i < first + kRowObjs && i < w.count; i++) {
+            const int32_t y = list_window_y(&w, i);
+            if (i < w.base || y < 0 || y + kRowH > content_h()) {
+                fail("visible row outside the window");
+            }
+        }
+    }
+
+    // LVGL clamps a scroll to the content, then sends LV_EVENT_SCROLL.
+    void scroll(int32_t dy)
+    {
+        scroll_y = std::clamp(scroll_y + dy, 0, max_scroll());
+        refresh(w.count, 0);
+    }
+};
+
+bool check_scroll(uint32_t count, int32_t step)
+{
+    Sim s;
+    s.refresh(count, 0);
+    const int64_t end = std::max<int64_t>((int64_t)count * kRowH - kViewH, 0);
+    uint32_t guard = 0;
+    while (s.abs_top() < end && guard++ < 10000000) {
+        s.scroll(step);
+    }
+    if (s.abs_top() != end) {
+        s.fail("could not scroll to the end");
+    }
+    const int32_t shown_h = (int32_t)std::min<int64_t>((int64_t)count * kRowH, kViewH); // short lists end early
+    const uint32_t last = list_window_index(&s.w, s.scroll_y + shown_h - 1);
+    if (count && last != count - 1) {
+        s.fail("last entry not at the bottom of the view");
+    }
+    const uint32_t down = s.slides;
+    while (s.abs_top() > 0 && guard++ < 20000000) {
+        s.scroll(-step);
+    }
+    if (s.abs_top() != 0 || s.w.base != 0) {
+        s.fail("could not scroll back to the top");
+    }
+    printf("%-8u %6d %9u %9u  %s\n", (unsigned)count, (int)step, (unsigned)down, (unsigned)(s.slides - down),
+           s.ok ? "OK" : "FAIL");
+    return s.ok;
+}
+
+// A scan streaming 64-name batches while the user scrolls; some names sort above the view.
+bool check_growth(uint32_t total, std::mt19937 &rng)
+{
+    Sim s;
+    uint32_t count = 0;
+    while (count < total) {
+        const uint32_t add = std::min<uint32_t>(64, total - count);
+        // The firmware only anchors once the user has scrolled away from the top.
+        const uint32_t above = s.abs_top() > 0 ? (uint32_t)(rng() % (add + 1)) : 0;
+        count += add;
+        s.refresh(count, above);
+        s.scroll((int32_t)(rng() % 1201) - 300);
+    }
+    printf("%-8u %6s %9u %9s  %s\n", (unsigned)total, "scan", (unsigned)s.slides, "-", s.ok ? "OK" : "FAIL");
+    return s.ok;
+}
+
+bool check_show(uint32_t count, std::mt19937 &rng)
+{
+    Sim s;
+    s.refresh(count, 0);
+    for (int n = 0; n < 1000; n++) {
+        const uint32_t index = count ? (uint32_t)(rng() % count) : 0;
+        s.scroll_y = list_window_show(&s.w, index, kViewH);
+        // scroll_to_y clamps at the end of the list.
+        const int64_t want = std::min<int64_t>((int64_t)index * kRowH, std::max<int64_t>((int64_t)count * kRowH - kViewH, 0));
+        s.scroll_y = std::min(s.scroll_y, s.max_scroll());
+        if (s.abs_top() != want) {
+            s.fail("show() did not put the entry at the top");
+        }
+        s.refresh(count, 0);
+    }
+    printf("%-8u %6s %9s %9s  %s\n", (unsigned)count, "show", "-", "-", s.ok ? "OK" : "FAIL");
+    return s.ok;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    std::mt19937 rng(7);
+    printf("Old layout: count * %u px passes LV_COORD_MAX (%d) at %u entries\n\n", (unsigned)kRowH, (int)kCoordMax,
+           (unsigned)(kCoordMax / kRowH + 1));
+    printf("%-8s %6s %9s %9s\n", "entries", "step", "slides_dn", "slides_up");
+    for (uint32_t count : {0u, 1u, 7u, 128u, 146u, 147u, 1000u, 5000u, 200000u}) {
+        for (int32_t step : {1, 17, 300, 1700}) {
+            if (count >= 100000 && step < 17) {
+                continue;
+            }
+            ok &= check_scroll(count, step);
+        }
+    }
+    for (uint32_t total : {100u, 1500u, 20000u}) {
+        ok &= check_growth(total, rng);
+    }
+    for (uint32_t count : {0u, 100u, 1500u, 200000u}) {
+        ok &= check_show(count, rng);
+    }
+    printf("\n%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// Host benchmark for main/pcm_ring.cpp.
+//
+//   g++ -O2 -std=c++17 -pthread -I main/include tools/bench/pcm_ring_bench.cpp main/pcm_ring.cpp -o /tmp/pcm_ring_bench
+//   /tmp/pcm_ring_bench
+//
+// Part 1 hammers a small ring from two threads with random write and release sizes and checks that
+// every frame comes out once, in order.
+//
+// Part 2 replays the MP3 player at kSpeed times real time: a decoder thread (decode cost per frame
+// plus random SD stalls) feeds the ring, and an output thread paced like I2S drains it into a file
+// sink, which is then compared with the generated PCM. The "coupled" row models the old single
+// playback task: the only buffer is the I2S DMA ring (6 x 240 frames) and nothing is prebuffered,
+// so any stall longer than ~30 ms is heard (its 3 ms of wall-clock margin also catches some host
+// scheduling jitter). The other rows are the decoder/output pipeline with
+// different ring depths. The stall schedule is the same for every row.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "pcm_ring.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kRate = 44100;
+constexpr uint32_t kFrameSamples = 1152; // one MPEG-1 Layer III frame
+constexpr double kSpeed = 10.0;          // simulated seconds per wall second
+constexpr uint32_t kTrackSeconds = 30;
+constexpr double kDecodeRealtime = 7.0;  // decode speed, x realtime
+constexpr double kStallEveryS = 1.5;     // mean time between SD stalls
+constexpr uint32_t kStallMinMs = 40;
+constexpr uint32_t kStallMaxMs = 400;
+constexpr uint32_t kPollMs = 5;
+
+int16_t sample(uint64_t frame, int ch)
+{
+    const uint64_t x = (frame * 2 + (uint64_t)ch) * 0x9E3779B97F4A7C15ull;
+    return (int16_t)(x >> 48);
+}
+
+void fill_frames(std::vector<int16_t> &buf, uint64_t first, uint32_t frames)
+{
+    buf.resize((size_t)frames * 2);
+    for (uint32_t i = 0; i < frames; i++) {
+        buf[2 * i] = sample(first + i, 0);
+        buf[2 * i + 1] = sample(first + i, 1);
+    }
+}
+
+void sleep_sim_us(double sim_us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(sim_us / kSpeed)));
+}
+
+// ---- Part 1: ordering under contention ----
+
+bool stress()
+{
+    constexpr uint32_t kCap = 1000; // deliberately not a power of two
+    constexpr uint64_t kTotal = 20 * 1000 * 1000;
+    pcm_ring_t *r = pcm_ring_create(kCap);
+    if (!r) {
+        return false;
+    }
+
+    std::thread producer([r] {
+        std::mt19937 rng(1);
+        std::vector<int16_t> buf;
+        uint64_t next = 0;
+        while (next < kTotal) {
+            const uint32_t want = (uint32_t)std::min<uint64_t>(1 + rng() % 1500, kTotal - next);
+            fill_frames(buf, next, want);
+            const uint32_t n = pcm_ring_write(r, buf.data(), want);
+            next += n;
+            if (n < want) {
+                std::this_thread::yield();
+            }
+        }
+        pcm_ring_close(r);
+    });
+
+    std::mt19937 rng(2);
+    uint64_t next = 0;
+    uint64_t bad = 0;
+    for (;;) {
+        uint32_t frames = 0;
+        const int16_t *pcm = pcm_ring_peek(r, &frames);
+        if (frames == 0) {
+            if (pcm_ring_is_closed(r) && pcm_ring_fill(r) == 0) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        frames = std::min<uint32_t>(frames, 1 + rng() % 700);
+        for (uint32_t i = 0; i < frames; i++) {
+            bad += pcm[2 * i] != sample(next + i, 0) || pcm[2 * i + 1] != sample(next + i, 1);
+        }
+        next += frames;
+        pcm_ring_release(r, frames);
+    }
+    producer.join();
+
+    pcm_ring_stats_t st;
+    pcm_ring_get_stats(r, &st);
+    pcm_ring_destroy(r);
+    const bool ok = next == kTotal && bad == 0 && st.frames_in == kTotal && st.frames_out == kTotal;
+    printf("stress: %llu frames through a %u-frame ring, %llu wrong, %u producer waits, %u underruns: %s\n\n",
+           (unsigned long long)next, (unsigned)kCap, (unsigned long long)bad, (unsigned)st.producer_waits,
+           (unsigned)st.underruns, ok ? "OK" : "FAIL");
+    return ok;
+}
+
+// ---- Part 2: decoder -> ring -> paced output ----
+
+struct Config {
+    const char *name;
+    uint32_t ring_frames;
+    uint32_t prebuffer_frames;
+    uint32_t out_chunk;
+};
+
+struct Stall {
+    uint32_t at_frame; // decoder stalls before producing this MP3 frame
+    uint32_t ms;
+};
+
+std::vector<Stall> make_stalls(uint32_t mp3_frames)
+{
+    std::mt19937 rng(42);
+    std::exponential_distribution<double> gap(1.0 / kStallEveryS);
+    std::uniform_int_distribution<uint32_t> len(kStallMinMs, kStallMaxMs);
+    const double frame_s = (double)kFrameSamples / kRate;
+    std::vector<Stall> stalls;
+    for (double t = gap(rng); t < mp3_frames * frame_s; t += gap(rng)) {
+        stalls.push_back({(uint32_t)(t / frame_s), len(rng)});
+    }
+    return stalls;
+}
+
+bool run(const Config &cfg, const std::vector<Stall> &stalls, uint32_t mp3_frames)
+{
+    pcm_ring_t *r = pcm_ring_create(cfg.ring_frames);
+    FILE *sink = tmpfile();
+    if (!r || !sink) {
+        return false;
+    }
+    const uint64_t total = (uint64_t)mp3_frames * kFrameSamples;
+    const double decode_us = kFrameSamples * 1e6 / kRate / kDecodeRealtime;
+
+    std::thread decoder([&] {
+        std::vector<int16_t> buf;
+        size_t s = 0;
+        for (uint32_t f = 0; f < mp3_frames; f++) {
+            while (s < stalls.size() && stalls[s].at_frame == f) {
+                sleep_sim_us(stalls[s++].ms * 1000.0);
+            }
+            sleep_sim_us(decode_us);
+            fill_frames(buf, (uint64_t)f * kFrameSamples, kFrameSamples);
+            const int16_t *p = buf.data();
+            uint32_t left = kFrameSamples;
+            for (;;) {
+                const uint32_t n = pcm_ring_write(r, p, left);
+                p += (size_t)n * 2;
+                left -= n;
+                if (left == 0) {
+                    break;
+                }
+                sleep_sim_us(kPollMs * 1000.0);
+            }
+        }
+        pcm_ring_close(r);
+    });
+
+    // Output: like the output task, prebuffer, then write chunks that take their playback time.
+    const Clock::time_point t0 = Clock::now();
+    while (!pcm_ring_is_closed(r) && pcm_ring_fill(r) < cfg.prebuffer_frames) {
+        sleep_sim_us(kPollMs * 1000.0);
+    }
+    Clock::time_point due = Clock::now();
+    bool starved = false;
+    for (;;) {
+        uint32_t frames = 0;
+        const int16_t *pcm = pcm_ring_peek(r, &frames);
+        if (frames == 0) {
+            if (pcm_ring_is_closed(r) && pcm_ring_fill(r) == 0) {
+                break;
+            }
+            starved = true;
+            sleep_sim_us(kPollMs * 1000.0);
+            continue;
+        }
+        frames = std::min(frames, cfg.out_chunk);
+        fwrite(pcm, sizeof(int16_t) * 2, frames, sink);
+        // The DMA plays at the sample rate; after running dry it restarts from now.
+        if (starved) {
+            due = std::max(due, Clock::now());
+            starved = false;
+        }
+        due += std::chrono::microseconds((int64_t)(frames * 1e6 / kRate / kSpeed));
+        std::this_thread::sleep_until(due);
+        pcm_ring_release(r, frames);
+    }
+    decoder.join();
+    const double wall_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // Compare the sink with the generated PCM.
+    rewind(sink);
+    std::vector<int16_t> got((size_t)kRate * 2);
+    uint64_t frame = 0;
+    uint64_t bad = 0;
+    size_t n;
+    while ((n = fread(got.data(), sizeof(int16_t) * 2, kRate, sink)) > 0) {
+        for (size_t i = 0; i < n; i++, frame++) {
+            bad += got[2 * i] != sample(frame, 0) || got[2 * i + 1] != sample(frame, 1);
+        }
+    }
+    fclose(sink);
+
+    pcm_ring_stats_t st;
+    pcm_ring_get_stats(r, &st);
+    pcm_ring_destroy(r);
+    uint32_t releases = 0;
+    for (uint32_t h : st.fill_hist) {
+        releases += h;
+    }
+    const bool ok = frame == total && bad == 0;
+    printf("%-10s %6u %6u %9u %9u %8u %6.1f  ", cfg.name, (unsigned)(cfg.ring_frames * 1000ull / kRate),
+           (unsigned)(cfg.prebuffer_frames * 1000ull / kRate), (unsigned)st.underruns, (unsigned)st.producer_waits,
+           (unsigned)(st.min_fill * 1000ull / kRate), wall_s * kSpeed);
+    for (uint32_t h : st.fill_hist) {
+        printf(" %3u", (unsigned)(releases ? h * 100ull / releases : 0));
+    }
+    printf("   %s\n", ok ? "OK" : "FAIL");
+    if (!ok) {
+        printf("  sink holds %llu of %llu frames, %llu wrong\n", (unsigned long long)frame,
+               (unsigned long long)total, (unsigned long long)bad);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = stress();
+
+    const uint32_t mp3_frames = kTrackSeconds * kRate / kFrameSamples;
+    const std::vector<Stall> stalls = make_stalls(mp3_frames);
+    uint32_t stall_ms = 0;
+    for (const Stall &s : stalls) {
+        stall_ms += s.ms;
+    }
+    printf("%u s track at %u Hz, decode %.0fx realtime, %zu SD stalls of %u..%u ms (%u ms total), %.0fx speed\n",
+           (unsigned)kTrackSeconds, (unsigned)kRate, kDecodeRealtime, stalls.size(), (unsigned)kStallMinMs,
+           (unsigned)kStallMaxMs, (unsigned)stall_ms, kSpeed);
+    printf("%-10s %6s %6s %9s %9s %8s %6s   %s\n", "config", "ring", "pre", "underruns", "prod_wait", "min_ms",
+           "sim_s", "fill % of writes by eighths (empty .. full)");
+
+    const Config configs[] = {
+        {"coupled", 6 * 240, 0, 240},
+        {"ring", kRate / 10, kRate / 20, kFrameSamples},
+        {"ring", kRate / 4, kRate / 8, kFrameSamples},
+        {"ring", kRate / 2, kRate / 4, kFrameSamples}, // the player's default
+    };
+    for (const Config &c : configs) {
+        ok = run(c, stalls, mp3_frames) && ok;
+    }
+    return ok ? 0 : 1;
+}
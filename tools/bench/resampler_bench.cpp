@@ -0,0 +1,189 @@
+// Host benchmark for main/audio_resampler.cpp.
+//
+//   g++ -O2 -std=c++17 -I main/include tools/bench/resampler_bench.cpp main/audio_resampler.cpp -o /tmp/resampler_bench
+//   /tmp/resampler_bench
+//
+// Converts every MP3 sample rate to the 48 kHz output rate and checks, per rate:
+//   - feeding the stream in random pieces gives the same output as one call,
+//   - a constant comes through unchanged (each phase has unity DC gain),
+//   - tones at 1 kHz and at 35% of the input rate keep their level (gain) and come out clean: the
+//     output is least-squares fitted to the ideal 48 kHz sine, and everything else (images,
+//     coefficient and output rounding) is counted as noise (SNR).
+// It also reports conversion cost per output frame. 48 kHz input must pass through bit-exact.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "audio_resampler.h"
+
+namespace {
+
+constexpr uint32_t kOutRate = 48000;
+constexpr double kAmplitude = 16000.0;
+constexpr double kMinGainDb = -0.2;
+constexpr double kMaxGainDb = 0.2;
+constexpr double kMinSnrDb = 70.0;
+
+std::vector<int16_t> tone(uint32_t rate, double hz, uint32_t frames, double phase_r)
+{
+    std::vector<int16_t> pcm((size_t)frames * 2);
+    for (uint32_t i = 0; i < frames; i++) {
+        const double w = 2.0 * M_PI * hz * i / rate;
+        pcm[2 * i] = (int16_t)lround(kAmplitude * sin(w));
+        pcm[2 * i + 1] = (int16_t)lround(kAmplitude * sin(w + phase_r));
+    }
+    return pcm;
+}
+
+std::vector<int16_t> convert(audio_resampler_t *r, const std::vector<int16_t> &in, std::mt19937 *chunks)
+{
+    const uint32_t frames = (uint32_t)(in.size() / 2);
+    std::vector<int16_t> out((size_t)audio_resampler_max_out(r, frames) * 2 + 2 * AUDIO_RESAMPLER_MAX_RATIO);
+    audio_resampler_reset(r);
+    uint32_t done = 0;
+    uint32_t produced = 0;
+    while (done < frames) {
+        uint32_t n = frames - done;
+        if (chunks) {
+            n = std::min<uint32_t>(n, 1 + (*chunks)() % 700);
+        }
+        std::vector<int16_t> part((size_t)audio_resampler_max_out(r, n) * 2);
+        const uint32_t got = audio_resampler_process(r, in.data() + (size_t)done * 2, n, part.data());
+        std::copy(part.begin(), part.begin() + (size_t)got * 2, out.begin() + (size_t)produced * 2);
+        produced += got;
+        done += n;
+    }
+    out.resize((size_t)produced * 2);
+    return out;
+}
+
+// Fits a*sin + b*cos + dc at hz to one channel, skipping the filter's start-up.
+void fit(const std::vector<int16_t> &pcm, int ch, double hz, double *gain_db, double *snr_db)
+{
+    const size_t frames = pcm.size() / 2;
+    const size_t skip = AUDIO_RESAMPLER_TAPS * AUDIO_RESAMPLER_MAX_RATIO * 2;
+    double ss = 0, sc = 0, cc = 0, sy = 0, cy = 0, s1 = 0, c1 = 0, y1 = 0, n = 0;
+    for (size_t i = skip; i < frames; i++) {
+        const double w = 2.0 * M_PI * hz * i / kOutRate;
+        const double s = sin(w), c = cos(w), y = pcm[2 * i + ch];
+        ss += s * s, sc += s * c, cc += c * c, sy += s * y, cy += c * y;
+        s1 += s, c1 += c, y1 += y, n += 1;
+    }
+    // 3x3 normal equations.
+    double m[3][4] = {{ss, sc, s1, sy}, {sc, cc, c1, cy}, {s1, c1, n, y1}};
+    for (int i = 0; i < 3; i++) {
+        for (int j = i + 1; j < 3; j++) {
+            const double f = m[j][i] / m[i][i];
+            for (int k = i; k < 4; k++) {
+                m[j][k] -= f * m[i][k];
+            }
+        }
+    }
+    double x[3];
+    for (int i = 2; i >= 0; i--) {
+        x[i] = m[i][3];
+        for (int k = i + 1; k < 3; k++) {
+            x[i] -= m[i][k] * x[k];
+        }
+        x[i] /= m[i][i];
+    }
+    double noise = 0;
+    for (size_t i = skip; i < frames; i++) {
+        const double w = 2.0 * M_PI * hz * i / kOutRate;
+        const double e = pcm[2 * i + ch] - (x[0] * sin(w) + x[1] * cos(w) + x[2]);
+        noise += e * e;
+    }
+    const double amp = sqrt(x[0] * x[0] + x[1] * x[1]);
+    *gain_db = 20.0 * log10(amp / kAmplitude);
+    *snr_db = 10.0 * log10((amp * amp / 2.0) / (noise / n + 1e-12));
+}
+
+} // namespace
+
+int main()
+{
+    const uint32_t rates[] = {8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000};
+    bool ok = true;
+    std::mt19937 rng(7);
+
+    printf("%-7s %6s %8s %7s %9s %9s %9s %9s %9s\n", "in_hz", "phases", "table_KB", "ns/frm", "chunked",
+           "dc", "1k_gain", "1k_snr", "hi_snr");
+    for (uint32_t rate : rates) {
+        audio_resampler_t *r = audio_resampler_create(rate, kOutRate);
+        if (!r) {
+            printf("%-7u unsupported: FAIL\n", (unsigned)rate);
+            ok = false;
+            continue;
+        }
+        const bool passthrough = rate == kOutRate;
+        const uint32_t phases = passthrough ? 0 : kOutRate / std::gcd(rate, kOutRate);
+
+        // Chunked == one call, and passthrough is exact.
+        const std::vector<int16_t> t1 = tone(rate, 1000.0, rate * 2, 1.0);
+        const std::vector<int16_t> whole = convert(r, t1, nullptr);
+        const std::vector<int16_t> pieces = convert(r, t1, &rng);
+        bool chunked_ok = whole == pieces;
+        if (passthrough) {
+            chunked_ok = chunked_ok && whole == t1;
+        }
+
+        // DC: after the start-up every frame equals the input constant.
+        std::vector<int16_t> dc_in((size_t)rate * 2, 12345);
+        for (size_t i = 1; i < dc_in.size(); i += 2) {
+            dc_in[i] = -20000;
+        }
+        const std::vector<int16_t> dc_out = convert(r, dc_in, &rng);
+        bool dc_ok = true;
+        for (size_t i = AUDIO_RESAMPLER_TAPS * AUDIO_RESAMPLER_MAX_RATIO * 2; i + 1 < dc_out.size(); i += 2) {
+            dc_ok = dc_ok && dc_out[i] == 12345 && dc_out[i + 1] == -20000;
+        }
+
+        double g1, s1, g_hi, s_hi, g_dummy, s_dummy;
+        fit(whole, 0, 1000.0, &g1, &s1);
+        fit(whole, 1, 1000.0, &g_dummy, &s_dummy);
+        s1 = std::min(s1, s_dummy);
+        const double hi_hz = 0.35 * rate;
+        const std::vector<int16_t> hi = convert(r, tone(rate, hi_hz, rate * 2, 0.5), nullptr);
+        fit(hi, 0, hi_hz, &g_hi, &s_hi);
+
+        // Cost: 10 s of 1 kHz through one call per 1152-frame MP3 frame.
+        const std::vector<int16_t> src = tone(rate, 1000.0, rate * 10, 1.0);
+        std::vector<int16_t> out((size_t)audio_resampler_max_out(r, 1152) * 2);
+        uint64_t produced = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t f = 0; f + 1152 <= src.size() / 2; f += 1152) {
+            produced += audio_resampler_process(r, src.data() + f * 2, 1152, out.data());
+        }
+        const double ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / (double)produced;
+
+        const bool rate_ok = chunked_ok && dc_ok && g1 >= kMinGainDb && g1 <= kMaxGainDb && g_hi >= kMinGainDb &&
+                             g_hi <= kMaxGainDb && s1 >= kMinSnrDb && s_hi >= kMinSnrDb;
+        ok = ok && rate_ok;
+        printf("%-7u %6u %8.1f %7.1f %9s %9s %+8.2f %8.1f %8.1f  (%+.2f dB at %.0f Hz)  %s\n", (unsigned)rate,
+               (unsigned)phases, phases * AUDIO_RESAMPLER_TAPS * 2 / 1024.0, ns,
+               chunked_ok ? "same" : "DIFF", dc_ok ? "exact" : "DRIFT", g1, s1, s_hi, g_hi, hi_hz,
+               rate_ok ? "OK" : "FAIL");
+        audio_resampler_destroy(r);
+    }
+
+    // Unsupported ratios are refused rather than converted badly.
+    audio_resampler_t *down = audio_resampler_create(96000, kOutRate);
+    audio_resampler_t *odd = audio_resampler_create(47999, kOutRate);
+    if (down || odd) {
+        printf("96 kHz (downsampling) or 47999 Hz (48000 phases) was accepted: FAIL\n");
+        ok = false;
+    }
+    audio_resampler_destroy(down);
+    audio_resampler_destroy(odd);
+
+    printf("\n%u taps per phase; thresholds: gain %+.1f..%+.1f dB, SNR >= %.0f dB\n", (unsigned)AUDIO_RESAMPLER_TAPS,
+           kMinGainDb, kMaxGainDb, kMinSnrDb);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Host benchmark for the boot splash asset (tools/img_conv.py, main/assets.cpp).
+//
+//   python3 tools/img_conv.py logo.png /tmp/asset_logo.h logo --swap
+//   python3 tools/img_conv.py logo.png /tmp/asset_logo_rle.h logo --swap --rle
+//   g++ -O2 -std=c++17 tools/bench/splash_asset_bench.cpp -lpng -o /tmp/splash_asset_bench
+//   /tmp/splash_asset_bench logo.png /tmp/asset_logo.h /tmp/asset_logo_rle.h
+//
+// Before: the splash embedded logo.png, so the first frame decoded it (inflate + unfilter) and
+// converted RGBA8888 to LVGL's RGB565 + alpha. After: the pixels are generated at build time and
+// drawn from flash, or unpacked once when the asset is RLE. This times the per-boot work on each
+// path and checks libpng's decode, converted here, against the bytes img_conv.py generated.
+// libpng stands in for LVGL's PNG decoder, which the firmware no longer builds (CONFIG_LV_USE_PNG).
+
+#include <png.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kRuns = 50;
+
+std::vector<uint8_t> read_file(const char *path)
+{
+    std::vector<uint8_t> data;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        exit(1);
+    }
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        data.insert(data.end(), buf, buf + n);
+    }
+    fclose(f);
+    return data;
+}
+
+// The bytes of the asset_<name>_map[] initializer in a generated header.
+std::vector<uint8_t> read_asset_map(const char *path)
+{
+    const std::vector<uint8_t> text = read_file(path);
+    std::string s(text.begin(), text.end());
+    const size_t start = s.find("_map[] = {");
+    const size_t end = s.find("};", start);
+    if (start == std::string::npos || end == std::string::npos) {
+        fprintf(stderr, "%s: no asset map\n", path);
+        exit(1);
+    }
+    std::vector<uint8_t> out;
+    for (size_t p = s.find("0x", start); p < end; p = s.find("0x", p + 4)) {
+        out.push_back((uint8_t)strtoul(s.substr(p, 4).c_str(), nullptr, 16));
+    }
+    return out;
+}
+
+// What the old splash paid on its first frame: PNG decode plus conversion to lv_color_t + alpha.
+std::vector<uint8_t> decode_png_native(const std::vector<uint8_t> &png, uint32_t *w, uint32_t *h)
+{
+    png_image img;
+    memset(&img, 0, sizeof(img));
+    img.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&img, png.data(), png.size())) {
+        fprintf(stderr, "png: %s\n", img.message);
+        exit(1);
+    }
+    img.format = PNG_FORMAT_RGBA;
+    std::vector<uint8_t> rgba(PNG_IMAGE_SIZE(img));
+    if (!png_image_finish_read(&img, nullptr, rgba.data(), 0, nullptr)) {
+        fprintf(stderr, "png: %s\n", img.message);
+        exit(1);
+    }
+    *w = img.width;
+    *h = img.height;
+    std::vector<uint8_t> out((size_t)img.width * img.height * 3);
+    for (size_t i = 0, o = 0; i < rgba.size(); i += 4, o += 3) {
+        const uint8_t a = rgba[i + 3];
+        const uint16_t c = a ? (uint16_t)(((rgba[i] >> 3) << 11) | ((rgba[i + 1] >> 2) << 5) | (rgba[i + 2] >> 3)) : 0;
+        out[o] = (uint8_t)(c >> 8); // LV_COLOR_16_SWAP
+        out[o + 1] = (uint8_t)c;
+        out[o + 2] = a;
+    }
+    return out;
+}
+
+// Same format as rle_unpack() in main/assets.cpp.
+bool rle_unpack(const std::vector<uint8_t> &in, std::vector<uint8_t> &out, uint32_t bpp)
+{
+    size_t i = 0;
+    size_t o = 0;
+    while (i < in.size()) {
+        const uint8_t ctrl = in[i++];
+        const size_t bytes = ((ctrl & 0x7F) + 1) * bpp;
+        if (o + bytes > out.size()) return false;
+        if (ctrl & 0x80) {
+            if (i + bytes > in.size()) return false;
+            memcpy(&out[o], &in[i], bytes);
+            i += bytes;
+        } else {
+            if (i + bpp > in.size()) return false;
+            for (size_t k = 0; k < bytes; k += bpp) {
+                memcpy(&out[o + k], &in[i], bpp);
+            }
+            i += bpp;
+        }
+        o += bytes;
+    }
+    return o == out.size();
+}
+
+template <typename F>
+double time_us(F &&fn)
+{
+    double best = 1e30;
+    for (int r = 0; r < kRuns; r++) {
+        const auto t0 = std::chrono::steady_clock::now();
+        fn();
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+        if (us < best) best = us;
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s logo.png asset_logo.h asset_logo_rle.h\n", argv[0]);
+        return 2;
+    }
+    const std::vector<uint8_t> png = read_file(argv[1]);
+    const std::vector<uint8_t> raw = read_asset_map(argv[2]);
+    const std::vector<uint8_t> rle = read_asset_map(argv[3]);
+
+    uint32_t w = 0;
+    uint32_t h = 0;
+    const std::vector<uint8_t> decoded = decode_png_native(png, &w, &h);
+    std::vector<uint8_t> unpacked(raw.size());
+    if (decoded != raw) {
+        fprintf(stderr, "MISMATCH: libpng decode differs from the generated asset\n");
+        return 1;
+    }
+    if (!rle_unpack(rle, unpacked, 3) || unpacked != raw) {
+        fprintf(stderr, "MISMATCH: RLE asset does not unpack to the raw asset\n");
+        return 1;
+    }
+
+    const double png_us = time_us([&] { decode_png_native(png, &w, &h); });
+    const double rle_us = time_us([&] { rle_unpack(rle, unpacked, 3); });
+    printf("logo %ux%u, best of %d runs (host CPU)\n", (unsigned)w, (unsigned)h, kRuns);
+    printf("  %-26s %8zu bytes flash  %8.1f us\n", "PNG decode + convert", png.size(), png_us);
+    printf("  %-26s %8zu bytes flash  %8.1f us\n", "RLE asset (unpack once)", rle.size(), rle_us);
+    printf("  %-26s %8zu bytes flash  %8.1f us\n", "raw asset", raw.size(), 0.0);
+    return 0;
+}
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+Image Converter - Turns PNG assets into native LVGL 8 image data at build time
+
+Usage: python img_conv.py <input.png> <output.h> <name> [--swap] [--rle]
+
+The output header defines `asset_<name>`, a constexpr asset_img_t (see main/include/assets.h) whose
+pixels are already in the firmware's lv_color_t layout: RGB565, byte-swapped with --swap to match
+LV_COLOR_16_SWAP, plus an alpha byte per pixel when the PNG has transparency. --rle packs the pixels
+with the run-length scheme asset_img() unpacks. Only the Python standard library is used.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+LV_IMG_CF_TRUE_COLOR = 4
+LV_IMG_CF_TRUE_COLOR_ALPHA = 5
+LV_IMG_MAX_SIZE = 2047  # lv_img_header_t width/height are 11-bit fields
+RLE_MAX_RUN = 128
+
+
+def read_png(path):
+    """Returns (width, height, rows) with rows as lists of (r, g, b, a) tuples"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(f"{path}: not a PNG file")
+
+    pos = 8
+    idat = bytearray()
+    width = height = color_type = None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+            if depth != 8 or color_type not in (2, 6) or interlace != 0:
+                raise ValueError(f"{path}: only 8-bit RGB/RGBA non-interlaced PNGs are supported")
+        elif kind == b'IDAT':
+            idat.extend(chunk)
+        elif kind == b'IEND':
+            break
+    if width is None:
+        raise ValueError(f"{path}: missing IHDR")
+
+    channels = 4 if color_type == 6 else 3
+    stride = width * channels
+    raw = zlib.decompress(bytes(idat))
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        filt = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if filt == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filt == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filt == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif filt == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        rows.append([tuple(line[x * channels:x * channels + 3]) + ((line[x * channels + 3],) if channels == 4 else (255,))
+                     for x in range(width)])
+        prev = line
+    return width, height, rows
+
+
+def convert(width, height, rows, swap):
+    """Returns (cf, bytes per pixel, pixel data) in LVGL's 16-bit lv_color_t layout"""
+    has_alpha = any(px[3] != 255 for row in rows for px in row)
+    cf = LV_IMG_CF_TRUE_COLOR_ALPHA if has_alpha else LV_IMG_CF_TRUE_COLOR
+    fmt = '>H' if swap else '<H'
+    out = bytearray()
+    for row in rows:
+        for r, g, b, a in row:
+            if a == 0:
+                r = g = b = 0  # invisible anyway; keeps runs long for --rle
+            out.extend(struct.pack(fmt, ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)))
+            if has_alpha:
+                out.append(a)
+    return cf, 3 if has_alpha else 2, bytes(out)
+
+
+def rle_pack(data, bpp):
+    """Control byte n < 0x80: pixel repeated n + 1 times; n >= 0x80: (n & 0x7F) + 1 literal pixels"""
+    pixels = [data[i:i + bpp] for i in range(0, len(data), bpp)]
+    out = bytearray()
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < RLE_MAX_RUN and pixels[i + run] == pixels[i]:
+            run += 1
+        if run > 1:
+            out.append(run - 1)
+            out.extend(pixels[i])
+            i += run
+            continue
+        start = i
+        while i < len(pixels) and i - start < RLE_MAX_RUN:
+            if i + 1 < len(pixels) and pixels[i + 1] == pixels[i]:
+                break
+            i += 1
+        out.append(0x80 | (i - start - 1))
+        for px in pixels[start:i]:
+            out.extend(px)
+    return bytes(out)
+
+
+def write_header(path, name, src, width, height, cf, raw_size, data, swap, rle):
+    lines = [
+        f"// Generated by tools/img_conv.py from {os.path.basename(src)}. Do not edit.",
+        "#pragma once",
+        "",
+        '#include "assets.h"',
+        "",
+        "static_assert(LV_COLOR_DEPTH == 16, \"assets are generated for 16-bit color\");",
+        f"static_assert(LV_COLOR_16_SWAP == {1 if swap else 0}, \"assets were generated for another LV_COLOR_16_SWAP\");",
+        "",
+        f"alignas(4) inline constexpr uint8_t asset_{name}_map[] = {{",
+    ]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + 16]) + ",")
+    lines += [
+        "};",
+        "",
+        f"inline constexpr asset_img_t asset_{name} = {{",
+        f"    {{{{{cf}, 0, 0, {width}, {height}}}, sizeof(asset_{name}_map), asset_{name}_map}},",
+        f"    {raw_size},",
+        f"    {'true' if rle else 'false'},",
+        "};",
+        "",
+    ]
+    with open(path, 'w', newline='\r\n') as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith('--')]
+    flags = {a for a in sys.argv[1:] if a.startswith('--')}
+    if len(args) != 3 or not flags <= {'--swap', '--rle'}:
+        print("Usage: python img_conv.py <input.png> <output.h> <name> [--swap] [--rle]")
+        sys.exit(1)
+    src, dst, name = args
+    swap = '--swap' in flags
+    rle = '--rle' in flags
+
+    width, height, rows = read_png(src)
+    if width > LV_IMG_MAX_SIZE or height > LV_IMG_MAX_SIZE:
+        raise ValueError(f"{src}: {width}x{height} exceeds LVGL's {LV_IMG_MAX_SIZE} px limit")
+    cf, bpp, data = convert(width, height, rows, swap)
+    raw_size = len(data)
+    if rle:
+        data = rle_pack(data, bpp)
+    write_header(dst, name, src, width, height, cf, raw_size, data, swap, rle)
+    print(f"{src}: {width}x{height} cf={cf} {raw_size} bytes" + (f", {len(data)} RLE" if rle else ""))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Mirror Decoder - Rebuilds screens from a recorded screen_mirror stream
+
+Usage: python mirror_decode.py <capture.bin> <out.ppm> [--frames DIR]
+
+The capture is what `launcher_sim --mirror FILE` records: each message the device would send over
+/mirror/ws (see main/include/screen_mirror.h), prefixed with its length as a little-endian u32.
+The final screen is written as a binary PPM with the same RGB565 expansion as the simulator's
+`screenshot` command, so the two can be compared byte for byte. --frames also writes the screen
+after every sender pass (frame_0000.ppm, ...). Only the Python standard library is used.
+"""
+
+import os
+import struct
+import sys
+
+CODEC_RAW = 0
+CODEC_RLE = 1
+
+
+def read_messages(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    pos = 0
+    while pos + 4 <= len(data):
+        (length,) = struct.unpack_from('<I', data, pos)
+        pos += 4
+        if pos + length > len(data):
+            raise ValueError(f"{path}: truncated message at byte {pos}")
+        yield data[pos:pos + length]
+        pos += length
+
+
+def decode_pixels(codec, payload, count):
+    if codec == CODEC_RAW:
+        return list(struct.unpack_from(f'<{count}H', payload))
+    if codec != CODEC_RLE:
+        raise ValueError(f"unknown codec {codec}")
+    px = []
+    i = 0
+    while i < len(payload):
+        ctrl = payload[i]
+        i += 1
+        n = (ctrl & 0x7F) + 1
+        if ctrl & 0x80:
+            px.extend(struct.unpack_from(f'<{n}H', payload, i))
+            i += n * 2
+        else:
+            (v,) = struct.unpack_from('<H', payload, i)
+            px.extend([v] * n)
+            i += 2
+    if len(px) != count:
+        raise ValueError(f"RLE rectangle holds {len(px)} pixels, expected {count}")
+    return px
+
+
+def write_ppm(path, width, height, screen):
+    out = bytearray()
+    for c in screen:
+        out += bytes((((c >> 11) & 0x1F) * 255 // 31, ((c >> 5) & 0x3F) * 255 // 63, (c & 0x1F) * 255 // 31))
+    with open(path, 'wb') as f:
+        f.write(f"P6\n{width} {height}\n255\n".encode())
+        f.write(out)
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith('--')]
+    frames_dir = None
+    if '--frames' in sys.argv:
+        idx = sys.argv.index('--frames')
+        if idx + 1 >= len(sys.argv):
+            args = []
+        else:
+            frames_dir = sys.argv[idx + 1]
+            args.remove(frames_dir)
+    if len(args) != 2:
+        print("Usage: python mirror_decode.py <capture.bin> <out.ppm> [--frames DIR]")
+        sys.exit(1)
+    src, dst = args
+
+    width = height = 0
+    screen = []
+    rects = raw = rle = 0
+    payload_bytes = 0
+    frame = 0
+    for msg in read_messages(src):
+        kind = msg[0:1]
+        if kind == b'H':
+            _, version, width, height = struct.unpack_from('<BBHH', msg)
+            if version != 1:
+                raise ValueError(f"unsupported stream version {version}")
+            if len(screen) != width * height:
+                screen = [0] * (width * height)
+            continue
+        if kind == b'F':
+            if frames_dir:
+                write_ppm(os.path.join(frames_dir, f"frame_{frame:04d}.ppm"), width, height, screen)
+            frame += 1
+            continue
+        if kind != b'R' or not width:
+            raise ValueError("rectangle before the hello message")
+        _, codec, x, y, w, h = struct.unpack_from('<BBHHHH', msg)
+        if x + w > width or y + h > height:
+            raise ValueError(f"rectangle {x},{y} {w}x{h} is off screen")
+        px = decode_pixels(codec, msg[10:], w * h)
+        for row in range(h):
+            start = (y + row) * width + x
+            screen[start:start + w] = px[row * w:(row + 1) * w]
+        rects += 1
+        raw += codec == CODEC_RAW
+        rle += codec == CODEC_RLE
+        payload_bytes += len(msg)
+
+    if not width:
+        raise ValueError(f"{src}: no hello message")
+    write_ppm(dst, width, height, screen)
+    print(f"{src}: {width}x{height}, {frame} frames, {rects} rectangles ({rle} RLE, {raw} raw), {payload_bytes} bytes")
+
+
+if __name__ == "__main__":
+    main()